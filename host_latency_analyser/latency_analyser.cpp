@@ -0,0 +1,744 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/* Round-trip latency, packet jitter and feedback accuracy analyser for lib_xua devices
+ *
+ * Opens the Audio Class 2.0 streaming interfaces of the device directly with libusb and streams a test
+ * signal out while capturing the stream in. The device (or an external cable) must loop an output channel
+ * back to an input channel, for example with the lib_xua channel maps (see host_usb_mixer_control).
+ *
+ * Two test signals are supported:
+ *  - counter: every sample of the test channel holds the index of the output sample. Requires a bit exact
+ *             (digital) loopback and gives the latency of every captured sample as well as detecting dropouts
+ *  - pulse:   a full scale pulse once per period, detected by threshold on the input. For analogue loopbacks
+ *
+ * For each sample rate the round-trip latency, the IN packet size and completion jitter and the rate reported
+ * by the feedback endpoint (against both the nominal rate and the rate measured from the IN stream) is
+ * reported. Feedback values may be logged to a CSV file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include "libusb.h"
+
+#define XMOS_VID                0x20b1
+
+#define USB_CLASS_AUDIO_        0x01
+#define USB_SUBCLASS_CONTROL    0x01
+#define USB_SUBCLASS_STREAMING  0x02
+#define USB_CS_INTERFACE        0x24
+
+#define UAC2_AS_GENERAL         0x01
+#define UAC2_FORMAT_TYPE        0x02
+#define UAC2_CLOCK_SOURCE       0x0A
+#define UAC2_CS_SAM_FREQ_CONTROL 0x01
+#define UAC2_CUR                0x01
+
+#define USB_REQUEST_TO_DEV      0x21
+#define USB_REQUEST_FROM_DEV    0xa1
+
+#define EP_USAGE_TYPE(attr)     (((attr) >> 4) & 3)
+#define EP_USAGE_FEEDBACK       1
+
+#define NUM_TRANSFERS           8       /* Transfers in flight per endpoint */
+#define PACKETS_PER_TRANSFER    8
+
+#define MAX_RATES               16
+#define PULSE_THRESHOLD         0x40000000
+
+typedef struct
+{
+    int iface;
+    int alt;
+    int ep;
+    int maxPacket;
+    int chans;
+    int subslot;
+    int fbEp;                           /* Explicit feedback endpoint, 0 if none */
+    int fbMaxPacket;
+} stream_t;
+
+typedef struct
+{
+    double sum;
+    double sumSq;
+    double min;
+    double max;
+    unsigned long long count;
+} stats_t;
+
+static libusb_device_handle *devh = NULL;
+static int highSpeed = 0;
+static int packetsPerSec = 1000;
+static int clockId = -1;
+static int controlIface = 0;
+
+static stream_t streamOut, streamIn;
+
+/* Options */
+static int signalPulse = 0;
+static int outChan = 0;
+static int inChan = 0;
+static int pulsePeriod = 4800;
+static double duration = 10.0;
+static const char *logFilename = NULL;
+static FILE *logFile = NULL;
+
+/* Per rate state, accessed from the libusb callbacks */
+static unsigned sampleRate;
+static double outFrac;                  /* Fractional samples carried between OUT packets */
+static double fbRate;                   /* Samples per packet, from the feedback endpoint */
+static unsigned long long outIndex;     /* Index of the next sample to be played */
+static unsigned long long inIndex;      /* Index of the next sample captured */
+static unsigned long long lastPulseIn;
+static unsigned long long lastDelay;     /* Latency of the last captured counter sample */
+static int running;
+static int inFlight;
+static double startTime;
+static double lastInTime;
+
+static stats_t latency, inPacketSize, inInterval, fbHz;
+static unsigned long long dropouts;
+static unsigned long long inSamplesTotal;
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void stats_reset(stats_t *s)
+{
+    memset(s, 0, sizeof(*s));
+    s->min = 1e300;
+    s->max = -1e300;
+}
+
+static void stats_add(stats_t *s, double v)
+{
+    s->sum += v;
+    s->sumSq += v * v;
+    s->count++;
+    if (v < s->min)
+        s->min = v;
+    if (v > s->max)
+        s->max = v;
+}
+
+static double stats_mean(const stats_t *s)
+{
+    return s->count ? s->sum / s->count : 0;
+}
+
+static double stats_sd(const stats_t *s)
+{
+    if (s->count < 2)
+        return 0;
+    double m = stats_mean(s);
+    double v = s->sumSq / s->count - m * m;
+    return v > 0 ? sqrt(v) : 0;
+}
+
+/* Find the streaming interfaces and the clock source from the active configuration */
+static int find_streams(libusb_device *dev, int altOut, int altIn)
+{
+    struct libusb_config_descriptor *config;
+
+    if (libusb_get_active_config_descriptor(dev, &config) < 0)
+    {
+        fprintf(stderr, "Could not read configuration descriptor\n");
+        return -1;
+    }
+
+    memset(&streamOut, 0, sizeof(streamOut));
+    memset(&streamIn, 0, sizeof(streamIn));
+    streamOut.iface = streamIn.iface = -1;
+
+    for (int i = 0; i < config->bNumInterfaces; i++)
+    {
+        const struct libusb_interface *iface = &config->interface[i];
+
+        for (int a = 0; a < iface->num_altsetting; a++)
+        {
+            const struct libusb_interface_descriptor *alt = &iface->altsetting[a];
+
+            if (alt->bInterfaceClass != USB_CLASS_AUDIO_)
+                continue;
+
+            if (alt->bInterfaceSubClass == USB_SUBCLASS_CONTROL)
+            {
+                controlIface = alt->bInterfaceNumber;
+
+                /* Use the first clock source */
+                for (int j = 0; j + 3 < alt->extra_length; j += alt->extra[j])
+                {
+                    if (alt->extra[j] == 0)
+                        break;
+                    if ((alt->extra[j + 1] == USB_CS_INTERFACE) && (alt->extra[j + 2] == UAC2_CLOCK_SOURCE) && (clockId < 0))
+                        clockId = alt->extra[j + 3];
+                }
+                continue;
+            }
+
+            if ((alt->bInterfaceSubClass != USB_SUBCLASS_STREAMING) || (alt->bNumEndpoints == 0))
+                continue;
+
+            stream_t s;
+            memset(&s, 0, sizeof(s));
+            s.iface = alt->bInterfaceNumber;
+            s.alt = alt->bAlternateSetting;
+
+            for (int j = 0; j + 5 < alt->extra_length; j += alt->extra[j])
+            {
+                if (alt->extra[j] == 0)
+                    break;
+                if (alt->extra[j + 1] != USB_CS_INTERFACE)
+                    continue;
+                if ((alt->extra[j + 2] == UAC2_AS_GENERAL) && (alt->extra[j] > 10))
+                    s.chans = alt->extra[j + 10];
+                else if (alt->extra[j + 2] == UAC2_FORMAT_TYPE)
+                    s.subslot = alt->extra[j + 4];
+            }
+
+            int dirIn = 0;
+            for (int e = 0; e < alt->bNumEndpoints; e++)
+            {
+                const struct libusb_endpoint_descriptor *ep = &alt->endpoint[e];
+
+                if ((ep->bmAttributes & 3) != LIBUSB_TRANSFER_TYPE_ISOCHRONOUS)
+                    continue;
+
+                if (EP_USAGE_TYPE(ep->bmAttributes) == EP_USAGE_FEEDBACK)
+                {
+                    s.fbEp = ep->bEndpointAddress;
+                    s.fbMaxPacket = ep->wMaxPacketSize & 0x7ff;
+                }
+                else
+                {
+                    s.ep = ep->bEndpointAddress;
+                    s.maxPacket = ep->wMaxPacketSize & 0x7ff;
+                    dirIn = (ep->bEndpointAddress & LIBUSB_ENDPOINT_IN) != 0;
+                }
+            }
+
+            if (!s.ep || !s.chans || !s.subslot)
+                continue;
+
+            /* Take the requested alternate, otherwise the first */
+            stream_t *d = dirIn ? &streamIn : &streamOut;
+            int want = dirIn ? altIn : altOut;
+            if ((d->iface < 0 && want == 0) || (s.alt == want))
+                *d = s;
+        }
+    }
+
+    libusb_free_config_descriptor(config);
+
+    if (streamOut.iface < 0 || streamIn.iface < 0)
+    {
+        fprintf(stderr, "Device does not have both an OUT and an IN Audio Class 2.0 streaming interface\n");
+        return -1;
+    }
+
+    if (clockId < 0)
+    {
+        fprintf(stderr, "No Audio Class 2.0 clock source found\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int set_sample_rate(unsigned rate)
+{
+    unsigned char data[4] = {(unsigned char)rate, (unsigned char)(rate >> 8), (unsigned char)(rate >> 16), (unsigned char)(rate >> 24)};
+    unsigned char readback[4];
+
+    if (libusb_control_transfer(devh, USB_REQUEST_TO_DEV, UAC2_CUR, UAC2_CS_SAM_FREQ_CONTROL << 8,
+            (clockId << 8) | controlIface, data, 4, 1000) != 4)
+    {
+        fprintf(stderr, "Failed to set sample rate %u\n", rate);
+        return -1;
+    }
+
+    if (libusb_control_transfer(devh, USB_REQUEST_FROM_DEV, UAC2_CUR, UAC2_CS_SAM_FREQ_CONTROL << 8,
+            (clockId << 8) | controlIface, readback, 4, 1000) == 4)
+    {
+        unsigned cur = readback[0] | (readback[1] << 8) | (readback[2] << 16) | ((unsigned)readback[3] << 24);
+        if (cur != rate)
+        {
+            fprintf(stderr, "Device reports %u Hz after setting %u Hz\n", cur, rate);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* Sample values are handled as left justified 32-bit */
+static void put_sample(unsigned char *p, int subslot, unsigned v)
+{
+    for (int b = 0; b < subslot; b++)
+        p[b] = (unsigned char)(v >> (8 * (4 - subslot + b)));
+}
+
+static unsigned get_sample(const unsigned char *p, int subslot)
+{
+    unsigned v = 0;
+    for (int b = 0; b < subslot; b++)
+        v |= (unsigned)p[b] << (8 * (4 - subslot + b));
+    return v;
+}
+
+/* Bits of the counter test signal that survive both the OUT and IN subslot sizes */
+static unsigned counter_bits(void)
+{
+    int subslot = streamIn.subslot < streamOut.subslot ? streamIn.subslot : streamOut.subslot;
+    return 8 * subslot;
+}
+
+/* Test signal sample for output sample index n. In counter mode the index is placed in the MSBs */
+static unsigned signal_sample(unsigned long long n)
+{
+    if (signalPulse)
+        return (n % pulsePeriod) == 0 ? 0x7fffff00 : 0;
+
+    return (unsigned)(n << (32 - counter_bits()));
+}
+
+static void fill_out_transfer(struct libusb_transfer *xfr)
+{
+    int frameBytes = streamOut.chans * streamOut.subslot;
+    int offset = 0;
+
+    for (int p = 0; p < xfr->num_iso_packets; p++)
+    {
+        outFrac += fbRate;
+        int samples = (int)outFrac;
+        outFrac -= samples;
+
+        if (samples * frameBytes > streamOut.maxPacket)
+            samples = streamOut.maxPacket / frameBytes;
+
+        unsigned char *pkt = xfr->buffer + offset;
+        memset(pkt, 0, samples * frameBytes);
+        for (int s = 0; s < samples; s++)
+        {
+            put_sample(pkt + s * frameBytes + outChan * streamOut.subslot, streamOut.subslot, signal_sample(outIndex));
+            outIndex++;
+        }
+
+        xfr->iso_packet_desc[p].length = samples * frameBytes;
+        offset += streamOut.maxPacket;
+    }
+}
+
+static void LIBUSB_CALL out_callback(struct libusb_transfer *xfr)
+{
+    if (!running || xfr->status == LIBUSB_TRANSFER_CANCELLED)
+    {
+        inFlight--;
+        return;
+    }
+
+    fill_out_transfer(xfr);
+    if (libusb_submit_transfer(xfr) < 0)
+        inFlight--;
+}
+
+static void LIBUSB_CALL in_callback(struct libusb_transfer *xfr)
+{
+    if (!running || xfr->status == LIBUSB_TRANSFER_CANCELLED)
+    {
+        inFlight--;
+        return;
+    }
+
+    double t = now();
+    if (lastInTime > 0)
+        stats_add(&inInterval, (t - lastInTime) * 1e6);
+    lastInTime = t;
+
+    int frameBytes = streamIn.chans * streamIn.subslot;
+    unsigned bits = counter_bits();
+    unsigned long long mask = (bits >= 32) ? 0xffffffffULL : ((1ULL << bits) - 1);
+
+    for (int p = 0; p < xfr->num_iso_packets; p++)
+    {
+        struct libusb_iso_packet_descriptor *d = &xfr->iso_packet_desc[p];
+        if (d->status != LIBUSB_TRANSFER_COMPLETED)
+            continue;
+
+        int samples = d->actual_length / frameBytes;
+        stats_add(&inPacketSize, samples);
+        inSamplesTotal += samples;
+
+        unsigned char *pkt = libusb_get_iso_packet_buffer_simple(xfr, p);
+        for (int s = 0; s < samples; s++)
+        {
+            unsigned v = get_sample(pkt + s * frameBytes + inChan * streamIn.subslot, streamIn.subslot);
+
+            if (signalPulse)
+            {
+                if (((int)v > PULSE_THRESHOLD) && (inIndex - lastPulseIn > (unsigned long long)pulsePeriod / 2))
+                {
+                    stats_add(&latency, (double)(inIndex % pulsePeriod));
+                    lastPulseIn = inIndex;
+                }
+            }
+            else if (v != 0)
+            {
+                /* Sample index of the played sample, extended to the full counter relative to the capture index */
+                unsigned long long played = v >> (32 - bits);
+                unsigned long long delay = (inIndex - played) & mask;
+                if (latency.count && delay != lastDelay)
+                    dropouts++;
+                lastDelay = delay;
+                stats_add(&latency, (double)delay);
+            }
+            inIndex++;
+        }
+    }
+
+    if (libusb_submit_transfer(xfr) < 0)
+        inFlight--;
+}
+
+static void LIBUSB_CALL fb_callback(struct libusb_transfer *xfr)
+{
+    if (!running || xfr->status == LIBUSB_TRANSFER_CANCELLED)
+    {
+        inFlight--;
+        return;
+    }
+
+    for (int p = 0; p < xfr->num_iso_packets; p++)
+    {
+        struct libusb_iso_packet_descriptor *d = &xfr->iso_packet_desc[p];
+        unsigned char *b = libusb_get_iso_packet_buffer_simple(xfr, p);
+        unsigned raw;
+        double perPacket;
+
+        if (d->status != LIBUSB_TRANSFER_COMPLETED || d->actual_length < 3)
+            continue;
+
+        if (highSpeed && d->actual_length >= 4)
+        {
+            /* 16.16 samples per microframe */
+            raw = b[0] | (b[1] << 8) | (b[2] << 16) | ((unsigned)b[3] << 24);
+            perPacket = raw / 65536.0;
+        }
+        else
+        {
+            /* 10.14 samples per frame */
+            raw = b[0] | (b[1] << 8) | (b[2] << 16);
+            perPacket = raw / 16384.0;
+        }
+
+        if (perPacket <= 0)
+            continue;
+
+        fbRate = perPacket;
+        stats_add(&fbHz, perPacket * packetsPerSec);
+
+        if (logFile)
+            fprintf(logFile, "%u,%.6f,0x%08x,%.4f\n", sampleRate, now() - startTime, raw, perPacket * packetsPerSec);
+    }
+
+    if (libusb_submit_transfer(xfr) < 0)
+        inFlight--;
+}
+
+static struct libusb_transfer *alloc_transfer(int ep, int maxPacket, libusb_transfer_cb_fn cb)
+{
+    struct libusb_transfer *xfr = libusb_alloc_transfer(PACKETS_PER_TRANSFER);
+    unsigned char *buf = (unsigned char *)calloc(PACKETS_PER_TRANSFER, maxPacket);
+
+    libusb_fill_iso_transfer(xfr, devh, ep, buf, PACKETS_PER_TRANSFER * maxPacket, PACKETS_PER_TRANSFER, cb, NULL, 1000);
+    libusb_set_iso_packet_lengths(xfr, maxPacket);
+    return xfr;
+}
+
+static int run_rate(unsigned rate)
+{
+    struct libusb_transfer *xfrs[3 * NUM_TRANSFERS];
+    int numXfrs = 0;
+
+    sampleRate = rate;
+    if (set_sample_rate(rate) < 0)
+        return -1;
+
+    if (libusb_set_interface_alt_setting(devh, streamOut.iface, streamOut.alt) < 0 ||
+        libusb_set_interface_alt_setting(devh, streamIn.iface, streamIn.alt) < 0)
+    {
+        fprintf(stderr, "Failed to select the streaming alternate settings\n");
+        return -1;
+    }
+
+    stats_reset(&latency);
+    stats_reset(&inPacketSize);
+    stats_reset(&inInterval);
+    stats_reset(&fbHz);
+    dropouts = 0;
+    inSamplesTotal = 0;
+    outIndex = inIndex = 0;
+    lastPulseIn = 0;
+    lastDelay = 0;
+    outFrac = 0;
+    fbRate = (double)rate / packetsPerSec;
+    lastInTime = 0;
+
+    for (int i = 0; i < NUM_TRANSFERS; i++)
+    {
+        xfrs[numXfrs++] = alloc_transfer(streamIn.ep, streamIn.maxPacket, in_callback);
+        if (streamOut.fbEp)
+            xfrs[numXfrs++] = alloc_transfer(streamOut.fbEp, streamOut.fbMaxPacket, fb_callback);
+        struct libusb_transfer *o = alloc_transfer(streamOut.ep, streamOut.maxPacket, out_callback);
+        xfrs[numXfrs++] = o;
+    }
+
+    running = 1;
+    inFlight = 0;
+    startTime = now();
+
+    for (int i = 0; i < numXfrs; i++)
+    {
+        if (xfrs[i]->endpoint == streamOut.ep)
+            fill_out_transfer(xfrs[i]);
+        if (libusb_submit_transfer(xfrs[i]) == 0)
+            inFlight++;
+    }
+
+    while (now() - startTime < duration)
+    {
+        struct timeval tv = {0, 100000};
+        libusb_handle_events_timeout(NULL, &tv);
+    }
+
+    double elapsed = now() - startTime;
+    running = 0;
+    for (int i = 0; i < numXfrs; i++)
+        libusb_cancel_transfer(xfrs[i]);
+    while (inFlight > 0)
+    {
+        struct timeval tv = {0, 100000};
+        libusb_handle_events_timeout(NULL, &tv);
+    }
+
+    for (int i = 0; i < numXfrs; i++)
+    {
+        free(xfrs[i]->buffer);
+        libusb_free_transfer(xfrs[i]);
+    }
+
+    libusb_set_interface_alt_setting(devh, streamOut.iface, 0);
+    libusb_set_interface_alt_setting(devh, streamIn.iface, 0);
+
+    /* Report */
+    double measuredRate = inSamplesTotal / elapsed;
+    printf("\n%u Hz (%s, %d out x %d bytes, %d in x %d bytes)\n", rate, highSpeed ? "high-speed" : "full-speed",
+        streamOut.chans, streamOut.subslot, streamIn.chans, streamIn.subslot);
+
+    if (latency.count)
+    {
+        printf("  Round-trip latency: min %.0f avg %.1f max %.0f samples (%.3f ms avg)\n",
+            latency.min, stats_mean(&latency), latency.max, stats_mean(&latency) * 1000.0 / rate);
+        if (!signalPulse)
+            printf("  Latency changes (dropouts/slips): %llu\n", dropouts);
+    }
+    else
+    {
+        printf("  Round-trip latency: test signal not detected on input channel %d\n", inChan);
+    }
+
+    printf("  IN packet size: min %.0f avg %.4f max %.0f sd %.4f samples\n",
+        inPacketSize.min, stats_mean(&inPacketSize), inPacketSize.max, stats_sd(&inPacketSize));
+    printf("  IN transfer interval: avg %.1f sd %.1f max %.1f us (%d packets)\n",
+        stats_mean(&inInterval), stats_sd(&inInterval), inInterval.max, PACKETS_PER_TRANSFER);
+    printf("  IN stream rate (host clock): %.3f Hz (%+.1f ppm)\n", measuredRate, (measuredRate - rate) * 1e6 / rate);
+
+    if (fbHz.count)
+    {
+        double fb = stats_mean(&fbHz);
+        printf("  Feedback: avg %.3f Hz sd %.3f min %.3f max %.3f (%llu values)\n", fb, stats_sd(&fbHz), fbHz.min,
+            fbHz.max, fbHz.count);
+        printf("  Feedback error: %+.1f ppm vs nominal, %+.1f ppm vs IN stream\n", (fb - rate) * 1e6 / rate,
+            (fb - measuredRate) * 1e6 / measuredRate);
+    }
+    else
+    {
+        printf("  Feedback: no explicit feedback endpoint (implicit feedback from the IN stream)\n");
+    }
+
+    return 0;
+}
+
+static void print_usage(const char *name, const char *error)
+{
+    if (error)
+        fprintf(stderr, "%s\n\n", error);
+
+    fprintf(stderr, "Usage: %s [options]\n"
+        "  --pid pid            Product ID of the device (default: first XMOS device)\n"
+        "  --rates r1,r2,...    Sample rates to test (default: 48000)\n"
+        "  --duration secs      Time to stream at each rate (default: 10)\n"
+        "  --signal counter|pulse\n"
+        "                       Test signal, counter needs a bit exact loopback (default: counter)\n"
+        "  --pulse-period n     Samples between pulses (default: 4800)\n"
+        "  --out-chan n         Output channel carrying the test signal (default: 0)\n"
+        "  --in-chan n          Input channel the test signal is looped back to (default: 0)\n"
+        "  --alt-out n          OUT streaming alternate setting (default: first)\n"
+        "  --alt-in n           IN streaming alternate setting (default: first)\n"
+        "  --log file           Write the feedback values to a CSV file\n", name);
+    exit(1);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned rates[MAX_RATES] = {48000};
+    int numRates = 1;
+    int pid = -1;
+    int altOut = 0, altIn = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+        if (strcmp(arg, "--help") == 0)
+            print_usage(argv[0], NULL);
+
+        if (!val)
+            print_usage(argv[0], "Missing option value");
+
+        if (strcmp(arg, "--pid") == 0)
+            pid = (int)strtol(val, NULL, 0);
+        else if (strcmp(arg, "--rates") == 0)
+        {
+            char *s = (char *)val;
+            numRates = 0;
+            while (*s && numRates < MAX_RATES)
+            {
+                rates[numRates++] = (unsigned)strtoul(s, &s, 10);
+                if (*s == ',')
+                    s++;
+            }
+        }
+        else if (strcmp(arg, "--duration") == 0)
+            duration = atof(val);
+        else if (strcmp(arg, "--signal") == 0)
+        {
+            if (strcmp(val, "pulse") == 0)
+                signalPulse = 1;
+            else if (strcmp(val, "counter") != 0)
+                print_usage(argv[0], "Unknown signal");
+        }
+        else if (strcmp(arg, "--pulse-period") == 0)
+            pulsePeriod = atoi(val);
+        else if (strcmp(arg, "--out-chan") == 0)
+            outChan = atoi(val);
+        else if (strcmp(arg, "--in-chan") == 0)
+            inChan = atoi(val);
+        else if (strcmp(arg, "--alt-out") == 0)
+            altOut = atoi(val);
+        else if (strcmp(arg, "--alt-in") == 0)
+            altIn = atoi(val);
+        else if (strcmp(arg, "--log") == 0)
+            logFilename = val;
+        else
+            print_usage(argv[0], "Unknown option");
+        i++;
+    }
+
+    if (pulsePeriod <= 0)
+        print_usage(argv[0], "Pulse period must be positive");
+
+    if (libusb_init(NULL) < 0)
+    {
+        fprintf(stderr, "failed to initialise libusb\n");
+        return -1;
+    }
+
+    libusb_device **devs;
+    libusb_device *dev = NULL;
+    ssize_t count = libusb_get_device_list(NULL, &devs);
+
+    for (ssize_t i = 0; i < count; i++)
+    {
+        struct libusb_device_descriptor desc;
+        libusb_get_device_descriptor(devs[i], &desc);
+        if (desc.idVendor == XMOS_VID && (pid < 0 || desc.idProduct == pid))
+        {
+            dev = devs[i];
+            break;
+        }
+    }
+
+    if (!dev || libusb_open(dev, &devh) < 0)
+    {
+        fprintf(stderr, "Could not find or open an XMOS device\n");
+        libusb_free_device_list(devs, 1);
+        return -1;
+    }
+
+    highSpeed = libusb_get_device_speed(dev) >= LIBUSB_SPEED_HIGH;
+    packetsPerSec = highSpeed ? 8000 : 1000;
+
+    int ret = find_streams(dev, altOut, altIn);
+    libusb_free_device_list(devs, 1);
+
+    if (ret == 0)
+    {
+        if (outChan >= streamOut.chans || inChan >= streamIn.chans)
+        {
+            fprintf(stderr, "Test channel out of range (%d out, %d in)\n", streamOut.chans, streamIn.chans);
+            ret = -1;
+        }
+    }
+
+    if (ret == 0)
+    {
+        libusb_set_auto_detach_kernel_driver(devh, 1);
+        if (libusb_claim_interface(devh, controlIface) < 0 || libusb_claim_interface(devh, streamOut.iface) < 0 ||
+            libusb_claim_interface(devh, streamIn.iface) < 0)
+        {
+            fprintf(stderr, "Could not claim the audio interfaces (in use by the OS audio driver?)\n");
+            ret = -1;
+        }
+    }
+
+    if (ret == 0 && logFilename)
+    {
+        logFile = fopen(logFilename, "w");
+        if (!logFile)
+        {
+            fprintf(stderr, "Could not open %s\n", logFilename);
+            ret = -1;
+        }
+        else
+        {
+            fprintf(logFile, "rate,time_s,feedback_raw,feedback_hz\n");
+        }
+    }
+
+    for (int i = 0; ret == 0 && i < numRates; i++)
+    {
+        ret = run_rate(rates[i]);
+    }
+
+    if (logFile)
+        fclose(logFile);
+
+    libusb_release_interface(devh, streamIn.iface);
+    libusb_release_interface(devh, streamOut.iface);
+    libusb_release_interface(devh, controlIface);
+    libusb_close(devh);
+    libusb_exit(NULL);
+
+    return ret;
+}
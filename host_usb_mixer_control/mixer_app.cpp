@@ -4,6 +4,10 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 #include "usb_mixer.h"
 
 #define MIXER_UNIT_DISPLAY_VALUE 2
@@ -390,6 +394,210 @@ void print_levels(const char* levelTitle, unsigned char* levels, int levelBytes)
 
 
 
+static int print_level_frame(const usb_level_frame *frame, void *user)
+{
+    int *framesLeft = (int *) user;
+
+    printf("Frame %5d:", frame->frame);
+    for(int i = 0; i < frame->num_chans; i++)
+    {
+       printf(" %04x/%04x", frame->peak[i], frame->rms[i]);
+    }
+    printf("\n");
+
+    return --(*framesLeft) <= 0;
+}
+
+static int print_status_event(const usb_status_event *event, void *user)
+{
+    int *eventsLeft = (int *) user;
+
+    printf("Entity %3d: CS %d, CN %d, attribute %d\n", event->entity, event->cs, event->cn, event->attribute);
+
+    return --(*eventsLeft) <= 0;
+}
+
+static const char *pipeline_stats_names[USB_PIPELINE_STATS_EVENTS] =
+{
+    "OUT underflows",
+    "OUT overflows",
+    "IN underflows",
+    "IN overflows",
+    "S/PDIF Rx underflows",
+    "S/PDIF Rx overflows",
+    "ADAT Rx underflows",
+    "ADAT Rx overflows",
+    "MIDI from host overflows",
+    "Audiohub late transfers",
+};
+
+static void print_pipeline_stats(const usb_pipeline_stats *stats)
+{
+    for(int i = 0; i < USB_PIPELINE_STATS_EVENTS; i++)
+    {
+       printf("%-26s %u\n", pipeline_stats_names[i], stats->events[i]);
+    }
+    printf("%-26s %u - %u bytes\n", "OUT FIFO fill", stats->fill_min[0], stats->fill_max[0]);
+    printf("%-26s %u - %u bytes\n", "IN FIFO fill", stats->fill_min[1], stats->fill_max[1]);
+}
+
+static const char *glitch_event_names[USB_GLITCH_EVENTS] =
+{
+    "OUT underflow",
+    "OUT packet size",
+    "OUT partial frame",
+    "IN overflow",
+    "OUT DC",
+    "OUT clipped",
+};
+
+/* Prints each event with its time relative to the oldest, the device reference timer running at 100MHz */
+static void print_glitch_log(const usb_glitch_log *log)
+{
+    printf("%u events since reset\n", log->count);
+    for(unsigned int i = 0; i < log->num_events; i++)
+    {
+        const usb_glitch_event *e = &log->events[i];
+        const char *name = (e->event < USB_GLITCH_EVENTS) ? glitch_event_names[e->event] : "Unknown";
+        double ms = (double)(e->time - log->events[0].time) / 100000.0;
+
+        printf("%8u %12.3fms  %-18s", e->seq, ms, name);
+        switch(e->event)
+        {
+            case 1:
+                printf(" %u frames, %u expected\n", e->arg >> 12, e->arg & 0xfff);
+                break;
+            case 2:
+                printf(" %u bytes\n", e->arg);
+                break;
+            case 3:
+                printf(" fill %u bytes\n", e->arg);
+                break;
+            case 4:
+            case 5:
+                printf(" channel %u\n", e->arg);
+                break;
+            default:
+                printf("\n");
+                break;
+        }
+    }
+}
+
+static const char *event_names[USB_EVENT_EVENTS] =
+{
+    "USB reset",
+    "Set interface",
+    "Sample rate",
+    "OUT format",
+    "IN format",
+    "OUT underflow",
+    "IN overflow",
+    "Clock validity",
+    "Clock select",
+};
+
+/* Prints each event with its time relative to the oldest, the device reference timer running at 100MHz */
+static void print_event_log(const usb_event_log *log)
+{
+    printf("%u events since reset\n", log->count);
+    for(unsigned int i = 0; i < log->num_events; i++)
+    {
+        const usb_event *e = &log->events[i];
+        const char *name = (e->event < USB_EVENT_EVENTS) ? event_names[e->event] : "Unknown";
+        double ms = (double)(e->time - log->events[0].time) / 100000.0;
+
+        printf("%12.3fms  %-16s", ms, name);
+        switch(e->event)
+        {
+            case 1:
+                printf(" interface %u alt %u\n", e->arg >> 8, e->arg & 0xff);
+                break;
+            case 2:
+                printf(" %uHz\n", e->arg);
+                break;
+            case 3:
+            case 4:
+                printf(" %u channels, %u byte subslot\n", e->arg >> 8, e->arg & 0xff);
+                break;
+            case 6:
+                printf(" fill %u bytes\n", e->arg);
+                break;
+            case 7:
+                printf(" clock %u %s\n", e->arg >> 8, (e->arg & 0xff) ? "valid" : "invalid");
+                break;
+            case 0:
+            case 8:
+                printf(" %u\n", e->arg);
+                break;
+            default:
+                printf("\n");
+                break;
+        }
+    }
+}
+
+/* Frames for the loopback to settle before the capture, 100ms at 48kHz */
+#define TEST_SIGNAL_SETTLE_FRAMES 4800
+
+/* Number of 10ms polls for the capture to complete */
+#define TEST_SIGNAL_POLLS 100
+
+/* Prints the level of each tone, relative to full scale and to the loudest captured channel (the crosstalk on the
+ * channels not driven), and the THD+N of each captured channel */
+static void print_test_signal(const usb_test_signal_config *config, const usb_test_signal_result *result)
+{
+    double n = (double) result->block;
+    double fullScale = 8388608.0 * 8388608.0 / 2.0;     /* Power of a full scale sine in 24-bit samples */
+    double level[USB_TEST_SIGNAL_CAPTURE_CHANS][USB_TEST_SIGNAL_TONES];
+
+    for(int c = 0; c < USB_TEST_SIGNAL_CAPTURE_CHANS; c++)
+    {
+        for(int t = 0; t < USB_TEST_SIGNAL_TONES; t++)
+        {
+            double re = (double) result->chans[c].re[t];
+            double im = (double) result->chans[c].im[t];
+
+            level[c][t] = 2.0 * ((re * re) + (im * im)) / (n * n);
+        }
+    }
+
+    for(int c = 0; c < USB_TEST_SIGNAL_CAPTURE_CHANS; c++)
+    {
+        double mean = (double) result->chans[c].sum / n;
+        double ac = ((double) result->chans[c].sum_sq / n) - (mean * mean);
+        double tones = 0;
+
+        printf("Input %d\n", config->in_chans[c]);
+
+        for(int t = 0; t < USB_TEST_SIGNAL_TONES; t++)
+        {
+            double loudest = 0;
+
+            if(!config->bins[t])
+            {
+                continue;
+            }
+
+            for(int i = 0; i < USB_TEST_SIGNAL_CAPTURE_CHANS; i++)
+            {
+                if(level[i][t] > loudest)
+                {
+                    loudest = level[i][t];
+                }
+            }
+
+            tones += level[c][t];
+            printf("  Bin %4d: %8.2f dBFS %8.2f dB\n", config->bins[t],
+                10.0 * log10((level[c][t] + 1e-20) / fullScale),
+                10.0 * log10((level[c][t] + 1e-20) / (loudest + 1e-20)));
+        }
+
+        /* Everything other than DC and the tones is distortion and noise */
+        printf("  THD+N:     %8.2f dB\n", 10.0 * log10((fabs(ac - tones) + 1e-20) / (tones + 1e-20)));
+    }
+}
+
 void mixer_display_usage(void) {
     fprintf(stderr, "Usage: xmos_mixer "
 #ifdef _WIN32
@@ -421,6 +629,17 @@ void mixer_display_usage(void) {
             "\n"
             "     --get-mixer-levels-input            mixer_id\n"
             "     --get-mixer-levels-output           mixer_id\n"
+            "     --stream-levels                     num_frames\n"
+            "     --stream-status                     num_events\n"
+            "     --get-pipeline-stats\n"
+            "     --reset-pipeline-stats\n"
+            "     --get-glitch-log\n"
+            "     --reset-glitch-log\n"
+            "     --get-event-log\n"
+            "     --reset-event-log\n"
+            "     --get-chan-profile\n"
+            "     --set-chan-profile                  profile\n"
+            "     --test-signal                       out_mask, level_dbfs, in_chan, in_chan, tone_bin, [tone_bin...]\n"
             "     --vendor-audio-request-get   bRequest, ControlSelector, ChannelNumber, UnitId\n"
             "     --vendor-audio-request-set   bRequest, ControlSelector, ChannelNumber, UnitId, Data[0], Data[1],...\n"
             );
@@ -672,6 +891,182 @@ int main (int argc, char **argv) {
       print_levels("Mixer Input", levels, datalength);
 
   }
+  else if(strcmp(argv[arg_idx], "--stream-levels") == 0)
+  {
+    int frames = 0;
+
+    if (argc - arg_idx < 2) {
+      fprintf(stderr, "ERROR :: incorrect number of arguments passed\n");
+      return -1;
+    }
+
+    frames = atoi(argv[arg_idx+1]);
+
+    if(usb_levels_open() != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device has no level meter endpoint\n");
+      return -1;
+    }
+
+    /* Each frame is printed as peak/RMS for every channel */
+    usb_levels_stream(print_level_frame, &frames);
+    usb_levels_close();
+  }
+  else if(strcmp(argv[arg_idx], "--stream-status") == 0)
+  {
+    int events = 0;
+
+    if (argc - arg_idx < 2) {
+      fprintf(stderr, "ERROR :: incorrect number of arguments passed\n");
+      return -1;
+    }
+
+    events = atoi(argv[arg_idx+1]);
+
+    if(usb_status_open() != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device has no interrupt endpoint or its interface is in use\n");
+      return -1;
+    }
+
+    /* Each event names the control that changed on the device */
+    usb_status_stream(print_status_event, &events);
+    usb_status_close();
+  }
+  else if(strcmp(argv[arg_idx], "--get-pipeline-stats") == 0)
+  {
+    usb_pipeline_stats stats;
+
+    if(usb_pipeline_stats_get(&stats) != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not report pipeline statistics\n");
+      return -1;
+    }
+    print_pipeline_stats(&stats);
+  }
+  else if(strcmp(argv[arg_idx], "--reset-pipeline-stats") == 0)
+  {
+    if(usb_pipeline_stats_reset() != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not report pipeline statistics\n");
+      return -1;
+    }
+  }
+  else if(strcmp(argv[arg_idx], "--get-glitch-log") == 0)
+  {
+    usb_glitch_log log;
+
+    if(usb_glitch_log_get(&log) != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not record stream glitches\n");
+      return -1;
+    }
+    print_glitch_log(&log);
+  }
+  else if(strcmp(argv[arg_idx], "--reset-glitch-log") == 0)
+  {
+    if(usb_glitch_log_reset() != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not record stream glitches\n");
+      return -1;
+    }
+  }
+  else if(strcmp(argv[arg_idx], "--get-event-log") == 0)
+  {
+    static usb_event_log log;
+
+    if(usb_event_log_get(&log) != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not keep an event log\n");
+      return -1;
+    }
+    print_event_log(&log);
+  }
+  else if(strcmp(argv[arg_idx], "--reset-event-log") == 0)
+  {
+    if(usb_event_log_reset() != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not keep an event log\n");
+      return -1;
+    }
+  }
+  else if(strcmp(argv[arg_idx], "--get-chan-profile") == 0)
+  {
+    unsigned int profile;
+
+    if(usb_chan_profile_get(&profile) != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not support channel profiles\n");
+      return -1;
+    }
+    printf("Channel profile: %u (%s)\n", profile, (profile == USB_CHAN_PROFILE_FULL) ? "full" : "reduced");
+  }
+  else if(strcmp(argv[arg_idx], "--set-chan-profile") == 0)
+  {
+    if (argc - arg_idx < 2) {
+      fprintf(stderr, "ERROR :: incorrect number of arguments passed\n");
+      return -1;
+    }
+
+    if(usb_chan_profile_set(atoi(argv[arg_idx+1])) != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device does not support channel profiles or the profile is invalid\n");
+      return -1;
+    }
+  }
+  else if(strcmp(argv[arg_idx], "--test-signal") == 0)
+  {
+    usb_test_signal_config config;
+    usb_test_signal_result signal;
+    int tones = argc - arg_idx - 5;
+    int polls = 0;
+
+    if((tones < 1) || (tones > USB_TEST_SIGNAL_TONES))
+    {
+      fprintf(stderr, "ERROR :: incorrect number of arguments passed\n");
+      return -1;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.out_mask = strtoul(argv[arg_idx + 1], NULL, 0);
+    config.settle_frames = TEST_SIGNAL_SETTLE_FRAMES;
+    config.amplitude = (int) fmin(pow(10.0, atof(argv[arg_idx + 2]) / 20.0) * 2147483648.0, 2147483647.0);
+    for(int i = 0; i < USB_TEST_SIGNAL_CAPTURE_CHANS; i++)
+    {
+      config.in_chans[i] = atoi(argv[arg_idx + 3 + i]);
+    }
+    for(int i = 0; i < tones; i++)
+    {
+      config.bins[i] = atoi(argv[arg_idx + 5 + i]);
+    }
+
+    if(usb_test_signal_start(&config) != USB_MIXER_SUCCESS)
+    {
+      fprintf(stderr, "ERROR :: device has no test signal or refused its configuration\n");
+      return -1;
+    }
+
+    do
+    {
+#ifndef _WIN32
+      usleep(10000);
+#endif
+      if(usb_test_signal_get(&signal) != USB_MIXER_SUCCESS)
+      {
+        signal.state = USB_TEST_SIGNAL_OFF;
+        break;
+      }
+    } while((signal.state != USB_TEST_SIGNAL_DONE) && (++polls < TEST_SIGNAL_POLLS));
+
+    usb_test_signal_stop();
+
+    if(signal.state != USB_TEST_SIGNAL_DONE)
+    {
+      fprintf(stderr, "ERROR :: test signal capture did not complete\n");
+      return -1;
+    }
+    print_test_signal(&config, &signal);
+  }
   else if(strcmp(argv[arg_idx], "--vendor-audio-request-get") == 0)
   {
     unsigned int bRequest = 0;
@@ -25,6 +25,34 @@
  				 * D4:0 Receipient: 1 (Interface) */
 #define USB_REQUEST_FROM_DEV 0xa1
 
+#define USB_VENDOR_REQUEST_TO_DEV 0x40 /* D7 Data direction: 0 (Host to device)
+                                        * D6:5 Type: 10 (Vendor)
+                                        * D4:0 Receipient: 0 (Device) */
+
+/* lib_xua vendor request for loading mixer weights, XUA_VENDOR_REQ_BASE + 4 */
+#define XUA_VENDOR_REQ_MIX_MATRIX 0xF4
+
+#define USB_VENDOR_REQUEST_FROM_DEV 0xc0
+
+/* lib_xua vendor request for pipeline statistics, XUA_VENDOR_REQ_BASE + 9 */
+#define XUA_VENDOR_REQ_PIPELINE_STATS 0xF9
+
+/* lib_xua vendor request for the production test signal, XUA_VENDOR_REQ_BASE + 10 */
+#define XUA_VENDOR_REQ_TEST_SIGNAL 0xFA
+
+/* lib_xua vendor request for the stream glitch log, XUA_VENDOR_REQ_BASE + 11 */
+#define XUA_VENDOR_REQ_GLITCH_LOG 0xFB
+
+/* lib_xua vendor request for string descriptors as ASCII, XUA_VENDOR_REQ_BASE + 12 */
+#define XUA_VENDOR_REQ_STRINGS 0xFC
+#define XUA_STRINGS_REQ_LEN 512
+
+/* lib_xua vendor request for the diagnostic event log, XUA_VENDOR_REQ_BASE + 13 */
+#define XUA_VENDOR_REQ_EVENT_LOG 0xFD
+
+/* lib_xua vendor request for the channel profile, XUA_VENDOR_REQ_BASE + 14 */
+#define XUA_VENDOR_REQ_CHAN_PROFILE 0xFE
+
 #define USB_CS_INTERFACE 0x24
 #define USB_INPUT_TERM_TYPE 0x02
 #define USB_MIXER_UNIT_TYPE 0x04
@@ -60,12 +88,19 @@
 #define OFFSET_IT_BNRCHANNELS 8
 #define OFFSET_IT_ICHANNELNAMES 13
 
+/* Device mixer state change counters, in the order returned by the mixer memory request (XUA_MIXER_CHANGE_COUNTERS) */
+#define MIXER_CHANGE_WEIGHTS    0
+#define MIXER_CHANGE_MIXSEL     1
+#define MIXER_CHANGE_CHAN_MAP   2
+#define MIXER_CHANGE_COUNT      3
+
 typedef struct
 {
     double min;
     double max;
     double res;
     double weight;
+    int dirty;          /* Set locally, not yet written to the device */
 } mixer_node;
 
 typedef struct 
@@ -86,6 +121,7 @@ typedef struct {
     int default_value;
     char name[USB_MIXER_MAX_NAME_LEN];
     enum usb_chan_type ctype;
+    int dirty;
 }channel_map_node;
 
 typedef struct {
@@ -101,6 +137,7 @@ typedef struct
     char inputStrings[USB_MIXER_INPUTS*4][USB_MIXER_MAX_NAME_LEN];   /* Complete list of all possible inputs */
     unsigned int numOutputs;
     unsigned int state[USB_MIXER_INPUTS];
+    unsigned char dirty[USB_MIXER_INPUTS];
 } t_usb_mixSel;
 
 typedef struct {
@@ -112,7 +149,11 @@ typedef struct {
   channel_mapp audChannelMap;
   channel_mapp usbChannelMap;
 
-
+  /* Cached state, see usb_mixer_begin_update() and usb_mixer_sync() */
+  unsigned int version;
+  unsigned int update_depth;
+  unsigned int change_counts[MIXER_CHANGE_COUNT];
+  int change_counts_valid;
 } usb_mixer_handle;
 
 #if defined(__APPLE__)
@@ -179,6 +220,181 @@ int usb_audio_class_set(unsigned char bRequest, unsigned char cs, unsigned char
 #endif
 }
 
+/* ASYNCHRONOUS REQUEST QUEUE
+ *
+ * Up to USB_ASYNC_MAX_IN_FLIGHT control requests are kept in flight, so the round trip of one overlaps the next.
+ * Callbacks are made in the order the requests were issued, not the order they complete */
+#define USB_ASYNC_MAX_IN_FLIGHT 8
+#define USB_ASYNC_MAX_DATA 64
+#define USB_ASYNC_TIMEOUT_MS 1000
+
+#if defined(__APPLE__)
+#ifndef LIBUSB_CALL
+#define LIBUSB_CALL
+#endif
+
+typedef struct
+{
+    struct libusb_transfer *xfer;
+    unsigned char buffer[LIBUSB_CONTROL_SETUP_SIZE + USB_ASYNC_MAX_DATA];
+    usb_request_callback callback;
+    void *user;
+    int done;
+    int result;
+} usb_async_req;
+
+static usb_async_req async_reqs[USB_ASYNC_MAX_IN_FLIGHT];
+static unsigned int async_head = 0;     /* Oldest request not yet called back */
+static unsigned int async_count = 0;    /* Requests issued but not yet called back */
+
+/* Make callbacks for all completed requests at the head of the queue */
+static void usb_async_retire()
+{
+    while (async_count && async_reqs[async_head].done)
+    {
+        usb_async_req *req = &async_reqs[async_head];
+        unsigned char *data = req->buffer + LIBUSB_CONTROL_SETUP_SIZE;
+
+        async_head = (async_head + 1) % USB_ASYNC_MAX_IN_FLIGHT;
+        async_count--;
+        req->done = 0;
+
+        if (req->callback)
+        {
+            req->callback(req->result, data, req->user);
+        }
+    }
+}
+
+static void LIBUSB_CALL usb_async_complete(struct libusb_transfer *xfer)
+{
+    usb_async_req *req = (usb_async_req *)xfer->user_data;
+
+    req->result = (xfer->status == LIBUSB_TRANSFER_COMPLETED) ? xfer->actual_length : LIBUSB_ERROR_IO;
+    req->done = 1;
+}
+
+static int usb_async_submit(unsigned char bmRequestType, unsigned char bRequest, unsigned short wValue,
+    unsigned short wIndex, unsigned short wLength, const unsigned char *data, usb_request_callback callback, void *user)
+{
+    usb_async_req *req;
+
+    if (wLength > USB_ASYNC_MAX_DATA)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    /* Wait for a free slot */
+    while (async_count == USB_ASYNC_MAX_IN_FLIGHT)
+    {
+        libusb_handle_events(NULL);
+        usb_async_retire();
+    }
+
+    req = &async_reqs[(async_head + async_count) % USB_ASYNC_MAX_IN_FLIGHT];
+
+    if (req->xfer == NULL && (req->xfer = libusb_alloc_transfer(0)) == NULL)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    libusb_fill_control_setup(req->buffer, bmRequestType, bRequest, wValue, wIndex, wLength);
+    if (data && !(bmRequestType & LIBUSB_ENDPOINT_IN))
+    {
+        memcpy(req->buffer + LIBUSB_CONTROL_SETUP_SIZE, data, wLength);
+    }
+    libusb_fill_control_transfer(req->xfer, devh, req->buffer, usb_async_complete, req, USB_ASYNC_TIMEOUT_MS);
+
+    req->callback = callback;
+    req->user = user;
+    req->done = 0;
+
+    if (libusb_submit_transfer(req->xfer) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    async_count++;
+    return USB_MIXER_SUCCESS;
+}
+
+static void usb_async_free()
+{
+    usb_audio_requests_wait();
+
+    for (int i = 0; i < USB_ASYNC_MAX_IN_FLIGHT; i++)
+    {
+        if (async_reqs[i].xfer)
+        {
+            libusb_free_transfer(async_reqs[i].xfer);
+            async_reqs[i].xfer = NULL;
+        }
+    }
+}
+#endif
+
+int usb_audio_class_get_async(unsigned char bRequest, unsigned char cs, unsigned char cn, unsigned short unitID,
+    unsigned short wLength, usb_request_callback callback, void *user)
+{
+#if defined(__APPLE__)
+    return usb_async_submit(USB_REQUEST_FROM_DEV, bRequest, (cs<<8) | cn, (unitID & 0xff) << 8 | 0x0, wLength,
+        NULL, callback, user);
+#elif defined(_WIN32)
+    /* The driver API is synchronous, complete immediately */
+    unsigned char data[USB_ASYNC_MAX_DATA];
+    int result;
+
+    if (wLength > USB_ASYNC_MAX_DATA)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    result = (usb_audio_class_get(bRequest, cs, cn, unitID, wLength, data) == TSTATUS_SUCCESS) ? wLength : -1;
+    if (callback)
+    {
+        callback(result, data, user);
+    }
+    return USB_MIXER_SUCCESS;
+#endif
+}
+
+int usb_audio_class_set_async(unsigned char bRequest, unsigned char cs, unsigned char cn, unsigned short unitID,
+    unsigned short wLength, const unsigned char *data, usb_request_callback callback, void *user)
+{
+#if defined(__APPLE__)
+    return usb_async_submit(USB_REQUEST_TO_DEV, bRequest, (cs<<8) | cn, (unitID & 0xff) << 8 | 0x0, wLength,
+        data, callback, user);
+#elif defined(_WIN32)
+    unsigned char buffer[USB_ASYNC_MAX_DATA];
+    int result;
+
+    if (wLength > USB_ASYNC_MAX_DATA)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    memcpy(buffer, data, wLength);
+    result = (usb_audio_class_set(bRequest, cs, cn, unitID, wLength, buffer) == TSTATUS_SUCCESS) ? wLength : -1;
+    if (callback)
+    {
+        callback(result, buffer, user);
+    }
+    return USB_MIXER_SUCCESS;
+#endif
+}
+
+int usb_audio_requests_wait()
+{
+#if defined(__APPLE__)
+    while (async_count)
+    {
+        libusb_handle_events(NULL);
+        usb_async_retire();
+    }
+#endif
+    return USB_MIXER_SUCCESS;
+}
+
 /* Note, this never get cached in an object since it can change on the device side */
 int usb_mixer_mem_get(unsigned int mixer, unsigned offset, unsigned char *data)
 {
@@ -202,6 +418,51 @@ int usb_mixer_mem_get(unsigned int mixer, unsigned offset, unsigned char *data)
 #endif
 }
 
+/* Mixer memory offsets holding all weights and the state change counters (lib_xua) */
+#define MIXER_MEM_WEIGHTS 3
+#define MIXER_MEM_CHANGE_COUNTS 4
+
+/* Reads every weight of a mixer in one memory request. Fails on devices without the request */
+static int dev_get_mixer_values(unsigned int mixer, short *weights, unsigned int count)
+{
+#if defined(__APPLE__)
+    int numBytes = libusb_control_transfer(devh,
+                            USB_REQUEST_FROM_DEV,
+                            MEM,
+                            MIXER_MEM_WEIGHTS,       /* wValue */
+                            (usb_mixers->usb_mixer[mixer].id & 0xff) << 8 | 0x0, /* wIndex */
+                            (unsigned char *)weights, count * sizeof(short), USB_ASYNC_TIMEOUT_MS);
+    return (numBytes == (int)(count * sizeof(short))) ? USB_MIXER_SUCCESS : USB_MIXER_FAILURE;
+#elif defined(_WIN32)
+    unsigned int numBytes = 0;
+    TUsbAudioStatus st = gDrvApi.TUSBAUDIO_AudioControlRequestGet(devh,
+                            usb_mixers->usb_mixer[mixer].id,
+                            MEM,
+                            0, // cs
+                            MIXER_MEM_WEIGHTS,
+                            (unsigned char *)weights,
+                            count * sizeof(short),
+                            &numBytes,
+                            1000);
+    return ((TSTATUS_SUCCESS == st) && (numBytes == count * sizeof(short))) ? USB_MIXER_SUCCESS : USB_MIXER_FAILURE;
+#endif
+}
+
+/* Reads the device's mixer state change counters. Fails on devices built without XUA_MIXER_CHANGE_COUNTERS */
+static int dev_get_change_counts(unsigned int counts[MIXER_CHANGE_COUNT])
+{
+    unsigned char data[64];
+    int numBytes = usb_mixer_mem_get(0, MIXER_MEM_CHANGE_COUNTS, data);
+
+    if (numBytes != (int)(MIXER_CHANGE_COUNT * sizeof(unsigned int)))
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    memcpy(counts, data, MIXER_CHANGE_COUNT * sizeof(unsigned int));
+    return USB_MIXER_SUCCESS;
+}
+
 static const unsigned char *findUnit(const unsigned char *descs, int length, int id)
 {
     const unsigned char *interface_data = descs;
@@ -242,175 +503,625 @@ static int get_num_mixer_units(const unsigned char *data, int length) {
   return num_mixer_units_found;
 }
 
-static double dev_get_mixer_value(unsigned int mixer, unsigned int nodeId)
+int dev_get_channel_map(int channel, int unitId)
 {
     short data;
-    unsigned char cs = 0; /* Device doesnt use CS for getting/setting mixer weights */
-    usb_audio_class_get(CUR, cs,  nodeId,  usb_mixers->usb_mixer[mixer].id, 2,(unsigned char *) &data);
-    return ((double) data / 256);
+    usb_audio_class_get(CUR, 0,  channel,  unitId, 2,(unsigned char *) &data);
+    return data;
 }
 
-/* Populates min, max, res */
-static unsigned short dev_get_mixer_range(unsigned int mixer, unsigned int channel, 
-         double *min, double *max, double *res)
+static void mixer_range_callback(int result, unsigned char *data, void *user)
 {
-    short data[64];
-
-    short min2, max2, res2;
-
-    usb_audio_class_get(RANGE, MU_MIXER_CONTROL, channel, usb_mixers->usb_mixer[mixer].id, 8, (unsigned char *) data); 
+    mixer_node *node = (mixer_node *)user;
 
-    min2 = data[1];
-    max2 = data[2];
-    res2 = data[3];
-    //printf("%f, %f, %f\n", (double)min2/256, (double)max2/256, (double) res2/256);
-    *min = (double)min2/256;
-    *max = (double)max2/256;
-    *res = (double)res2/256;
-
-   return 0;
+    if (result >= 8)
+    {
+        short *range = (short *)data;
+        node->min = (double)range[1]/256;
+        node->max = (double)range[2]/256;
+        node->res = (double)range[3]/256;
+    }
 }
 
-int dev_get_channel_map(int channel, int unitId)
+static void mixer_value_callback(int result, unsigned char *data, void *user)
 {
-    short data;
-    usb_audio_class_get(CUR, 0,  channel,  unitId, 2,(unsigned char *) &data);
-    return data;
-}
+    mixer_node *node = (mixer_node *)user;
 
-static int dev_set_channel_map(int channel, int val, int unitId)
-{
-    short value = val;
-    usb_audio_class_set(CUR, 0, channel, unitId, 1, (unsigned char *)&value);
-    return 0;
+    if (result >= 2)
+    {
+        node->weight = (double)*(short *)data / 256;
+    }
 }
 
-static int mixer_update_all_nodes(unsigned int mixer_index) 
+/* Populates every node with requests pipelined through the async queue. Weights are read in one request where the
+ * device supports it. Ranges are only read if get_ranges is set, they are fixed for a device */
+static int mixer_update_all_nodes(unsigned int mixer_index, int get_ranges)
 {
-    int i = 0;
-    int j = 0;
-    double min, max, res;
- 
-    for (i = 0; i < usb_mixers->usb_mixer[mixer_index].num_inputs; i++) 
+    usb_mixer_device *mixer = &usb_mixers->usb_mixer[mixer_index];
+    unsigned int num_nodes = mixer->num_inputs * mixer->num_outputs;
+    short weights[USB_MIXER_INPUTS * USB_MIXER_OUTPUTS];
+    int have_weights = (dev_get_mixer_values(mixer_index, weights, num_nodes) == USB_MIXER_SUCCESS);
+
+    for (unsigned int i = 0; i < num_nodes; i++) 
     {
-        for (j = 0; j < usb_mixers->usb_mixer[mixer_index].num_outputs; j++) 
+        if (get_ranges)
         {
-            dev_get_mixer_range(mixer_index, (i*usb_mixers->usb_mixer[mixer_index].num_outputs)+j, &min, &max, &res);
-           
-            usb_mixers->usb_mixer[mixer_index].nodes[(i*usb_mixers->usb_mixer[mixer_index].num_outputs)+j].min = min; 
-            usb_mixers->usb_mixer[mixer_index].nodes[(i*usb_mixers->usb_mixer[mixer_index].num_outputs)+j].max = max; 
-            usb_mixers->usb_mixer[mixer_index].nodes[(i*usb_mixers->usb_mixer[mixer_index].num_outputs)+j].res = res; 
-            //printf("%f, %f, %f\n", min, max, res);
+            usb_audio_class_get_async(RANGE, MU_MIXER_CONTROL, i, mixer->id, 8, mixer_range_callback, &mixer->nodes[i]);
+        }
 
-            usb_mixers->usb_mixer[mixer_index].nodes[(i*usb_mixers->usb_mixer[mixer_index].num_outputs)+j].weight = 
-                dev_get_mixer_value(mixer_index, (i*usb_mixers->usb_mixer[mixer_index].num_outputs)+j);
+        if (have_weights)
+        {
+            mixer->nodes[i].weight = (double)weights[i] / 256;
+        }
+        else
+        {
+            unsigned char cs = 0; /* Device doesnt use CS for getting/setting mixer weights */
+            usb_audio_class_get_async(CUR, cs, i, mixer->id, 2, mixer_value_callback, &mixer->nodes[i]);
         }
     }
+
+    usb_audio_requests_wait();
     return 0;
 }
 
+/* MIXER STATE CACHE
+ *
+ * Setters update the cached state and mark it dirty. Dirty state is written to the device straight away, or once
+ * the outermost usb_mixer_end_update() is reached. The number of requests written is added to the expected device
+ * change counters, so that usb_mixer_sync() only re-reads what something else has changed */
 
-/* Start at unit %id, find it in descs, keep recursively parsing up path(s) until get to Input Term and add strings */
-int addStrings(const unsigned char *data, int length, int mixer_index, int id, int chanCount)
+#if defined(__APPLE__)
+/* Writes count cached weights starting at first to the device in one request */
+static int dev_set_mixer_values(unsigned int mixer, unsigned int first, unsigned int count)
 {
-    const unsigned char *currentUnitPtr = NULL;
+    short values[USB_MIXER_INPUTS * USB_MIXER_OUTPUTS];
 
-    /* Find this unit in the descs */
-    currentUnitPtr = findUnit(data, length, id);
-#if defined(_WIN32)
-    TUsbAudioStatus st;
-#endif
-                
-    if(currentUnitPtr != NULL)
+    for (unsigned int i = 0; i < count; i++)
     {
-        /* Check if unit is a Input term */
-        if(*(currentUnitPtr+OFFSET_BDESCRIPTORSUBTYPE) == INPUT_TERMINAL)
-        {
+        values[i] = (short) (usb_mixers->usb_mixer[mixer].nodes[first + i].weight * 256);
+    }
 
-             /* Get channel names */
-#ifdef DEBUG
-            printf("Input terminal found on path (ID: %d): %d channels, total: %d\n",*(currentUnitPtr+OFFSET_BUNITID),  
-                    *(currentUnitPtr+OFFSET_IT_BNRCHANNELS), chanCount);
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_MIX_MATRIX,
+                            first,                  /* wValue */
+                            0,                      /* wIndex */
+                            (unsigned char *)values,
+                            count * sizeof(short),
+                            USB_ASYNC_TIMEOUT_MS) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+}
 #endif
 
-            int iChannelNames = *(currentUnitPtr+OFFSET_IT_ICHANNELNAMES);
-            int wTerminalType = *(currentUnitPtr+OFFSET_IT_WTERMINALTYPE);
-
-#ifdef DEBUG
-            printf("iChannelNames: %d wTerminalType: %d\n", iChannelNames, wTerminalType);
-
-            printf("Channels found:\n");
-            
-#endif
-            for(int i = 0; i < *(currentUnitPtr+OFFSET_IT_BNRCHANNELS); i++)
-            {
-                char_style mixer_input_name[USB_MIXER_MAX_NAME_LEN];
-#if defined(__APPLE__)
-                memset(mixer_input_name, 0 ,USB_MIXER_MAX_NAME_LEN);
-#elif defined(_WIN32)
-                WCHAR mixer_input_name_wchar[USB_MIXER_MAX_NAME_LEN];
-#endif
-                if (wTerminalType == 1) 
-                {
-                    strcpy(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount], "DAW - ");
+static void mixer_set_callback(int result, unsigned char *data, void *user)
+{
+    if (result < 0)
+    {
+        *(int *)user = USB_MIXER_FAILURE;
+    }
+}
 
-                    //usb_mixers->channel_maps[usb_mixers->num_channel_maps].ctype = (enum usb_chan_type) USB_CHAN_OUT;
-                    
-                    usb_mixers->audChannelMap.numOutputs = usb_mixers->audChannelMap.numOutputs +1;
+/* Writes all dirty channel map entries. Returns the number of requests issued */
+static unsigned int channel_map_flush(channel_mapp *map, unsigned short unitId, int *result)
+{
+    unsigned int writes = 0;
 
-                    usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_OUT;
-                    usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_OUT;
-                    
-                }
-                else  
-                {
-                    strcpy(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount], "AUD - ");
-                    
-                    //usb_mixers->channel_maps[usb_mixers->num_channel_maps].ctype = (enum usb_chan_type) USB_CHAN_IN;
+    for (int i = 0; i < map->numOutputs; i++)
+    {
+        if (map->map[i].dirty)
+        {
+            unsigned char value = map->map[i].cur;
+            map->map[i].dirty = 0;
+            usb_audio_class_set_async(CUR, 0, i, unitId, 1, &value, mixer_set_callback, result);
+            writes++;
+        }
+    }
+    return writes;
+}
 
-                    usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_IN;
-                    usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_IN;
+static int mixer_flush()
+{
+    int result = USB_MIXER_SUCCESS;
+    unsigned int writes[MIXER_CHANGE_COUNT] = {0};
 
+    for (unsigned int m = 0; m < usb_mixers->num_usb_mixers; m++)
+    {
+        usb_mixer_device *mixer = &usb_mixers->usb_mixer[m];
+        t_usb_mixSel *mixSel = &usb_mixers->usb_mixSel[m];
+        int first = -1, last = -1;
 
-                    usb_mixers->usbChannelMap.numOutputs = usb_mixers->usbChannelMap.numOutputs +1;
-                } 
-                /* Get relevant string descriptor */
-#if defined(__APPLE__)
-                libusb_get_string_descriptor_ascii(devh, iChannelNames+i, mixer_input_name, 
-                    USB_MIXER_MAX_NAME_LEN - strlen(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount]));
-#elif defined(_WIN32)
-                st = gDrvApi.TUSBAUDIO_GetUsbStringDescriptorString(devh, iChannelNames + i, 0, mixer_input_name_wchar, USB_MIXER_MAX_NAME_LEN - strlen(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount]));
-                if (TSTATUS_SUCCESS != st) {
-                    return USB_MIXER_FAILURE;
+        for (int i = 0; i < USB_MIXER_INPUTS * USB_MIXER_OUTPUTS; i++)
+        {
+            if (mixer->nodes[i].dirty)
+            {
+                mixer->nodes[i].dirty = 0;
+                if (first < 0)
+                {
+                    first = i;
                 }
-                wcstombs(mixer_input_name, mixer_input_name_wchar, USB_MIXER_MAX_NAME_LEN);
+                last = i;
+#if defined(_WIN32)
+                /* Vendor requests are not issued through the driver API, one request per node */
+                short value = (short) (mixer->nodes[i].weight * 256);
+                unsigned char cs = 0; /* Device doesnt use CS for setting/getting mixer nodes */
+                usb_audio_class_set_async(CUR, cs, i & 0xff, mixer->id, 2, (unsigned char *)&value,
+                    mixer_set_callback, &result);
+                writes[MIXER_CHANGE_WEIGHTS]++;
 #endif
-                strcat(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount], (char *)mixer_input_name);
-
-                /* Add to channel mappers also */
-                //strcat(usb_mixers->channel_maps[usb_mixers->num_channel_maps].name, (char *)mixer_input_name);
-                strcat(usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs ].name, (char *)mixer_input_name);
-                strcat(usb_mixers->usbChannelMap.map[usb_mixers->audChannelMap.numInputs].name, (char *)mixer_input_name);
-                
-                usb_mixers->audChannelMap.numInputs = usb_mixers->audChannelMap.numInputs +1;
-                usb_mixers->usbChannelMap.numInputs = usb_mixers->usbChannelMap.numInputs +1;
-
-                //usb_mixers->num_channel_maps = usb_mixers->num_channel_maps+1;
-                chanCount++;
             }
+        }
 
-#ifdef DEBUG
-            int meh = chanCount - *(currentUnitPtr+OFFSET_IT_BNRCHANNELS);
-            for(int i = 0; i < *(currentUnitPtr+OFFSET_IT_BNRCHANNELS); i++)
+#if defined(__APPLE__)
+        /* One request from the first to the last changed node, the clean nodes in between are rewritten unchanged */
+        if (first >= 0)
+        {
+            if (dev_set_mixer_values(m, first, last - first + 1) != USB_MIXER_SUCCESS)
             {
-                printf("%d: %s\n", i,usb_mixers->usb_mixSel[mixer_index].inputStrings[meh+i]);
+                result = USB_MIXER_FAILURE;
             }
-
-            printf("\n\n");
-#endif
+            writes[MIXER_CHANGE_WEIGHTS]++;
         }
-        else 
-        {
+#endif
+
+        for (unsigned int dst = 0; dst < mixSel->numOutputs; dst++)
+        {
+            if (mixSel->dirty[dst])
+            {
+                // Note, we are updating inputs to all mixers here with a hard-coded 0, though the device allows
+                // for separate input mapping per mixer
+                unsigned char src = mixSel->state[dst];
+                mixSel->dirty[dst] = 0;
+                usb_audio_class_set_async(CUR, 0, dst, mixSel->id, 1, &src, mixer_set_callback, &result);
+                writes[MIXER_CHANGE_MIXSEL]++;
+            }
+        }
+    }
+
+    writes[MIXER_CHANGE_CHAN_MAP] += channel_map_flush(&usb_mixers->audChannelMap, ID_XU_OUT, &result);
+    writes[MIXER_CHANGE_CHAN_MAP] += channel_map_flush(&usb_mixers->usbChannelMap, ID_XU_IN, &result);
+
+    usb_audio_requests_wait();
+
+    /* The device counts our own writes too */
+    for (int k = 0; k < MIXER_CHANGE_COUNT; k++)
+    {
+        usb_mixers->change_counts[k] += writes[k];
+    }
+
+    return result;
+}
+
+static int mixer_flush_if_idle()
+{
+    return usb_mixers->update_depth ? USB_MIXER_SUCCESS : mixer_flush();
+}
+
+static void mixsel_value_callback(int result, unsigned char *data, void *user)
+{
+    if (result >= 1)
+    {
+        *(unsigned int *)user = data[0];
+    }
+}
+
+static void channel_map_value_callback(int result, unsigned char *data, void *user)
+{
+    if (result >= 2)
+    {
+        *(int *)user = *(short *)data;
+    }
+}
+
+/* Re-reads the channel map entries without local changes */
+static void channel_map_sync(channel_mapp *map, unsigned short unitId)
+{
+    for (int i = 0; i < map->numOutputs; i++)
+    {
+        if (!map->map[i].dirty)
+        {
+            usb_audio_class_get_async(CUR, 0, i, unitId, 2, channel_map_value_callback, &map->map[i].cur);
+        }
+    }
+}
+
+void usb_mixer_begin_update()
+{
+    usb_mixers->update_depth++;
+}
+
+int usb_mixer_end_update()
+{
+    if (usb_mixers->update_depth && (--usb_mixers->update_depth == 0))
+    {
+        return mixer_flush();
+    }
+    return USB_MIXER_SUCCESS;
+}
+
+unsigned int usb_mixer_get_version()
+{
+    return usb_mixers->version;
+}
+
+int usb_mixer_sync()
+{
+    unsigned int counts[MIXER_CHANGE_COUNT];
+    int changed = 0;
+    int counted = usb_mixers->change_counts_valid && (dev_get_change_counts(counts) == USB_MIXER_SUCCESS);
+
+    if (counted)
+    {
+        for (int k = 0; k < MIXER_CHANGE_COUNT; k++)
+        {
+            if (counts[k] != usb_mixers->change_counts[k])
+            {
+                changed |= (1 << k);
+            }
+        }
+    }
+    else
+    {
+        /* No counters on the device, assume everything changed */
+        changed = USB_MIXER_SYNC_WEIGHTS | USB_MIXER_SYNC_MIXSEL | USB_MIXER_SYNC_CHAN_MAP;
+    }
+
+    for (unsigned int m = 0; m < usb_mixers->num_usb_mixers; m++)
+    {
+        usb_mixer_device *mixer = &usb_mixers->usb_mixer[m];
+        t_usb_mixSel *mixSel = &usb_mixers->usb_mixSel[m];
+
+        if (changed & USB_MIXER_SYNC_WEIGHTS)
+        {
+            unsigned int num_nodes = mixer->num_inputs * mixer->num_outputs;
+            short weights[USB_MIXER_INPUTS * USB_MIXER_OUTPUTS];
+            int have_weights = (dev_get_mixer_values(m, weights, num_nodes) == USB_MIXER_SUCCESS);
+
+            for (unsigned int i = 0; i < num_nodes; i++)
+            {
+                if (mixer->nodes[i].dirty)
+                {
+                    continue;
+                }
+                if (have_weights)
+                {
+                    mixer->nodes[i].weight = (double)weights[i] / 256;
+                }
+                else
+                {
+                    unsigned char cs = 0; /* Device doesnt use CS for getting/setting mixer weights */
+                    usb_audio_class_get_async(CUR, cs, i, mixer->id, 2, mixer_value_callback, &mixer->nodes[i]);
+                }
+            }
+        }
+
+        if (changed & USB_MIXER_SYNC_MIXSEL)
+        {
+            for (unsigned int j = 0; j < mixSel->numOutputs; j++)
+            {
+                if (!mixSel->dirty[j])
+                {
+                    /* Note, currently the host app configures all mix sel's indentically, so if we get one they all
+                     * should match */
+                    unsigned char cs = 1;
+                    usb_audio_class_get_async(CUR, cs, j, mixSel->id, 1, mixsel_value_callback, &mixSel->state[j]);
+                }
+            }
+        }
+    }
+
+    if (changed & USB_MIXER_SYNC_CHAN_MAP)
+    {
+        channel_map_sync(&usb_mixers->audChannelMap, ID_XU_OUT);
+        channel_map_sync(&usb_mixers->usbChannelMap, ID_XU_IN);
+    }
+
+    usb_audio_requests_wait();
+
+    if (changed & USB_MIXER_SYNC_MIXSEL)
+    {
+        for (unsigned int m = 0; m < usb_mixers->num_usb_mixers; m++)
+        {
+            t_usb_mixSel *mixSel = &usb_mixers->usb_mixSel[m];
+
+            for (unsigned int j = 0; j < mixSel->numOutputs; j++)
+            {
+                strcpy(usb_mixers->usb_mixer[m].input_names[j], mixSel->inputStrings[mixSel->state[j]]);
+            }
+        }
+    }
+
+    /* Counters were read before the state, a change made meanwhile is picked up next time */
+    if (counted)
+    {
+        memcpy(usb_mixers->change_counts, counts, sizeof(counts));
+    }
+
+    if (changed)
+    {
+        usb_mixers->version++;
+    }
+
+    return changed;
+}
+
+
+/* DEVICE STRINGS
+ *
+ * Where the device supports XUA_VENDOR_REQ_STRINGS the strings are read in a few transfers on connect, rather
+ * than with a GET_DESCRIPTOR request per channel name */
+
+#if defined(__APPLE__)
+#define DEV_STRINGS_MAX 256
+
+static char dev_strings[DEV_STRINGS_MAX][USB_MIXER_MAX_NAME_LEN];
+static int dev_strings_count = 0;   /* Strings read, from index 0 */
+
+static void dev_get_strings()
+{
+    dev_strings_count = 0;
+    unsigned char data[XUA_STRINGS_REQ_LEN];
+
+    while (dev_strings_count < DEV_STRINGS_MAX)
+    {
+        int result = libusb_control_transfer(devh, USB_VENDOR_REQUEST_FROM_DEV, XUA_VENDOR_REQ_STRINGS,
+            dev_strings_count, DEV_STRINGS_MAX - dev_strings_count, data, sizeof(data), 0);
+        int read = 0;
+
+        /* Each string is NUL terminated, none returned past the end of the string table */
+        for (int i = 0; i < result; i++)
+        {
+            if (data[i] == 0)
+            {
+                read++;
+            }
+        }
+        if (read == 0)
+        {
+            break;
+        }
+
+        const char *str = (const char *)data;
+        for (int i = 0; i < read; i++)
+        {
+            strncpy(dev_strings[dev_strings_count], str, USB_MIXER_MAX_NAME_LEN - 1);
+            dev_strings[dev_strings_count][USB_MIXER_MAX_NAME_LEN - 1] = 0;
+            str += strlen(str) + 1;
+            dev_strings_count++;
+        }
+    }
+}
+
+/* Reads string index as ASCII into str of len bytes, NUL terminated */
+static void get_string_ascii(int index, unsigned char *str, int len)
+{
+    if (len <= 0)
+    {
+        return;
+    }
+
+    if (index < dev_strings_count)
+    {
+        strncpy((char *)str, dev_strings[index], len - 1);
+        str[len - 1] = 0;
+    }
+    else if (libusb_get_string_descriptor_ascii(devh, index, str, len) < 0)
+    {
+        str[0] = 0;
+    }
+}
+#endif
+
+/* TOPOLOGY CACHE
+ *
+ * The parsed units, channel names and mixer node ranges are saved on the first connect to a device and reloaded
+ * on later ones, skipping the descriptor parse and string and range requests. The cache is keyed by VID, PID,
+ * bcdDevice and a checksum of the audio control descriptors, so a firmware change that alters the topology is
+ * parsed afresh. Set USB_MIXER_NO_CACHE in the environment to always parse the device */
+
+#define TOPOLOGY_CACHE_MAGIC    0x54584d55  /* "UMXT" */
+#define TOPOLOGY_CACHE_VERSION  1
+
+typedef struct
+{
+    unsigned int magic;
+    unsigned int version;
+    unsigned int size;          /* sizeof(usb_mixer_handle) */
+    unsigned int vid;
+    unsigned int pid;
+    unsigned int bcdDevice;
+    unsigned int checksum;
+} topology_key;
+
+#if defined(__APPLE__)
+static void topology_get_key(topology_key *key, const struct libusb_device_descriptor *dev_desc,
+    const libusb_config_descriptor *config_desc)
+{
+    /* FNV-1a over the class specific descriptors of every interface */
+    unsigned int checksum = 2166136261u;
+
+    for (int j = 0; j < config_desc->bNumInterfaces; j++)
+    {
+        const libusb_interface_descriptor *inter_desc = config_desc->interface[j].altsetting;
+
+        for (int i = 0; i < inter_desc->extra_length; i++)
+        {
+            checksum = (checksum ^ inter_desc->extra[i]) * 16777619u;
+        }
+    }
+
+    memset(key, 0, sizeof(*key));
+    key->magic = TOPOLOGY_CACHE_MAGIC;
+    key->version = TOPOLOGY_CACHE_VERSION;
+    key->size = sizeof(usb_mixer_handle);
+    key->vid = dev_desc->idVendor;
+    key->pid = dev_desc->idProduct;
+    key->bcdDevice = dev_desc->bcdDevice;
+    key->checksum = checksum;
+}
+
+static FILE *topology_cache_open(const topology_key *key, const char *mode)
+{
+    char path[1024];
+    const char *home = getenv("HOME");
+
+    if (home == NULL || getenv("USB_MIXER_NO_CACHE") != NULL)
+    {
+        return NULL;
+    }
+
+    snprintf(path, sizeof(path), "%s/.usb_mixer_topology_%04x_%04x_%04x", home, key->vid, key->pid, key->bcdDevice);
+    return fopen(path, mode);
+}
+
+static int topology_cache_load(const topology_key *key)
+{
+    topology_key file_key;
+    FILE *f = topology_cache_open(key, "rb");
+    int loaded = 0;
+
+    if (f == NULL)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    if (fread(&file_key, sizeof(file_key), 1, f) == 1 && memcmp(&file_key, key, sizeof(file_key)) == 0)
+    {
+        loaded = (fread(usb_mixers, sizeof(usb_mixer_handle), 1, f) == 1);
+    }
+    fclose(f);
+
+    if (!loaded)
+    {
+        memset(usb_mixers, 0, sizeof(usb_mixer_handle));
+        return USB_MIXER_FAILURE;
+    }
+
+    /* Only the topology is used, the state is read from the device */
+    usb_mixers->version = 0;
+    usb_mixers->update_depth = 0;
+    usb_mixers->change_counts_valid = 0;
+    return USB_MIXER_SUCCESS;
+}
+
+static void topology_cache_save(const topology_key *key)
+{
+    FILE *f = topology_cache_open(key, "wb");
+
+    if (f == NULL)
+    {
+        return;
+    }
+
+    fwrite(key, sizeof(*key), 1, f);
+    fwrite(usb_mixers, sizeof(usb_mixer_handle), 1, f);
+    fclose(f);
+}
+#endif
+
+/* Start at unit %id, find it in descs, keep recursively parsing up path(s) until get to Input Term and add strings */
+int addStrings(const unsigned char *data, int length, int mixer_index, int id, int chanCount)
+{
+    const unsigned char *currentUnitPtr = NULL;
+
+    /* Find this unit in the descs */
+    currentUnitPtr = findUnit(data, length, id);
+#if defined(_WIN32)
+    TUsbAudioStatus st;
+#endif
+                
+    if(currentUnitPtr != NULL)
+    {
+        /* Check if unit is a Input term */
+        if(*(currentUnitPtr+OFFSET_BDESCRIPTORSUBTYPE) == INPUT_TERMINAL)
+        {
+
+             /* Get channel names */
+#ifdef DEBUG
+            printf("Input terminal found on path (ID: %d): %d channels, total: %d\n",*(currentUnitPtr+OFFSET_BUNITID),  
+                    *(currentUnitPtr+OFFSET_IT_BNRCHANNELS), chanCount);
+#endif
+
+            int iChannelNames = *(currentUnitPtr+OFFSET_IT_ICHANNELNAMES);
+            int wTerminalType = *(currentUnitPtr+OFFSET_IT_WTERMINALTYPE);
+
+#ifdef DEBUG
+            printf("iChannelNames: %d wTerminalType: %d\n", iChannelNames, wTerminalType);
+
+            printf("Channels found:\n");
+            
+#endif
+            for(int i = 0; i < *(currentUnitPtr+OFFSET_IT_BNRCHANNELS); i++)
+            {
+                char_style mixer_input_name[USB_MIXER_MAX_NAME_LEN];
+#if defined(__APPLE__)
+                memset(mixer_input_name, 0 ,USB_MIXER_MAX_NAME_LEN);
+#elif defined(_WIN32)
+                WCHAR mixer_input_name_wchar[USB_MIXER_MAX_NAME_LEN];
+#endif
+                if (wTerminalType == 1) 
+                {
+                    strcpy(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount], "DAW - ");
+
+                    //usb_mixers->channel_maps[usb_mixers->num_channel_maps].ctype = (enum usb_chan_type) USB_CHAN_OUT;
+                    
+                    usb_mixers->audChannelMap.numOutputs = usb_mixers->audChannelMap.numOutputs +1;
+
+                    usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_OUT;
+                    usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_OUT;
+                    
+                }
+                else  
+                {
+                    strcpy(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount], "AUD - ");
+                    
+                    //usb_mixers->channel_maps[usb_mixers->num_channel_maps].ctype = (enum usb_chan_type) USB_CHAN_IN;
+
+                    usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_IN;
+                    usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_IN;
+
+
+                    usb_mixers->usbChannelMap.numOutputs = usb_mixers->usbChannelMap.numOutputs +1;
+                } 
+                /* Get relevant string descriptor */
+#if defined(__APPLE__)
+                get_string_ascii(iChannelNames+i, mixer_input_name,
+                    USB_MIXER_MAX_NAME_LEN - strlen(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount]));
+#elif defined(_WIN32)
+                st = gDrvApi.TUSBAUDIO_GetUsbStringDescriptorString(devh, iChannelNames + i, 0, mixer_input_name_wchar, USB_MIXER_MAX_NAME_LEN - strlen(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount]));
+                if (TSTATUS_SUCCESS != st) {
+                    return USB_MIXER_FAILURE;
+                }
+                wcstombs(mixer_input_name, mixer_input_name_wchar, USB_MIXER_MAX_NAME_LEN);
+#endif
+                strcat(usb_mixers->usb_mixSel[mixer_index].inputStrings[chanCount], (char *)mixer_input_name);
+
+                /* Add to channel mappers also */
+                //strcat(usb_mixers->channel_maps[usb_mixers->num_channel_maps].name, (char *)mixer_input_name);
+                strcat(usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs ].name, (char *)mixer_input_name);
+                strcat(usb_mixers->usbChannelMap.map[usb_mixers->audChannelMap.numInputs].name, (char *)mixer_input_name);
+                
+                usb_mixers->audChannelMap.numInputs = usb_mixers->audChannelMap.numInputs +1;
+                usb_mixers->usbChannelMap.numInputs = usb_mixers->usbChannelMap.numInputs +1;
+
+                //usb_mixers->num_channel_maps = usb_mixers->num_channel_maps+1;
+                chanCount++;
+            }
+
+#ifdef DEBUG
+            int meh = chanCount - *(currentUnitPtr+OFFSET_IT_BNRCHANNELS);
+            for(int i = 0; i < *(currentUnitPtr+OFFSET_IT_BNRCHANNELS); i++)
+            {
+                printf("%d: %s\n", i,usb_mixers->usb_mixSel[mixer_index].inputStrings[meh+i]);
+            }
+
+            printf("\n\n");
+#endif
+        }
+        else 
+        {
             /* Unit not a input terminal, keep going... */
             if(*(currentUnitPtr+OFFSET_BDESCRIPTORSUBTYPE) == FEATURE_UNIT)
             {
@@ -621,7 +1332,7 @@ static int get_mixer_info(const unsigned char *data, int length, unsigned int mi
                 /* Get relevant string descriptor */
                 strcpy(usb_mixers->usb_mixer[mixer_index].output_names[i], "MIX - ");
 #if defined(__APPLE__)
-                libusb_get_string_descriptor_ascii(devh, iChannelNames+i, mixer_output_name, 
+                get_string_ascii(iChannelNames+i, mixer_output_name,
                   USB_MIXER_MAX_NAME_LEN - strlen(usb_mixers->usb_mixSel[mixer_index].inputStrings[i]));
 #elif defined(_WIN32)
                 TUsbAudioStatus st = gDrvApi.TUSBAUDIO_GetUsbStringDescriptorString(devh, iChannelNames + i, 0, mixer_output_name_wchar, USB_MIXER_MAX_NAME_LEN - strlen(usb_mixers->usb_mixSel[mixer_index].inputStrings[i]));
@@ -645,157 +1356,707 @@ static int find_xmos_device(unsigned int id)
 {
     int i = 0;
     int found = -1;
+    int cached = 0;     /* Topology loaded from the cache */
 #if defined(__APPLE__)
     libusb_device *dev;
     libusb_device **devs;
+    topology_key key;
 
     libusb_get_device_list(NULL, &devs);
     while ((dev = devs[i]) != NULL) 
     {
-        struct libusb_device_descriptor desc;
-        libusb_get_device_descriptor(dev, &desc);
-        // printf("VID = 0x%x, PID = 0x%x\n", desc.idVendor, desc.idProduct);
-        if (desc.idVendor == XMOS_VID && desc.idProduct < XMOS_DEBUG_PID)
+        struct libusb_device_descriptor desc;
+        libusb_get_device_descriptor(dev, &desc);
+        // printf("VID = 0x%x, PID = 0x%x\n", desc.idVendor, desc.idProduct);
+        if (desc.idVendor == XMOS_VID && desc.idProduct < XMOS_DEBUG_PID)
+        {
+            found++;
+            if (found == id)
+            {
+                id = i;
+            }
+        }
+        i++;
+    }
+    if (found == -1) {
+        fprintf(stderr, "ERROR :: No device detected\n");
+        return USB_MIXER_FAILURE;
+    }
+    else if (found > 0) {
+        fprintf(stderr, "ERROR :: Multiple devices detected\n");
+        return USB_MIXER_FAILURE;
+    }
+
+#elif defined(_WIN32)
+    TUsbAudioStatus st;
+
+    unsigned int devcnt = gDrvApi.TUSBAUDIO_GetDeviceCount();
+    if (devcnt == 0) {
+        fprintf(stderr, "ERROR :: No device detected\n");
+        return USB_MIXER_FAILURE;
+    }
+    else if (devcnt > 1) {
+        fprintf(stderr, "ERROR :: Multiple devices detected\n");
+        return USB_MIXER_FAILURE;
+    }
+
+    st = gDrvApi.TUSBAUDIO_OpenDeviceByIndex(0, &devh);
+#endif
+    if (
+#if defined(__APPLE__)
+    libusb_open(devs[id], &devh) < 0
+#elif defined(_WIN32)
+    TSTATUS_SUCCESS != st
+#endif
+    )
+    {
+        devh = 0;
+        // skip
+    }
+    else
+    {
+#if defined(__APPLE__)
+        libusb_config_descriptor *config_desc = NULL;
+        libusb_get_active_config_descriptor(devs[id], &config_desc);
+        if (config_desc != NULL) 
+        {
+            //unsigned int num_mixers_found = 0;
+            struct libusb_device_descriptor dev_desc;
+            libusb_get_device_descriptor(devs[id], &dev_desc);
+            topology_get_key(&key, &dev_desc, config_desc);
+            cached = (topology_cache_load(&key) == USB_MIXER_SUCCESS);
+
+            usb_mixers->device_open = 1;
+
+            if (!cached)
+            {
+                usb_mixers->num_usb_mixers = 0;
+                dev_get_strings();
+
+                for (int j = 0; j < config_desc->bNumInterfaces; j++) 
+                {
+                    const libusb_interface_descriptor *inter_desc = 
+                        ((libusb_interface *)&config_desc->interface[j])->altsetting;
+        
+                    usb_mixers->num_usb_mixers += get_num_mixer_units(inter_desc->extra, inter_desc->extra_length);
+                }
+
+                for (int j = 0; j < config_desc->bNumInterfaces; j++) 
+                {
+                    const libusb_interface_descriptor *inter_desc = 
+                        ((libusb_interface *)&config_desc->interface[j])->altsetting;
+                    get_mixer_info(inter_desc->extra, inter_desc->extra_length, j, config_desc);
+                }
+            }
+            libusb_free_config_descriptor(config_desc);
+        }
+#elif defined(_WIN32)
+        unsigned int numBytes = 0;
+        unsigned char descBuffer[64 * 1024];
+
+        st = gDrvApi.TUSBAUDIO_GetUsbConfigDescriptor(devh, descBuffer, 64 * 1024, &numBytes);
+        if (TSTATUS_SUCCESS != st) {
+            return USB_MIXER_FAILURE;
+        }
+
+        usb_mixers->num_usb_mixers = get_num_mixer_units(descBuffer, numBytes);
+        get_mixer_info(descBuffer, numBytes, 0);
+#endif
+        /* Baseline for usb_mixer_sync(), read before the state itself so that changes made meanwhile are not missed */
+        usb_mixers->change_counts_valid = (usb_mixers->num_usb_mixers > 0)
+            && (dev_get_change_counts(usb_mixers->change_counts) == USB_MIXER_SUCCESS);
+
+        /* Init channel maps from device */
+        for(int i = 0; i < usb_mixers->audChannelMap.numOutputs; i++)
+        {
+        usb_mixers->audChannelMap.map[i].cur = dev_get_channel_map(i, ID_XU_OUT);
+        
+        }
+
+        for(int i = 0; i < usb_mixers->usbChannelMap.numOutputs; i++)
+        {
+        usb_mixers->usbChannelMap.map[i].cur = dev_get_channel_map(i, ID_XU_IN);
+        //printf("%d\n", usb_mixers->usbChannelMap.map[i].cur);
+        }
+        
+        /* Now add the mix outputs, already in a cached topology */
+        for(int i = 0; (i < usb_mixers->num_usb_mixers) && !cached; i++)
+        {
+            for(int j = 0; j < usb_mixers->usb_mixer[i].num_outputs;j++)
+            {   
+                //strcpy(usb_mixers->channel_maps[usb_mixers->num_channel_maps].name, usb_mixers->usb_mixer[i].output_names[j]);
+                //usb_mixers->channel_maps[usb_mixers->num_channel_maps].ctype = (enum usb_chan_type) USB_CHAN_MIXER;
+                //usb_mixers->num_channel_maps = usb_mixers->num_channel_maps+1;
+
+                usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_MIXER;
+                strcpy(usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].name, usb_mixers->usb_mixer[i].output_names[j]);
+                usb_mixers->audChannelMap.numInputs = usb_mixers->audChannelMap.numInputs +1;
+
+                usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_MIXER;
+                strcpy(usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].name, usb_mixers->usb_mixer[i].output_names[j]);
+                usb_mixers->usbChannelMap.numInputs = usb_mixers->usbChannelMap.numInputs +1;
+            }
+        }
+
+        if(devh)
+        {
+            /* Populate mixer input strings */
+            for(int i = 0; i < usb_mixers->num_usb_mixers; i++)
+            {
+                mixer_update_all_nodes(i, !cached);
+
+                /* Get current each mixer input and populate channel number state and strings from device */
+                for (int j = 0; j < usb_mixers->usb_mixSel[i].numOutputs; j++)
+                {
+                    /* Get value from device */
+                    int inputChan = get_mixsel_value(i, j);
+
+                    usb_mixers->usb_mixSel[i].state[j] = inputChan;
+
+                    /* Look up channel string */
+                    strcpy(usb_mixers->usb_mixer[i].input_names[j], usb_mixers->usb_mixSel[i].inputStrings[inputChan]);
+                }
+            }
+#if defined(__APPLE__)
+            if (!cached && usb_mixers->device_open)
+            {
+                topology_cache_save(&key);
+            }
+#endif
+        }
+    }
+#if defined(__APPLE__)
+    libusb_free_device_list(devs, 1);
+#endif
+    return devh ? 0 : -1;
+}
+
+#if defined(__APPLE__)
+/* Level meter interface and endpoint, found by usb_levels_open() */
+static int levels_interface = -1;
+static unsigned char levels_endpoint = 0;
+static unsigned short levels_max_packet = 0;
+#endif
+
+int usb_levels_open()
+{
+#if defined(__APPLE__)
+    libusb_config_descriptor *config_desc = NULL;
+
+    if(devh == NULL || libusb_get_active_config_descriptor(libusb_get_device(devh), &config_desc) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    /* The level meter interface is vendor specific with a single interrupt IN endpoint */
+    for(int j = 0; j < config_desc->bNumInterfaces; j++)
+    {
+        const libusb_interface_descriptor *inter_desc = config_desc->interface[j].altsetting;
+
+        if((inter_desc->bInterfaceClass == LIBUSB_CLASS_VENDOR_SPEC) && (inter_desc->bNumEndpoints == 1)
+            && ((inter_desc->endpoint[0].bmAttributes & 0x3) == LIBUSB_TRANSFER_TYPE_INTERRUPT)
+            && (inter_desc->endpoint[0].bEndpointAddress & LIBUSB_ENDPOINT_IN))
+        {
+            levels_interface = inter_desc->bInterfaceNumber;
+            levels_endpoint = inter_desc->endpoint[0].bEndpointAddress;
+            levels_max_packet = inter_desc->endpoint[0].wMaxPacketSize;
+            break;
+        }
+    }
+    libusb_free_config_descriptor(config_desc);
+
+    if(levels_interface < 0 || libusb_claim_interface(devh, levels_interface) < 0)
+    {
+        levels_interface = -1;
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    /* The level meter interface is not exposed through the driver API */
+    return USB_MIXER_FAILURE;
+#endif
+}
+
+int usb_levels_read(usb_level_frame *frame, unsigned int timeout_ms)
+{
+#if defined(__APPLE__)
+    unsigned char data[1024];
+    int length = 0;
+
+    if(levels_interface < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    if(libusb_interrupt_transfer(devh, levels_endpoint, data, levels_max_packet, &length, timeout_ms) < 0 || length < 4)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    /* Frame count, channel count then (peak, RMS) per channel, all 16-bit little endian */
+    frame->frame = data[0] | (data[1] << 8);
+    frame->num_chans = data[2] | (data[3] << 8);
+
+    if(frame->num_chans > USB_LEVELS_MAX_CHANS || length < (4 + frame->num_chans * 4))
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    for(int i = 0; i < frame->num_chans; i++)
+    {
+        frame->peak[i] = data[4 + (i * 4)] | (data[5 + (i * 4)] << 8);
+        frame->rms[i] = data[6 + (i * 4)] | (data[7 + (i * 4)] << 8);
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
+#endif
+}
+
+int usb_levels_stream(int (*callback)(const usb_level_frame *frame, void *user), void *user)
+{
+    usb_level_frame frame;
+
+    while(usb_levels_read(&frame, 0) == USB_MIXER_SUCCESS)
+    {
+        if(callback(&frame, user))
+        {
+            return USB_MIXER_SUCCESS;
+        }
+    }
+    return USB_MIXER_FAILURE;
+}
+
+int usb_levels_close()
+{
+#if defined(__APPLE__)
+    if(levels_interface >= 0)
+    {
+        libusb_release_interface(devh, levels_interface);
+        levels_interface = -1;
+    }
+#endif
+    return USB_MIXER_SUCCESS;
+}
+
+#if defined(__APPLE__)
+/* AudioControl interface and its interrupt endpoint, found by usb_status_open() */
+static int status_interface = -1;
+static unsigned char status_endpoint = 0;
+#endif
+
+int usb_status_open()
+{
+#if defined(__APPLE__)
+    libusb_config_descriptor *config_desc = NULL;
+
+    if(devh == NULL || libusb_get_active_config_descriptor(libusb_get_device(devh), &config_desc) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    /* The AudioControl interface has an interrupt IN endpoint when XUA_STATUS_INT_EN is enabled */
+    for(int j = 0; j < config_desc->bNumInterfaces; j++)
+    {
+        const libusb_interface_descriptor *inter_desc = config_desc->interface[j].altsetting;
+
+        if((inter_desc->bInterfaceClass == LIBUSB_CLASS_AUDIO) && (inter_desc->bInterfaceSubClass == 1)
+            && (inter_desc->bNumEndpoints == 1)
+            && ((inter_desc->endpoint[0].bmAttributes & 0x3) == LIBUSB_TRANSFER_TYPE_INTERRUPT)
+            && (inter_desc->endpoint[0].bEndpointAddress & LIBUSB_ENDPOINT_IN))
+        {
+            status_interface = inter_desc->bInterfaceNumber;
+            status_endpoint = inter_desc->endpoint[0].bEndpointAddress;
+            break;
+        }
+    }
+    libusb_free_config_descriptor(config_desc);
+
+    if(status_interface < 0 || libusb_claim_interface(devh, status_interface) < 0)
+    {
+        status_interface = -1;
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    /* Status interrupts are consumed by the driver */
+    return USB_MIXER_FAILURE;
+#endif
+}
+
+int usb_status_read(usb_status_event *event, unsigned int timeout_ms)
+{
+#if defined(__APPLE__)
+    unsigned char data[6];
+    int length = 0;
+
+    if(status_interface < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    if(libusb_interrupt_transfer(devh, status_endpoint, data, sizeof(data), &length, timeout_ms) < 0 || length < 6)
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    /* bInfo, bAttribute, wValue (CN, CS) then wIndex (interface, entity ID) */
+    event->info = data[0];
+    event->attribute = data[1];
+    event->cn = data[2];
+    event->cs = data[3];
+    event->interface = data[4];
+    event->entity = data[5];
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
+#endif
+}
+
+int usb_status_stream(int (*callback)(const usb_status_event *event, void *user), void *user)
+{
+    usb_status_event event;
+
+    while(usb_status_read(&event, 0) == USB_MIXER_SUCCESS)
+    {
+        if(callback(&event, user))
         {
-            found++;
-            if (found == id)
-            {
-                id = i;
-            }
+            return USB_MIXER_SUCCESS;
         }
-        i++;
     }
-    if (found == -1) {
-        fprintf(stderr, "ERROR :: No device detected\n");
-        return USB_MIXER_FAILURE;
+    return USB_MIXER_FAILURE;
+}
+
+int usb_status_close()
+{
+#if defined(__APPLE__)
+    if(status_interface >= 0)
+    {
+        libusb_release_interface(devh, status_interface);
+        status_interface = -1;
     }
-    else if (found > 0) {
-        fprintf(stderr, "ERROR :: Multiple devices detected\n");
+#endif
+    return USB_MIXER_SUCCESS;
+}
+
+int usb_pipeline_stats_get(usb_pipeline_stats *stats)
+{
+#if defined(__APPLE__)
+    unsigned int data[USB_PIPELINE_STATS_EVENTS + (2 * USB_PIPELINE_STATS_FILLS)];
+
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_FROM_DEV,
+                            XUA_VENDOR_REQ_PIPELINE_STATS,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            (unsigned char *)data,
+                            sizeof(data),
+                            USB_ASYNC_TIMEOUT_MS) != (int)sizeof(data))
+    {
         return USB_MIXER_FAILURE;
     }
 
+    /* Event counts then a (min, max) pair per fill range, little endian as is the host */
+    for (int i = 0; i < USB_PIPELINE_STATS_EVENTS; i++)
+    {
+        stats->events[i] = data[i];
+    }
+    for (int i = 0; i < USB_PIPELINE_STATS_FILLS; i++)
+    {
+        stats->fill_min[i] = data[USB_PIPELINE_STATS_EVENTS + (2 * i)];
+        stats->fill_max[i] = data[USB_PIPELINE_STATS_EVENTS + (2 * i) + 1];
+    }
+    return USB_MIXER_SUCCESS;
 #elif defined(_WIN32)
-    TUsbAudioStatus st;
+    /* Vendor requests are not exposed through the driver API */
+    return USB_MIXER_FAILURE;
+#endif
+}
 
-    unsigned int devcnt = gDrvApi.TUSBAUDIO_GetDeviceCount();
-    if (devcnt == 0) {
-        fprintf(stderr, "ERROR :: No device detected\n");
+int usb_pipeline_stats_reset()
+{
+#if defined(__APPLE__)
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_PIPELINE_STATS,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            NULL,
+                            0,
+                            USB_ASYNC_TIMEOUT_MS) < 0)
+    {
         return USB_MIXER_FAILURE;
     }
-    else if (devcnt > 1) {
-        fprintf(stderr, "ERROR :: Multiple devices detected\n");
-        return USB_MIXER_FAILURE;
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
+#endif
+}
+
+int usb_test_signal_start(const usb_test_signal_config *config)
+{
+#if defined(__APPLE__)
+    unsigned int data[3 + USB_TEST_SIGNAL_TONES + USB_TEST_SIGNAL_CAPTURE_CHANS];
+
+    data[0] = config->out_mask;
+    data[1] = config->settle_frames;
+    data[2] = (unsigned int) config->amplitude;
+    for (int i = 0; i < USB_TEST_SIGNAL_TONES; i++)
+    {
+        data[3 + i] = config->bins[i];
+    }
+    for (int i = 0; i < USB_TEST_SIGNAL_CAPTURE_CHANS; i++)
+    {
+        data[3 + USB_TEST_SIGNAL_TONES + i] = config->in_chans[i];
     }
 
-    st = gDrvApi.TUSBAUDIO_OpenDeviceByIndex(0, &devh);
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_TEST_SIGNAL,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            (unsigned char *)data,
+                            sizeof(data),
+                            USB_ASYNC_TIMEOUT_MS) != (int)sizeof(data))
+    {
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
 #endif
-    if (
+}
+
+int usb_test_signal_stop()
+{
 #if defined(__APPLE__)
-    libusb_open(devs[id], &devh) < 0
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_TEST_SIGNAL,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            NULL,
+                            0,
+                            USB_ASYNC_TIMEOUT_MS) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
 #elif defined(_WIN32)
-    TSTATUS_SUCCESS != st
+    return USB_MIXER_FAILURE;
 #endif
-    )
+}
+
+int usb_test_signal_get(usb_test_signal_result *result)
+{
+#if defined(__APPLE__)
+    unsigned int data[2 + (USB_TEST_SIGNAL_CAPTURE_CHANS * (4 + (4 * USB_TEST_SIGNAL_TONES)))];
+    unsigned int *w = &data[2];
+
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_FROM_DEV,
+                            XUA_VENDOR_REQ_TEST_SIGNAL,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            (unsigned char *)data,
+                            sizeof(data),
+                            USB_ASYNC_TIMEOUT_MS) != (int)sizeof(data))
     {
-        devh = 0;
-        // skip
+        return USB_MIXER_FAILURE;
     }
-    else
+
+    /* 64-bit values are sent as two little endian words, low word first */
+    result->state = data[0];
+    result->block = data[1];
+    for (int c = 0; c < USB_TEST_SIGNAL_CAPTURE_CHANS; c++)
     {
-#if defined(__APPLE__)
-        libusb_config_descriptor *config_desc = NULL;
-        libusb_get_active_config_descriptor(devs[id], &config_desc);
-        if (config_desc != NULL) 
+        result->chans[c].sum = (long long)(((unsigned long long)w[1] << 32) | w[0]);
+        result->chans[c].sum_sq = (long long)(((unsigned long long)w[3] << 32) | w[2]);
+        w += 4;
+        for (int t = 0; t < USB_TEST_SIGNAL_TONES; t++)
         {
-            //unsigned int num_mixers_found = 0;
-
-            usb_mixers->device_open = 1;
-            usb_mixers->num_usb_mixers = 0;
-
-            for (int j = 0; j < config_desc->bNumInterfaces; j++) 
-            {
-                const libusb_interface_descriptor *inter_desc = 
-                    ((libusb_interface *)&config_desc->interface[j])->altsetting;
-    
-                usb_mixers->num_usb_mixers += get_num_mixer_units(inter_desc->extra, inter_desc->extra_length);
-            }
-
-            for (int j = 0; j < config_desc->bNumInterfaces; j++) 
-            {
-                const libusb_interface_descriptor *inter_desc = 
-                    ((libusb_interface *)&config_desc->interface[j])->altsetting;
-                get_mixer_info(inter_desc->extra, inter_desc->extra_length, j, config_desc);
-            }
+            result->chans[c].re[t] = (long long)(((unsigned long long)w[1] << 32) | w[0]);
+            result->chans[c].im[t] = (long long)(((unsigned long long)w[3] << 32) | w[2]);
+            w += 4;
         }
+    }
+    return USB_MIXER_SUCCESS;
 #elif defined(_WIN32)
-        unsigned int numBytes = 0;
-        unsigned char descBuffer[64 * 1024];
+    return USB_MIXER_FAILURE;
+#endif
+}
 
-        st = gDrvApi.TUSBAUDIO_GetUsbConfigDescriptor(devh, descBuffer, 64 * 1024, &numBytes);
-        if (TSTATUS_SUCCESS != st) {
-            return USB_MIXER_FAILURE;
-        }
+int usb_glitch_log_get(usb_glitch_log *log)
+{
+#if defined(__APPLE__)
+    unsigned int data[1 + (3 * USB_GLITCH_LOG_LEN)];
+
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_FROM_DEV,
+                            XUA_VENDOR_REQ_GLITCH_LOG,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            (unsigned char *)data,
+                            sizeof(data),
+                            USB_ASYNC_TIMEOUT_MS) != (int)sizeof(data))
+    {
+        return USB_MIXER_FAILURE;
+    }
 
-        usb_mixers->num_usb_mixers = get_num_mixer_units(descBuffer, numBytes);
-        get_mixer_info(descBuffer, numBytes, 0);
-#endif
-        /* Init channel maps from device */
-        for(int i = 0; i < usb_mixers->audChannelMap.numOutputs; i++)
+    /* Count then the ring of (sequence number, time, event << 24 | argument) entries */
+    log->count = data[0];
+    log->num_events = 0;
+    for (int i = 0; i < USB_GLITCH_LOG_LEN; i++)
+    {
+        unsigned int *entry = &data[1 + (3 * i)];
+        int j;
+
+        if (entry[0] == 0)
         {
-        usb_mixers->audChannelMap.map[i].cur = dev_get_channel_map(i, ID_XU_OUT);
-        
+            continue;
         }
 
-        for(int i = 0; i < usb_mixers->usbChannelMap.numOutputs; i++)
+        /* Insert in sequence order, the ring wraps part way through */
+        for (j = log->num_events; (j > 0) && (log->events[j - 1].seq > entry[0]); j--)
         {
-        usb_mixers->usbChannelMap.map[i].cur = dev_get_channel_map(i, ID_XU_IN);
-        //printf("%d\n", usb_mixers->usbChannelMap.map[i].cur);
+            log->events[j] = log->events[j - 1];
         }
-        
-        /* Now add the mix outputs */
-        for(int i = 0; i < usb_mixers->num_usb_mixers; i++)
-        {
-            for(int j = 0; j < usb_mixers->usb_mixer[i].num_outputs;j++)
-            {   
-                //strcpy(usb_mixers->channel_maps[usb_mixers->num_channel_maps].name, usb_mixers->usb_mixer[i].output_names[j]);
-                //usb_mixers->channel_maps[usb_mixers->num_channel_maps].ctype = (enum usb_chan_type) USB_CHAN_MIXER;
-                //usb_mixers->num_channel_maps = usb_mixers->num_channel_maps+1;
+        log->events[j].seq = entry[0];
+        log->events[j].time = entry[1];
+        log->events[j].event = entry[2] >> 24;
+        log->events[j].arg = entry[2] & 0xffffff;
+        log->num_events++;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    /* Vendor requests are not exposed through the driver API */
+    return USB_MIXER_FAILURE;
+#endif
+}
 
-                usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_MIXER;
-                strcpy(usb_mixers->audChannelMap.map[usb_mixers->audChannelMap.numInputs].name, usb_mixers->usb_mixer[i].output_names[j]);
-                usb_mixers->audChannelMap.numInputs = usb_mixers->audChannelMap.numInputs +1;
+int usb_glitch_log_reset()
+{
+#if defined(__APPLE__)
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_GLITCH_LOG,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            NULL,
+                            0,
+                            USB_ASYNC_TIMEOUT_MS) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
+#endif
+}
 
-                usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].ctype = (enum usb_chan_type) USB_CHAN_MIXER;
-                strcpy(usb_mixers->usbChannelMap.map[usb_mixers->usbChannelMap.numInputs].name, usb_mixers->usb_mixer[i].output_names[j]);
-                usb_mixers->usbChannelMap.numInputs = usb_mixers->usbChannelMap.numInputs +1;
-            }
-        }
+int usb_event_log_get(usb_event_log *log)
+{
+#if defined(__APPLE__)
+    unsigned int data[1 + (2 * USB_EVENT_LOG_MAX)];
+    int entries;
+    int ret = libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_FROM_DEV,
+                            XUA_VENDOR_REQ_EVENT_LOG,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            (unsigned char *)data,
+                            sizeof(data),
+                            USB_ASYNC_TIMEOUT_MS);
+
+    if (ret < (int)(3 * sizeof(unsigned int)))
+    {
+        return USB_MIXER_FAILURE;
+    }
 
-        if(devh)
-        {
-            /* Populate mixer input strings */
-            for(int i = 0; i < usb_mixers->num_usb_mixers; i++)
-            {
-                mixer_update_all_nodes(i);
+    /* Count then the ring of (time, event << 24 | argument) entries, its length set by the device build */
+    entries = (ret / sizeof(unsigned int) - 1) / 2;
+    log->count = data[0];
+    log->num_events = (log->count < (unsigned)entries) ? log->count : entries;
+    for (unsigned int i = 0; i < log->num_events; i++)
+    {
+        /* Oldest first, the ring wraps at the count once full */
+        unsigned int idx = (log->count - log->num_events + i) % entries;
+        unsigned int *entry = &data[1 + (2 * idx)];
 
-                /* Get current each mixer input and populate channel number state and strings from device */
-                for (int j = 0; j < usb_mixers->usb_mixSel[i].numOutputs; j++)
-                {
-                    /* Get value from device */
-                    int inputChan = get_mixsel_value(i, j);
+        log->events[i].time = entry[0];
+        log->events[i].event = entry[1] >> 24;
+        log->events[i].arg = entry[1] & 0xffffff;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    /* Vendor requests are not exposed through the driver API */
+    return USB_MIXER_FAILURE;
+#endif
+}
 
-                    usb_mixers->usb_mixSel[i].state[j] = inputChan;
+int usb_event_log_reset()
+{
+#if defined(__APPLE__)
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_EVENT_LOG,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            NULL,
+                            0,
+                            USB_ASYNC_TIMEOUT_MS) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
+#endif
+}
 
-                    /* Look up channel string */
-                    strcpy(usb_mixers->usb_mixer[i].input_names[j], usb_mixers->usb_mixSel[i].inputStrings[inputChan]);
-                }
-            }
-        }
+int usb_chan_profile_get(unsigned int *profile)
+{
+#if defined(__APPLE__)
+    unsigned char data;
+    int ret = libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_FROM_DEV,
+                            XUA_VENDOR_REQ_CHAN_PROFILE,
+                            0,                      /* wValue */
+                            0,                      /* wIndex */
+                            &data,
+                            sizeof(data),
+                            USB_ASYNC_TIMEOUT_MS);
+
+    if (ret != (int)sizeof(data))
+    {
+        return USB_MIXER_FAILURE;
     }
+    *profile = data;
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    /* Vendor requests are not exposed through the driver API */
+    return USB_MIXER_FAILURE;
+#endif
+}
+
+int usb_chan_profile_set(unsigned int profile)
+{
 #if defined(__APPLE__)
-    libusb_free_device_list(devs, 1);
+    if (libusb_control_transfer(devh,
+                            USB_VENDOR_REQUEST_TO_DEV,
+                            XUA_VENDOR_REQ_CHAN_PROFILE,
+                            profile,                /* wValue */
+                            0,                      /* wIndex */
+                            NULL,
+                            0,
+                            USB_ASYNC_TIMEOUT_MS) < 0)
+    {
+        return USB_MIXER_FAILURE;
+    }
+    return USB_MIXER_SUCCESS;
+#elif defined(_WIN32)
+    return USB_MIXER_FAILURE;
 #endif
-    return devh ? 0 : -1;
 }
 
 // End of libusb interface functions
@@ -838,6 +2099,7 @@ int usb_mixer_connect()
 
 int usb_mixer_disconnect() {
 #if defined(__APPLE__)
+    usb_async_free();
     libusb_close(devh);
     libusb_exit(NULL);
 #elif(_WIN32)
@@ -907,21 +2169,66 @@ unsigned char usb_mixsel_get_state(unsigned int mixer, unsigned int channel)
 
 void usb_mixsel_set_state(unsigned int mixer, unsigned int dst, unsigned int src)
 {
-    // Write to device
-    // Note, we are updating inputs to all mixers here with a hard-coded 0, though the device allows
-    // for separate input mapping per mixer
-    unsigned bRequest = CUR; 
-    unsigned cs = 0;
-    unsigned cn = usb_mixers->usb_mixSel[mixer].id;
-    unsigned wLength = 1;
-    usb_audio_class_set(CUR, 0, dst, usb_mixers->usb_mixSel[mixer].id, wLength, (unsigned char *)&src);
+    if(usb_mixers->usb_mixSel[mixer].state[dst] != src)
+    {
+        // Update object state, written to the device by mixer_flush()
+        usb_mixers->usb_mixSel[mixer].state[dst] = src;
+        usb_mixers->usb_mixSel[mixer].dirty[dst] = 1;
+        usb_mixers->version++;
+
+        // Update local object strings
+        // TODO we don't really need to store strings since we can look them up...*/
+        strcpy(usb_mixers->usb_mixer[mixer].input_names[dst], usb_mixers->usb_mixSel[mixer].inputStrings[src]);
+
+        mixer_flush_if_idle();
+    }
+}
+
+int usb_mixer_get_values(unsigned int mixer, unsigned int first, unsigned int count, double *vals)
+{
+    usb_mixer_device *m = &usb_mixers->usb_mixer[mixer];
+    unsigned int num_nodes = m->num_inputs * m->num_outputs;
+    short weights[USB_MIXER_INPUTS * USB_MIXER_OUTPUTS];
+
+    if ((first + count) > num_nodes)
+    {
+        return USB_MIXER_FAILURE;
+    }
 
-    // Update object state
-    usb_mixers->usb_mixSel[mixer].state[dst] = src;
+    if (dev_get_mixer_values(mixer, weights, num_nodes) == USB_MIXER_SUCCESS)
+    {
+        for (unsigned int i = 0; i < num_nodes; i++)
+        {
+            if (!m->nodes[i].dirty)
+            {
+                m->nodes[i].weight = (double)weights[i] / 256;
+            }
+        }
+    }
+    else
+    {
+        /* Device without the bulk read, one pipelined request per node */
+        for (unsigned int i = first; i < first + count; i++)
+        {
+            if (m->nodes[i].dirty)
+            {
+                continue;
+            }
+            unsigned char cs = 0; /* Device doesnt use CS for getting/setting mixer weights */
+            if (usb_audio_class_get_async(CUR, cs, i, m->id, 2, mixer_value_callback, &m->nodes[i]) != USB_MIXER_SUCCESS)
+            {
+                usb_audio_requests_wait();
+                return USB_MIXER_FAILURE;
+            }
+        }
+        usb_audio_requests_wait();
+    }
 
-    // Update local object strings 
-    // TODO we don't really need to store strings since we can look them up...*/
-    strcpy(usb_mixers->usb_mixer[mixer].input_names[dst], usb_mixers->usb_mixSel[mixer].inputStrings[src]);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        vals[i] = m->nodes[first + i].weight;
+    }
+    return USB_MIXER_SUCCESS;
 }
 
 double usb_mixer_get_value(unsigned int mixer, unsigned int nodeId) 
@@ -946,21 +2253,31 @@ double usb_mixer_get_max(unsigned int mixer, unsigned int nodeId)
 
 int usb_mixer_set_value(unsigned int mixer, unsigned int nodeId, double val) 
 {
-    /* check if update required */
-    if(usb_mixers->usb_mixer[mixer].nodes[nodeId].weight != val)
+    return usb_mixer_set_values(mixer, nodeId, 1, &val);
+}
+
+int usb_mixer_set_values(unsigned int mixer, unsigned int first, unsigned int count, const double *vals)
+{
+    if((first + count) > (USB_MIXER_INPUTS * USB_MIXER_OUTPUTS))
+    {
+        return USB_MIXER_FAILURE;
+    }
+
+    for(unsigned int i = 0; i < count; i++)
     {
-        /* update local object */
-        usb_mixers->usb_mixer[mixer].nodes[nodeId].weight= val;
+        mixer_node *node = &usb_mixers->usb_mixer[mixer].nodes[first + i];
 
-        /* write to device */
-        short value = (short) (val * 256);
-       
-        unsigned char cs = 0; /* Device doesnt use CS for setting/getting mixer nodes */ 
-        unsigned char cn = nodeId & 0xff;
-        usb_audio_class_set(CUR, cs, cn, usb_mixers->usb_mixer[mixer].id,  2, (unsigned char *)&value);
-        
+        /* check if update required */
+        if(node->weight != vals[i])
+        {
+            /* update local object, written to the device by mixer_flush() */
+            node->weight = vals[i];
+            node->dirty = 1;
+            usb_mixers->version++;
+        }
     }
-    return 0;
+
+    return mixer_flush_if_idle();
 }
 
 int usb_mixer_get_range(unsigned int mixer, unsigned int mixer_unit, int *min, int *max, int *res) 
@@ -984,11 +2301,12 @@ int usb_set_aud_channel_map(int channel, int val)
     /* Check if update required */
     if(usb_mixers->audChannelMap.map[channel].cur != val)
     {
-        /* Update local object */
+        /* Update local object, written to the device by mixer_flush() */
         usb_mixers->audChannelMap.map[channel].cur = val;
-    
-        /* Write setting to dev */    
-        dev_set_channel_map(channel, val, ID_XU_OUT);
+        usb_mixers->audChannelMap.map[channel].dirty = 1;
+        usb_mixers->version++;
+
+        return mixer_flush_if_idle();
     }
     return 0;
 }
@@ -998,11 +2316,12 @@ int usb_set_usb_channel_map(int channel, int val)
     /* Check if update required */
     if(usb_mixers->usbChannelMap.map[channel].cur != val)
     {
-        /* Update local object */
+        /* Update local object, written to the device by mixer_flush() */
         usb_mixers->usbChannelMap.map[channel].cur = val;
-    
-        /* Write setting to dev */    
-        dev_set_channel_map(channel, val, ID_XU_IN);
+        usb_mixers->usbChannelMap.map[channel].dirty = 1;
+        usb_mixers->version++;
+
+        return mixer_flush_if_idle();
     }
     return 0;
 }
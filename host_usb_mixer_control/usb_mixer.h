@@ -52,12 +52,224 @@ double usb_mixer_get_value(unsigned int mixer, unsigned int mixer_unit);
 /* Sets the current value for a selected mixer unit */
 int usb_mixer_set_value(unsigned int mixer, unsigned int mixer_unit, double val);
 
+/* Sets the values of count consecutive mixer units, starting at first, in a single request. The device applies
+ * them all on the same frame */
+int usb_mixer_set_values(unsigned int mixer, unsigned int first, unsigned int count, const double *vals);
+
+/* Reads the values of count consecutive mixer units, starting at first, from the device into vals. All weights are
+ * read in a single request where the device supports it */
+int usb_mixer_get_values(unsigned int mixer, unsigned int first, unsigned int count, double *vals);
+
 /* Returns the range values for a selected mixer unit */
 int usb_mixer_get_range(unsigned int mixer, unsigned int mixer_unit, double *min, double *max, double *res);
 
 /* Returns the number of bytes read from a mem request, data is stored in data */
 int usb_mixer_mem_get(unsigned int mixer, unsigned offset, unsigned char *data);
 
+/* MIXER STATE CACHE
+ *
+ * Getters return the cached state. Setters update the cache and write the change to the device, unless made between
+ * usb_mixer_begin_update() and usb_mixer_end_update() in which case all changes are written together at the end in
+ * as few requests as possible */
+
+void usb_mixer_begin_update();
+int usb_mixer_end_update();
+
+/* Returns a count incremented on every change to the cached state, local or read from the device */
+unsigned int usb_mixer_get_version();
+
+#define USB_MIXER_SYNC_WEIGHTS  (1)
+#define USB_MIXER_SYNC_MIXSEL   (2)
+#define USB_MIXER_SYNC_CHAN_MAP (4)
+
+/* Re-reads state changed on the device by something other than this host, returns a mask of USB_MIXER_SYNC_* for
+ * the parts that were re-read. Devices without XUA_MIXER_CHANGE_COUNTERS have all state re-read */
+int usb_mixer_sync();
+
+
+/* LEVEL METER ENDPOINT (XUA_LEVEL_METER_EP_EN) */
+
+#define USB_LEVELS_MAX_CHANS 255
+
+/* A level frame as pushed by the device. Levels are 16-bit, full scale 0xffff */
+typedef struct
+{
+    unsigned short frame;                           /* Frame count, increments for each frame sent */
+    unsigned short num_chans;                       /* USB out, then USB in, then mixer output channels */
+    unsigned short peak[USB_LEVELS_MAX_CHANS];      /* Peak-hold levels */
+    unsigned short rms[USB_LEVELS_MAX_CHANS];       /* RMS levels */
+} usb_level_frame;
+
+/* Claims the device's level meter interface. Fails if the device has no level meter endpoint */
+int usb_levels_open();
+
+/* Waits up to timeout_ms (0 for no timeout) for the next level frame from the device and stores it in frame */
+int usb_levels_read(usb_level_frame *frame, unsigned int timeout_ms);
+
+/* Calls callback with each level frame received until it returns non-zero or a read fails */
+int usb_levels_stream(int (*callback)(const usb_level_frame *frame, void *user), void *user);
+
+/* Releases the level meter interface */
+int usb_levels_close();
+
+
+/* STATUS INTERRUPTS (XUA_STATUS_INT_EN) */
+
+/* A status interrupt from the AudioControl interrupt endpoint, telling of a control changed on the device (UAC2
+ * 6.1). The control should be re-read to get its new value */
+typedef struct
+{
+    unsigned char info;         /* bInfo, zero for an AudioControl interface control */
+    unsigned char attribute;    /* Attribute that changed, CUR or RANGE */
+    unsigned char cs;           /* Control selector, zero for a clock validity change */
+    unsigned char cn;           /* Channel number, or mixer control number */
+    unsigned char interface;    /* Interface number */
+    unsigned char entity;       /* ID of the unit, terminal or clock entity holding the control */
+} usb_status_event;
+
+/* Claims the device's AudioControl interface for its interrupt endpoint. Fails if the device has no interrupt
+ * endpoint or another driver holds the interface */
+int usb_status_open();
+
+/* Waits up to timeout_ms (0 for no timeout) for the next status interrupt from the device and stores it in event */
+int usb_status_read(usb_status_event *event, unsigned int timeout_ms);
+
+/* Calls callback with each status interrupt received until it returns non-zero or a read fails */
+int usb_status_stream(int (*callback)(const usb_status_event *event, void *user), void *user);
+
+/* Releases the AudioControl interface */
+int usb_status_close();
+
+
+/* PIPELINE STATISTICS (XUA_PIPELINE_STATS) */
+
+#define USB_PIPELINE_STATS_EVENTS 10
+#define USB_PIPELINE_STATS_FILLS 2
+
+/* Buffer statistics as counted by the device since boot or the last reset, see XUA_STATS_xxx in lib_xua */
+typedef struct
+{
+    unsigned int events[USB_PIPELINE_STATS_EVENTS];     /* Underflow, overflow and late transfer counts */
+    unsigned int fill_min[USB_PIPELINE_STATS_FILLS];    /* Lowest decouple OUT, IN FIFO fill in bytes */
+    unsigned int fill_max[USB_PIPELINE_STATS_FILLS];    /* Highest decouple OUT, IN FIFO fill in bytes */
+} usb_pipeline_stats;
+
+/* Reads the pipeline statistics in one request. Fails on devices built without XUA_PIPELINE_STATS */
+int usb_pipeline_stats_get(usb_pipeline_stats *stats);
+
+/* Resets the pipeline statistics */
+int usb_pipeline_stats_reset();
+
+
+/* STREAM GLITCH LOG (XUA_GLITCH_DETECT) */
+
+#define USB_GLITCH_LOG_LEN 32
+#define USB_GLITCH_EVENTS 6
+
+/* Stream discontinuities as recorded by the device, see XUA_GLITCH_xxx in lib_xua */
+typedef struct
+{
+    unsigned int seq;               /* 1 for the first event since reset, 0 for an unused entry */
+    unsigned int time;              /* Device reference timer value (100MHz) when detected */
+    unsigned int event;             /* Index into the event names, as XUA_GLITCH_xxx */
+    unsigned int arg;               /* Event argument, see XUA_GLITCH_xxx */
+} usb_glitch_event;
+
+typedef struct
+{
+    unsigned int count;                             /* Events recorded since reset, including those overwritten */
+    unsigned int num_events;                        /* Entries in events[] */
+    usb_glitch_event events[USB_GLITCH_LOG_LEN];    /* Last events recorded, oldest first */
+} usb_glitch_log;
+
+/* Reads the glitch log in one request. Fails on devices built without XUA_GLITCH_DETECT */
+int usb_glitch_log_get(usb_glitch_log *log);
+
+/* Clears the glitch log */
+int usb_glitch_log_reset();
+
+
+/* DIAGNOSTIC EVENT LOG (XUA_EVENT_LOG) */
+
+/* Largest log read, the device returns the XUA_EVENT_LOG_LEN entries it holds */
+#define USB_EVENT_LOG_MAX 256
+#define USB_EVENT_EVENTS 9
+
+/* Events as logged by the device, see XUA_EVENT_xxx in lib_xua */
+typedef struct
+{
+    unsigned int time;              /* Device reference timer value (100MHz) when logged */
+    unsigned int event;             /* Index into the event names, as XUA_EVENT_xxx */
+    unsigned int arg;               /* Event argument, see XUA_EVENT_xxx */
+} usb_event;
+
+typedef struct
+{
+    unsigned int count;                         /* Events logged since reset, including those overwritten */
+    unsigned int num_events;                    /* Entries in events[] */
+    usb_event events[USB_EVENT_LOG_MAX];        /* Last events logged, oldest first */
+} usb_event_log;
+
+/* Reads the event log in one request. Fails on devices built without XUA_EVENT_LOG */
+int usb_event_log_get(usb_event_log *log);
+
+/* Clears the event log */
+int usb_event_log_reset();
+
+
+/* CHANNEL PROFILE (XUA_CHAN_PROFILE_EN) */
+
+#define USB_CHAN_PROFILE_FULL 0
+#define USB_CHAN_PROFILE_REDUCED 1
+
+/* Reads the channel profile the device enumerated with. Fails on devices built without XUA_CHAN_PROFILE_EN */
+int usb_chan_profile_get(unsigned int *profile);
+
+/* Selects the channel profile. The device reboots and re-enumerates if the profile changes, so the
+ * connection must then be reopened */
+int usb_chan_profile_set(unsigned int profile);
+
+
+/* PRODUCTION TEST SIGNAL (XUA_TEST_SIGNAL) */
+
+#define USB_TEST_SIGNAL_TONES 4
+#define USB_TEST_SIGNAL_CAPTURE_CHANS 2
+
+#define USB_TEST_SIGNAL_OFF 0
+#define USB_TEST_SIGNAL_RUNNING 1
+#define USB_TEST_SIGNAL_DONE 2
+
+typedef struct
+{
+    unsigned int out_mask;                                  /* Output channels replaced by the test signal */
+    unsigned int settle_frames;                             /* Frames to wait before capturing */
+    int amplitude;                                          /* Peak of each tone, Q31 */
+    unsigned int bins[USB_TEST_SIGNAL_TONES];               /* Tone frequencies as DFT bins of the block, 0 unused */
+    unsigned int in_chans[USB_TEST_SIGNAL_CAPTURE_CHANS];   /* Input channels captured */
+} usb_test_signal_config;
+
+typedef struct
+{
+    unsigned int state;                                     /* USB_TEST_SIGNAL_xxx */
+    unsigned int block;                                     /* Captured block length in samples */
+    struct
+    {
+        long long sum;                                      /* Sum of the 24-bit samples */
+        long long sum_sq;                                   /* Sum of their squares */
+        long long re[USB_TEST_SIGNAL_TONES];                /* DFT terms at each tone bin */
+        long long im[USB_TEST_SIGNAL_TONES];
+    } chans[USB_TEST_SIGNAL_CAPTURE_CHANS];
+} usb_test_signal_result;
+
+/* Starts the test signal and its capture. Fails on devices built without XUA_TEST_SIGNAL */
+int usb_test_signal_start(const usb_test_signal_config *config);
+
+/* Stops the test signal, returning the outputs to the host */
+int usb_test_signal_stop();
+
+/* Reads the state and, once it is USB_TEST_SIGNAL_DONE, the analysis of the captured block */
+int usb_test_signal_get(usb_test_signal_result *result);
+
 
 /* INPUT / OUTPUT / MIXER MAPPING UNIT INTERFACE */
 
@@ -108,6 +320,21 @@ int usb_audio_class_get(unsigned char bRequest, unsigned char cs, unsigned char
 
 int usb_audio_class_set(unsigned char bRequest, unsigned char cs, unsigned char cn, unsigned short unitID, unsigned short wLength, unsigned char *data);
 
+/* ASYNCHRONOUS CLASS REQUESTS
+ *
+ * Requests are queued and several kept in flight at once. The callback is made with the result (bytes transferred,
+ * negative on error) and the data, in the order the requests were issued. Callbacks are made from within later
+ * async calls or usb_audio_requests_wait(). Requests carry at most 64 bytes */
+
+typedef void (*usb_request_callback)(int result, unsigned char *data, void *user);
+
+int usb_audio_class_get_async(unsigned char bRequest, unsigned char cs, unsigned char cn, unsigned short unitID, unsigned short wLength, usb_request_callback callback, void *user);
+
+int usb_audio_class_set_async(unsigned char bRequest, unsigned char cs, unsigned char cn, unsigned short unitID, unsigned short wLength, const unsigned char *data, usb_request_callback callback, void *user);
+
+/* Waits for all outstanding requests to complete and be called back */
+int usb_audio_requests_wait();
+
 double usb_mixer_get_res(unsigned int mixer, unsigned int nodeId);
 
 double usb_mixer_get_min(unsigned int mixer, unsigned int nodeId) ;
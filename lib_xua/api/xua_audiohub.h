@@ -48,6 +48,8 @@
  *  \param dfuInterface         Interface supporting DFU methods
  *
  *  \param c_pdm_in             Channel for receiving decimated PDM samples
+ *
+ *  \param c_dsp_fanout         Array of streaming channels connected to XUA_DspFanOutWorker() threads
  */
 void XUA_AudioHub(chanend ?c_aud,
     clock ?clk_audio_mclk,
@@ -60,10 +62,10 @@ void XUA_AudioHub(chanend ?c_aud,
 #if (XUA_SPDIF_TX_EN) || defined(__DOXYGEN__)
     , chanend c_spdif_tx
 #endif
-#if (XUA_SPDIF_RX_EN || XUA_ADAT_RX_EN || defined(__DOXYGEN__))
+#if (XUA_CLOCKGEN_EN || defined(__DOXYGEN__))
     , chanend c_dig
 #endif
-#if (XUA_SYNCMODE == XUA_SYNCMODE_SYNC || XUA_SPDIF_RX_EN || XUA_ADAT_RX_EN || defined(__DOXYGEN__))
+#if (XUA_USB_CLK_RECOVERY || XUA_CLOCKGEN_EN || defined(__DOXYGEN__))
     , chanend c_audio_rate_change
 #endif
 #if (((XUD_TILE != 0) && (AUDIO_IO_TILE == 0) && (XUA_DFU_EN == 1)) || defined(__DOXYGEN__))
@@ -72,10 +74,37 @@ void XUA_AudioHub(chanend ?c_aud,
 #if (XUA_NUM_PDM_MICS > 0 || defined(__DOXYGEN__))
     , chanend c_pdm_in
 #endif
+#if (XUA_DSP_FANOUT_WORKERS > 0 || defined(__DOXYGEN__))
+    , streaming chanend c_dsp_fanout[XUA_DSP_FANOUT_WORKERS]
+#endif
 );
 
 void SpdifTxWrapper(chanend c_spdif_tx);
 
+#if (XUA_SPDIF_TX_EN && (XUA_SPDIF_TX_PORTS > 1)) || defined(__DOXYGEN__)
+/** Multi-port S/PDIF transmitter, outputs a stereo pair on each of XUA_SPDIF_TX_PORTS ports from one thread.
+ *  Used in place of spdif_tx() from lib_spdif when XUA_SPDIF_TX_PORTS > 1.
+ *
+ *  \param p_spdif_tx  1-bit S/PDIF transmit ports, clocked from the master clock (see XUA_SpdifTxMultiPortConfig())
+ *
+ *  \param c_spdif_tx  Channel connected to XUA_AudioHub(). Each frame, for all ports, is passed by reference
+ */
+void XUA_SpdifTxMulti(buffered out port:32 p_spdif_tx[XUA_SPDIF_TX_PORTS], chanend c_spdif_tx);
+
+/** Configures the ports of XUA_SpdifTxMulti() to be clocked from the master clock, as spdif_tx_port_config().
+ *
+ *  \param p_spdif_tx  1-bit S/PDIF transmit ports
+ *
+ *  \param clk         Clock block to clock the ports from, clocked by p_mclk
+ *
+ *  \param p_mclk      Master clock input port
+ *
+ *  \param delay       Fall delay of the clock block
+ */
+void XUA_SpdifTxMultiPortConfig(buffered out port:32 p_spdif_tx[XUA_SPDIF_TX_PORTS], clock clk, in port p_mclk,
+    int delay);
+#endif
+
 /* These functions must be implemented for the CODEC/ADC/DAC arrangement of a specific design */
 
 /* Any required clocking and CODEC initialisation - run once at start up */
@@ -114,4 +143,48 @@ void UserBufferManagement(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudi
  */
 void UserBufferManagementInit(unsigned sampFreq);
 
+/**
+ * @brief   Block mode user buffer management code
+ *
+ * Called in place of UserBufferManagement() when XUA_USER_BUFFER_BLOCK_FRAMES is non-zero. Each call carries
+ * ``frames`` audio-frames, channel interleaved i.e. sample ``c`` of frame ``f`` is at index ``f * channels + c``,
+ * where channels is NUM_USB_CHAN_OUT and NUM_USB_CHAN_IN respectively. The samples may be overwritten in place.
+ *
+ * This function runs on its own thread whilst the audio hub fills the next block, so samples are delayed by two
+ * blocks in each direction. It must return within one block period (``frames`` sample periods), otherwise the audio
+ * hub stalls waiting for it.
+ *
+ * \param sampsFromUsbToAudio    Block of samples received from USB host and to be presented to audio interfaces
+ *
+ * \param sampsFromAudioToUsb    Block of samples received from the audio interfaces and to be presented to the USB host
+ *
+ * \param frames                 The number of audio-frames in each block (XUA_USER_BUFFER_BLOCK_FRAMES)
+ */
+void UserBufferManagementBlock(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[], unsigned frames);
+
+/**
+ * @brief   DSP fan-out user buffer management code
+ *
+ * Called in place of UserBufferManagement() when XUA_DSP_FANOUT_WORKERS is non-zero. Each fan-out worker thread calls
+ * this once per frame for its own group of channels. Group ``group`` starts at USB channel
+ * ``group * XUA_DSP_FANOUT_CHANS_OUT`` and ``group * XUA_DSP_FANOUT_CHANS_IN`` respectively, the last group may be
+ * smaller. The samples may be overwritten in place.
+ *
+ * Processed samples are output one frame later. The function must return within one frame period, otherwise the audio
+ * hub stalls waiting for it.
+ *
+ * \param group                  Index of the channel group (worker)
+ *
+ * \param sampsFromUsbToAudio    Samples in this group received from USB host and to be presented to audio interfaces
+ *
+ * \param numChansOut            The number of channels in sampsFromUsbToAudio
+ *
+ * \param sampsFromAudioToUsb    Samples in this group received from the audio interfaces and to be presented to the
+ *                               USB host
+ *
+ * \param numChansIn             The number of channels in sampsFromAudioToUsb
+ */
+void UserBufferManagementGroup(unsigned group, unsigned sampsFromUsbToAudio[], unsigned numChansOut,
+    unsigned sampsFromAudioToUsb[], unsigned numChansIn);
+
 #endif // _XUA_AUDIOHUB_H_
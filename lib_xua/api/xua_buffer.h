@@ -11,7 +11,7 @@
  *
  *  This function buffers USB audio data between the XUD and the audio subsystem.
  *  Most of the chanend parameters to the function should be connected to
- *  XUD_Manager().  The uses two cores.
+ *  XUD_Manager().  The uses two cores, or one with XUA_BUFFER_SINGLE_THREAD.
  *
  *  \param c_aud_out            Audio OUT endpoint channel connected to the XUD
  *  \param c_aud_in             Audio IN endpoint channel connected to the XUD
@@ -19,7 +19,7 @@
  *  \param c_midi_from_host     MIDI OUT endpoint channel connected to the XUD
  *  \param c_midi_to_host       MIDI IN endpoint channel connected to the XUD
  *  \param c_midi               Channel connected to MIDI core
- *  \param c_int                Audio clocking interrupt endpoint channel connected to the XUD
+ *  \param c_int                AudioControl interrupt endpoint channel connected to the XUD (XUA_STATUS_INT_EN only)
  *  \param c_clk_int            Optional chanend connected to the clockGen() thread if present
  *  \param c_sof                Start of frame channel connected to the XUD
  *  \param c_aud_ctl            Audio control channel connected to  Endpoint0()
@@ -28,6 +28,9 @@
  *  \param c_audio_rate_change  Channel to notify and synchronise on audio rate change
  *  \param i_pll_ref            Interface to task that toggles reference pin to CS2100
  *  \param c_swpll_update       Channel connected to software PLL task. Expects master clock counts based on USB frames.
+ *  \param c_levels             Level meter endpoint channel from XUD (XUA_LEVEL_METER_EP_EN only)
+ *  \param c_aud_in_aux         Auxiliary audio IN endpoint channel from XUD (XUA_AUX_IN_EN only)
+ *  \param c_hid_out            HID OUT endpoint channel from XUD (XUA_HID_OUT_EN only)
  */
 void XUA_Buffer(
             chanend c_aud_out,
@@ -42,7 +45,7 @@ void XUA_Buffer(
             chanend c_midi_to_host,
             chanend c_midi,
 #endif
-#if XUA_SPDIF_RX_EN || XUA_ADAT_RX_EN || defined(__DOXYGEN__)
+#if (XUA_STATUS_INT_EN) || defined(__DOXYGEN__)
             chanend ?c_int,
             chanend ?c_clk_int,
 #endif
@@ -51,9 +54,12 @@ void XUA_Buffer(
             in port p_off_mclk
 #if (HID_CONTROLS)
             , chanend c_hid
+#endif
+#if (XUA_HID_OUT_EN)
+            , chanend c_hid_out
 #endif
             , chanend c_aud
-#if (XUA_SYNCMODE == XUA_SYNCMODE_SYNC) || defined(__DOYXGEN__)
+#if (XUA_USB_CLK_RECOVERY) || defined(__DOYXGEN__)
             , chanend c_audio_rate_change
     #if (!XUA_USE_SW_PLL) || defined(__DOXYGEN__)
             , client interface pll_ref_if i_pll_ref
@@ -61,6 +67,12 @@ void XUA_Buffer(
     #if (XUA_USE_SW_PLL) || defined(__DOXYGEN__)
             , chanend c_swpll_update
     #endif
+#endif
+#if (XUA_LEVEL_METER_EP_EN) || defined(__DOXYGEN__)
+            , chanend c_levels
+#endif
+#if (XUA_AUX_IN_EN) || defined(__DOXYGEN__)
+            , chanend c_aud_in_aux
 #endif
         );
 
@@ -76,7 +88,7 @@ void XUA_Buffer_Ep(chanend c_aud_out,
             chanend c_midi_to_host,
             chanend c_midi,
 #endif
-#if (XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN)
+#if (XUA_STATUS_INT_EN)
             chanend ?c_int,
             chanend ?c_clk_int,
 #endif
@@ -86,10 +98,13 @@ void XUA_Buffer_Ep(chanend c_aud_out,
 #if (HID_CONTROLS)
             , chanend c_hid
 #endif
+#if (XUA_HID_OUT_EN)
+            , chanend c_hid_out
+#endif
 #ifdef CHAN_BUFF_CTRL
             , chanend c_buff_ctrl
 #endif
-#if (XUA_SYNCMODE == XUA_SYNCMODE_SYNC) || defined(__DOYXGEN__)
+#if (XUA_USB_CLK_RECOVERY) || defined(__DOYXGEN__)
             , chanend c_audio_rate_change
     #if (!XUA_USE_SW_PLL) || defined(__DOXYGEN__)
             , client interface pll_ref_if i_pll_ref
@@ -97,6 +112,15 @@ void XUA_Buffer_Ep(chanend c_aud_out,
     #if (XUA_USE_SW_PLL) || defined(__DOXYGEN__)
             , chanend c_swpll_update
     #endif
+#endif
+#if (XUA_LEVEL_METER_EP_EN) || defined(__DOXYGEN__)
+            , chanend c_levels
+#endif
+#if (XUA_AUX_IN_EN) || defined(__DOXYGEN__)
+            , chanend c_aud_in_aux
+#endif
+#if (XUA_BUFFER_SINGLE_THREAD)
+            , chanend c_aud
 #endif
     );
 
@@ -111,5 +135,34 @@ void XUA_Buffer_Decouple(chanend c_audio_out
      , chanend c_buff_ctrl
 #endif
 );
+
+/** Manage the USB audio buffers for XUA_DECOUPLE_NO_INTERRUPT, in place of XUA_Buffer_Decouple(). Services the
+ *  endpoints and FIFO state whilst XUA_Buffer_DecoupleAudio() answers the audio requests.
+ */
+void XUA_Buffer_DecoupleEp(
+#ifdef CHAN_BUFF_CTRL
+     chanend c_buff_ctrl
+#endif
+);
+
+/** Answer the sample requests from the audio() or mixer() threads from the FIFOs of XUA_Buffer_DecoupleEp(),
+ *  without interrupts. Must run on the same tile as XUA_Buffer_DecoupleEp().
+ *
+ * \param c_audio_out Channel connected to the audio() or mixer() threads
+ */
+void XUA_Buffer_DecoupleAudio(chanend c_audio_out);
+
+/* The decoupler loop of the above in parts, such that XUA_Buffer_Ep() runs it in its own loop for
+ * XUA_BUFFER_SINGLE_THREAD */
+void XUA_Buffer_DecoupleInit();
+void XUA_Buffer_DecoupleStart();
+#if (XUA_DECOUPLE_NO_INTERRUPT)
+void XUA_Buffer_DecouplePoll();
+#else
+void XUA_Buffer_DecouplePoll(chanend c_audio_out);
+#endif
+
+#pragma select handler
+void handle_audio_request(chanend c_audio_out);
 #endif
 #endif
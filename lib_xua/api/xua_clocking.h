@@ -31,6 +31,8 @@ void PllRefPinTask(server interface pll_ref_if i_pll_ref, out port p_sync);
  *  \param c_audio_rate_change  channel to notify of master clock change
  *  \param p_for_mclk_count_aud port used for counting mclk and providing a timestamp
  *  \param c_sw_pll             channel used to communicate with software PLL task
+ *  \param c_asrc               channel connected to XUA_DigRxAsrc() (XUA_DIG_RX_ASRC only)
+ *  \param p_wordclk            1 bit port receiving the word clock (XUA_WORDCLOCK_RX_EN only)
  *
  */
 void clockGen(  streaming chanend ?c_spdif_rx,
@@ -43,8 +45,23 @@ void clockGen(  streaming chanend ?c_spdif_rx,
 #if XUA_USE_SW_PLL
                 , port p_for_mclk_count_aud
                 , chanend c_sw_pll
+#endif
+#if (XUA_DIG_RX_ASRC)
+                , streaming chanend c_asrc
+#endif
+#if (XUA_WORDCLOCK_RX_EN)
+                , in port p_wordclk
 #endif
                 );
 
+#if (XUA_DIG_RX_ASRC)
+/** Asynchronous sample rate conversion of the S/PDIF and ADAT receive streams into the local clock domain
+ *  whilst they are not the selected clock source (XUA_DIG_RX_ASRC). Must run on the same tile as clockGen().
+ *
+ *  \param c_asrc               channel connected to clockGen()
+ */
+void XUA_DigRxAsrc(streaming chanend c_asrc);
+#endif
+
 #endif
 
@@ -57,6 +57,18 @@
 #define PLL_REF_TILE    AUDIO_IO_TILE
 #endif
 
+/**
+ * @brief Run the task driving the CS2100 reference signal in the thread of the task generating the edges,
+ *        rather than in a thread of its own. The edges are still timed by the reference port. The task
+ *        generating the edges is the buffering task on XUD_TILE for USB clock recovery, otherwise clockgen
+ *        on AUDIO_IO_TILE, which must be the tile set by PLL_REF_TILE.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_PLL_REF_DISTRIBUTE
+#define XUA_PLL_REF_DISTRIBUTE (0)
+#endif
+
 /*
  * Channel based defines
  */
@@ -78,7 +90,9 @@
 #endif
 
 /**
- * @brief Number of PDM microphones in the design.
+ * @brief Number of PDM microphones in the design. Up to 16 microphones are supported, decimated
+ *        in groups of 4. More than 8 microphones require a second PDM data port (PORT_PDM_DATA_2)
+ *        carrying microphones 8 to 15.
  *
  * Default: 0
  */
@@ -86,6 +100,10 @@
 #define XUA_NUM_PDM_MICS         (0)
 #endif
 
+#if (XUA_NUM_PDM_MICS > 16)
+#error XUA_NUM_PDM_MICS must be 16 or fewer
+#endif
+
 /**
  * @brief Number of DSD output channels.
  *
@@ -145,7 +163,8 @@
 #endif
 
 /**
- * @brief Channels per I2S frame. *
+ * @brief Channels per I2S frame (i.e. per data line). Must be 2 for I2S. For TDM 4, 8 or 16 are supported, with
+ *        16 channels per frame the bit clock at 48kHz (32 bit slots) equals a 24.576MHz master clock.
  *
  * Default: 2 i.e standard stereo I2S (8 if using TDM i.e. XUA_PCM_FORMAT_TDM).
  *
@@ -158,6 +177,19 @@
     #endif
 #endif
 
+/* The audiohub indexes the slots of a frame with a mask, so the slot count must be a power of two */
+#if (XUA_PCM_FORMAT == XUA_PCM_FORMAT_TDM)
+    #if (I2S_CHANS_PER_FRAME != 4) && (I2S_CHANS_PER_FRAME != 8) && (I2S_CHANS_PER_FRAME != 16)
+        #error Unsupported value for I2S_CHANS_PER_FRAME in TDM mode (only values 4/8/16 supported)
+    #endif
+#elif (I2S_CHANS_PER_FRAME != 2)
+    #error I2S_CHANS_PER_FRAME must be 2 in I2S mode
+#endif
+
+#if ((I2S_CHANS_DAC % I2S_CHANS_PER_FRAME) != 0) || ((I2S_CHANS_ADC % I2S_CHANS_PER_FRAME) != 0)
+    #error I2S_CHANS_DAC and I2S_CHANS_ADC must be multiples of I2S_CHANS_PER_FRAME
+#endif
+
 /**
  * @brief Number of bits per channel for I2S/TDM. Supported values: 16/32-bit.
  *
@@ -174,17 +206,43 @@
 /**
  * @brief Ratio of the I2S sample rate to the USB Audio sample rate. Up and
  *        down-sampling will be enabled as necessary when the rates differ.
+ *        Supported ratios are 2, 3 and 4. A ratio of 3 uses the lib_src voice
+ *        resampler and requires the application to depend on lib_src.
  *
  * Default: 1 i.e. I2S and USB Audio are running at the same sample rate.
  */
 #ifndef AUD_TO_USB_RATIO
 #define AUD_TO_USB_RATIO (1)
 #else
-    #if (AUD_TO_USB_RATIO != 3) && (AUD_TO_USB_RATIO != 1)
+    #if (AUD_TO_USB_RATIO < 1) || (AUD_TO_USB_RATIO > 4)
         #error Unsupported I2S to USB Audio sample rate ratio
     #endif
 #endif
 
+/**
+ * @brief Ratio of the USB Audio OUT (playback) sample rate to the USB Audio IN
+ *        (capture) sample rate, e.g. 3 for 48kHz playback with 16kHz capture.
+ *        The Decoupler decimates the IN channels by this ratio with the resampler
+ *        used for AUD_TO_USB_RATIO. Supported ratios are 2, 3 and 4, a ratio of 3
+ *        using the lib_src voice resampler and requiring the application to
+ *        depend on lib_src. The host sees the IN terminals clocked by a clock
+ *        multiplier of 1/ratio from the clock selector. Requires Audio Class 2.0
+ *        and AUD_TO_USB_RATIO of 1.
+ *
+ * Default: 1 i.e. IN and OUT streams run at the same sample rate.
+ */
+#ifndef USB_OUT_TO_IN_RATIO
+#define USB_OUT_TO_IN_RATIO (1)
+#endif
+
+#if (USB_OUT_TO_IN_RATIO < 1) || (USB_OUT_TO_IN_RATIO > 4)
+    #error Unsupported USB OUT to USB IN sample rate ratio
+#endif
+
+#if (USB_OUT_TO_IN_RATIO > 1) && (AUD_TO_USB_RATIO > 1)
+    #error USB_OUT_TO_IN_RATIO requires AUD_TO_USB_RATIO of 1
+#endif
+
 /**
  * @brief Ratio of the I2S sample rate to the PDM microphone decimator sample
  *        rate.
@@ -227,7 +285,8 @@
  */
 
 /**
- * @brief Max supported sample frequency for device (Hz).
+ * @brief Max supported sample frequency for device (Hz). Up to 768000Hz, rates above 192000Hz generally
+ *        requiring a BCLK equal to MCLK (see XUA_MIXER_MAX_FREQ for use with the mixer).
  *
  * Default: 192000Hz
  */
@@ -235,6 +294,10 @@
 #define MAX_FREQ                 (192000)
 #endif
 
+#if (MAX_FREQ > 768000)
+#error MAX_FREQ above 768000 not supported
+#endif
+
 /**
  * @brief Min supported sample frequency for device (Hz).
  *
@@ -300,6 +363,32 @@
 #define CODEC_MASTER       (0)
 #endif
 
+/**
+ * @brief Detect the sample rate of the LR clock when the CODEC is I2S master. The LR clock is timed over
+ *        every XUA_I2S_SLAVE_RATE_DETECT_FRAMES frames. When two successive measurements agree on a supported
+ *        rate other than the current one, the audio hub reconfigures itself for the detected rate, including
+ *        calling AudioHwConfig(), without waiting for a rate change from the host.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_I2S_SLAVE_RATE_DETECT
+#define XUA_I2S_SLAVE_RATE_DETECT (0)
+#endif
+
+/**
+ * @brief Number of frames over which the LR clock is timed by XUA_I2S_SLAVE_RATE_DETECT, rounded up to a
+ *        multiple of the audio hub to USB sample rate ratio.
+ *
+ * Default: 8
+ */
+#ifndef XUA_I2S_SLAVE_RATE_DETECT_FRAMES
+#define XUA_I2S_SLAVE_RATE_DETECT_FRAMES (8)
+#endif
+
+#if (XUA_I2S_SLAVE_RATE_DETECT) && !(CODEC_MASTER)
+#error XUA_I2S_SLAVE_RATE_DETECT requires CODEC_MASTER
+#endif
+
 /*
  * Audio Class defines
  */
@@ -348,6 +437,10 @@
 #error AUDIO_CLASS set to 1 and FULL_SPEED_AUDIO_2 enabled!
 #endif
 
+#if (USB_OUT_TO_IN_RATIO > 1) && ((AUDIO_CLASS == 1) || (AUDIO_CLASS_FALLBACK))
+#error USB_OUT_TO_IN_RATIO requires Audio Class 2.0 without AUDIO_CLASS_FALLBACK
+#endif
+
 /*
  * Feature defines
  */
@@ -378,6 +471,32 @@
 #define XUA_MIC_FRAME_SIZE      (1)
 #endif
 
+/**
+ * @brief Number of microphone sample frames passed from the PDM buffer task to the audiohub per
+ *        request. The audiohub then consumes one frame per (microphone) sample period from its
+ *        local copy, so the channel exchange and the decimator timing is decoupled from every
+ *        I2S frame. Adds XUA_PDM_MIC_BATCH_FRAMES frames of latency.
+ *
+ * Default: 1
+ */
+#ifndef XUA_PDM_MIC_BATCH_FRAMES
+#define XUA_PDM_MIC_BATCH_FRAMES (1)
+#endif
+
+/**
+ * @brief Depth, in frames, of the microphone sample FIFO in the PDM buffer task. Must be a
+ *        multiple of XUA_PDM_MIC_BATCH_FRAMES.
+ *
+ * Default: XUA_PDM_MIC_BATCH_FRAMES
+ */
+#ifndef MIC_BUFFER_DEPTH
+#define MIC_BUFFER_DEPTH         (XUA_PDM_MIC_BATCH_FRAMES)
+#endif
+
+#if ((MIC_BUFFER_DEPTH) % (XUA_PDM_MIC_BATCH_FRAMES)) != 0
+#error MIC_BUFFER_DEPTH must be a multiple of XUA_PDM_MIC_BATCH_FRAMES
+#endif
+
 /**
  * @brief Enable MIDI functionality including buffering, descriptors etc. Default: DISABLED
  */
@@ -390,12 +509,85 @@
 #endif
 
 /**
- * @brief MIDI Rx port width (1 or 4bit). Default: 1
+ * @brief MIDI Rx port width (1, 4 or 8bit). Default: 1
  */
 #ifndef MIDI_RX_PORT_WIDTH
 #define MIDI_RX_PORT_WIDTH      (1)
 #endif
 
+/**
+ * @brief Depth, in USB MIDI events, of the queue in usb_midi() holding events for the host. The queue
+ *        fills whilst XUA_Buffer has an event outstanding, or holds its ack back because its packet
+ *        buffer is full. Must be a power of 2. Default: 16
+ */
+#ifndef XUA_MIDI_TO_HOST_FIFO_SIZE
+#define XUA_MIDI_TO_HOST_FIFO_SIZE (16)
+#endif
+
+/**
+ * @brief Number of MIDI ports, each presented as a USB MIDI cable. More than one port are all serviced
+ *        from a single thread by usb_midi_multi(). Port n receives on bit n of PORT_MIDI_IN,
+ *        which must be MIDI_RX_PORT_WIDTH (4 or 8) bits wide. It transmits on bit MIDI_SHIFT_TX + n
+ *        of PORT_MIDI_OUT. Default: 1
+ */
+#ifndef XUA_MIDI_PORTS
+#define XUA_MIDI_PORTS          (1)
+#endif
+
+#if (XUA_MIDI_PORTS < 1) || (XUA_MIDI_PORTS > 8)
+#error XUA_MIDI_PORTS must be between 1 and 8
+#endif
+
+#if (XUA_MIDI_PORTS > 1) && (XUA_MIDI_PORTS > MIDI_RX_PORT_WIDTH)
+#error XUA_MIDI_PORTS greater than 1 requires a MIDI_RX_PORT_WIDTH of at least XUA_MIDI_PORTS
+#endif
+
+#if (XUA_MIDI_PORTS > 1) && defined(IAP)
+#error XUA_MIDI_PORTS greater than 1 not supported with IAP
+#endif
+
+/**
+ * @brief Depth, in UART symbols, of each port's transmit queue when XUA_MIDI_PORTS is greater than 1.
+ *        Must be a power of 2. Default: 256
+ */
+#ifndef XUA_MIDI_PORT_OUT_FIFO_SIZE
+#define XUA_MIDI_PORT_OUT_FIFO_SIZE (256)
+#endif
+
+/**
+ * @brief Enable MIDI timing measurement. MIDI timing clocks (0xF8) are time stamped at their start bit on the
+ *        MIDI input and output (port 0 when XUA_MIDI_PORTS is greater than 1) and a histogram of the clock
+ *        jitter in each direction is made available to the host through the vendor request
+ *        XUA_VENDOR_REQ_MIDI_TIMING. This is only visible when MIDI_TILE is XUD_TILE. Default: 0 (Disabled)
+ */
+#ifndef XUA_MIDI_TIMING
+#define XUA_MIDI_TIMING         (0)
+#endif
+
+/**
+ * @brief Number of bins in each MIDI jitter histogram. The last bin also counts all larger jitter. Default: 16
+ */
+#ifndef XUA_MIDI_JITTER_HIST_BINS
+#define XUA_MIDI_JITTER_HIST_BINS (16)
+#endif
+
+/**
+ * @brief Width of each MIDI jitter histogram bin in microseconds. Default: 32 (one MIDI bit time)
+ */
+#ifndef XUA_MIDI_JITTER_BIN_US
+#define XUA_MIDI_JITTER_BIN_US  (32)
+#endif
+
+/**
+ * @brief Enable USB MIDI 2.0. The MIDI streaming interface gets an alternate setting 1 carrying Universal MIDI
+ *        Packets (UMP), with one bidirectional group terminal block per MIDI port (group n is port n). The MIDI
+ *        1.0 UARTs are bridged through a translation layer, MIDI 2.0 channel voice messages being scaled to
+ *        MIDI 1.0. Alternate setting 0 remains USB MIDI 1.0. Default: 0 (Disabled)
+ */
+#ifndef XUA_MIDI_UMP
+#define XUA_MIDI_UMP            (0)
+#endif
+
 /**
  * @brief Enables SPDIF Tx. Default: 0 (Disabled)
  */
@@ -412,6 +604,22 @@
 #define SPDIF_TX_INDEX        (0)
 #endif
 
+/**
+ * @brief Number of S/PDIF transmit ports (1 to 4). With more than one port the 2 * XUA_SPDIF_TX_PORTS output
+ *        channels from SPDIF_TX_INDEX are output on S/PDIF, a stereo pair per port, all from a single thread
+ *        (XUA_SpdifTxMulti() in place of lib_spdif). Ports after the first are PORT_SPDIF_OUT2 to PORT_SPDIF_OUT4.
+ *        The master clock must be 128, 256, 512 or 1024 times the sample rate.
+ *
+ * Default: 1
+ */
+#ifndef XUA_SPDIF_TX_PORTS
+#define XUA_SPDIF_TX_PORTS    (1)
+#endif
+
+#if (XUA_SPDIF_TX_PORTS < 1) || (XUA_SPDIF_TX_PORTS > 4)
+#error XUA_SPDIF_TX_PORTS must be 1 to 4
+#endif
+
 /**
  * @brief Enables ADAT Tx. Default: 0 (Disabled)
  */
@@ -428,6 +636,21 @@
 #define ADAT_TX_INDEX         (0)
 #endif
 
+/**
+ * @brief Number of ADAT transmit ports (1 or 2). With 2 ports the 16 output channels from ADAT_TX_INDEX
+ *        are output on ADAT, 8 per port (fewer in SMUX modes, each port then carries the next 8/SMUX
+ *        channels). The second port is PORT_ADAT_OUT2 and requires an additional thread on the audio tile.
+ *
+ * Default: 1
+ */
+#ifndef XUA_ADAT_TX_PORTS
+#define XUA_ADAT_TX_PORTS     (1)
+#endif
+
+#if (XUA_ADAT_TX_PORTS != 1) && (XUA_ADAT_TX_PORTS != 2)
+#error XUA_ADAT_TX_PORTS must be 1 or 2
+#endif
+
 /**
  * @brief Enables SPDIF Rx. Default: 0 (Disabled)
  */
@@ -454,6 +677,91 @@
 #define XUA_ADAT_RX_EN        (0)
 #endif
 
+/**
+ * @brief Run the S/PDIF and ADAT receive FIFOs as elastic buffers. Rather than only recovering from an overflow or
+ *        underflow by refilling from half full, a frame is dropped when the FIFO is above three quarters full
+ *        and repeated when below a quarter full, at most once every XUA_DIG_RX_CORRECTION_INTERVAL frames.
+ *        This keeps the input continuous whilst the master clock is not yet locked to the digital input e.g.
+ *        after switching input. Fill statistics are recorded in g_xua_spdif_rx_stats and g_xua_adat_rx_stats.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DIG_RX_ELASTIC
+#define XUA_DIG_RX_ELASTIC    (0)
+#endif
+
+/**
+ * @brief Minimum number of frames between frame drops or repeats of an elastic receive FIFO, bounding the
+ *        frequency offset corrected (to 1 / XUA_DIG_RX_CORRECTION_INTERVAL). See XUA_DIG_RX_ELASTIC.
+ *
+ * Default: 32
+ */
+#ifndef XUA_DIG_RX_CORRECTION_INTERVAL
+#define XUA_DIG_RX_CORRECTION_INTERVAL (32)
+#endif
+
+/**
+ * @brief Convert the S/PDIF and ADAT receive streams into the local clock domain with an asynchronous sample rate
+ *        converter whilst they are not the selected clock source, so that they may be used (e.g. mixed) whilst
+ *        the device is clocked from USB or its internal clock. Conversion runs in an additional thread
+ *        (XUA_DigRxAsrc()) on the same tile as clockGen(), with a fixed latency of 48 input frames. Input rates
+ *        up to 1.1 times the device rate are converted, faster inputs are muted. ADAT is only converted in
+ *        non-SMUX mode. Has no effect unless XUA_SPDIF_RX_EN or XUA_ADAT_RX_EN is enabled. The filter kernel
+ *        uses the vector unit on xcore.ai devices.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DIG_RX_ASRC
+#define XUA_DIG_RX_ASRC       (0)
+#endif
+
+/**
+ * @brief Enables word clock Rx, an external clock source alongside S/PDIF and ADAT. The master clock is locked to
+ *        a word clock at the sample rate on PORT_WORDCLOCK_IN, a 1 bit port on the audio tile, with lib_sw_pll
+ *        (XUA_USE_SW_PLL) or an external PLL driven from PORT_PLL_REF. Several devices locked to one word clock,
+ *        for example that of a device enabling XUA_WORDCLOCK_TX_EN, run at exactly the same rate.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_WORDCLOCK_RX_EN
+#define XUA_WORDCLOCK_RX_EN   (0)
+#endif
+
+/**
+ * @brief Enables word clock Tx, output of a word clock on PORT_WORDCLOCK_OUT, a 1 bit port on the audio tile.
+ *        The word clock rises at the start of each I2S/TDM frame with a 50% duty cycle, so is synchronous with
+ *        the LR clock. Requires the xcore to be I2S master (CODEC_MASTER disabled).
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_WORDCLOCK_TX_EN
+#define XUA_WORDCLOCK_TX_EN   (0)
+#endif
+
+/**
+ * @brief Start the I2S/TDM frame on a rising edge of the word clock input (XUA_WORDCLOCK_RX_EN) each time the
+ *        audio ports are started, at most two periods of the lowest sample rate after it is requested. Devices
+ *        locked to a word clock then start their frames together, to within a bit clock, and with
+ *        XUA_WORDCLOCK_TX_EN the word clock output is in phase with the input. Requires the xcore to be I2S
+ *        master (CODEC_MASTER disabled).
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_WORDCLOCK_START_SYNC
+#define XUA_WORDCLOCK_START_SYNC (0)
+#endif
+
+#if (XUA_WORDCLOCK_START_SYNC) && !(XUA_WORDCLOCK_RX_EN)
+#error XUA_WORDCLOCK_START_SYNC requires XUA_WORDCLOCK_RX_EN
+#endif
+
+#if ((XUA_WORDCLOCK_TX_EN) || (XUA_WORDCLOCK_START_SYNC)) && (CODEC_MASTER)
+#error XUA_WORDCLOCK_TX_EN and XUA_WORDCLOCK_START_SYNC require CODEC_MASTER to be disabled
+#endif
+
+/* clockGen() runs whenever there is an external clock source i.e. S/PDIF, ADAT or word clock Rx */
+#define XUA_CLOCKGEN_EN         ((XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN) || (XUA_WORDCLOCK_RX_EN))
+
 /**
  * @brief S/PDIF Rx first channel index, defines which channels S/PDIF will be input on.
  * Note, indexed from 0.
@@ -528,6 +836,68 @@
 #undef XUA_DFU_EN
 #endif
 
+/**
+ * @brief DFU transfer size in bytes, reported as wTransferSize in the DFU functional descriptor. This is the largest
+ *        block the host may send in a single DFU_DNLOAD or request in a single DFU_UPLOAD. Larger blocks reduce the
+ *        number of control transfers (and status polls) needed to move an image. Must be a multiple of 64 and no
+ *        greater than 1024.
+ *
+ * Default: 64
+ */
+#ifndef XUA_DFU_TRANSFER_SIZE
+#define XUA_DFU_TRANSFER_SIZE        (64)
+#endif
+
+#if ((XUA_DFU_TRANSFER_SIZE % 64) != 0) || (XUA_DFU_TRANSFER_SIZE == 0) || (XUA_DFU_TRANSFER_SIZE > 1024)
+#error XUA_DFU_TRANSFER_SIZE must be a non-zero multiple of 64 and no greater than 1024
+#endif
+
+/**
+ * @brief Accept delta DFU images. A delta image describes the new upgrade image as pages copied from the installed
+ *        upgrade image plus literal pages. The new image is written after the installed one, which is deleted
+ *        once the download completes, so the flash must have room for two upgrade images.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DFU_DELTA
+#define XUA_DFU_DELTA                (0)
+#endif
+
+/**
+ * @brief Accept compressed DFU images. A compressed image is a simple LZ stream whose back references reach no
+ *        further than XUA_DFU_COMPRESS_WINDOW bytes, it is decompressed as it arrives into the flash page buffers.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DFU_COMPRESS
+#define XUA_DFU_COMPRESS             (0)
+#endif
+
+/**
+ * @brief Bytes of decompressed output kept for back references when XUA_DFU_COMPRESS is enabled. Images compressed
+ *        with a larger window are refused. Must be a power of two.
+ *
+ * Default: 512
+ */
+#ifndef XUA_DFU_COMPRESS_WINDOW
+#define XUA_DFU_COMPRESS_WINDOW      (512)
+#endif
+
+#if (XUA_DFU_COMPRESS_WINDOW & (XUA_DFU_COMPRESS_WINDOW - 1)) || (XUA_DFU_COMPRESS_WINDOW > 65536)
+#error XUA_DFU_COMPRESS_WINDOW must be a power of two no greater than 65536
+#endif
+
+/**
+ * @brief Allow an interrupted download to be resumed. A USB reset during a download leaves the device in DFU mode
+ *        with the download kept, and the count and CRC-32 of the blocks received so far are reported by
+ *        XMOS_DFU_DNLOADSTATE such that the host may continue from the next block.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DFU_RESUME
+#define XUA_DFU_RESUME               (0)
+#endif
+
 /**
  * @brief Enable HID playback controls functionality.
  *
@@ -562,7 +932,8 @@
 #endif
 
 /**
- * @brief Enable a HID OUT endpoint. Only use this if you supply your own HID control.
+ * @brief Enable a HID OUT endpoint. With HID_CONTROLS, reports from the host are passed to UserHIDOutReport()
+ *        by the buffer core. Otherwise you must supply your own HID control.
  *
  * 1 for enabled, 0 for disabled.
  *
@@ -572,6 +943,13 @@
 #define HID_OUT_REQUIRED       (0)
 #endif
 
+/* With the built-in XUA-HID, HID OUT reports are received by the buffer core and passed to UserHIDOutReport() */
+#if (HID_CONTROLS) && (HID_OUT_REQUIRED)
+#define XUA_HID_OUT_EN         (1)
+#else
+#define XUA_HID_OUT_EN         (0)
+#endif
+
 /**
  * @brief Serial Number String used by the device
  *
@@ -631,6 +1009,30 @@
 #define PRODUCT_STR_A1           "XMOS xCORE (UAC1.0)"
 #endif
 
+/**
+ * @brief Generate the per-channel name strings (e.g. "Analogue 1/SPDIF 1") when the host requests them,
+ *        from a small table of name prefixes and channel ranges, rather than holding a string for every
+ *        USB channel in memory (chanstrings.h). Each name is built into a single shared string descriptor
+ *        buffer, so memory use does not grow with channel count. Channel names set in g_strTable by the
+ *        application are still returned.
+ *
+ * Default: 1 (Enabled)
+ */
+#ifndef XUA_CHAN_STRINGS_ON_DEMAND
+#define XUA_CHAN_STRINGS_ON_DEMAND (1)
+#endif
+
+/**
+ * @brief Enable the vendor request XUA_VENDOR_REQ_STRINGS, which returns a run of string descriptors
+ *        (e.g. the channel names) as ASCII in a single transfer. Used by host_usb_mixer_control to read
+ *        the channel names on connect without a GET_DESCRIPTOR request per string.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_STRINGS_REQ
+#define XUA_STRINGS_REQ (0)
+#endif
+
 /**
  * @brief USB Product ID (PID) for Audio Class 1.0 mode. Only required if AUDIO_CLASS == 1 or AUDIO_CLASS_FALLBACK is enabled.
  *
@@ -715,6 +1117,26 @@
     #endif
 #endif
 
+/**
+ * @brief Output stream alternate (1 to OUTPUT_FORMAT_COUNT) that carries IEEE-754 32 bit float samples.
+ *        Its resolution defaults to 32 bits and its data format to UAC_FORMAT_TYPEI_IEEE_FLOAT. The
+ *        Decoupler converts its samples to fixed point, full scale being +/-1.0. Set to 0 for no float
+ *        alternate.
+ *
+ * Default: 0 (None)
+ */
+#ifndef XUA_FLOAT_OUT_FORMAT_NUM
+    #define XUA_FLOAT_OUT_FORMAT_NUM    (0)
+#endif
+
+#if (XUA_FLOAT_OUT_FORMAT_NUM > OUTPUT_FORMAT_COUNT)
+    #error XUA_FLOAT_OUT_FORMAT_NUM must be an output stream alternate
+#endif
+
+#if defined(NATIVE_DSD) && (XUA_FLOAT_OUT_FORMAT_NUM != 0) && (XUA_FLOAT_OUT_FORMAT_NUM == NATIVE_DSD_FORMAT_NUM)
+    #error XUA_FLOAT_OUT_FORMAT_NUM and NATIVE_DSD_FORMAT_NUM must be different alternates
+#endif
+
 
 /* Default sample resolutions for each alternate */
 
@@ -729,6 +1151,8 @@
 #ifndef STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS
     #if (NATIVE_DSD_FORMAT_NUM == 1)
         #define STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS      32  /* DSD requires 32bits */
+    #elif (XUA_FLOAT_OUT_FORMAT_NUM == 1)
+        #define STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS      32  /* IEEE-754 single precision */
     #else
         #define STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS      24
     #endif
@@ -743,6 +1167,8 @@
 #ifndef STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS
 #if (NATIVE_DSD_FORMAT_NUM == 2)
         #define STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS      32  /* DSD requires 32bits */
+    #elif (XUA_FLOAT_OUT_FORMAT_NUM == 2)
+        #define STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS      32  /* IEEE-754 single precision */
     #else
         #define STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS      16
     #endif
@@ -757,6 +1183,8 @@
 #ifndef STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS
     #if (NATIVE_DSD_FORMAT_NUM == 3)
         #define STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS      32  /* DSD requires 32bits */
+    #elif (XUA_FLOAT_OUT_FORMAT_NUM == 3)
+        #define STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS      32  /* IEEE-754 single precision */
     #else
         #define STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS      32
     #endif
@@ -885,11 +1313,14 @@
 /**
  * @brief Sample audio data-format if output stream Alternate 1.
  *
- * Default: UAC_FORMAT_TYPEI_RAW_DATA when Alternate 1 is RAW/DSD else UAC_FORMAT_TYPEI_PCM
+ * Default: UAC_FORMAT_TYPEI_RAW_DATA when Alternate 1 is RAW/DSD, UAC_FORMAT_TYPEI_IEEE_FLOAT when
+ *          it is float, else UAC_FORMAT_TYPEI_PCM
  */
 #ifndef STREAM_FORMAT_OUTPUT_1_DATAFORMAT
     #if (NATIVE_DSD_FORMAT_NUM == 1)
         #define STREAM_FORMAT_OUTPUT_1_DATAFORMAT               UAC_FORMAT_TYPEI_RAW_DATA
+    #elif (XUA_FLOAT_OUT_FORMAT_NUM == 1)
+        #define STREAM_FORMAT_OUTPUT_1_DATAFORMAT               UAC_FORMAT_TYPEI_IEEE_FLOAT
     #else
         #define STREAM_FORMAT_OUTPUT_1_DATAFORMAT               UAC_FORMAT_TYPEI_PCM
     #endif
@@ -898,11 +1329,14 @@
 /**
  * @brief Sample audio data-format if output stream Alternate 2.
  *
- * Default: UAC_FORMAT_TYPEI_RAW_DATA when Alternate 2 is RAW/DSD else UAC_FORMAT_TYPEI_PCM
+ * Default: UAC_FORMAT_TYPEI_RAW_DATA when Alternate 2 is RAW/DSD, UAC_FORMAT_TYPEI_IEEE_FLOAT when
+ *          it is float, else UAC_FORMAT_TYPEI_PCM
  */
 #ifndef STREAM_FORMAT_OUTPUT_2_DATAFORMAT
     #if (NATIVE_DSD_FORMAT_NUM == 2)
         #define STREAM_FORMAT_OUTPUT_2_DATAFORMAT               UAC_FORMAT_TYPEI_RAW_DATA
+    #elif (XUA_FLOAT_OUT_FORMAT_NUM == 2)
+        #define STREAM_FORMAT_OUTPUT_2_DATAFORMAT               UAC_FORMAT_TYPEI_IEEE_FLOAT
     #else
         #define STREAM_FORMAT_OUTPUT_2_DATAFORMAT               UAC_FORMAT_TYPEI_PCM
     #endif
@@ -911,11 +1345,14 @@
 /**
  * @brief Sample audio data-format if output stream Alternate 3.
  *
- * Default: UAC_FORMAT_TYPEI_RAW_DATA when Alternate 3 is RAW/DSD else UAC_FORMAT_TYPEI_PCM
+ * Default: UAC_FORMAT_TYPEI_RAW_DATA when Alternate 3 is RAW/DSD, UAC_FORMAT_TYPEI_IEEE_FLOAT when
+ *          it is float, else UAC_FORMAT_TYPEI_PCM
  */
 #ifndef STREAM_FORMAT_OUTPUT_3_DATAFORMAT
     #if (NATIVE_DSD_FORMAT_NUM == 3)
         #define STREAM_FORMAT_OUTPUT_3_DATAFORMAT               UAC_FORMAT_TYPEI_RAW_DATA
+    #elif (XUA_FLOAT_OUT_FORMAT_NUM == 3)
+        #define STREAM_FORMAT_OUTPUT_3_DATAFORMAT               UAC_FORMAT_TYPEI_IEEE_FLOAT
     #else
         #define STREAM_FORMAT_OUTPUT_3_DATAFORMAT               UAC_FORMAT_TYPEI_PCM
     #endif
@@ -931,21 +1368,49 @@
     #define INPUT_FORMAT_COUNT 1
 #endif
 
+/**
+ * @brief Input stream alternate (1 to INPUT_FORMAT_COUNT) that carries IEEE-754 32 bit float samples.
+ *        Its resolution defaults to 32 bits and its data format to UAC_FORMAT_TYPEI_IEEE_FLOAT. The
+ *        Decoupler converts the fixed point samples to float, full scale being +/-1.0. Set to 0 for no
+ *        float alternate.
+ *
+ * Default: 0 (None)
+ */
+#ifndef XUA_FLOAT_IN_FORMAT_NUM
+    #define XUA_FLOAT_IN_FORMAT_NUM     (0)
+#endif
+
+#if (XUA_FLOAT_IN_FORMAT_NUM > INPUT_FORMAT_COUNT)
+    #error XUA_FLOAT_IN_FORMAT_NUM must be an input stream alternate
+#endif
+
 /**
  * @brief Sample resolution (bits) of input stream Alternate 1.
  *
- * Default: 24
+ * Default: 32 if Alternate 1 is float, else 24
  */
 #ifndef STREAM_FORMAT_INPUT_1_RESOLUTION_BITS
-    #define STREAM_FORMAT_INPUT_1_RESOLUTION_BITS           24
+    #if (XUA_FLOAT_IN_FORMAT_NUM == 1)
+        #define STREAM_FORMAT_INPUT_1_RESOLUTION_BITS       32  /* IEEE-754 single precision */
+    #else
+        #define STREAM_FORMAT_INPUT_1_RESOLUTION_BITS       24
+    #endif
 #endif
 
 #ifndef STREAM_FORMAT_INPUT_2_RESOLUTION_BITS
-    #define STREAM_FORMAT_INPUT_2_RESOLUTION_BITS           24
+    #if (XUA_FLOAT_IN_FORMAT_NUM == 2)
+        #define STREAM_FORMAT_INPUT_2_RESOLUTION_BITS       32  /* IEEE-754 single precision */
+    #else
+        #define STREAM_FORMAT_INPUT_2_RESOLUTION_BITS       24
+    #endif
 #endif
 
 #ifndef STREAM_FORMAT_INPUT_3_RESOLUTION_BITS
-    #define STREAM_FORMAT_INPUT_3_RESOLUTION_BITS           24
+    #if (XUA_FLOAT_IN_FORMAT_NUM == 3)
+        #define STREAM_FORMAT_INPUT_3_RESOLUTION_BITS       32  /* IEEE-754 single precision */
+    #else
+        #define STREAM_FORMAT_INPUT_3_RESOLUTION_BITS       24
+    #endif
 #endif
 
 
@@ -978,6 +1443,25 @@
 #endif
 
 
+/* Channel count defines for output streams. Alternates with fewer channels than NUM_USB_CHAN_OUT use smaller packets,
+ * the remaining channels being muted */
+#ifndef HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT
+    #define HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT            NUM_USB_CHAN_OUT
+#endif
+
+#ifndef HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT
+    #define HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT            NUM_USB_CHAN_OUT
+#endif
+
+#ifndef HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT
+    #define HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT            NUM_USB_CHAN_OUT
+#endif
+
+#if (HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT > NUM_USB_CHAN_OUT) || (HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT > NUM_USB_CHAN_OUT) \
+    || (HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT > NUM_USB_CHAN_OUT)
+    #error HS_STREAM_FORMAT_OUTPUT_N_CHAN_COUNT must not exceed NUM_USB_CHAN_OUT
+#endif
+
 /* Channel count defines for input streams */
 #ifndef HS_STREAM_FORMAT_INPUT_1_CHAN_COUNT
     #define HS_STREAM_FORMAT_INPUT_1_CHAN_COUNT             NUM_USB_CHAN_IN
@@ -1049,60 +1533,206 @@
 /**
  * @brief Sample audio data-format for input stream Alternate 1.
  *
- * Default: UAC_FORMAT_TYPEI_PCM
+ * Default: UAC_FORMAT_TYPEI_IEEE_FLOAT when Alternate 1 is float else UAC_FORMAT_TYPEI_PCM
  */
 #ifndef STREAM_FORMAT_INPUT_1_DATAFORMAT
-    #define STREAM_FORMAT_INPUT_1_DATAFORMAT               UAC_FORMAT_TYPEI_PCM
+    #if (XUA_FLOAT_IN_FORMAT_NUM == 1)
+        #define STREAM_FORMAT_INPUT_1_DATAFORMAT           UAC_FORMAT_TYPEI_IEEE_FLOAT
+    #else
+        #define STREAM_FORMAT_INPUT_1_DATAFORMAT           UAC_FORMAT_TYPEI_PCM
+    #endif
 #endif
 
 #ifndef STREAM_FORMAT_INPUT_2_DATAFORMAT
-    #define STREAM_FORMAT_INPUT_2_DATAFORMAT               UAC_FORMAT_TYPEI_PCM
+    #if (XUA_FLOAT_IN_FORMAT_NUM == 2)
+        #define STREAM_FORMAT_INPUT_2_DATAFORMAT           UAC_FORMAT_TYPEI_IEEE_FLOAT
+    #else
+        #define STREAM_FORMAT_INPUT_2_DATAFORMAT           UAC_FORMAT_TYPEI_PCM
+    #endif
 #endif
 
 #ifndef STREAM_FORMAT_INPUT_3_DATAFORMAT
-    #define STREAM_FORMAT_INPUT_3_DATAFORMAT               UAC_FORMAT_TYPEI_PCM
+    #if (XUA_FLOAT_IN_FORMAT_NUM == 3)
+        #define STREAM_FORMAT_INPUT_3_DATAFORMAT           UAC_FORMAT_TYPEI_IEEE_FLOAT
+    #else
+        #define STREAM_FORMAT_INPUT_3_DATAFORMAT           UAC_FORMAT_TYPEI_PCM
+    #endif
 #endif
 
 
 /****** END INPUT STREAMS FORMAT *****/
 
+/**
+ * @brief Enable an auxiliary input stream. This is a second, independent, Audio Class 2.0 streaming
+ *        interface and isochronous IN endpoint carrying XUA_AUX_IN_NUM_CHAN of the input channels
+ *        (for example a stereo monitor or chat stream alongside the main input stream). It shares the
+ *        clock of the main streams and is always 24 bit samples in 4 byte subslots. The host may open
+ *        either stream, or both. Requires Audio Class 2.0 (without AUDIO_CLASS_FALLBACK).
+ *
+ * Default: 0 (disabled)
+ */
+#ifndef XUA_AUX_IN_EN
+    #define XUA_AUX_IN_EN                                   (0)
+#endif
 
 /**
- * @brief Enable/disable output volume control including all processing and descriptor support
+ * @brief Number of channels in the auxiliary input stream (XUA_AUX_IN_EN)
  *
- * Default: 1 (Enabled)
+ * Default: 2
  */
-#ifndef OUTPUT_VOLUME_CONTROL
-#define OUTPUT_VOLUME_CONTROL       (1)
+#ifndef XUA_AUX_IN_NUM_CHAN
+    #define XUA_AUX_IN_NUM_CHAN                             (2)
 #endif
 
 /**
- * @brief Enable/disable input volume control including all processing and descriptor support
+ * @brief Index of the first input channel carried by the auxiliary input stream (XUA_AUX_IN_EN)
  *
- * Default: 1 (Enabled)
+ * Default: 0
  */
-#ifndef INPUT_VOLUME_CONTROL
-#define INPUT_VOLUME_CONTROL        (1)
+#ifndef XUA_AUX_IN_CHAN_INDEX
+    #define XUA_AUX_IN_CHAN_INDEX                           (0)
 #endif
 
-/* Power */
+#if (XUA_AUX_IN_EN)
+    #if (AUDIO_CLASS != 2) || (AUDIO_CLASS_FALLBACK)
+        #error XUA_AUX_IN_EN requires AUDIO_CLASS 2 without AUDIO_CLASS_FALLBACK
+    #endif
+    #if (XUA_AUX_IN_NUM_CHAN < 1)
+        #error XUA_AUX_IN_NUM_CHAN must be at least 1
+    #endif
+    #if ((XUA_AUX_IN_CHAN_INDEX + XUA_AUX_IN_NUM_CHAN) > NUM_USB_CHAN_IN)
+        #error XUA_AUX_IN_CHAN_INDEX + XUA_AUX_IN_NUM_CHAN exceeds NUM_USB_CHAN_IN
+    #endif
+#endif
 
-#define XUA_POWERMODE_SELF          (0)
-#define XUA_POWERMODE_BUS           (1)
 /**
- * @brief Report as self or bus powered device. This affects descriptors
- * and XUD usage and is important for USB compliance
+ * @brief Number of loopback input channels. The last XUA_LOOPBACK_CHANS input channels carry a copy of
+ *        the output channels from XUA_LOOPBACK_OUT_INDEX, as sent to the audio hardware (after output
+ *        volume), rather than the samples from the audio hardware or mixer. This allows host capture of
+ *        playback without any hardware loopback. The copy is made in the decouple thread and costs no
+ *        mixer or routing work.
  *
- * Default: XUA_POWERMODE_BUS
+ * Default: 0 (disabled)
  */
-#ifndef XUA_POWERMODE
-#define XUA_POWERMODE               XUA_POWERMODE_BUS
+#ifndef XUA_LOOPBACK_CHANS
+    #define XUA_LOOPBACK_CHANS                              (0)
 #endif
 
 /**
- * @brief Power drawn from the host (in mA x 2)
+ * @brief Index of the first output channel copied to the loopback input channels (XUA_LOOPBACK_CHANS)
  *
- * Default: 0 when self-powered, else 250 (500mA)
+ * Default: 0
+ */
+#ifndef XUA_LOOPBACK_OUT_INDEX
+    #define XUA_LOOPBACK_OUT_INDEX                          (0)
+#endif
+
+#if (XUA_LOOPBACK_CHANS > 0)
+    #if (XUA_LOOPBACK_CHANS > NUM_USB_CHAN_IN)
+        #error XUA_LOOPBACK_CHANS exceeds NUM_USB_CHAN_IN
+    #endif
+    #if ((XUA_LOOPBACK_OUT_INDEX + XUA_LOOPBACK_CHANS) > NUM_USB_CHAN_OUT)
+        #error XUA_LOOPBACK_OUT_INDEX + XUA_LOOPBACK_CHANS exceeds NUM_USB_CHAN_OUT
+    #endif
+#endif
+
+/**
+ * @brief Enable runtime channel profiles. In the reduced profile (XUA_CHAN_PROFILE_REDUCED) the high-speed
+ *        Audio Class 2.0 descriptors advertise at most XUA_CHAN_PROFILE_CHAN_OUT/IN channels in every stream
+ *        format, for example a 2 channel low latency mode on a 16 channel build, and the decouple thread
+ *        streams that many channels. The profile is selected by XUA_Endpoint0_setChanProfile() or vendor
+ *        request, after which the device reboots and re-enumerates with the new descriptors. The profile is
+ *        kept over the reboot but not over a power cycle, the device then starting in the full profile.
+ *        Requires Audio Class 2.0.
+ *
+ * Default: 0 (disabled)
+ */
+#ifndef XUA_CHAN_PROFILE_EN
+    #define XUA_CHAN_PROFILE_EN                             (0)
+#endif
+
+/**
+ * @brief Number of output channels in the reduced channel profile (XUA_CHAN_PROFILE_EN)
+ *
+ * Default: 2
+ */
+#ifndef XUA_CHAN_PROFILE_CHAN_OUT
+    #define XUA_CHAN_PROFILE_CHAN_OUT                       (2)
+#endif
+
+/**
+ * @brief Number of input channels in the reduced channel profile (XUA_CHAN_PROFILE_EN)
+ *
+ * Default: 2
+ */
+#ifndef XUA_CHAN_PROFILE_CHAN_IN
+    #define XUA_CHAN_PROFILE_CHAN_IN                        (2)
+#endif
+
+/**
+ * @brief Delay between acknowledging a channel profile change and the reboot, in milliseconds
+ *        (XUA_CHAN_PROFILE_EN)
+ *
+ * Default: 50
+ */
+#ifndef XUA_CHAN_PROFILE_REBOOT_DELAY_MS
+    #define XUA_CHAN_PROFILE_REBOOT_DELAY_MS                (50)
+#endif
+
+/* Channel profiles, see XUA_Endpoint0_setChanProfile() */
+#define XUA_CHAN_PROFILE_FULL                               (0)
+#define XUA_CHAN_PROFILE_REDUCED                            (1)
+#define XUA_CHAN_PROFILE_COUNT                              (2)
+
+#if (XUA_CHAN_PROFILE_EN)
+    #if (AUDIO_CLASS != 2)
+        #error XUA_CHAN_PROFILE_EN requires AUDIO_CLASS 2
+    #endif
+    #if (XUA_CHAN_PROFILE_CHAN_OUT > NUM_USB_CHAN_OUT) || (XUA_CHAN_PROFILE_CHAN_IN > NUM_USB_CHAN_IN)
+        #error XUA_CHAN_PROFILE_CHAN_OUT/IN exceed NUM_USB_CHAN_OUT/IN
+    #endif
+    #if ((NUM_USB_CHAN_OUT > 0) && (XUA_CHAN_PROFILE_CHAN_OUT < 1)) || ((NUM_USB_CHAN_IN > 0) && (XUA_CHAN_PROFILE_CHAN_IN < 1))
+        #error XUA_CHAN_PROFILE_CHAN_OUT/IN must be at least 1
+    #endif
+#endif
+
+
+/**
+ * @brief Enable/disable output volume control including all processing and descriptor support
+ *
+ * Default: 1 (Enabled)
+ */
+#ifndef OUTPUT_VOLUME_CONTROL
+#define OUTPUT_VOLUME_CONTROL       (1)
+#endif
+
+/**
+ * @brief Enable/disable input volume control including all processing and descriptor support
+ *
+ * Default: 1 (Enabled)
+ */
+#ifndef INPUT_VOLUME_CONTROL
+#define INPUT_VOLUME_CONTROL        (1)
+#endif
+
+/* Power */
+
+#define XUA_POWERMODE_SELF          (0)
+#define XUA_POWERMODE_BUS           (1)
+/**
+ * @brief Report as self or bus powered device. This affects descriptors
+ * and XUD usage and is important for USB compliance
+ *
+ * Default: XUA_POWERMODE_BUS
+ */
+#ifndef XUA_POWERMODE
+#define XUA_POWERMODE               XUA_POWERMODE_BUS
+#endif
+
+/**
+ * @brief Power drawn from the host (in mA x 2)
+ *
+ * Default: 0 when self-powered, else 250 (500mA)
  */
 #if (XUA_POWERMODE == XUA_POWERMODE_SELF)
     /* Default to taking no power from the bus in self-powered mode */
@@ -1116,148 +1746,1328 @@
     #endif
 #endif
 
-/* Mixer defines */
+/* Mixer defines */
+
+/**
+ * @brief Enable "mixer" core
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef MIXER
+#define MIXER              (0)
+#endif
+
+/**
+ * @brief Number of seperate mixes to perform
+ *
+ * Default: 8 if MIXER enabled, else 0
+ */
+#if (MIXER)
+    #ifndef MAX_MIX_COUNT
+        #define MAX_MIX_COUNT          (8)
+    #endif
+#else
+    #ifndef MAX_MIX_COUNT
+        #define MAX_MIX_COUNT          (0)
+    #endif
+#endif
+
+/**
+ * @brief Number of channels input into the mixer.
+ *
+ * Note, total number of mixer nodes is MIX_INPUTS * MAX_MIX_COUNT
+ *
+ * Default: 18
+ */
+#ifndef MIX_INPUTS
+    #define MIX_INPUTS                 (18)
+#endif
+
+/**
+ * @brief Mix using a per-mix list of active (source, weight) pairs rather than all MIX_INPUTS.
+ *
+ * Mixer inputs with a zero weight, or routed to the "off" source, are skipped such that the
+ * cost of each mix scales with the number of sources the host has actually routed into it.
+ * Note, the worst case (all inputs active) is slightly more expensive than the default mixer.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_SPARSE
+    #define XUA_MIXER_SPARSE           (0)
+#endif
+
+/**
+ * @brief Perform all mixes in a single mixer thread using the vector unit.
+ *        Only available on xcore.ai devices.
+ *
+ * All MAX_MIX_COUNT mixes are computed at every sample rate, rather than a reduced number of
+ * mixes above 96kHz.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_VPU
+    #define XUA_MIXER_VPU              (0)
+#endif
+
+#if (XUA_MIXER_VPU) && !defined(__XS3A__)
+    #error XUA_MIXER_VPU is only supported on xcore.ai devices
+#endif
+
+#if (XUA_MIXER_VPU) && (XUA_MIXER_SPARSE)
+    #error XUA_MIXER_VPU and XUA_MIXER_SPARSE cannot both be enabled
+#endif
+
+/**
+ * @brief Mix with single precision floating point weights and accumulation, using the scalar FPU.
+ *        Only available on xcore.ai devices.
+ *
+ * Mixes are accumulated as floats so have no fixed point headroom limit, only the mix outputs are saturated.
+ * Weights are converted to floats as they are loaded. As with XUA_MIXER_SPARSE only inputs with a non-zero weight
+ * are mixed.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_FLOAT
+    #define XUA_MIXER_FLOAT            (0)
+#endif
+
+#if (XUA_MIXER_FLOAT) && !defined(__XS3A__)
+    #error XUA_MIXER_FLOAT is only supported on xcore.ai devices
+#endif
+
+#if (XUA_MIXER_FLOAT) && ((XUA_MIXER_VPU) || (XUA_MIXER_SPARSE))
+    #error XUA_MIXER_FLOAT cannot be enabled with XUA_MIXER_VPU or XUA_MIXER_SPARSE
+#endif
+
+/**
+ * @brief Mix from a per-mix row of weights for every mixer source, loading two samples and two weights with each
+ *        pair of double word loads.
+ *
+ * The weights of mixer inputs that share a source are summed into the one entry of the row for that source. The cost
+ * of a mix is then set by the number of mixer sources rather than MIX_INPUTS, with half the loads per multiply
+ * accumulate of the default mixer, suiting devices that mix many inputs into each mix.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_LDD
+    #define XUA_MIXER_LDD              (0)
+#endif
+
+#if (XUA_MIXER_LDD) && ((XUA_MIXER_VPU) || (XUA_MIXER_SPARSE) || (XUA_MIXER_FLOAT))
+    #error XUA_MIXER_LDD cannot be enabled with XUA_MIXER_VPU, XUA_MIXER_SPARSE or XUA_MIXER_FLOAT
+#endif
+
+/**
+ * @brief Perform all mixes in a single mixer thread, freeing the second mixer thread for use by the application.
+ *
+ * The single thread performs twice the mixes of either thread of the default two thread mixer, so is only suitable
+ * where this fits in the sample period at the rates in use. This should be confirmed with XUA_PROFILE, the
+ * XUA_PROFILE_MIXER1 loop time must stay within the sample period. As with two threads only the first two mixes are
+ * performed above 96kHz. Not relevant with XUA_MIXER_VPU, which always uses a single thread.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_SINGLE_THREAD
+    #define XUA_MIXER_SINGLE_THREAD    (0)
+#endif
+
+/**
+ * @brief Highest sample rate at which the mixer performs any mixes. Above this rate the mixer threads only
+ *        transfer samples between the host and the audio hub (the mix outputs are silent), leaving the sample
+ *        period for the transfers of 384kHz and 768kHz streams.
+ *
+ * Default: 192000
+ */
+#ifndef XUA_MIXER_MAX_FREQ
+    #define XUA_MIXER_MAX_FREQ         (192000)
+#endif
+
+/**
+ * @brief Number of biquad sections in the EQ applied to each output channel by the mixer, after the mix and
+ *        routing and before any output volume (OUT_VOLUME_IN_MIXER). Coefficients are loaded per output with the
+ *        XUA_VENDOR_REQ_MIXER_EQ vendor request and default to pass through. The EQ adds one sample of latency
+ *        and, like the mixes, is not performed above XUA_MIXER_MAX_FREQ. Requires MIXER.
+ *
+ * Each section costs five multiply-accumulates per output channel per sample in the mixer thread connected
+ * to the audio hub, confirm this fits in the sample period with XUA_PROFILE.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_EQ_BIQUADS
+    #define XUA_MIXER_EQ_BIQUADS       (0)
+#endif
+
+/**
+ * @brief Maximum number of mixer weights passed to the mixer in each transaction when loading a
+ *        whole mix matrix (see XUA_VENDOR_REQ_MIX_MATRIX). Bounds the time the mixer thread spends
+ *        servicing a single control command.
+ *
+ * Default: 8
+ */
+#ifndef XUA_MIXER_BANK_CHUNK
+    #define XUA_MIXER_BANK_CHUNK       (8)
+#endif
+
+#if (XUA_MIXER_BANK_CHUNK < 1)
+    #error XUA_MIXER_BANK_CHUNK must be at least 1
+#endif
+
+/**
+ * @brief Number of samples over which the mixer ramps a mix weight, or a volume multiplier applied
+ *        in the mixer, to a new value. Avoids an audible step when a control is changed.
+ *
+ * Default: 0 (Disabled, new values are applied immediately)
+ */
+#ifndef XUA_MIXER_RAMP_SAMPLES
+    #define XUA_MIXER_RAMP_SAMPLES     (0)
+#endif
+
+/**
+ * @brief Maximum number of gain ramps that may be in progress at once. Changes made whilst all
+ *        ramps are in use are applied immediately. Requires XUA_MIXER_RAMP_SAMPLES.
+ *
+ * Default: 8
+ */
+#ifndef XUA_MIXER_RAMP_SLOTS
+    #define XUA_MIXER_RAMP_SLOTS       (8)
+#endif
+
+#if (XUA_MIXER_RAMP_SAMPLES > 0) && ((XUA_MIXER_SPARSE) || (XUA_MIXER_FLOAT))
+    #error XUA_MIXER_RAMP_SAMPLES is not supported with XUA_MIXER_SPARSE or XUA_MIXER_FLOAT
+#endif
+
+/**
+ * @brief Count changes to the mixer state held by Endpoint 0 (mixer weights, mixer input selection and
+ *        channel maps). The host reads all counters with a single mixer memory request (offset 4), such
+ *        that control software caching the mixer state resyncs only the parts that changed. Firmware that
+ *        modifies this state itself should call XUA_MIXER_CHANGED() as well.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_CHANGE_COUNTERS
+    #define XUA_MIXER_CHANGE_COUNTERS  (0)
+#endif
+
+/**
+ * @brief Number of mixer scenes that may be saved to the flash data partition, one per data sector.
+ *        A scene holds the mixer weights, mixer input selection, channel maps and volume and mute
+ *        state held by Endpoint 0. Scenes are saved and recalled with the XUA_VENDOR_REQ_MIXER_SCENE
+ *        vendor request. Requires MIXER and XUA_DFU_EN.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MIXER_SCENES
+    #define XUA_MIXER_SCENES           (0)
+#endif
+
+/**
+ * @brief Scene recalled as the device starts, if one has been saved in this slot. -1 for none.
+ *
+ * Default: 0
+ */
+#ifndef XUA_MIXER_SCENE_BOOT
+    #define XUA_MIXER_SCENE_BOOT       (0)
+#endif
+
+#if (XUA_MIXER_SCENES) && ((MIXER == 0) || (MAX_MIX_COUNT == 0) || (XUA_DFU_EN == 0))
+    #error XUA_MIXER_SCENES requires MIXER with MAX_MIX_COUNT > 0 and XUA_DFU_EN
+#endif
+
+#if (XUA_MIXER_SCENES > 32)
+    #error XUA_MIXER_SCENES must be at most 32
+#endif
+
+/**
+ * @brief Number of level meter passes a new peak level is held for before it decays. With
+ *        LEVEL_METER_HOST the mixer updates the meter of one channel (USB out, USB in then mix
+ *        outputs) per sample, so each channel is updated once every
+ *        (NUM_USB_CHAN_OUT + NUM_USB_CHAN_IN + MAX_MIX_COUNT) samples.
+ *
+ * Default: 32
+ */
+#ifndef XUA_LEVEL_METER_HOLD
+    #define XUA_LEVEL_METER_HOLD       (32)
+#endif
+
+/**
+ * @brief Peak level meter decay per pass, once the hold has expired, as a right shift of the level.
+ *
+ * Default: 3 (i.e. the level decays by 1/8th per pass)
+ */
+#ifndef XUA_LEVEL_METER_DECAY_SHIFT
+    #define XUA_LEVEL_METER_DECAY_SHIFT (3)
+#endif
+
+/**
+ * @brief Time constant of the RMS level meter, as a right shift applied to the update of the mean
+ *        square each pass.
+ *
+ * Default: 5
+ */
+#ifndef XUA_LEVEL_METER_RMS_SHIFT
+    #define XUA_LEVEL_METER_RMS_SHIFT  (5)
+#endif
+
+/**
+ * @brief Maximum number of channel levels returned by the mixer in response to each GET_LEVELS
+ *        command.
+ *
+ * Default: 8
+ */
+#ifndef XUA_LEVEL_METER_CHUNK
+    #define XUA_LEVEL_METER_CHUNK      (8)
+#endif
+
+/**
+ * @brief Enable the level meter endpoint. This is an interrupt IN endpoint, on a vendor specific
+ *        interface, that pushes a frame holding the peak and RMS levels of all meter channels to
+ *        the host at XUA_LEVEL_METER_EP_RATE. Host meter displays can then avoid polling the levels
+ *        over endpoint 0. Requires LEVEL_METER_HOST, Audio Class 2.0 and the mixer to run on
+ *        XUD_TILE (AUDIO_IO_TILE == XUD_TILE).
+ *
+ * Default: 0 (disabled)
+ */
+#ifndef XUA_LEVEL_METER_EP_EN
+    #define XUA_LEVEL_METER_EP_EN      (0)
+#endif
+
+/**
+ * @brief Rate, in frames per second, at which the level meter endpoint offers level frames to the
+ *        host. Frames are only sent when the host polls the endpoint.
+ *
+ * Default: 30
+ */
+#ifndef XUA_LEVEL_METER_EP_RATE
+    #define XUA_LEVEL_METER_EP_RATE    (30)
+#endif
+
+#if (XUA_LEVEL_METER_EP_EN)
+    #if !defined(LEVEL_METER_HOST) || !(MIXER)
+        #error XUA_LEVEL_METER_EP_EN requires MIXER and LEVEL_METER_HOST
+    #endif
+    #if (AUDIO_CLASS != 2)
+        #error XUA_LEVEL_METER_EP_EN requires AUDIO_CLASS 2
+    #endif
+    #if (AUDIO_IO_TILE != XUD_TILE)
+        #error XUA_LEVEL_METER_EP_EN requires AUDIO_IO_TILE == XUD_TILE
+    #endif
+    #if (XUA_LEVEL_METER_EP_RATE < 1) || (XUA_LEVEL_METER_EP_RATE > 1000)
+        #error XUA_LEVEL_METER_EP_RATE must be in the range 1 to 1000
+    #endif
+#endif
+
+/**
+ * @brief Enable the Audio Class 2.0 AudioControl interrupt endpoint. Status interrupts tell the host of
+ *        changes made on the device, so host control panels can re-read a control when it changes rather
+ *        than polling endpoint 0. An interrupt is sent on a change of clock validity and for each call to
+ *        XUA_Endpoint0_notifyChange(), which the application makes after changing a volume, mute, mixer
+ *        or other control itself, for example from a hardware knob.
+ *
+ * Default: Enabled if XUA_SPDIF_RX_EN, XUA_ADAT_RX_EN or XUA_WORDCLOCK_RX_EN, otherwise disabled
+ */
+#ifndef XUA_STATUS_INT_EN
+    #define XUA_STATUS_INT_EN          (XUA_CLOCKGEN_EN)
+#endif
+
+#if (XUA_CLOCKGEN_EN) && !(XUA_STATUS_INT_EN)
+    #error XUA_STATUS_INT_EN is required by XUA_SPDIF_RX_EN, XUA_ADAT_RX_EN and XUA_WORDCLOCK_RX_EN for clock validity interrupts
+#endif
+
+/**
+ * @brief Exchange samples between the audiohub and the mixer, or decouple when MIXER is disabled, through
+ *        shared memory.
+ *
+ * Rather than passing one channel word per channel every sample period, the audiohub passes the
+ * mixer (or decouple) pointers to its sample buffers which are read and written directly. The
+ * handshake per sample period is then fixed regardless of channel count. The mixer and audiohub
+ * always run on the same tile. Without the mixer samples are only shared with decouple when
+ * XUD_TILE is AUDIO_IO_TILE and native DSD block transfer (XUA_DSD_BLOCK_FRAMES) is not in use,
+ * otherwise samples are passed over the channel as before.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_SHARED_SAMPLE_TRANSFER
+    #define XUA_SHARED_SAMPLE_TRANSFER (0)
+#endif
+
+/**
+ * @brief Number of frames of native DSD passed from decouple to the audiohub in each exchange.
+ *
+ * In native DSD mode decouple sends the DSD channels (only) of XUA_DSD_BLOCK_FRAMES frames in one
+ * exchange rather than every channel of one frame, and the audiohub outputs the block to the DSD
+ * ports. Output volume is not applied and UserBufferManagement() is not called for native DSD frames.
+ * DoP and PCM streams are unaffected. Only relevant when MIXER is disabled, i.e. the audiohub is
+ * connected directly to decouple.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DSD_BLOCK_FRAMES
+    #define XUA_DSD_BLOCK_FRAMES (0)
+#endif
+
+#if (XUA_DSD_BLOCK_FRAMES > 0) && (DSD_CHANS_DAC > 0) && (NUM_USB_CHAN_OUT > 0) && (!MIXER)
+    #define XUA_DSD_BLOCK_TRANSFER (1)
+#else
+    #define XUA_DSD_BLOCK_TRANSFER (0)
+#endif
+
+/* Samples shared between the audiohub and decouple (XUA_SHARED_SAMPLE_TRANSFER without the mixer) */
+#if (XUA_SHARED_SAMPLE_TRANSFER) && (!MIXER) && (XUD_TILE == AUDIO_IO_TILE) && (!XUA_DSD_BLOCK_TRANSFER)
+    #define XUA_SHARED_SAMPLE_TRANSFER_DECOUPLE (1)
+#else
+    #define XUA_SHARED_SAMPLE_TRANSFER_DECOUPLE (0)
+#endif
+
+/**
+ * @brief Pack the samples exchanged between decouple and the mixer (or audiohub when MIXER is disabled)
+ *        as 24 bit samples, four to every three channel words, when XUD_TILE and AUDIO_IO_TILE differ.
+ *
+ * This reduces the intertile link traffic per frame by a quarter, for designs whose channel count is
+ * limited by the link. The lower 8 bits of every sample are lost, so 32 bit stream formats and DSD are not
+ * supported.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_INTERTILE_PACKED_24
+    #define XUA_INTERTILE_PACKED_24 (0)
+#endif
+
+/**
+ * @brief Run the sample pipeline at 16 bit. Samples are exchanged between decouple, the mixer and the
+ *        audiohub two to every channel word, and the decouple FIFOs are sized for 2 byte subslots.
+ *
+ * This halves the decouple buffer memory and the channel words per frame, for designs that only stream
+ * 16 bit (e.g. voice and conferencing). Every stream format must use 2 byte subslots. Samples reach the
+ * audiohub, and are taken from it, with only their upper 16 bits. DSD is not supported.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_PIPELINE_PACKED_16
+    #define XUA_PIPELINE_PACKED_16 (0)
+#endif
+
+/* Frames exchanged with decouple over a channel are packed (XUA_INTERTILE_PACKED_24, XUA_PIPELINE_PACKED_16) */
+#if ((XUA_INTERTILE_PACKED_24) && (XUD_TILE != AUDIO_IO_TILE)) || ((XUA_PIPELINE_PACKED_16) && !(XUA_SHARED_SAMPLE_TRANSFER_DECOUPLE))
+    #define XUA_FRAME_PACK (1)
+#else
+    #define XUA_FRAME_PACK (0)
+#endif
+
+/**
+ * @brief Number of audio-frames batched into each call to UserBufferManagementBlock().
+ *
+ * When non-zero UserBufferManagementBlock() is called with blocks of this many channel interleaved
+ * frames in place of the per-frame UserBufferManagement(). The audiohub double-buffers the blocks and
+ * the callback runs on an additional thread on the audio tile, adding a latency of two blocks.
+ *
+ * Default: 0 (Disabled, UserBufferManagement() is called every frame)
+ */
+#ifndef XUA_USER_BUFFER_BLOCK_FRAMES
+    #define XUA_USER_BUFFER_BLOCK_FRAMES (0)
+#endif
+
+/**
+ * @brief Run UserBufferManagement() on a dedicated worker thread.
+ *
+ * Frames are passed to the worker thread through a lock-free ring and returned to the audiohub
+ * a fixed XUA_USER_BUFFER_WORKER_LATENCY frames later, so processing time in UserBufferManagement()
+ * no longer counts against the I2S timing budget. Frames the worker does not complete in time are
+ * replaced with silence. UserBufferManagementInit() is called on the worker thread. The worker
+ * requires an additional thread on the audio tile. Cannot be used with XUA_USER_BUFFER_BLOCK_FRAMES.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_USER_BUFFER_WORKER
+    #define XUA_USER_BUFFER_WORKER (0)
+#endif
+
+#if (XUA_USER_BUFFER_WORKER) && (XUA_USER_BUFFER_BLOCK_FRAMES > 0)
+    #error XUA_USER_BUFFER_WORKER and XUA_USER_BUFFER_BLOCK_FRAMES cannot be used together
+#endif
+
+/**
+ * @brief Latency, in frames, added by the XUA_USER_BUFFER_WORKER thread. This is also the time the
+ *        worker has to process each frame.
+ *
+ * Default: 16
+ */
+#ifndef XUA_USER_BUFFER_WORKER_LATENCY
+    #define XUA_USER_BUFFER_WORKER_LATENCY (16)
+#endif
+
+#if (XUA_USER_BUFFER_WORKER_LATENCY < 1)
+    #error XUA_USER_BUFFER_WORKER_LATENCY must be at least 1
+#endif
+
+/**
+ * @brief Number of DSP fan-out worker threads.
+ *
+ * When non-zero the USB channels are split into this many groups and UserBufferManagementGroup() is
+ * called for each group on its own worker thread, in place of UserBufferManagement(). Samples are
+ * exchanged with the workers over streaming channels, so workers may be placed on either tile (see
+ * XUA_DSP_FANOUT_WORKERS_REMOTE). Processed samples are delayed by exactly one frame. Cannot be used
+ * with XUA_USER_BUFFER_BLOCK_FRAMES or XUA_USER_BUFFER_WORKER.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_DSP_FANOUT_WORKERS
+    #define XUA_DSP_FANOUT_WORKERS (0)
+#endif
+
+#if (XUA_DSP_FANOUT_WORKERS > 0) && ((XUA_USER_BUFFER_BLOCK_FRAMES > 0) || (XUA_USER_BUFFER_WORKER))
+    #error XUA_DSP_FANOUT_WORKERS cannot be used with XUA_USER_BUFFER_BLOCK_FRAMES or XUA_USER_BUFFER_WORKER
+#endif
+
+/**
+ * @brief Tile that remote DSP fan-out workers are placed on.
+ *
+ * Default: XUD_TILE
+ */
+#ifndef XUA_DSP_FANOUT_REMOTE_TILE
+    #define XUA_DSP_FANOUT_REMOTE_TILE (XUD_TILE)
+#endif
+
+/**
+ * @brief Number of the DSP fan-out workers placed on XUA_DSP_FANOUT_REMOTE_TILE, the remainder are
+ *        placed on AUDIO_IO_TILE. Remote workers take the highest numbered channel groups.
+ *
+ * Default: XUA_DSP_FANOUT_WORKERS / 2
+ */
+#ifndef XUA_DSP_FANOUT_WORKERS_REMOTE
+    #define XUA_DSP_FANOUT_WORKERS_REMOTE (XUA_DSP_FANOUT_WORKERS / 2)
+#endif
+
+#if (XUA_DSP_FANOUT_WORKERS_REMOTE > XUA_DSP_FANOUT_WORKERS)
+    #error XUA_DSP_FANOUT_WORKERS_REMOTE cannot be greater than XUA_DSP_FANOUT_WORKERS
+#endif
+
+/**
+ * @brief Number of output (USB to audio) channels in each DSP fan-out group.
+ *
+ * Default: NUM_USB_CHAN_OUT divided between XUA_DSP_FANOUT_WORKERS, rounded up
+ */
+#if (XUA_DSP_FANOUT_WORKERS > 0)
+#ifndef XUA_DSP_FANOUT_CHANS_OUT
+    #define XUA_DSP_FANOUT_CHANS_OUT ((NUM_USB_CHAN_OUT + XUA_DSP_FANOUT_WORKERS - 1) / XUA_DSP_FANOUT_WORKERS)
+#endif
+
+/**
+ * @brief Number of input (audio to USB) channels in each DSP fan-out group.
+ *
+ * Default: NUM_USB_CHAN_IN divided between XUA_DSP_FANOUT_WORKERS, rounded up
+ */
+#ifndef XUA_DSP_FANOUT_CHANS_IN
+    #define XUA_DSP_FANOUT_CHANS_IN ((NUM_USB_CHAN_IN + XUA_DSP_FANOUT_WORKERS - 1) / XUA_DSP_FANOUT_WORKERS)
+#endif
+#endif
+
+/* Volume processing defines */
+
+/**
+ * @brief The minimum volume setting above -inf. This is a signed 8.8 fixed point
+ *        number that must be strictly greater than -128 (0x8000)
+ *
+ * Default: 0x8100 (-127db)
+ */
+#ifndef MIN_VOLUME
+#define MIN_VOLUME                     (0x8100)
+#endif
+
+
+/**
+ * @brief The maximum volume setting. This is a signed 8.8 fixed point number.
+ *
+ * Default: 0x0000 (0db)
+ */
+#ifndef MAX_VOLUME
+#define MAX_VOLUME                     (0x0000)
+#endif
+
+/**
+ * @brief The resolution of the volume control in db as a 8.8 fixed point number
+ *
+ * Default: 0x100 (1db)
+ */
+#ifndef VOLUME_RES
+#define VOLUME_RES                     (0x100)
+#endif
+
+/**
+ * @brief The minimum volume setting for the mixer unit above -inf.
+ * This is a signed 8.8 fixed point number that must be strictly greater than -128 (0x8000)
+ *
+ * Default: 0x8100 (-127db)
+ */
+#ifndef MIN_MIXER_VOLUME
+#define MIN_MIXER_VOLUME             (0x8100)
+#endif
+
+/**
+ * @brief The maximum volume setting for the mixer. This is a signed 8.8 fixed point number.
+ *
+ * Default: 0x0000 (0db)
+ */
+#ifndef MAX_MIXER_VOLUME
+#define MAX_MIXER_VOLUME            (0x0000)
+#endif
+
+/**
+ * @brief The resolution of the volume control in db as a 8.8 fixed point number
+ *
+* Default: 0x100 (1db)
+*/
+#ifndef VOLUME_RES_MIXER
+#define VOLUME_RES_MIXER            (0x100)
+#endif
+
+/* Handle out volume control in the mixer - enabled by default */
+#ifndef OUT_VOLUME_IN_MIXER
+#if MIXER
+    #define OUT_VOLUME_IN_MIXER     (1)
+#else
+    #define OUT_VOLUME_IN_MIXER     (0)
+#endif
+#endif
+
+/* Apply out volume controls after the mix. Only relevant when OUT_VOLUME_IN_MIXER enabled. Enabled by default */
+#ifndef OUT_VOLUME_AFTER_MIX
+#define OUT_VOLUME_AFTER_MIX        (1)
+#endif
+
+/* Handle in volume control in the mixer - disabled by default */
+#ifndef IN_VOLUME_IN_MIXER
+#define IN_VOLUME_IN_MIXER          (0)
+#endif
+
+/* Apply in volume controls after the mix. Only relevant when IN_VOLUMNE_IN MIXER enabled. Enabled by default */
+#ifndef IN_VOLUME_AFTER_MIX
+#define IN_VOLUME_AFTER_MIX         (1)
+#endif
+
+/* Always enable explicit feedback EP, even when input stream is present */
+#ifndef UAC_FORCE_FEEDBACK_EP
+#define UAC_FORCE_FEEDBACK_EP       (1)
+#endif
+
+#if (defined(UAC_FORCE_FEEDBACK_EP) && UAC_FORCE_FEEDBACK_EP == 0)
+#undef UAC_FORCE_FEEDBACK_EP
+#endif
+
+/* Synchronisation defines */
+#define XUA_SYNCMODE_ASYNC (1) // USB_ENDPOINT_SYNCTYPE_ASYNC
+#define XUA_SYNCMODE_ADAPT (2) // USB_ENDPOINT_SYNCTYPE_ADAPT
+#define XUA_SYNCMODE_SYNC  (3) // USB_ENDPOINT_SYNCTYPE_SYNC
+
+#ifndef XUA_SYNCMODE
+#define XUA_SYNCMODE XUA_SYNCMODE_ASYNC
+#endif
+
+#if (XUA_SYNCMODE == XUA_SYNCMODE_SYNC)
+    #if (XUA_SPDIF_RX_EN|| ADAT_RX)
+        #error "Digital input streams not supported in Sync mode"
+    #endif
+#endif
+
+#if (XUA_SYNCMODE == XUA_SYNCMODE_ADAPT)
+    #if (XUA_SPDIF_RX_EN|| ADAT_RX)
+        #error "Digital input streams not supported in Adaptive mode"
+    #endif
+    #if !(XUA_USE_SW_PLL)
+        #error "Adaptive mode requires XUA_USE_SW_PLL"
+    #endif
+    #if (NUM_USB_CHAN_OUT == 0)
+        #error "Adaptive mode requires an OUT stream, the master clock is steered from the OUT buffer fill level"
+    #endif
+#endif
+
+/* In Sync and Adaptive modes the master clock is recovered from the USB host. In Sync mode it is
+ * locked to SOF, in Adaptive mode it is steered by the OUT stream buffer fill level in decouple */
+#define XUA_USB_CLK_RECOVERY ((XUA_SYNCMODE == XUA_SYNCMODE_SYNC) || (XUA_SYNCMODE == XUA_SYNCMODE_ADAPT))
+
+/**
+ * @brief Number of consecutive clock detection ticks (1.67ms) an S/PDIF or ADAT input must be
+ *        classified as the same, stable, sample rate, after the first, before it is reported
+ *        as a valid clock.
+ *
+ * Default: 2
+ */
+#ifndef XUA_CLOCK_LOCK_CONFIDENCE
+    #define XUA_CLOCK_LOCK_CONFIDENCE (2)
+#endif
+
+/**
+ * @brief Use a higher integral gain in the software PLL (see XUA_USE_SW_PLL) control loop until it
+ *        has locked, after which the normal gains are restored. Reduces the time taken to recover
+ *        the clock after the input or sample rate changes.
+ *
+ * Default: 1 (Enabled)
+ */
+#ifndef XUA_SW_PLL_FAST_LOCK
+    #define XUA_SW_PLL_FAST_LOCK (1)
+#endif
+
+/**
+ * @brief Multiplier applied to the software PLL integral gain whilst acquiring lock. Requires
+ *        XUA_SW_PLL_FAST_LOCK.
+ *
+ * Default: 8
+ */
+#ifndef XUA_SW_PLL_FAST_LOCK_GAIN
+    #define XUA_SW_PLL_FAST_LOCK_GAIN (8)
+#endif
+
+/**
+ * @brief Largest software PLL frequency error, in master clock counts per control loop update,
+ *        considered to be in lock.
+ *
+ * Default: 2
+ */
+#ifndef XUA_SW_PLL_LOCK_THRESHOLD
+    #define XUA_SW_PLL_LOCK_THRESHOLD (2)
+#endif
+
+/**
+ * @brief Number of consecutive software PLL control loop updates (10ms each for digital inputs)
+ *        the error must be within XUA_SW_PLL_LOCK_THRESHOLD before the PLL is reported as locked.
+ *
+ * Default: 3
+ */
+#ifndef XUA_SW_PLL_LOCK_COUNT
+    #define XUA_SW_PLL_LOCK_COUNT (3)
+#endif
+
+/**
+ * @brief Record software PLL telemetry (last error, control value, lock state and time to lock).
+ *        When the PLL runs on XUD_TILE it may be read using the XUA_VENDOR_REQ_SW_PLL vendor request.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_SW_PLL_TELEMETRY
+    #define XUA_SW_PLL_TELEMETRY (0)
+#endif
+
+#if (XUA_SW_PLL_FAST_LOCK) && (XUA_SW_PLL_FAST_LOCK_GAIN < 1)
+    #error "XUA_SW_PLL_FAST_LOCK_GAIN must be at least 1"
+#endif
+
+/**
+ * @brief Switch between clock sources without a step in the master clock. Requires XUA_USE_SW_PLL.
+ *
+ * On a change of the clock selector the S/PDIF and ADAT inputs are faded out, the source switched and the inputs
+ * faded back in. The software PLL is left running and steered towards the new source at a bounded rate (see
+ * XUA_CLOCK_SWITCH_SLEW_ERROR) rather than re-acquiring lock with the fast lock gain. A source running at a sample
+ * rate of the other master clock family cannot be slewed to, the software PLL is then restarted at its nominal
+ * setting for the current master clock.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_CLOCK_SWITCH_SEAMLESS
+    #define XUA_CLOCK_SWITCH_SEAMLESS (0)
+#endif
+
+/**
+ * @brief Length, in samples, of each of the fade out and fade in of the digital inputs around a clock source switch
+ *        (XUA_CLOCK_SWITCH_SEAMLESS). Must be a power of 2.
+ *
+ * Default: 64
+ */
+#ifndef XUA_CLOCK_SWITCH_FADE_SAMPLES
+    #define XUA_CLOCK_SWITCH_FADE_SAMPLES (64)
+#endif
+
+/**
+ * @brief Largest software PLL frequency error, in master clock counts per control loop update, acted on whilst
+ *        slewing to a new clock source (XUA_CLOCK_SWITCH_SEAMLESS). Sets the rate at which the master clock moves
+ *        to the frequency of the new source.
+ *
+ * Default: 4
+ */
+#ifndef XUA_CLOCK_SWITCH_SLEW_ERROR
+    #define XUA_CLOCK_SWITCH_SLEW_ERROR (4)
+#endif
+
+#if (XUA_CLOCK_SWITCH_SEAMLESS) && !(XUA_USE_SW_PLL)
+    #error "XUA_CLOCK_SWITCH_SEAMLESS requires XUA_USE_SW_PLL"
+#endif
+
+#if (XUA_CLOCK_SWITCH_SEAMLESS) && (XUA_CLOCK_SWITCH_FADE_SAMPLES & (XUA_CLOCK_SWITCH_FADE_SAMPLES - 1))
+    #error "XUA_CLOCK_SWITCH_FADE_SAMPLES must be a power of 2"
+#endif
+
+/* Asynchronous feedback filters */
+#define XUA_FEEDBACK_FILTER_NONE           (0)
+#define XUA_FEEDBACK_FILTER_MOVING_AVERAGE (1)
+#define XUA_FEEDBACK_FILTER_IIR            (2)
+
+/**
+ * @brief Filter applied to the asynchronous feedback value calculated at the end of each feedback window.
+ *        One of XUA_FEEDBACK_FILTER_NONE, XUA_FEEDBACK_FILTER_MOVING_AVERAGE or XUA_FEEDBACK_FILTER_IIR.
+ *
+ * Default: XUA_FEEDBACK_FILTER_NONE
+ */
+#ifndef XUA_FEEDBACK_FILTER
+    #define XUA_FEEDBACK_FILTER XUA_FEEDBACK_FILTER_NONE
+#endif
+
+/**
+ * @brief Length of the asynchronous feedback calculation window, log2 SOFs. A shorter window used with
+ *        XUA_FEEDBACK_FILTER_MOVING_AVERAGE updates the feedback value more often for the same amount of
+ *        averaging. Range 3 (8 SOFs) to 7 (128 SOFs).
+ *
+ * Default: 7 (128 SOFs, 16ms at high-speed, 128ms at full-speed)
+ */
+#ifndef XUA_FEEDBACK_WINDOW_LOG2
+    #define XUA_FEEDBACK_WINDOW_LOG2 (7)
+#endif
+
+#if (XUA_FEEDBACK_WINDOW_LOG2 < 3) || (XUA_FEEDBACK_WINDOW_LOG2 > 7)
+    #error "XUA_FEEDBACK_WINDOW_LOG2 must be in the range 3 to 7"
+#endif
+
+/**
+ * @brief Number of feedback windows averaged by XUA_FEEDBACK_FILTER_MOVING_AVERAGE.
+ *
+ * Default: 8
+ */
+#ifndef XUA_FEEDBACK_MA_LEN
+    #define XUA_FEEDBACK_MA_LEN (8)
+#endif
+
+/**
+ * @brief Coefficient of XUA_FEEDBACK_FILTER_IIR as a shift, each new value is weighted 1/(2^shift).
+ *
+ * Default: 2
+ */
+#ifndef XUA_FEEDBACK_IIR_SHIFT
+    #define XUA_FEEDBACK_IIR_SHIFT (2)
+#endif
+
+/**
+ * @brief Enable fast lock of the asynchronous feedback after a sample rate change. The feedback window
+ *        starts at 8 SOFs and doubles after each window until it reaches XUA_FEEDBACK_WINDOW_LOG2. Allows a
+ *        shorter FEEDBACK_STABILITY_DELAY_HS/FS.
+ *
+ * Default: 1 (Enabled)
+ */
+#ifndef XUA_FEEDBACK_FAST_LOCK
+    #define XUA_FEEDBACK_FAST_LOCK (1)
+#endif
+
+/**
+ * @brief Remove the SOF handling latency from the asynchronous feedback measurement. The MCLK port
+ *        timestamp taken on each SOF is paired with the reference timer, which is compared against a
+ *        prediction of the SOF time at minimum latency, corrected every 128 SOFs.
+ *        The MCLK count is corrected by the excess latency, such that it matches the SOF event itself
+ *        rather than the point the buffer thread got round to it.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_FEEDBACK_SOF_DEJITTER
+    #define XUA_FEEDBACK_SOF_DEJITTER (0)
+#endif
+
+/**
+ * @brief Coalesce the asynchronous feedback calculation of each window of SOFs. Each SOF only takes the
+ *        MCLK timestamp and sums the count since the last, the count being scaled and the feedback value
+ *        calculated once at the end of the window, when the next feedback packet is due. The feedback
+ *        values are identical, the buffer thread being freed for its other endpoints (MIDI, HID etc).
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_FEEDBACK_SOF_COALESCE
+    #define XUA_FEEDBACK_SOF_COALESCE (0)
+#endif
+
+/**
+ * @brief Complete the status stage of a sample rate change before the audio core has handshaked the change.
+ *        The handshake and the wait for feedback to stabilise are deferred until Endpoint 0 next needs the
+ *        audio core, i.e. a further rate change, a stream start (SET_INTERFACE) or DFU. Other control requests
+ *        (volume, mute, mixer, HID, vendor) are serviced in the meantime.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_EP0_ASYNC_RATE_CHANGE
+    #define XUA_EP0_ASYNC_RATE_CHANGE (0)
+#endif
+
+/* USB buffering defines */
+
+/**
+ * @brief Size of the OUT and IN FIFOs in XUA_Buffer_Decouple(), in maximum sized packets.
+ *        Minimum is 4.
+ *
+ * Default: 4
+ */
+#ifndef XUA_BUFFER_PACKET_COUNT
+    #define XUA_BUFFER_PACKET_COUNT (4)
+#endif
+
+#if (XUA_BUFFER_PACKET_COUNT < 4)
+    #error XUA_BUFFER_PACKET_COUNT must be at least 4
+#endif
+
+/**
+ * @brief Size of the OUT FIFO in XUA_Buffer_Decouple(), in maximum sized packets. Allows the OUT and IN
+ *        FIFOs, which are held on XUD_TILE, to be sized independently, for example to give spare RAM on
+ *        that tile to a deeper OUT FIFO. Minimum is 4.
+ *
+ * Default: XUA_BUFFER_PACKET_COUNT
+ */
+#ifndef XUA_BUFFER_PACKET_COUNT_OUT
+    #define XUA_BUFFER_PACKET_COUNT_OUT (XUA_BUFFER_PACKET_COUNT)
+#endif
+
+/**
+ * @brief Size of the IN FIFO in XUA_Buffer_Decouple(), in maximum sized packets. Minimum is 4.
+ *
+ * Default: XUA_BUFFER_PACKET_COUNT
+ */
+#ifndef XUA_BUFFER_PACKET_COUNT_IN
+    #define XUA_BUFFER_PACKET_COUNT_IN (XUA_BUFFER_PACKET_COUNT)
+#endif
+
+#if (XUA_BUFFER_PACKET_COUNT_OUT < 4) || (XUA_BUFFER_PACKET_COUNT_IN < 4)
+    #error XUA_BUFFER_PACKET_COUNT_OUT and XUA_BUFFER_PACKET_COUNT_IN must be at least 4
+#endif
+
+/**
+ * @brief Report the size of the main statically sized buffers (FIFOs, sample frames, resampler delay
+ *        lines, PDM decimator data and descriptors) and the tile they are held on. Each task prints its own
+ *        buffers as it starts.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_MEMORY_REPORT
+    #define XUA_MEMORY_REPORT (0)
+#endif
+
+/**
+ * @brief Number of frames (samples per channel) of OUT stream data buffered before playback starts.
+ *        Lower values reduce host to device latency at the expense of tolerance to host jitter.
+ *        0 selects one maximum sized OUT packet.
+ *
+ * Default: 0
+ */
+#ifndef XUA_OUT_BUFFER_PREFILL
+    #define XUA_OUT_BUFFER_PREFILL (0)
+#endif
+
+/**
+ * @brief Number of frames (samples per channel) of IN stream data buffered before data is sent to the host.
+ *        Lower values reduce device to host latency at the expense of tolerance to host jitter.
+ *        0 selects two maximum sized IN packets.
+ *
+ * Default: 0
+ */
+#ifndef XUA_IN_BUFFER_PREFILL
+    #define XUA_IN_BUFFER_PREFILL (0)
+#endif
+
+/**
+ * @brief Enable the vendor request that allows the host to read and set the OUT and IN prefill
+ *        levels at runtime. See XUA_VENDOR_REQ_BUFFER_PREFILL.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_BUFFER_PREFILL_CTRL
+    #define XUA_BUFFER_PREFILL_CTRL (0)
+#endif
+
+/**
+ * @brief Adapt the OUT and IN prefill levels to the stream. The prefill is raised after each underrun
+ *        and decays back towards the configured level whilst the buffer level keeps a safe margin.
+ *        The adaptation is cleared on every stream format or sample rate change.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_BUFFER_ADAPTIVE_PREFILL
+    #define XUA_BUFFER_ADAPTIVE_PREFILL (0)
+#endif
+
+/**
+ * @brief Conceal OUT underruns whilst streaming. Rather than dropping to silence, the last frame sent is
+ *        repeated with its level decaying towards zero, and playback resumes at the shorter prefill level
+ *        XUA_OUT_CONCEAL_PREFILL. Underruns at stream start, and DSD streams, still output silence.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_OUT_UNDERFLOW_CONCEAL
+    #define XUA_OUT_UNDERFLOW_CONCEAL (0)
+#endif
+
+/**
+ * @brief Number of frames of OUT stream data buffered before playback resumes after a concealed underrun.
+ *        0 selects half of the current OUT prefill level.
+ *
+ * Default: 0
+ */
+#ifndef XUA_OUT_CONCEAL_PREFILL
+    #define XUA_OUT_CONCEAL_PREFILL (0)
+#endif
+
+/**
+ * @brief Decay of the repeated frame whilst concealing an OUT underrun. Each frame the level falls by
+ *        1/2^XUA_OUT_CONCEAL_FADE_SHIFT, 4 decaying to -60dB in roughly 100 frames.
+ *
+ * Default: 4
+ */
+#ifndef XUA_OUT_CONCEAL_FADE_SHIFT
+    #define XUA_OUT_CONCEAL_FADE_SHIFT (4)
+#endif
+
+#if (XUA_OUT_UNDERFLOW_CONCEAL) && ((XUA_OUT_CONCEAL_FADE_SHIFT < 1) || (XUA_OUT_CONCEAL_FADE_SHIFT > 16))
+#error XUA_OUT_CONCEAL_FADE_SHIFT must be between 1 and 16
+#endif
 
 /**
- * @brief Enable "mixer" core
+ * @brief Run the decoupler as two threads without interrupts. XUA_Buffer_DecoupleEp() services the endpoints
+ *        whilst XUA_Buffer_DecoupleAudio() answers the audio requests in a select loop, the two sharing
+ *        the FIFOs through single writer counts. Uses one further thread on XUD_TILE. Rate and format
+ *        changes pause the audio requests, waiting at most one sample period.
  *
  * Default: 0 (Disabled)
  */
-#ifndef MIXER
-#define MIXER              (0)
+#ifndef XUA_DECOUPLE_NO_INTERRUPT
+    #define XUA_DECOUPLE_NO_INTERRUPT (0)
 #endif
 
 /**
- * @brief Number of seperate mixes to perform
+ * @brief Run the endpoint buffer and the decoupler as a single thread. XUA_Buffer_Ep() answers the audio
+ *        requests as a case of its select loop and updates the FIFOs between events, saving a thread on
+ *        XUD_TILE. Every other event delays an audio request, so this is limited to two channels in each
+ *        direction at up to 96kHz.
  *
- * Default: 8 if MIXER enabled, else 0
+ * Default: 0 (Disabled)
  */
-#if (MIXER)
-    #ifndef MAX_MIX_COUNT
-        #define MAX_MIX_COUNT          (8)
+#ifndef XUA_BUFFER_SINGLE_THREAD
+    #define XUA_BUFFER_SINGLE_THREAD (0)
+#endif
+
+#if (XUA_BUFFER_SINGLE_THREAD)
+    #if (XUA_DECOUPLE_NO_INTERRUPT)
+        #error XUA_BUFFER_SINGLE_THREAD cannot be used with XUA_DECOUPLE_NO_INTERRUPT
     #endif
-#else
-    #ifndef MAX_MIX_COUNT
-        #define MAX_MIX_COUNT          (0)
+    #ifdef CHAN_BUFF_CTRL
+        #error XUA_BUFFER_SINGLE_THREAD cannot be used with CHAN_BUFF_CTRL
+    #endif
+    #if (NUM_USB_CHAN_OUT > 2) || (NUM_USB_CHAN_IN > 2) || (MAX_FREQ > 96000)
+        #error XUA_BUFFER_SINGLE_THREAD supports at most two channels in each direction at up to 96kHz
     #endif
 #endif
 
 /**
- * @brief Number of channels input into the mixer.
+ * @brief Keep the audio path running between streams. When an OUT stream starts at the DSD mode and
+ *        sample resolution already in use the decoupler only resets its OUT buffer, rather than stopping
+ *        the audiohub to configure the audio hardware again (AudioHwConfig() with mute and un-mute). The
+ *        clocks and codecs stay configured and the outputs play silence whilst idle, so streaming resumes
+ *        once the OUT buffer is prefilled. Sample rate changes are unaffected.
  *
- * Note, total number of mixer nodes is MIX_INPUTS * MAX_MIX_COUNT
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_WARM_STANDBY
+    #define XUA_WARM_STANDBY (0)
+#endif
+
+/**
+ * @brief Enable latency measurement. Packets are time stamped as they pass through the USB buffering
+ *        and the latency statistics for each stage are made available to the host through the vendor
+ *        request XUA_VENDOR_REQ_LATENCY_STATS.
  *
- * Default: 18
+ * Default: 0 (Disabled)
  */
-#ifndef MIX_INPUTS
-    #define MIX_INPUTS                 (18)
+#ifndef XUA_LATENCY_STATS
+    #define XUA_LATENCY_STATS (0)
 #endif
 
-/* Volume processing defines */
+/**
+ * @brief Number of bins in each latency histogram. The last bin also counts all longer latencies.
+ *
+ * Default: 16
+ */
+#ifndef XUA_LATENCY_HIST_BINS
+    #define XUA_LATENCY_HIST_BINS (16)
+#endif
 
 /**
- * @brief The minimum volume setting above -inf. This is a signed 8.8 fixed point
- *        number that must be strictly greater than -128 (0x8000)
+ * @brief Width of each latency histogram bin in microseconds.
  *
- * Default: 0x8100 (-127db)
+ * Default: 125 (one high-speed USB micro-frame)
  */
-#ifndef MIN_VOLUME
-#define MIN_VOLUME                     (0x8100)
+#ifndef XUA_LATENCY_HIST_BIN_US
+    #define XUA_LATENCY_HIST_BIN_US (125)
 #endif
 
+/**
+ * @brief Enable startup timing. The time from reset at which each startup milestone (descriptors ready,
+ *        XUD started, enumerated, first stream, first samples etc) is first reached is recorded and made
+ *        available to the host through the vendor request XUA_VENDOR_REQ_STARTUP_STATS. Milestones on
+ *        AUDIO_IO_TILE are only reported when it is XUD_TILE.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_STARTUP_STATS
+    #define XUA_STARTUP_STATS (0)
+#endif
 
 /**
- * @brief The maximum volume setting. This is a signed 8.8 fixed point number.
+ * @brief Enable pipeline statistics. Underflow and overflow counts of each buffer (decouple FIFOs,
+ *        digital receive FIFOs, MIDI from host), late audiohub sample transfers and the range of the
+ *        decouple FIFO fill levels are recorded and made available to the host through the vendor
+ *        request XUA_VENDOR_REQ_PIPELINE_STATS. Only statistics of tasks on XUD_TILE are reported.
  *
- * Default: 0x0000 (0db)
+ * Default: 0 (Disabled)
  */
-#ifndef MAX_VOLUME
-#define MAX_VOLUME                     (0x0000)
+#ifndef XUA_PIPELINE_STATS
+    #define XUA_PIPELINE_STATS (0)
 #endif
 
 /**
- * @brief The resolution of the volume control in db as a 8.8 fixed point number
+ * @brief Enable stream glitch detection. OUT underflows, OUT packets two or more frames off the
+ *        feedback rate or ending part way through a frame, IN overflows and sustained DC or runs of
+ *        clipped samples on the first XUA_GLITCH_CHANS output channels are recorded by the Decoupler
+ *        with a reference timer timestamp. The last XUA_GLITCH_LOG_LEN events are made available to
+ *        the host through the vendor request XUA_VENDOR_REQ_GLITCH_LOG.
  *
- * Default: 0x100 (1db)
+ * Default: 0 (Disabled)
  */
-#ifndef VOLUME_RES
-#define VOLUME_RES                     (0x100)
+#ifndef XUA_GLITCH_DETECT
+    #define XUA_GLITCH_DETECT (0)
 #endif
 
 /**
- * @brief The minimum volume setting for the mixer unit above -inf.
- * This is a signed 8.8 fixed point number that must be strictly greater than -128 (0x8000)
+ * @brief Number of events held by the glitch log. Must be a power of 2.
  *
- * Default: 0x8100 (-127db)
+ * Default: 32
  */
-#ifndef MIN_MIXER_VOLUME
-#define MIN_MIXER_VOLUME             (0x8100)
+#ifndef XUA_GLITCH_LOG_LEN
+    #define XUA_GLITCH_LOG_LEN (32)
+#endif
+
+#if (XUA_GLITCH_DETECT) && ((XUA_GLITCH_LOG_LEN & (XUA_GLITCH_LOG_LEN - 1)) != 0)
+#error XUA_GLITCH_LOG_LEN must be a power of 2
 #endif
 
 /**
- * @brief The maximum volume setting for the mixer. This is a signed 8.8 fixed point number.
+ * @brief Number of output channels, from channel 0, checked for sustained DC and clipped runs by the
+ *        glitch detector. Each channel checked costs a few instructions per sample in the Decoupler.
  *
- * Default: 0x0000 (0db)
+ * Default: 2
  */
-#ifndef MAX_MIXER_VOLUME
-#define MAX_MIXER_VOLUME            (0x0000)
+#ifndef XUA_GLITCH_CHANS
+    #define XUA_GLITCH_CHANS (2)
+#endif
+
+#if (XUA_GLITCH_DETECT) && ((XUA_GLITCH_CHANS < 1) || (XUA_GLITCH_CHANS > 32))
+#error XUA_GLITCH_CHANS must be between 1 and 32
 #endif
 
 /**
- * @brief The resolution of the volume control in db as a 8.8 fixed point number
+ * @brief Level (Q31) of the average of an output channel above which the glitch detector records
+ *        sustained DC. The average settles over 4096 samples.
  *
-* Default: 0x100 (1db)
-*/
-#ifndef VOLUME_RES_MIXER
-#define VOLUME_RES_MIXER            (0x100)
+ * Default: 0x02000000 (-36dBFS)
+ */
+#ifndef XUA_GLITCH_DC_LEVEL
+    #define XUA_GLITCH_DC_LEVEL (0x02000000)
 #endif
 
-/* Handle out volume control in the mixer - enabled by default */
-#ifndef OUT_VOLUME_IN_MIXER
-#if MIXER
-    #define OUT_VOLUME_IN_MIXER     (1)
-#else
-    #define OUT_VOLUME_IN_MIXER     (0)
+/**
+ * @brief Number of consecutive full scale samples on an output channel that the glitch detector
+ *        records as clipped.
+ *
+ * Default: 4
+ */
+#ifndef XUA_GLITCH_CLIP_RUN
+    #define XUA_GLITCH_CLIP_RUN (4)
 #endif
+
+/**
+ * @brief Enable the diagnostic event log. Stream starts, rate and format changes, FIFO underflows and
+ *        overflows, bus resets and clock source changes are logged with a reference timer timestamp
+ *        into a ring of the last XUA_EVENT_LOG_LEN events, each costing a handful of instructions.
+ *        The ring on XUD_TILE is made available to the host through the vendor request
+ *        XUA_VENDOR_REQ_EVENT_LOG.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_EVENT_LOG
+    #define XUA_EVENT_LOG (0)
 #endif
 
-/* Apply out volume controls after the mix. Only relevant when OUT_VOLUME_IN_MIXER enabled. Enabled by default */
-#ifndef OUT_VOLUME_AFTER_MIX
-#define OUT_VOLUME_AFTER_MIX        (1)
+/**
+ * @brief Number of events held by the event log. Must be a power of 2.
+ *
+ * Default: 64
+ */
+#ifndef XUA_EVENT_LOG_LEN
+    #define XUA_EVENT_LOG_LEN (64)
 #endif
 
-/* Handle in volume control in the mixer - disabled by default */
-#ifndef IN_VOLUME_IN_MIXER
-#define IN_VOLUME_IN_MIXER          (0)
+#if (XUA_EVENT_LOG) && ((XUA_EVENT_LOG_LEN & (XUA_EVENT_LOG_LEN - 1)) != 0)
+#error XUA_EVENT_LOG_LEN must be a power of 2
 #endif
 
-/* Apply in volume controls after the mix. Only relevant when IN_VOLUMNE_IN MIXER enabled. Enabled by default */
-#ifndef IN_VOLUME_AFTER_MIX
-#define IN_VOLUME_AFTER_MIX         (1)
+/**
+ * @brief Enable the production test signal generator and analyser. When started through the vendor
+ *        request XUA_VENDOR_REQ_TEST_SIGNAL, the audiohub replaces the selected output channels with a
+ *        sum of up to XUA_TEST_SIGNAL_TONES sine tones and captures a block of
+ *        XUA_TEST_SIGNAL_BLOCK samples from the looped back input channels. The DC, power and DFT
+ *        terms of the captured block at each tone are returned to the host, from which level, THD+N
+ *        and crosstalk are computed. Requires AUDIO_IO_TILE to be XUD_TILE.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_TEST_SIGNAL
+    #define XUA_TEST_SIGNAL (0)
 #endif
 
-/* Always enable explicit feedback EP, even when input stream is present */
-#ifndef UAC_FORCE_FEEDBACK_EP
-#define UAC_FORCE_FEEDBACK_EP       (1)
+#if (XUA_TEST_SIGNAL) && (AUDIO_IO_TILE != XUD_TILE)
+#error XUA_TEST_SIGNAL requires AUDIO_IO_TILE to be XUD_TILE
 #endif
 
-#if (defined(UAC_FORCE_FEEDBACK_EP) && UAC_FORCE_FEEDBACK_EP == 0)
-#undef UAC_FORCE_FEEDBACK_EP
+/**
+ * @brief Length in samples of the block captured by the test signal analyser, and of one cycle of
+ *        the test signal. Must be a power of 2. Tones are whole numbers of cycles per block.
+ *
+ * Default: 1024
+ */
+#ifndef XUA_TEST_SIGNAL_BLOCK
+    #define XUA_TEST_SIGNAL_BLOCK (1024)
 #endif
 
-/* Synchronisation defines */
-#define XUA_SYNCMODE_ASYNC (1) // USB_ENDPOINT_SYNCTYPE_ASYNC
-#define XUA_SYNCMODE_ADAPT (2) // USB_ENDPOINT_SYNCTYPE_ADAPT
-#define XUA_SYNCMODE_SYNC  (3) // USB_ENDPOINT_SYNCTYPE_SYNC
+#if (XUA_TEST_SIGNAL) && ((XUA_TEST_SIGNAL_BLOCK & (XUA_TEST_SIGNAL_BLOCK - 1)) != 0)
+#error XUA_TEST_SIGNAL_BLOCK must be a power of 2
+#endif
 
-#ifndef XUA_SYNCMODE
-#define XUA_SYNCMODE XUA_SYNCMODE_ASYNC
+/**
+ * @brief Number of input channels captured at once by the test signal analyser.
+ *
+ * Default: 2
+ */
+#ifndef XUA_TEST_SIGNAL_CAPTURE_CHANS
+    #define XUA_TEST_SIGNAL_CAPTURE_CHANS (2)
 #endif
 
-#if (XUA_SYNCMODE == XUA_SYNCMODE_SYNC)
-    #if (XUA_SPDIF_RX_EN|| ADAT_RX)
-        #error "Digital input streams not supported in Sync mode"
-    #endif
+/**
+ * @brief Number of tones in the test signal, a tone at bin 0 being unused.
+ *
+ * Default: 4
+ */
+#ifndef XUA_TEST_SIGNAL_TONES
+    #define XUA_TEST_SIGNAL_TONES (4)
+#endif
+
+/* Profiling defines */
+
+/**
+ * @brief Enable thread load profiling. The iteration period and busy time of each lib_xua task are
+ *        recorded and made available to the host through the vendor request XUA_VENDOR_REQ_PROFILE
+ *        (tasks on XUD_TILE only) and optionally over xscope.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_PROFILE
+    #define XUA_PROFILE (0)
+#endif
+
+/**
+ * @brief Report thread load over xscope. Requires XUA_PROFILE. The application config.xscope must
+ *        declare XUA_PROFILE_COUNT integer probes starting at XUA_PROFILE_XSCOPE_PROBE_BASE.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_PROFILE_XSCOPE
+    #define XUA_PROFILE_XSCOPE (0)
+#endif
+
+/**
+ * @brief Index of the first xscope probe used for thread load reporting.
+ *
+ * Default: 0
+ */
+#ifndef XUA_PROFILE_XSCOPE_PROBE_BASE
+    #define XUA_PROFILE_XSCOPE_PROBE_BASE (0)
+#endif
+
+/**
+ * @brief Number of task iterations between xscope reports. Each report is the worst case busy time
+ *        (or period for polling tasks) in reference timer ticks seen over the interval.
+ *
+ * Default: 1000
+ */
+#ifndef XUA_PROFILE_XSCOPE_INTERVAL
+    #define XUA_PROFILE_XSCOPE_INTERVAL (1000)
+#endif
+
+/* xscope tap points, see XUA_XSCOPE_TAPS */
+#define XUA_XSCOPE_TAP_DECOUPLE_OUT         (1 << 0)    /* Output sample as decouple passes it to the mixer/audiohub */
+#define XUA_XSCOPE_TAP_DECOUPLE_IN          (1 << 1)    /* Input sample as decouple takes it from the mixer/audiohub */
+#define XUA_XSCOPE_TAP_AUDIOHUB_OUT         (1 << 2)    /* Output sample as the audiohub takes it from the mixer/decouple */
+#define XUA_XSCOPE_TAP_AUDIOHUB_IN          (1 << 3)    /* Input sample as the audiohub passes it to the mixer/decouple */
+#define XUA_XSCOPE_TAP_FILL_OUT             (1 << 4)    /* Decouple OUT FIFO fill level in bytes */
+#define XUA_XSCOPE_TAP_FILL_IN              (1 << 5)    /* Decouple IN FIFO fill level in bytes */
+#define XUA_XSCOPE_TAP_COUNT                (6)
+
+/**
+ * @brief Audio pipeline tap points reported over xscope, as a mask of XUA_XSCOPE_TAP_xxx. Each enabled
+ *        tap reports one value every XUA_XSCOPE_TAP_DECIMATION frames to its own integer probe, the
+ *        probe index being XUA_XSCOPE_TAP_PROBE_BASE plus the bit number of the tap. The application
+ *        config.xscope must declare the probes. Each tap costs a counter update per frame and a single
+ *        xscope_int() per report, such that a device can be observed without breaking its timing.
+ *
+ * Default: 0 (Disabled)
+ */
+#ifndef XUA_XSCOPE_TAPS
+    #define XUA_XSCOPE_TAPS (0)
+#endif
+
+/**
+ * @brief Index of the first xscope probe used for the tap points. Must not overlap the thread load
+ *        probes when XUA_PROFILE_XSCOPE is also enabled.
+ *
+ * Default: 0
+ */
+#ifndef XUA_XSCOPE_TAP_PROBE_BASE
+    #define XUA_XSCOPE_TAP_PROBE_BASE (0)
+#endif
+
+/**
+ * @brief Number of frames between reports of each tap point.
+ *
+ * Default: 48 (1ms at 48kHz)
+ */
+#ifndef XUA_XSCOPE_TAP_DECIMATION
+    #define XUA_XSCOPE_TAP_DECIMATION (48)
+#endif
+
+/**
+ * @brief Output channel reported by the output sample tap points.
+ *
+ * Default: 0
+ */
+#ifndef XUA_XSCOPE_TAP_CHAN_OUT
+    #define XUA_XSCOPE_TAP_CHAN_OUT (0)
+#endif
+
+/**
+ * @brief Input channel reported by the input sample tap points.
+ *
+ * Default: 0
+ */
+#ifndef XUA_XSCOPE_TAP_CHAN_IN
+    #define XUA_XSCOPE_TAP_CHAN_IN (0)
+#endif
+
+#if (XUA_XSCOPE_TAPS & (XUA_XSCOPE_TAP_DECOUPLE_OUT | XUA_XSCOPE_TAP_AUDIOHUB_OUT)) && (XUA_XSCOPE_TAP_CHAN_OUT >= NUM_USB_CHAN_OUT)
+#error XUA_XSCOPE_TAP_CHAN_OUT must be less than NUM_USB_CHAN_OUT
+#endif
+
+#if (XUA_XSCOPE_TAPS & (XUA_XSCOPE_TAP_DECOUPLE_IN | XUA_XSCOPE_TAP_AUDIOHUB_IN)) && (XUA_XSCOPE_TAP_CHAN_IN >= NUM_USB_CHAN_IN)
+#error XUA_XSCOPE_TAP_CHAN_IN must be less than NUM_USB_CHAN_IN
+#endif
+
+#if (XUA_XSCOPE_TAPS) && (XUA_XSCOPE_TAP_DECIMATION < 1)
+#error XUA_XSCOPE_TAP_DECIMATION must be at least 1
 #endif
 
 
@@ -1276,7 +3086,10 @@ enum USBEndpointNumber_In
 #if (NUM_USB_CHAN_IN != 0)
     ENDPOINT_NUMBER_IN_AUDIO,
 #endif
-#if (XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN)
+#if (XUA_AUX_IN_EN)
+    ENDPOINT_NUMBER_IN_AUDIO_AUX,
+#endif
+#if (XUA_STATUS_INT_EN)
     ENDPOINT_NUMBER_IN_INTERRUPT,   /* Audio interrupt/status EP */
 #endif
 #ifdef MIDI
@@ -1293,6 +3106,9 @@ enum USBEndpointNumber_In
 #ifdef IAP_EA_NATIVE_TRANS
     ENDPOINT_NUMBER_IN_IAP_EA_NATIVE_TRANS,
 #endif
+#endif
+#if (XUA_LEVEL_METER_EP_EN)
+    ENDPOINT_NUMBER_IN_LEVEL_METER,
 #endif
     XUA_ENDPOINT_COUNT_IN           /* End marker */
 };
@@ -1327,6 +3143,11 @@ enum USBEndpointNumber_Out
 #define ENDPOINT_COUNT_IN                 (XUA_ENDPOINT_COUNT_IN + XUA_ENDPOINT_COUNT_CUSTOM_IN)
 #define ENDPOINT_COUNT_OUT                (XUA_ENDPOINT_COUNT_OUT + XUA_ENDPOINT_COUNT_CUSTOM_OUT)
 
+/* Largest isochronous packet, a single transaction per (micro)frame. High-bandwidth isochronous endpoints (two or
+ * three transactions per microframe) are not supported by XUD, wMaxPacketSize must not encode additional transactions */
+#define XUA_ISO_MAX_PACKET_SIZE_HS        (1024)
+#define XUA_ISO_MAX_PACKET_SIZE_FS        (1023)
+
 #endif /* __ASSEMBLER__ */
 
 #define AUDIO_STOP_FOR_DFU                (0x12345678)
@@ -1340,8 +3161,19 @@ enum USBEndpointNumber_Out
 #define LEVEL_UPDATE_RATE                 (400000)
 #endif
 
-/* The number of clock ticks to wait for the audio feeback to stabalise
- * Note, feedback always counts 128 SOFs (16ms @ HS, 128ms @ FS) */
+/* The maximum number of clock ticks to wait for the audio feeback to stabalise. Endpoint 0 finishes waiting
+ * as soon as the endpoint buffer reports valid feedback, these are timeouts should that not happen
+ * Note, without fast lock feedback counts 1 << XUA_FEEDBACK_WINDOW_LOG2 SOFs (by default 16ms @ HS, 128ms @ FS).
+ * With fast lock the first value is ready after 8 SOFs (1ms @ HS, 8ms @ FS) */
+#if (XUA_FEEDBACK_FAST_LOCK)
+#ifndef FEEDBACK_STABILITY_DELAY_HS
+#define FEEDBACK_STABILITY_DELAY_HS       (500000)
+#endif
+
+#ifndef FEEDBACK_STABILITY_DELAY_FS
+#define FEEDBACK_STABILITY_DELAY_FS       (2000000)
+#endif
+#else
 #ifndef FEEDBACK_STABILITY_DELAY_HS
 #define FEEDBACK_STABILITY_DELAY_HS       (2000000)
 #endif
@@ -1349,15 +3181,10 @@ enum USBEndpointNumber_Out
 #ifndef FEEDBACK_STABILITY_DELAY_FS
 #define FEEDBACK_STABILITY_DELAY_FS       (20000000)
 #endif
+#endif
 
 /* Length of clock unit/clock-selector units */
-#if (XUA_SPDIF_RX_EN) && (XUA_ADAT_RX_EN)
-#define NUM_CLOCKS               (3)
-#elif (XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN)
-#define NUM_CLOCKS               (2)
-#else
-#define NUM_CLOCKS               (1)
-#endif
+#define NUM_CLOCKS               (1 + ((XUA_SPDIF_RX_EN) != 0) + ((XUA_ADAT_RX_EN) != 0) + ((XUA_WORDCLOCK_RX_EN) != 0))
 
 /* Audio Unit ID defines */
 #define FU_USBIN                 11              /* Feature Unit: USB Audio device -> host */
@@ -1365,12 +3192,15 @@ enum USBEndpointNumber_Out
 #define ID_IT_USB                2               /* Input terminal: USB streaming */
 #define ID_IT_AUD                1               /* Input terminal: Analogue input */
 #define ID_OT_USB                22              /* Output terminal: USB streaming */
+#define ID_OT_USB_AUX            23              /* Output terminal: USB streaming, auxiliary input stream */
 #define ID_OT_AUD                20              /* Output terminal: Analogue output */
 
 #define ID_CLKSEL                40              /* Clock selector ID */
 #define ID_CLKSRC_INT            41              /* Clock source ID (internal) */
 #define ID_CLKSRC_SPDIF          42              /* Clock source ID (external) */
 #define ID_CLKSRC_ADAT           43              /* Clock source ID (external) */
+#define ID_CLKSRC_WORDCLOCK      44              /* Clock source ID (external) */
+#define ID_CLKMUL_IN             45              /* Clock multiplier ID, IN terminals (USB_OUT_TO_IN_RATIO) */
 
 #define ID_XU_MIXSEL             50
 #define ID_XU_OUT                51
@@ -1405,6 +3235,94 @@ enum USBEndpointNumber_Out
 #undef FAST_MODE
 #endif
 
+/* Thread mode flags for the XUA_THREAD_MODE_ defines below */
+#define XUA_THREAD_FAST                 (1)     /* Fast mode, the thread never pauses its issue slot whilst waiting */
+#define XUA_THREAD_HIGH_PRIORITY        (2)     /* High priority, the thread is guaranteed its issue slots ahead of
+                                                 * normal priority threads on the tile (xcore.ai) */
+
+/**
+ * @brief Mode of the threads without their own XUA_THREAD_MODE_ define, and the default of those with one.
+ *        An OR of XUA_THREAD_FAST and XUA_THREAD_HIGH_PRIORITY, or 0.
+ *
+ * Default: XUA_THREAD_FAST if FAST_MODE is defined, else 0
+ */
+#ifndef XUA_THREAD_MODE_DEFAULT
+    #ifdef FAST_MODE
+        #define XUA_THREAD_MODE_DEFAULT                     (XUA_THREAD_FAST)
+    #else
+        #define XUA_THREAD_MODE_DEFAULT                     (0)
+    #endif
+#endif
+
+/**
+ * @brief Mode of the XUA_AudioHub() thread
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_AUDIOHUB
+    #define XUA_THREAD_MODE_AUDIOHUB                        (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+/**
+ * @brief Mode of the XUA_Buffer_Ep() thread
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_BUFFER_EP
+    #define XUA_THREAD_MODE_BUFFER_EP                       (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+/**
+ * @brief Mode of the XUA_Buffer_Decouple() thread(s)
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_DECOUPLE
+    #define XUA_THREAD_MODE_DECOUPLE                        (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+/**
+ * @brief Mode of the mixer thread(s)
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_MIXER
+    #define XUA_THREAD_MODE_MIXER                           (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+/**
+ * @brief Mode of the clockGen() thread
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_CLOCKGEN
+    #define XUA_THREAD_MODE_CLOCKGEN                        (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+/**
+ * @brief Mode of the usb_midi() thread
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_MIDI
+    #define XUA_THREAD_MODE_MIDI                            (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+/**
+ * @brief Mode of the XUA_Endpoint0() thread
+ *
+ * Default: XUA_THREAD_MODE_DEFAULT
+ */
+#ifndef XUA_THREAD_MODE_EP0
+    #define XUA_THREAD_MODE_EP0                             (XUA_THREAD_MODE_DEFAULT)
+#endif
+
+#if ((XUA_THREAD_MODE_DEFAULT | XUA_THREAD_MODE_AUDIOHUB | XUA_THREAD_MODE_BUFFER_EP | XUA_THREAD_MODE_DECOUPLE \
+        | XUA_THREAD_MODE_MIXER | XUA_THREAD_MODE_CLOCKGEN | XUA_THREAD_MODE_MIDI | XUA_THREAD_MODE_EP0) \
+        & XUA_THREAD_HIGH_PRIORITY) && !defined(__XS3A__)
+    #error XUA_THREAD_HIGH_PRIORITY requires xcore.ai
+#endif
+
 
 /* Some stream format checks */
 #if (OUTPUT_FORMAT_COUNT > 0)
@@ -1468,13 +3386,13 @@ enum USBEndpointNumber_Out
 #endif
 
 /* Useful for dropping lower part of macs in volume processing... */
-#if (FS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS > 24) || (HS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS > 24)
+#if (FS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS > 24) || (HS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS > 24) || (XUA_FLOAT_IN_FORMAT_NUM > 0)
     #define STREAM_FORMAT_INPUT_RESOLUTION_32BIT_USED 1
 #else
     #define STREAM_FORMAT_INPUT_RESOLUTION_32BIT_USED 0
 #endif
 
-#if((FS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES == 4) || (HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES == 4))
+#if((FS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES == 4) || (HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES == 4) || (XUA_FLOAT_IN_FORMAT_NUM > 0))
     #define STREAM_FORMAT_INPUT_SUBSLOT_4_USED 1
 #else
     #define STREAM_FORMAT_INPUT_SUBSLOT_4_USED 0
@@ -1492,6 +3410,31 @@ enum USBEndpointNumber_Out
     #define STREAM_FORMAT_INPUT_SUBSLOT_2_USED 0
 #endif
 
+/* Float stream conversion in the Decoupler */
+#define STREAM_FORMAT_OUTPUT_FLOAT_USED     (XUA_FLOAT_OUT_FORMAT_NUM > 0)
+#define STREAM_FORMAT_INPUT_FLOAT_USED      (XUA_FLOAT_IN_FORMAT_NUM > 0)
+
+#if (XUA_FLOAT_OUT_FORMAT_NUM == 1) && ((FS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES != 4) || (HS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES != 4))
+    #error Float output stream alternate requires 4 byte subslots
+#elif (XUA_FLOAT_OUT_FORMAT_NUM == 2) && ((FS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES != 4) || (HS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES != 4))
+    #error Float output stream alternate requires 4 byte subslots
+#elif (XUA_FLOAT_OUT_FORMAT_NUM == 3) && ((FS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES != 4) || (HS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES != 4))
+    #error Float output stream alternate requires 4 byte subslots
+#endif
+
+#if (XUA_FLOAT_IN_FORMAT_NUM == 1) && ((FS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES != 4) || (HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES != 4))
+    #error Float input stream alternate requires 4 byte subslots
+#elif (XUA_FLOAT_IN_FORMAT_NUM == 2) && ((FS_STREAM_FORMAT_INPUT_2_SUBSLOT_BYTES != 4) || (HS_STREAM_FORMAT_INPUT_2_SUBSLOT_BYTES != 4))
+    #error Float input stream alternate requires 4 byte subslots
+#elif (XUA_FLOAT_IN_FORMAT_NUM == 3) && ((FS_STREAM_FORMAT_INPUT_3_SUBSLOT_BYTES != 4) || (HS_STREAM_FORMAT_INPUT_3_SUBSLOT_BYTES != 4))
+    #error Float input stream alternate requires 4 byte subslots
+#endif
+
+/* The Audio Class 1.0 descriptors only describe a PCM Alternate 1 */
+#if ((AUDIO_CLASS == 1) || (AUDIO_CLASS_FALLBACK)) && ((XUA_FLOAT_OUT_FORMAT_NUM == 1) || (XUA_FLOAT_IN_FORMAT_NUM == 1))
+    #error Float stream alternate 1 is not supported with Audio Class 1.0
+#endif
+
 #if MAX_FREQ < MIN_FREQ
 #error MAX_FREQ should be >= MIN_FREQ!!
 #endif
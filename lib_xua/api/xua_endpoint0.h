@@ -37,6 +37,19 @@ void XUA_Endpoint0(chanend c_ep0_out,
 #endif
 );
 
+/** Function to tell the host that a control has been changed on the device, for
+ *  example a volume changed from a hardware knob. A status interrupt is queued
+ *  on the AudioControl interrupt endpoint and the host then reads the control's
+ *  new value. Must be called from the Endpoint 0 thread, e.g. from application
+ *  code run between calls to XUA_Endpoint0_loop(). Requires XUA_STATUS_INT_EN.
+ *
+ *  \param entityId     ID of the unit or terminal holding the control,
+ *                      e.g. FU_USBOUT or ID_MIXER_1
+ *  \param cs           Control selector, e.g. FU_VOLUME_CONTROL
+ *  \param cn           Channel number, or mixer control number
+ */
+void XUA_Endpoint0_notifyChange(unsigned entityId, unsigned cs, unsigned cn);
+
 /** Function to set the Vendor ID value
  *
  *  \param vid vendor ID value to set
@@ -138,4 +151,20 @@ unsigned short XUA_Endpoint0_getProductId();
 unsigned short XUA_Endpoint0_getBcdDevice();
 
 #endif
+
+/** Function to select the channel profile, XUA_CHAN_PROFILE_FULL or XUA_CHAN_PROFILE_REDUCED.
+ *  When called before XUA_Endpoint0() the device enumerates with the profile. Otherwise, when the
+ *  profile changes, the device reboots and re-enumerates with it. Must be called on XUD_TILE.
+ *  Requires XUA_CHAN_PROFILE_EN.
+ *
+ *  \param profile Channel profile to select
+*/
+void XUA_Endpoint0_setChanProfile(unsigned profile);
+
+/** Function to get the channel profile
+ *
+ *  \return Channel profile the device enumerated with
+*/
+unsigned XUA_Endpoint0_getChanProfile(void);
+
 #endif
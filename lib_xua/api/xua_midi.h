@@ -1,4 +1,4 @@
-// Copyright 2011-2022 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #ifndef _XUA_MIDI_H_
 #define _XUA_MIDI_H_
@@ -9,6 +9,17 @@
 #define MIDI_SHIFT_TX      (0)
 #endif
 
+/* The MIDI task is combinable when it shares its thread with the application tasks listed in
+ * XUA_MIDI_COMBINE_TASKS */
+#ifdef XUA_MIDI_COMBINE_TASKS
+#ifdef IAP
+#error XUA_MIDI_COMBINE_TASKS not supported with IAP
+#endif
+#define XUA_MIDI_COMBINABLE [[combinable]]
+#else
+#define XUA_MIDI_COMBINABLE
+#endif
+
 /** USB MIDI I/O task.
  *
  *  This function passes MIDI data between XUA_Buffer and MIDI UART I/O.
@@ -20,10 +31,15 @@
  *  \param c_midi       Chanend connected to the decouple() thread
  *  \param cable_number The cable number of the MIDI implementation.
  *                      This should be set to 0.
+ *
+ *  The task is combinable when XUA_MIDI_COMBINE_TASKS is defined.
  **/
+XUA_MIDI_COMBINABLE
 void usb_midi(
 #if (MIDI_RX_PORT_WIDTH == 4)
     buffered in port:4 ?p_midi_in,
+#elif (MIDI_RX_PORT_WIDTH == 8)
+    buffered in port:8 ?p_midi_in,
 #else
     buffered in port:1 ?p_midi_in,
 #endif
@@ -37,12 +53,40 @@ void usb_midi(
 #endif
 );
 
+/** Multi-port USB MIDI I/O task.
+ *
+ *  This function passes MIDI data between XUA_Buffer and XUA_MIDI_PORTS MIDI UARTs from a single thread.
+ *  USB MIDI cable n is received on bit n of p_midi_in and transmitted on bit MIDI_SHIFT_TX + n of p_midi_out.
+ *
+ *  \param p_midi_in    4-bit or 8-bit (MIDI_RX_PORT_WIDTH) input port for MIDI
+ *  \param p_midi_out   Output port for MIDI, at least MIDI_SHIFT_TX + XUA_MIDI_PORTS bits wide
+ *  \param clk_midi     Clock block used for clocking the ports
+ *  \param c_midi       Chanend connected to the decouple() thread
+ *
+ *  The task is combinable when XUA_MIDI_COMBINE_TASKS is defined.
+ **/
+XUA_MIDI_COMBINABLE
+void usb_midi_multi(
+#if (MIDI_RX_PORT_WIDTH == 8)
+    buffered in port:8 p_midi_in,
+#else
+    buffered in port:4 p_midi_in,
+#endif
+    port p_midi_out,
+    clock ?clk_midi,
+    chanend c_midi);
+
 #define MAX_USB_MIDI_PACKET_SIZE 1024
 #define MIDI_USB_BUFFER_FROM_HOST_FIFO_SIZE (512+1024)
 #define MIDI_USB_BUFFER_TO_HOST_SIZE (256)
 #define MIDI_ACK 20
+#define MIDI_SET_ALT 21
 #define USB_MIDI_DEVICE_OUT_FIFO_SIZE (1024)
 
+/* Length in words of a USB MIDI 2.0 Universal MIDI Packet (XUA_MIDI_UMP) from the message type of its first word,
+ * 2 bits (length - 1) per message type */
+#define MIDI_UMP_WORDS(w0) ((((0xFE950D40u) >> (((w0) >> 28) << 1)) & 3) + 1)
+
 #ifdef __MIDI_IMPL
 #define INLINE
 #else
@@ -53,12 +97,13 @@ void usb_midi(
 #pragma select handler
 void midi_get_ack_or_data(chanend c, int &is_ack, unsigned int &datum);
 #else
+/* is_ack is the control token (MIDI_ACK or MIDI_SET_ALT) or 0 for data. For MIDI_SET_ALT datum is the alternate
+ * setting of the MIDI streaming interface */
 #pragma select handler
 INLINE void midi_get_ack_or_data(chanend c, int &is_ack, unsigned int &datum) {
   if (testct(c)) {
-    is_ack = 1;
-    (void) inct(c); // read 1-bytes control token
-    (void) inuchar(c);
+    is_ack = inct(c); // read 1-bytes control token
+    datum = inuchar(c);
     (void) inuchar(c);
     (void) inuchar(c);
   }
@@ -75,6 +120,15 @@ INLINE void midi_send_ack(chanend c) {
   outuchar(c, 0);
   outuchar(c, 0);
 }
+
+/* Sent by XUA_Buffer when the host selects the MIDI streaming interface alternate setting, 1 for UMP
+ * (XUA_MIDI_UMP). Not acked */
+INLINE void midi_send_alt(chanend c, unsigned alt) {
+  outct(c, MIDI_SET_ALT);
+  outuchar(c, alt);
+  outuchar(c, 0);
+  outuchar(c, 0);
+}
 #define MIDI_RATE           (31250)
 #define MIDI_BITTIME        (XS1_TIMER_MHZ * 1000000 / MIDI_RATE)
 #define MIDI_BITTIME_2      (MIDI_BITTIME>>1)
@@ -1,4 +1,4 @@
-// Copyright 2011-2023 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #ifndef _XUA_MIXER_H_
 #define _XUA_MIXER_H_
@@ -14,9 +14,29 @@ enum mix_ctl_cmd {
   SET_MIX_OUT_VOL,
   GET_INPUT_LEVELS,
   GET_STREAM_LEVELS,
-  GET_OUTPUT_LEVELS
+  GET_OUTPUT_LEVELS,
+  SET_MIX_MULT_BANK,    /* Write up to XUA_MIXER_BANK_CHUNK weights of a mix into the shadow weight bank */
+  BUILD_MIX_BANK,       /* Prepare any derived weights of a mix from the shadow bank (sparse/VPU/LDD mixers) */
+  APPLY_MIX_BANK,       /* Swap the shadow and live weight banks */
+  GET_LEVELS,           /* Read up to XUA_LEVEL_METER_CHUNK (peak, mean square) meter levels */
+  SET_MIX_IN_VOLS,      /* Write up to XUA_MIXER_BANK_CHUNK consecutive input volume multipliers */
+  SET_MIX_OUT_VOLS,     /* Write up to XUA_MIXER_BANK_CHUNK consecutive output volume multipliers */
+  SET_MIX_ROUTING_BANK, /* Write up to XUA_MIXER_BANK_CHUNK entries of a routing map into the shadow routing, which
+                         * APPLY_MIX_BANK then applies along with the shadow weight bank */
+  SET_MIX_EQ_BANK,      /* Write up to XUA_MIXER_BANK_CHUNK EQ coefficients of an output into its shadow EQ bank */
+  APPLY_MIX_EQ          /* Swap the shadow and live EQ banks of an output */
 };
 
+/* Level meter channels (LEVEL_METER_HOST), in the order used by GET_LEVELS */
+#define XUA_LEVEL_METER_OFFSET_OUT  (0)                                     /* Streams from host */
+#define XUA_LEVEL_METER_OFFSET_IN   (NUM_USB_CHAN_OUT)                      /* Streams to host */
+#define XUA_LEVEL_METER_OFFSET_MIX  (NUM_USB_CHAN_OUT + NUM_USB_CHAN_IN)    /* Mixer outputs */
+#define XUA_LEVEL_METER_CHANS       (NUM_USB_CHAN_OUT + NUM_USB_CHAN_IN + MAX_MIX_COUNT)
+
+/* Level meter endpoint frame (XUA_LEVEL_METER_EP_EN), all fields 16-bit little endian:
+ * frame count, channel count then a (peak, RMS) pair per meter channel */
+#define XUA_LEVEL_METER_EP_BYTES    (4 + (XUA_LEVEL_METER_CHANS * 4))
+
 
 /** Digital sample mixer.
  *
@@ -1,4 +1,4 @@
-// Copyright 2015-2021 XMOS LIMITED.
+// Copyright 2015-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #ifndef XUA_PDM_MIC_H
@@ -7,9 +7,16 @@
 /* Included from lib_mic_array */
 #include "mic_array.h"
 
+/* Number of 4 channel decimators (and streaming channels between the decimators and XUA_PdmBuffer()) */
+#define XUA_NUM_PDM_DECIMATORS  ((XUA_NUM_PDM_MICS + 3) / 4)
 
 /* Configures PDM ports/clocks */
+#if (XUA_NUM_PDM_MICS > 8)
+void xua_pdm_mic_config(in port p_pdm_mclk, in port p_pdm_clk, buffered in port:32 p_pdm_mics,
+    buffered in port:32 p_pdm_mics_2, clock clk_pdm);
+#else
 void xua_pdm_mic_config(in port p_pdm_mclk, in port p_pdm_clk, buffered in port:32 p_pdm_mics, clock clk_pdm);
+#endif
 
 #ifdef MIC_PROCESSING_USE_INTERFACE
 /* Interface based user processing */
@@ -21,7 +28,7 @@ typedef interface mic_process_if
 
 
 [[combinable]]
-void XUA_PdmBuffer(streaming chanend c_ds_output[2], chanend c_audio
+void XUA_PdmBuffer(streaming chanend c_ds_output[XUA_NUM_PDM_DECIMATORS], chanend c_audio
 #ifdef MIC_PROCESSING_USE_INTERFACE
    , client mic_process_if i_mic_process
 #endif
@@ -30,9 +37,6 @@ void XUA_PdmBuffer(streaming chanend c_ds_output[2], chanend c_audio
 [[combinable]]
 void user_pdm_process(server mic_process_if i_mic_data);
 
-/* PDM interface and decimation cores */
-void xua_pdm_mic(streaming chanend c_ds_output[2], buffered in port:32 p_pdm_mics);
-
 #else
 
 /* Simple user hooks/call-backs */
@@ -42,11 +46,16 @@ void user_pdm_init();
 
 /* PDM interface and decimation cores */
 [[combinable]]
-void XUA_PdmBuffer(streaming chanend c_ds_output[2], chanend c_audio);
-
-/* PDM interface and decimation cores */
-void xua_pdm_mic(streaming chanend c_ds_output[2], buffered in port:32 p_pdm_mics);
+void XUA_PdmBuffer(streaming chanend c_ds_output[XUA_NUM_PDM_DECIMATORS], chanend c_audio);
 
 #endif
+
+/* PDM interface and decimation cores */
+#if (XUA_NUM_PDM_MICS > 8)
+void xua_pdm_mic(streaming chanend c_ds_output[XUA_NUM_PDM_DECIMATORS], buffered in port:32 p_pdm_mics,
+    buffered in port:32 p_pdm_mics_2);
+#else
+void xua_pdm_mic(streaming chanend c_ds_output[XUA_NUM_PDM_DECIMATORS], buffered in port:32 p_pdm_mics);
 #endif
 
+#endif
@@ -1,4 +1,4 @@
-// Copyright 2012-2021 XMOS LIMITED.
+// Copyright 2012-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #include <stdio.h>
 #include <stdlib.h>
@@ -18,6 +18,7 @@
 
 #else
 #include <unistd.h>
+#include <time.h>
 
 void Sleep(unsigned milliseconds) {
     usleep(milliseconds * 1000);
@@ -46,6 +47,11 @@ device_pid_t pidList[] = {
 
 unsigned int XMOS_DFU_IF = 0;
 
+/* Block size for download and upload, taken from wTransferSize in the device's DFU functional descriptor */
+#define DFU_DEFAULT_TRANSFER_SIZE 64
+#define DFU_MAX_TRANSFER_SIZE 4096
+unsigned int dfu_transfer_size = DFU_DEFAULT_TRANSFER_SIZE;
+
 #define DFU_REQUEST_TO_DEV 0x21
 #define DFU_REQUEST_FROM_DEV 0xa1
 
@@ -58,6 +64,11 @@ unsigned int XMOS_DFU_IF = 0;
 #define DFU_GETSTATE 5
 #define DFU_ABORT 6
 
+// DFU states
+#define DFU_STATE_DNBUSY 4
+
+#define DFU_FUNCTIONAL_DESC_TYPE 0x21
+
 // XMOS alternate setting requests
 #define XMOS_DFU_RESETDEVICE          0xf0
 #define XMOS_DFU_REVERTFACTORY        0xf1
@@ -65,9 +76,68 @@ unsigned int XMOS_DFU_IF = 0;
 #define XMOS_DFU_RESETFROMDFU         0xf3
 #define XMOS_DFU_SAVESTATE            0xf5
 #define XMOS_DFU_RESTORESTATE         0xf6
+#define XMOS_DFU_IMAGECRC             0xf7
+#define XMOS_DFU_DNLOADSTATE          0xf8
+
+/* Images are stored in whole flash pages, padding is zero */
+#define FLASH_PAGE_SIZE 256
+
+/* Delta image format, see dfu_types.h in lib_xua */
+#define DFU_DELTA_MAGIC         0x41544c44
+#define DFU_DELTA_VERSION       1
+#define DFU_DELTA_HEADER_WORDS  16
+#define DFU_DELTA_CMD_COPY      1
+#define DFU_DELTA_CMD_DATA      2
+#define DFU_DELTA_MAX_COUNT     0x0fffffff
 
 static libusb_device_handle *devh = NULL;
 
+/* Finds the DFU interface of a device. Returns its number, wTransferSize from the DFU functional descriptor and its
+ * bInterfaceProtocol (1 in application mode, 2 in DFU mode). Outputs are left unchanged where not found */
+static int get_dfu_interface(libusb_device *dev, unsigned int *interface, unsigned int *transfer_size,
+                             unsigned int *protocol)
+{
+    struct libusb_config_descriptor *config_desc = NULL;
+    int ret = libusb_get_active_config_descriptor(dev, &config_desc);
+    if (ret != 0) {
+      return -1;
+    }
+    if (config_desc != NULL)
+    {
+        //printf("bNumInterfaces: %d\n", config_desc->bNumInterfaces);
+        for (int j = 0; j < config_desc->bNumInterfaces; j++)
+        {
+            //printf("%d\n", j);
+            const struct libusb_interface_descriptor *inter_desc = ((struct libusb_interface *)&config_desc->interface[j])->altsetting;
+            if (inter_desc->bInterfaceClass == 0xFE && inter_desc->bInterfaceSubClass == 0x1)
+            {
+                *interface = inter_desc->bInterfaceNumber;
+                if (protocol)
+                {
+                    *protocol = inter_desc->bInterfaceProtocol;
+                }
+
+                /* DFU functional descriptor follows the interface descriptor */
+                const unsigned char *extra = inter_desc->extra;
+                if (inter_desc->extra_length >= 7 && extra[1] == DFU_FUNCTIONAL_DESC_TYPE)
+                {
+                    unsigned int size = extra[5] | (extra[6] << 8);
+                    if (size >= DFU_DEFAULT_TRANSFER_SIZE && size <= DFU_MAX_TRANSFER_SIZE)
+                    {
+                        *transfer_size = size;
+                    }
+                }
+            }
+        }
+        libusb_free_config_descriptor(config_desc);
+    }
+    else
+    {
+        *interface = 0;
+    }
+    return 0;
+}
+
 static int find_xmos_device(unsigned int id, unsigned int pid, unsigned int list)
 {
     libusb_device *dev;
@@ -107,27 +177,9 @@ static int find_xmos_device(unsigned int id, unsigned int pid, unsigned int list
                 }
                 else
                 {
-                    struct libusb_config_descriptor *config_desc = NULL;
-                    int ret = libusb_get_active_config_descriptor(dev, &config_desc);
-                    if (ret != 0) {
-                      return -1;
-                    }
-                    if (config_desc != NULL)
-                    {
-                        //printf("bNumInterfaces: %d\n", config_desc->bNumInterfaces);
-                        for (int j = 0; j < config_desc->bNumInterfaces; j++)
-                        {
-                            //printf("%d\n", j);
-                            const struct libusb_interface_descriptor *inter_desc = ((struct libusb_interface *)&config_desc->interface[j])->altsetting;
-                            if (inter_desc->bInterfaceClass == 0xFE && inter_desc->bInterfaceSubClass == 0x1)
-                            {
-                                XMOS_DFU_IF = inter_desc->bInterfaceNumber;
-                            }
-                        }
-                    }
-                    else
+                    if (get_dfu_interface(dev, &XMOS_DFU_IF, &dfu_transfer_size, NULL) < 0)
                     {
-                        XMOS_DFU_IF = 0;
+                        return -1;
                     }
                 }
                 break;
@@ -190,6 +242,20 @@ int dfu_getStatus(unsigned int interface, unsigned char *state, unsigned int *ti
     return 0;
 }
 
+/* Gets status, then whilst the device reports it is busy waits out its poll timeout and polls again */
+int dfu_waitStatus(unsigned int interface, unsigned char *state, unsigned int *timeout,
+                  unsigned char *nextState, unsigned char *strIndex)
+{
+    dfu_getStatus(interface, state, timeout, nextState, strIndex);
+
+    while (*nextState == DFU_STATE_DNBUSY)
+    {
+        Sleep(*timeout);
+        dfu_getStatus(interface, state, timeout, nextState, strIndex);
+    }
+    return 0;
+}
+
 int dfu_clrStatus(unsigned int interface)
 {
     libusb_control_transfer(devh, DFU_REQUEST_TO_DEV, DFU_CLRSTATUS, 0, interface, NULL, 0, 0);
@@ -232,15 +298,94 @@ int dfu_upload(unsigned int interface, unsigned int block_num, unsigned int size
     return numBytes;
 }
 
-int write_dfu_image(char *file)
+int xmos_dfu_image_crc(unsigned int interface, unsigned int pages, unsigned int *crc, unsigned int *length)
+{
+    unsigned int data[2];
+    int numBytes = libusb_control_transfer(devh, DFU_REQUEST_FROM_DEV, XMOS_DFU_IMAGECRC, pages, interface, (unsigned char *)data, 8, 0);
+    if (numBytes != 8)
+    {
+        return -1;
+    }
+    *crc = data[0];
+    *length = data[1];
+    return 0;
+}
+
+/* Standard (reflected) CRC-32, as computed by the device */
+static unsigned int crc32_update(unsigned int crc, const unsigned char *data, unsigned int len)
+{
+    for (unsigned int i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return crc;
+}
+
+/* Download checkpoint of a device built with XUA_DFU_RESUME. Returns non-zero if the device does not report one */
+int xmos_dfu_dnload_state(unsigned int interface, unsigned int *active, unsigned int *blocks, unsigned int *crc,
+                          unsigned int *length)
+{
+    unsigned int data[4];
+    int numBytes = libusb_control_transfer(devh, DFU_REQUEST_FROM_DEV, XMOS_DFU_DNLOADSTATE, 0, interface, (unsigned char *)data, 16, 0);
+    if (numBytes != 16)
+    {
+        return -1;
+    }
+    *active = data[0];
+    *blocks = data[1];
+    *length = data[2];
+    *crc = data[3];
+    return 0;
+}
+
+/* Returns the block to continue an interrupted download of inFile from, leaving the file at that block, if the
+ * blocks the device has received match the start of the file. Otherwise returns 0 with the file rewound */
+static unsigned int dfu_resume_block(FILE *inFile, unsigned int total_blocks, unsigned int block_size)
+{
+    unsigned int active = 0, blocks = 0, deviceCrc = 0, length = 0;
+    unsigned int crc = 0xFFFFFFFF;
+    unsigned char block_data[DFU_MAX_TRANSFER_SIZE];
+
+    if ((xmos_dfu_dnload_state(0, &active, &blocks, &deviceCrc, &length) != 0) || !active || (blocks == 0))
+    {
+        printf("... No interrupted download to resume\n");
+        return 0;
+    }
+
+    if ((blocks <= total_blocks) && (length == blocks * block_size))
+    {
+        for (unsigned int i = 0; i < blocks; i++)
+        {
+            memset(block_data, 0x0, block_size);
+            fread(block_data, 1, block_size, inFile);
+            crc = crc32_update(crc, block_data, block_size);
+        }
+
+        if (~crc == deviceCrc)
+        {
+            printf("... Resuming download from block %u of %u\n", blocks, total_blocks);
+            return blocks;
+        }
+    }
+
+    printf("... Interrupted download does not match %u byte blocks of this image, starting again\n", block_size);
+    fseek(inFile, 0, SEEK_SET);
+    return 0;
+}
+
+int write_dfu_image(char *file, unsigned int resume)
 {
     unsigned int i = 0;
     FILE* inFile = NULL;
     int image_size = 0;
     unsigned int num_blocks = 0;
-    unsigned int block_size = 64;
+    unsigned int block_size = dfu_transfer_size;
     unsigned int remainder = 0;
-    unsigned char block_data[256];
+    unsigned char block_data[DFU_MAX_TRANSFER_SIZE];
 
     unsigned char dfuState = 0;
     unsigned char nextDfuState = 0;
@@ -291,7 +436,12 @@ int write_dfu_image(char *file)
 
     dfuBlockCount = 0;
 
-    for (i = 0; i < num_blocks; i++)
+    if (resume)
+    {
+        dfuBlockCount = dfu_resume_block(inFile, num_blocks + (remainder ? 1 : 0), block_size);
+    }
+
+    for (i = dfuBlockCount; i < num_blocks; i++)
     {
         memset(block_data, 0x0, block_size);
         fread(block_data, 1, block_size, inFile);
@@ -303,21 +453,21 @@ int write_dfu_image(char *file)
             return -1;
 
         }
-        dfu_getStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
+        dfu_waitStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
         dfuBlockCount++;
     }
 
-    if (remainder)
+    if (remainder && (dfuBlockCount == num_blocks))
     {
         memset(block_data, 0x0, block_size);
         fread(block_data, 1, remainder, inFile);
         dfu_download(0, dfuBlockCount, block_size, block_data);
-        dfu_getStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
+        dfu_waitStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
     }
 
     // 0 length download terminates
     dfu_download(0, 0, 0, NULL);
-    dfu_getStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
+    dfu_waitStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
 
     printf("... Download complete\n");
 
@@ -328,8 +478,8 @@ int read_dfu_image(char *file)
 {
     FILE *outFile = NULL;
     unsigned int block_count = 0;
-    unsigned int block_size = 64;
-    unsigned char block_data[64];
+    unsigned int block_size = dfu_transfer_size;
+    unsigned char block_data[DFU_MAX_TRANSFER_SIZE];
 
     outFile = fopen( file, "wb" );
     if( outFile == NULL )
@@ -343,7 +493,7 @@ int read_dfu_image(char *file)
     while (1)
     {
         unsigned int numBytes = 0;
-        numBytes = dfu_upload(0, block_count, 64, block_data);
+        numBytes = dfu_upload(0, block_count, block_size, block_data);
         /* Upload is completed when dfu_upload() returns an empty block */
         if (numBytes == 0)
         {
@@ -360,184 +510,1294 @@ int read_dfu_image(char *file)
             fprintf(stderr,"dfu_upload error (%d)\n", numBytes);
             break;
         }
-        fwrite(block_data, 1, block_size, outFile);
+        fwrite(block_data, 1, numBytes, outFile);
         block_count++;
+        /* A short block is the last */
+        if (numBytes < block_size)
+        {
+            break;
+        }
     }
 
     fclose(outFile);
     return 0;
 }
 
-static void print_device_list(FILE *file, const char *indent)
+/* Compares the CRC of the file, padded to whole flash pages, with the CRC the device computes over the same length
+ * of its upgrade image. Nothing is read back over USB */
+int verify_dfu_image(char *file)
 {
-    for (long unsigned int i = 0; i < sizeof(pidList)/sizeof(pidList[0]); i++)
+    FILE *inFile = NULL;
+    unsigned char page[FLASH_PAGE_SIZE];
+    unsigned int crc = 0xFFFFFFFF;
+    unsigned int pages = 0;
+    unsigned int deviceCrc = 0;
+    unsigned int deviceLength = 0;
+    size_t numBytes;
+
+    inFile = fopen( file, "rb" );
+    if( inFile == NULL )
     {
-        fprintf(file, "%s%-30s (0x%0x)\n", indent, pidList[i].device_name, pidList[i].pid);
+        fprintf(stderr,"Error: Failed to open input data file.\n");
+        return -1;
     }
-}
 
-static void print_usage(const char *program_name, const char *error_msg)
-{
-    fprintf(stderr, "ERROR: %s\n\n", error_msg);
-    fprintf(stderr, "Usage:\n");
-    fprintf(stderr, "     %s --listdevices\n", program_name);
-    fprintf(stderr, "     %s DEVICE_PID COMMAND\n", program_name);
+    printf("... Verifying image (%s) on device\n", file);
 
-    fprintf(stderr, "    Where DEVICE_PID can be a hex value or a name from:\n");
-    print_device_list(stderr, "      ");
+    while ((numBytes = fread(page, 1, FLASH_PAGE_SIZE, inFile)) > 0)
+    {
+        memset(page + numBytes, 0x0, FLASH_PAGE_SIZE - numBytes);
+        crc = crc32_update(crc, page, FLASH_PAGE_SIZE);
+        pages++;
+    }
+    fclose(inFile);
+    crc = ~crc;
 
-    fprintf(stderr, "    And COMMAND is one of:\n");
-    fprintf(stderr, "       --download <firmware> : write an upgrade image\n");
-    fprintf(stderr, "       --upload <firmware>   : read the upgrade image\n");
-    fprintf(stderr, "       --revertfactory       : revert to the factory image\n");
-    fprintf(stderr, "       --savecustomstate     : \n");
-    fprintf(stderr, "       --restorecustomstate  : \n");
+    if (pages > 0xffff)
+    {
+        fprintf(stderr,"Error: Image too large to verify.\n");
+        return -1;
+    }
 
-    exit(1);
-}
+    if (xmos_dfu_image_crc(0, pages, &deviceCrc, &deviceLength) != 0)
+    {
+        fprintf(stderr,"Error: Device did not return an image CRC.\n");
+        return -1;
+    }
 
-static unsigned int select_pid(char *device_pid)
-{
-    // Try interpreting the name as a hex value
-    char * endptr = device_pid;
-    int pid = strtol(device_pid, &endptr, 16);
-    if (endptr != device_pid && *endptr == '\0')
+    if (deviceLength != pages * FLASH_PAGE_SIZE)
     {
-        return pid;
+        printf("... Verify FAILED: device image is %u bytes, expected %u\n", deviceLength, pages * FLASH_PAGE_SIZE);
+        return -1;
     }
 
-    // Otherwise do a lookup of names
-    for (long unsigned int i = 0; i < sizeof(pidList)/sizeof(pidList[0]); i++)
+    if (deviceCrc != crc)
     {
-        if (strcmp(device_pid, pidList[i].device_name) == 0)
-        {
-            return pidList[i].pid;
-        }
+        printf("... Verify FAILED: CRC 0x%08x, expected 0x%08x\n", deviceCrc, crc);
+        return -1;
     }
 
-    fprintf(stderr, "Failed to find device '%s', should have been one of:\n", device_pid);
-    print_device_list(stderr, "  ");
+    printf("... Verify OK (CRC 0x%08x)\n", crc);
     return 0;
 }
 
-int main(int argc, char **argv)
+/* BATCH MODE: upgrades every matching device on the bus concurrently. Each device runs its own download state
+ * machine driven by asynchronous control transfers, all serviced from a single libusb event loop */
+
+#define BATCH_MAX_DEVICES 128
+#define BATCH_MAX_PORTS 7
+#define BATCH_TRANSFER_TIMEOUT_MS 5000
+#define BATCH_ENUM_TIMEOUT_MS (30 * 1000)
+
+#define DFU_STATUS_LEN 6
+#define DFU_STATE_ERROR 10
+
+/* Older libusb headers (as bundled for some platforms) lack these */
+#ifndef LIBUSB_CALL
+#define LIBUSB_CALL
+#endif
+#if defined(LIBUSB_API_VERSION)
+#define BATCH_HAVE_PORT_NUMBERS 1
+#else
+#define BATCH_HAVE_PORT_NUMBERS 0
+#endif
+
+typedef enum
 {
-    unsigned int download = 0;
-    unsigned int upload = 0;
-    unsigned int revert = 0;
-    unsigned int save = 0;
-    unsigned int restore = 0;
-    unsigned int listdev = 0;
+    BATCH_DNLOAD,       /* Block (or terminating zero length block) sent */
+    BATCH_STATUS,       /* GETSTATUS sent */
+    BATCH_POLL_WAIT,    /* Device busy, waiting out its poll timeout */
+    BATCH_VERIFY,       /* IMAGECRC sent */
+    BATCH_RESET,        /* RESETFROMDFU sent */
+    BATCH_DONE,
+    BATCH_FAILED
+} batch_state_t;
+
+typedef struct
+{
+    unsigned char bus;
+    unsigned char ports[BATCH_MAX_PORTS];
+    int num_ports;
+    char name[32];
+    unsigned char address;          /* Device address once opened in DFU mode */
+    libusb_device_handle *devh;
+    unsigned int interface;
+    unsigned int transfer_size;
+    unsigned int num_blocks;
+    unsigned int block;             /* Next block to send */
+    int terminated;                 /* Zero length block sent */
+    batch_state_t state;
+    struct libusb_transfer *xfer;
+    unsigned long long poll_time;
+    int last_percent;
+    unsigned char buffer[LIBUSB_CONTROL_SETUP_SIZE + DFU_MAX_TRANSFER_SIZE];
+} batch_device_t;
+
+typedef struct
+{
+    const unsigned char *image;
+    unsigned int image_size;
+    unsigned int image_pages;
+    unsigned int image_crc;
+} batch_image_t;
 
-    char *firmware_filename = NULL;
+static batch_image_t batch_image;
 
-    const char *program_name = argv[0];
+static unsigned long long batch_now_ms(void)
+{
+#ifdef _WIN32
+    return GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+#endif
+}
 
-    int r = libusb_init(NULL);
-    if (r < 0)
-    {
-        fprintf(stderr, "failed to initialise libusb\n");
-        return -1;
-    }
+static void batch_set_location(batch_device_t *d, libusb_device *dev)
+{
+    d->bus = libusb_get_bus_number(dev);
+#if BATCH_HAVE_PORT_NUMBERS
+    int len;
 
-    if (argc == 2)
+    d->num_ports = libusb_get_port_numbers(dev, d->ports, BATCH_MAX_PORTS);
+    if (d->num_ports < 0)
     {
-        if (strcmp(argv[1], "--listdevices") == 0)
-        {
-            find_xmos_device(0, 0, 1);
-            return 0;
-        }
-        print_usage(program_name, "Not enough options passed to dfu application");
+        d->num_ports = 0;
     }
 
-    if (argc < 3)
+    len = snprintf(d->name, sizeof(d->name), "%d-", d->bus);
+    for (int i = 0; i < d->num_ports && len < (int)sizeof(d->name); i++)
     {
-        print_usage(program_name, "Not enough options passed to dfu application");
+        len += snprintf(d->name + len, sizeof(d->name) - len, i ? ".%d" : "%d", d->ports[i]);
     }
+#else
+    d->num_ports = 0;
+    snprintf(d->name, sizeof(d->name), "%d:%d", d->bus, libusb_get_device_address(dev));
+#endif
+}
 
-    char *device_pid = argv[1];
-    char *command = argv[2];
+/* Devices keep their bus location across the reset into DFU mode. Without port numbers any device on the same bus
+ * is taken, the device address changes on reset */
+static int batch_same_location(batch_device_t *d, libusb_device *dev)
+{
+#if BATCH_HAVE_PORT_NUMBERS
+    unsigned char ports[BATCH_MAX_PORTS];
+    int num_ports = libusb_get_port_numbers(dev, ports, BATCH_MAX_PORTS);
 
-    if (strcmp(command, "--download") == 0)
+    return (libusb_get_bus_number(dev) == d->bus) && (num_ports == d->num_ports)
+        && (memcmp(ports, d->ports, num_ports) == 0);
+#else
+    return libusb_get_bus_number(dev) == d->bus;
+#endif
+}
+
+static void batch_fail(batch_device_t *d, const char *reason)
+{
+    printf("[%s] FAILED: %s\n", d->name, reason);
+    d->state = BATCH_FAILED;
+}
+
+static void LIBUSB_CALL batch_callback(struct libusb_transfer *xfer);
+
+static void batch_submit(batch_device_t *d, unsigned char bmRequestType, unsigned char bRequest,
+                         unsigned short wValue, unsigned short wLength, batch_state_t state)
+{
+    libusb_fill_control_setup(d->buffer, bmRequestType, bRequest, wValue, d->interface, wLength);
+    libusb_fill_control_transfer(d->xfer, d->devh, d->buffer, batch_callback, d, BATCH_TRANSFER_TIMEOUT_MS);
+    d->state = state;
+
+    if (libusb_submit_transfer(d->xfer) != 0)
     {
-        if (argc < 4)
-        {
-            print_usage(program_name, "No filename specified for download option");
-        }
-        firmware_filename = argv[3];
-        download = 1;
+        batch_fail(d, "could not submit transfer");
     }
-    else if (strcmp(command, "--upload") == 0)
+}
+
+static void batch_send_block(batch_device_t *d)
+{
+    unsigned int offset = d->block * d->transfer_size;
+    unsigned int len = d->transfer_size;
+    unsigned char *data = d->buffer + LIBUSB_CONTROL_SETUP_SIZE;
+
+    /* Pad the last block */
+    memset(data, 0x0, d->transfer_size);
+    if (offset + len > batch_image.image_size)
     {
-        if (argc < 4)
-        {
-            print_usage(program_name, "No filename specified for upload option");
-        }
-        firmware_filename = argv[3];
-        upload = 1;
+        len = batch_image.image_size - offset;
     }
-    else if (strcmp(command, "--revertfactory") == 0)
+    memcpy(data, batch_image.image + offset, len);
+
+    batch_submit(d, DFU_REQUEST_TO_DEV, DFU_DNLOAD, d->block, d->transfer_size, BATCH_DNLOAD);
+}
+
+static void batch_progress(batch_device_t *d)
+{
+    int percent = d->num_blocks ? (int)((d->block * 100) / d->num_blocks) : 100;
+
+    if (percent / 10 != d->last_percent / 10)
     {
-        revert = 1;
+        printf("[%s] %3d%%\n", d->name, percent);
+        d->last_percent = percent;
     }
-    else if(strcmp(command, "--savecustomstate") == 0)
+}
+
+static void batch_status(batch_device_t *d, const unsigned char *status)
+{
+    unsigned int bStatus = status[0];
+    unsigned int timeout = status[1] | (status[2] << 8) | (status[3] << 16);
+    unsigned int bState = status[4];
+
+    if ((bStatus != 0) || (bState == DFU_STATE_ERROR))
     {
-        save = 1;
+        batch_fail(d, "device reported an error");
     }
-    else if(strcmp(command, "--restorecustomstate") == 0)
+    else if (bState == DFU_STATE_DNBUSY)
     {
-        restore = 1;
+        d->poll_time = batch_now_ms() + timeout;
+        d->state = BATCH_POLL_WAIT;
     }
-    else
+    else if (d->terminated)
     {
-        print_usage(program_name,  "Invalid option passed to dfu application");
+        batch_submit(d, DFU_REQUEST_FROM_DEV, XMOS_DFU_IMAGECRC, batch_image.image_pages, 8, BATCH_VERIFY);
     }
-
-    unsigned int pid = select_pid(device_pid);
-    if (pid == 0)
+    else if (d->block < d->num_blocks)
     {
-        return -1;
+        batch_send_block(d);
     }
-//#define START_IN_DFU 1
-#ifndef START_IN_DFU
-    r = find_xmos_device(0, pid, 0);
-    if (r < 0)
+    else
     {
-        fprintf(stderr, "Could not find/open device\n");
-        return -1;
+        /* 0 length download terminates */
+        d->terminated = 1;
+        batch_submit(d, DFU_REQUEST_TO_DEV, DFU_DNLOAD, 0, 0, BATCH_DNLOAD);
     }
+}
 
-    r = libusb_claim_interface(devh, XMOS_DFU_IF);
-    if (r < 0)
+static void batch_verify(batch_device_t *d, const unsigned char *data)
+{
+    unsigned int crc = data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+    unsigned int length = data[4] | (data[5] << 8) | (data[6] << 16) | ((unsigned int)data[7] << 24);
+
+    if ((length != batch_image.image_pages * FLASH_PAGE_SIZE) || (crc != batch_image.image_crc))
     {
-        fprintf(stderr, "Error claiming interface %d %d\n", XMOS_DFU_IF, r);
-        return -1;
+        batch_fail(d, "verify failed");
+        return;
     }
-    printf("XMOS DFU application started - Interface %d claimed\n", XMOS_DFU_IF);
-#endif
 
-    /* Dont go into DFU mode for save/restore */
-    if(save)
+    printf("[%s] Verify OK\n", d->name);
+    batch_submit(d, DFU_REQUEST_TO_DEV, XMOS_DFU_RESETFROMDFU, 0, 0, BATCH_RESET);
+}
+
+static void LIBUSB_CALL batch_callback(struct libusb_transfer *xfer)
+{
+    batch_device_t *d = (batch_device_t *)xfer->user_data;
+    const unsigned char *data = libusb_control_transfer_get_data(xfer);
+
+    /* The device resets as it acknowledges RESETFROMDFU, so any outcome is success */
+    if (d->state == BATCH_RESET)
     {
-        xmos_dfu_save_state(XMOS_DFU_IF);
+        printf("[%s] Done\n", d->name);
+        d->state = BATCH_DONE;
+        return;
     }
-    else if(restore)
+
+    if (xfer->status != LIBUSB_TRANSFER_COMPLETED)
     {
-        xmos_dfu_restore_state(XMOS_DFU_IF);
+        batch_fail(d, xfer->status == LIBUSB_TRANSFER_TIMED_OUT ? "transfer timed out" : "transfer error");
+        return;
     }
-    else if(!listdev)
-    {
-#ifndef START_IN_DFU
-        printf("Detaching device from application mode.\n");
-        xmos_dfu_resetintodfu(XMOS_DFU_IF);
-
-        libusb_release_interface(devh, XMOS_DFU_IF);
-        libusb_close(devh);
-
-        printf("Waiting for device to restart and enter DFU mode...\n");
 
-        // Wait for device to enter dfu mode and restart
-        Sleep(20 * 1000);
+    switch (d->state)
+    {
+        case BATCH_DNLOAD:
+            if (!d->terminated)
+            {
+                d->block++;
+                batch_progress(d);
+            }
+            batch_submit(d, DFU_REQUEST_FROM_DEV, DFU_GETSTATUS, 0, DFU_STATUS_LEN, BATCH_STATUS);
+            break;
+
+        case BATCH_STATUS:
+            if (xfer->actual_length < DFU_STATUS_LEN)
+            {
+                batch_fail(d, "short status");
+                break;
+            }
+            batch_status(d, data);
+            break;
+
+        case BATCH_VERIFY:
+            if (xfer->actual_length < 8)
+            {
+                batch_fail(d, "no image CRC");
+                break;
+            }
+            batch_verify(d, data);
+            break;
+
+        default:
+            break;
+    }
+}
+
+/* Sends every matching device in application mode into DFU mode, recording where each one is on the bus */
+static int batch_detach(unsigned int pid, batch_device_t *devices)
+{
+    libusb_device **devs;
+    libusb_device *dev;
+    int num_devices = 0;
+    int i = 0;
+
+    if (libusb_get_device_list(NULL, &devs) < 0)
+    {
+        return 0;
+    }
+
+    while ((dev = devs[i++]) != NULL && num_devices < BATCH_MAX_DEVICES)
+    {
+        struct libusb_device_descriptor desc;
+        libusb_device_handle *h;
+        unsigned int interface = 0;
+        unsigned int transfer_size = DFU_DEFAULT_TRANSFER_SIZE;
+        unsigned int protocol = 0;
+
+        libusb_get_device_descriptor(dev, &desc);
+        if (desc.idVendor != XMOS_VID || desc.idProduct != pid)
+        {
+            continue;
+        }
+
+        if (get_dfu_interface(dev, &interface, &transfer_size, &protocol) < 0 || libusb_open(dev, &h) < 0)
+        {
+            continue;
+        }
+
+        batch_device_t *d = &devices[num_devices++];
+        batch_set_location(d, dev);
+
+        /* Devices already in DFU mode are just picked up again below */
+        if (protocol != 2 && libusb_claim_interface(h, interface) == 0)
+        {
+            printf("[%s] Detaching device from application mode\n", d->name);
+            libusb_control_transfer(h, DFU_REQUEST_TO_DEV, XMOS_DFU_RESETINTODFU, 0, interface, NULL, 0,
+                BATCH_TRANSFER_TIMEOUT_MS);
+            libusb_release_interface(h, interface);
+        }
+        libusb_close(h);
+    }
+
+    libusb_free_device_list(devs, 1);
+    return num_devices;
+}
+
+/* Waits for each device to reappear in DFU mode at the same bus location, and opens it */
+static int batch_open(unsigned int pid, batch_device_t *devices, int num_devices)
+{
+    unsigned long long start = batch_now_ms();
+    int num_open = 0;
+
+    while (num_open < num_devices && batch_now_ms() - start < BATCH_ENUM_TIMEOUT_MS)
+    {
+        libusb_device **devs;
+        libusb_device *dev;
+        int i = 0;
+
+        Sleep(500);
+
+        if (libusb_get_device_list(NULL, &devs) < 0)
+        {
+            continue;
+        }
+
+        while ((dev = devs[i++]) != NULL)
+        {
+            struct libusb_device_descriptor desc;
+            unsigned int protocol = 0;
+
+            libusb_get_device_descriptor(dev, &desc);
+            if (desc.idVendor != XMOS_VID || desc.idProduct != pid)
+            {
+                continue;
+            }
+
+            /* Skip devices opened on an earlier pass */
+            int opened = 0;
+            for (int j = 0; j < num_devices; j++)
+            {
+                if (devices[j].devh && devices[j].bus == libusb_get_bus_number(dev)
+                    && devices[j].address == libusb_get_device_address(dev))
+                {
+                    opened = 1;
+                }
+            }
+            if (opened)
+            {
+                continue;
+            }
+
+            for (int j = 0; j < num_devices; j++)
+            {
+                batch_device_t *d = &devices[j];
+
+                if (d->devh || !batch_same_location(d, dev))
+                {
+                    continue;
+                }
+
+                d->interface = 0;
+                d->transfer_size = DFU_DEFAULT_TRANSFER_SIZE;
+                if (get_dfu_interface(dev, &d->interface, &d->transfer_size, &protocol) < 0 || protocol != 2)
+                {
+                    /* Not yet reset into DFU mode */
+                    break;
+                }
+
+                if (libusb_open(dev, &d->devh) < 0)
+                {
+                    d->devh = NULL;
+                    break;
+                }
+
+                if (libusb_claim_interface(d->devh, d->interface) != 0)
+                {
+                    libusb_close(d->devh);
+                    d->devh = NULL;
+                    break;
+                }
+
+                d->address = libusb_get_device_address(dev);
+                printf("[%s] DFU mode, transfer size %u\n", d->name, d->transfer_size);
+                num_open++;
+                break;
+            }
+        }
+
+        libusb_free_device_list(devs, 1);
+    }
+
+    return num_open;
+}
+
+int batch_download(unsigned int pid, char *file)
+{
+    FILE *inFile = NULL;
+    unsigned char *image = NULL;
+    long image_size;
+    batch_device_t *devices;
+    int num_devices;
+    int active;
+    int num_done = 0;
+
+    inFile = fopen( file, "rb" );
+    if( inFile == NULL )
+    {
+        fprintf(stderr,"Error: Failed to open input data file.\n");
+        return -1;
+    }
+
+    fseek(inFile, 0, SEEK_END);
+    image_size = ftell(inFile);
+    fseek(inFile, 0, SEEK_SET);
+
+    /* Verify takes the length in pages in a 16 bit field */
+    if (image_size <= 0 || ((image_size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE) > 0xffff)
+    {
+        fprintf(stderr,"Error: Input data file is empty or too large.\n");
+        fclose(inFile);
+        return -1;
+    }
+
+    /* Kept padded with zeros to whole flash pages, as it is stored on the device */
+    batch_image.image_pages = (image_size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    image = (unsigned char *)calloc(batch_image.image_pages * FLASH_PAGE_SIZE, 1);
+    if (image == NULL || fread(image, 1, image_size, inFile) != (size_t)image_size)
+    {
+        fprintf(stderr,"Error: Failed to read input data file.\n");
+        fclose(inFile);
+        free(image);
+        return -1;
+    }
+    fclose(inFile);
+
+    batch_image.image = image;
+    batch_image.image_size = image_size;
+    batch_image.image_crc = ~crc32_update(0xFFFFFFFF, image, batch_image.image_pages * FLASH_PAGE_SIZE);
+
+    devices = (batch_device_t *)calloc(BATCH_MAX_DEVICES, sizeof(batch_device_t));
+    if (devices == NULL)
+    {
+        free(image);
+        return -1;
+    }
+
+    num_devices = batch_detach(pid, devices);
+    if (num_devices == 0)
+    {
+        fprintf(stderr, "Could not find/open device\n");
+        free(devices);
+        free(image);
+        return -1;
+    }
+
+    printf("Waiting for %d device(s) to restart and enter DFU mode...\n", num_devices);
+    batch_open(pid, devices, num_devices);
+
+    printf("... Downloading image (%s) to devices\n", file);
+
+    for (int i = 0; i < num_devices; i++)
+    {
+        batch_device_t *d = &devices[i];
+
+        if (d->devh == NULL)
+        {
+            batch_fail(d, "did not enter DFU mode");
+            continue;
+        }
+
+        d->num_blocks = (image_size + d->transfer_size - 1) / d->transfer_size;
+        d->last_percent = -10;
+        d->xfer = libusb_alloc_transfer(0);
+        if (d->xfer == NULL)
+        {
+            batch_fail(d, "could not allocate transfer");
+            continue;
+        }
+        batch_progress(d);
+        batch_send_block(d);
+    }
+
+    do
+    {
+        struct timeval tv = {0, 10000};
+        unsigned long long now;
+
+        libusb_handle_events_timeout(NULL, &tv);
+
+        now = batch_now_ms();
+        active = 0;
+        for (int i = 0; i < num_devices; i++)
+        {
+            batch_device_t *d = &devices[i];
+
+            if (d->state == BATCH_POLL_WAIT && now >= d->poll_time)
+            {
+                batch_submit(d, DFU_REQUEST_FROM_DEV, DFU_GETSTATUS, 0, DFU_STATUS_LEN, BATCH_STATUS);
+            }
+            if (d->state != BATCH_DONE && d->state != BATCH_FAILED)
+            {
+                active++;
+            }
+        }
+    } while (active);
+
+    for (int i = 0; i < num_devices; i++)
+    {
+        batch_device_t *d = &devices[i];
+
+        if (d->state == BATCH_DONE)
+        {
+            num_done++;
+        }
+        if (d->xfer)
+        {
+            libusb_free_transfer(d->xfer);
+        }
+        if (d->devh)
+        {
+            libusb_release_interface(d->devh, d->interface);
+            libusb_close(d->devh);
+        }
+    }
+
+    printf("... %d of %d devices upgraded\n", num_done, num_devices);
+
+    free(devices);
+    free(image);
+
+    return (num_done == num_devices) ? 0 : -1;
+}
+
+/* DELTA MODE: the new image is sent as pages copied from the installed upgrade image plus literal pages, which the
+ * device (built with XUA_DFU_DELTA) reconstructs in flash */
+
+/* Reads a file padded with zeros to whole flash pages, as it is stored on the device */
+static unsigned char *read_image_pages(const char *file, unsigned int *pages)
+{
+    FILE *inFile = fopen(file, "rb");
+    unsigned char *image = NULL;
+    long size;
+
+    if (inFile == NULL)
+    {
+        fprintf(stderr,"Error: Failed to open input data file %s.\n", file);
+        return NULL;
+    }
+
+    if ((fseek(inFile, 0, SEEK_END) != 0) || ((size = ftell(inFile)) <= 0) || (fseek(inFile, 0, SEEK_SET) != 0))
+    {
+        fprintf(stderr,"Error: Failed to discover size of %s.\n", file);
+        fclose(inFile);
+        return NULL;
+    }
+
+    *pages = (size + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE;
+    image = (unsigned char *)calloc(*pages * FLASH_PAGE_SIZE, 1);
+    if (image == NULL || fread(image, 1, size, inFile) != (size_t)size)
+    {
+        fprintf(stderr,"Error: Failed to read %s.\n", file);
+        free(image);
+        image = NULL;
+    }
+    fclose(inFile);
+    return image;
+}
+
+static void put_word(unsigned char *p, unsigned int word)
+{
+    p[0] = word & 0xff;
+    p[1] = (word >> 8) & 0xff;
+    p[2] = (word >> 16) & 0xff;
+    p[3] = (word >> 24) & 0xff;
+}
+
+#define DELTA_HASH_BASE 257u
+#define DELTA_MAX_CANDIDATES 64
+
+/* Polynomial hash of a page, as rolled over the installed image */
+static unsigned int delta_hash(const unsigned char *data)
+{
+    unsigned int h = 0;
+    for (int i = 0; i < FLASH_PAGE_SIZE; i++)
+    {
+        h = (h * DELTA_HASH_BASE) + data[i];
+    }
+    return h;
+}
+
+/* Builds the delta of new_image against old_image. Each page of the new image is matched against every byte offset
+ * of the installed image, continuing the previous copy where it still matches. Returns the delta, its size in
+ * size, or NULL */
+static unsigned char *make_delta(const unsigned char *old_image, unsigned int old_pages,
+                                 const unsigned char *new_image, unsigned int new_pages, unsigned int *size)
+{
+    unsigned int old_size = old_pages * FLASH_PAGE_SIZE;
+    unsigned int windows = old_size - FLASH_PAGE_SIZE + 1;
+    unsigned int table_size = 1;
+    unsigned char *delta;
+    unsigned int *head, *next;
+    int *src;
+    unsigned int pos = 0;
+
+    while (table_size < windows)
+    {
+        table_size <<= 1;
+    }
+
+    head = (unsigned int *)malloc(table_size * sizeof(unsigned int));
+    next = (unsigned int *)malloc(windows * sizeof(unsigned int));
+    src = (int *)malloc(new_pages * sizeof(int));
+    delta = (unsigned char *)calloc((DFU_DELTA_HEADER_WORDS * 4) + (new_pages * (FLASH_PAGE_SIZE + 8)), 1);
+    if (!head || !next || !src || !delta)
+    {
+        free(head); free(next); free(src); free(delta);
+        return NULL;
+    }
+
+    /* Index every page sized window of the installed image by its hash */
+    memset(head, 0xff, table_size * sizeof(unsigned int));
+    {
+        unsigned int h = delta_hash(old_image);
+        unsigned int top = 1;
+        for (int i = 1; i < FLASH_PAGE_SIZE; i++)
+        {
+            top *= DELTA_HASH_BASE;
+        }
+
+        for (unsigned int offset = 0; offset < windows; offset++)
+        {
+            next[offset] = head[h & (table_size - 1)];
+            head[h & (table_size - 1)] = offset;
+
+            if (offset + FLASH_PAGE_SIZE < old_size)
+            {
+                h = ((h - (old_image[offset] * top)) * DELTA_HASH_BASE) + old_image[offset + FLASH_PAGE_SIZE];
+            }
+        }
+    }
+
+    for (unsigned int p = 0; p < new_pages; p++)
+    {
+        const unsigned char *page = new_image + (p * FLASH_PAGE_SIZE);
+        src[p] = -1;
+
+        if ((p > 0) && (src[p - 1] >= 0) && ((unsigned int)(src[p - 1] + 2 * FLASH_PAGE_SIZE) <= old_size)
+            && (memcmp(old_image + src[p - 1] + FLASH_PAGE_SIZE, page, FLASH_PAGE_SIZE) == 0))
+        {
+            src[p] = src[p - 1] + FLASH_PAGE_SIZE;
+            continue;
+        }
+
+        unsigned int candidate = head[delta_hash(page) & (table_size - 1)];
+        for (int c = 0; (candidate != 0xffffffff) && (c < DELTA_MAX_CANDIDATES); c++)
+        {
+            if (memcmp(old_image + candidate, page, FLASH_PAGE_SIZE) == 0)
+            {
+                src[p] = candidate;
+                break;
+            }
+            candidate = next[candidate];
+        }
+    }
+
+    put_word(delta + 0, DFU_DELTA_MAGIC);
+    put_word(delta + 4, DFU_DELTA_VERSION);
+    put_word(delta + 8, old_pages);
+    put_word(delta + 12, ~crc32_update(0xFFFFFFFF, old_image, old_size));
+    put_word(delta + 16, new_pages);
+    pos = DFU_DELTA_HEADER_WORDS * 4;
+
+    /* Runs of literal pages, and of pages copied from consecutive pages of the installed image, are one command */
+    for (unsigned int p = 0; p < new_pages;)
+    {
+        unsigned int run = 1;
+
+        if (src[p] < 0)
+        {
+            while ((p + run < new_pages) && (src[p + run] < 0) && (run < DFU_DELTA_MAX_COUNT))
+            {
+                run++;
+            }
+            put_word(delta + pos, (DFU_DELTA_CMD_DATA << 28) | run);
+            memcpy(delta + pos + 4, new_image + (p * FLASH_PAGE_SIZE), run * FLASH_PAGE_SIZE);
+            pos += 4 + (run * FLASH_PAGE_SIZE);
+        }
+        else
+        {
+            while ((p + run < new_pages) && (src[p + run] == (int)(src[p] + run * FLASH_PAGE_SIZE))
+                && (run < DFU_DELTA_MAX_COUNT))
+            {
+                run++;
+            }
+            put_word(delta + pos, (DFU_DELTA_CMD_COPY << 28) | run);
+            put_word(delta + pos + 4, src[p]);
+            pos += 8;
+        }
+        p += run;
+    }
+
+    free(head);
+    free(next);
+    free(src);
+
+    *size = pos;
+    return delta;
+}
+
+/* Downloads a delta or compressed image in blocks of dfu_transfer_size, the last padded with zeros (which the device
+ * ignores), and terminates the download */
+static int download_stream(unsigned char *data, unsigned int size, const char *kind)
+{
+    unsigned char block_data[DFU_MAX_TRANSFER_SIZE];
+    unsigned int block_size = dfu_transfer_size;
+    unsigned char dfuState = 0;
+    unsigned char nextDfuState = 0;
+    unsigned int timeout = 0;
+    unsigned char strIndex = 0;
+    unsigned int block = 0;
+
+    for (unsigned int offset = 0; offset < size; offset += block_size)
+    {
+        unsigned int len = (size - offset) < block_size ? (size - offset) : block_size;
+
+        memset(block_data, 0x0, block_size);
+        memcpy(block_data, data + offset, len);
+
+        if (dfu_download(0, block++, block_size, block_data) != block_size)
+        {
+            fprintf(stderr,"Error: Device refused the %s image, it may not support %s images.\n", kind, kind);
+            return -1;
+        }
+        dfu_waitStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
+        if (nextDfuState == DFU_STATE_ERROR)
+        {
+            fprintf(stderr,"Error: Device reported an error.\n");
+            return -1;
+        }
+    }
+
+    // 0 length download terminates
+    dfu_download(0, 0, 0, NULL);
+    dfu_waitStatus(0, &dfuState, &timeout, &nextDfuState, &strIndex);
+
+    printf("... Download complete\n");
+    return 0;
+}
+
+/* Downloads a delta of file against installed, having checked with XMOS_DFU_IMAGECRC that installed is the image
+ * on the device, then verifies the result */
+int write_dfu_delta(char *installed, char *file)
+{
+    unsigned int old_pages = 0, new_pages = 0, delta_size = 0;
+    unsigned char *old_image, *new_image, *delta;
+    unsigned int deviceCrc = 0, deviceLength = 0;
+    int result;
+
+    old_image = read_image_pages(installed, &old_pages);
+    new_image = read_image_pages(file, &new_pages);
+    if (!old_image || !new_image || (old_pages > 0xffff))
+    {
+        free(old_image);
+        free(new_image);
+        return -1;
+    }
+
+    if ((xmos_dfu_image_crc(0, old_pages, &deviceCrc, &deviceLength) != 0)
+        || (deviceLength != old_pages * FLASH_PAGE_SIZE)
+        || (deviceCrc != ~crc32_update(0xFFFFFFFF, old_image, old_pages * FLASH_PAGE_SIZE)))
+    {
+        fprintf(stderr,"Error: The upgrade image on the device is not %s.\n", installed);
+        free(old_image);
+        free(new_image);
+        return -1;
+    }
+
+    delta = make_delta(old_image, old_pages, new_image, new_pages, &delta_size);
+    free(old_image);
+    free(new_image);
+    if (delta == NULL)
+    {
+        fprintf(stderr,"Error: Failed to create delta.\n");
+        return -1;
+    }
+
+    printf("... Downloading delta of %s (%u bytes for an image of %u bytes) to device\n", file, delta_size,
+           new_pages * FLASH_PAGE_SIZE);
+
+    result = download_stream(delta, delta_size, "delta");
+    free(delta);
+
+    if (result == 0)
+    {
+        result = verify_dfu_image(file);
+    }
+    return result;
+}
+
+/* COMPRESSED MODE: the image is sent as an LZ stream with a window small enough for the device (built with
+ * XUA_DFU_COMPRESS) to keep, see dfu_types.h in lib_xua */
+#define DFU_LZ_MAGIC            0x315a4c44
+#define DFU_LZ_VERSION          1
+#define DFU_LZ_HEADER_WORDS     16
+#define DFU_LZ_MATCH            0x80
+#define DFU_LZ_MIN_MATCH        3
+#define DFU_LZ_MAX_MATCH        (0x7f + DFU_LZ_MIN_MATCH)
+#define DFU_LZ_MAX_LITERALS     0x80
+#define DFU_LZ_WINDOW           512     /* Default XUA_DFU_COMPRESS_WINDOW */
+#define DFU_LZ_HASH_SIZE        4096
+
+static unsigned int lz_hash(const unsigned char *data)
+{
+    return ((data[0] << 8) ^ (data[1] << 4) ^ data[2]) & (DFU_LZ_HASH_SIZE - 1);
+}
+
+/* Greedy LZ compression of image, the longest match within the window being found through hash chains of each
+ * position's first DFU_LZ_MIN_MATCH bytes. Returns the compressed image, its size in size, or NULL */
+static unsigned char *make_compressed(const unsigned char *image, unsigned int pages, unsigned int *size)
+{
+    unsigned int length = pages * FLASH_PAGE_SIZE;
+    unsigned char *out;
+    int *head, *prev;
+    unsigned int pos = DFU_LZ_HEADER_WORDS * 4;
+    unsigned int literal_start = 0, literals = 0;
+
+    /* Worst case, all literals */
+    out = (unsigned char *)calloc(pos + length + (length / DFU_LZ_MAX_LITERALS) + 1, 1);
+    head = (int *)malloc(DFU_LZ_HASH_SIZE * sizeof(int));
+    prev = (int *)malloc(length * sizeof(int));
+    if (!out || !head || !prev)
+    {
+        free(out); free(head); free(prev);
+        return NULL;
+    }
+
+    for (int i = 0; i < DFU_LZ_HASH_SIZE; i++)
+    {
+        head[i] = -1;
+    }
+
+    put_word(out + 0, DFU_LZ_MAGIC);
+    put_word(out + 4, DFU_LZ_VERSION);
+    put_word(out + 8, DFU_LZ_WINDOW);
+    put_word(out + 12, pages);
+
+    for (unsigned int i = 0; i < length;)
+    {
+        unsigned int best_len = 0, best_dist = 0;
+        unsigned int step;
+
+        if (i + DFU_LZ_MIN_MATCH <= length)
+        {
+            for (int c = head[lz_hash(image + i)]; (c >= 0) && ((i - c) <= DFU_LZ_WINDOW); c = prev[c])
+            {
+                unsigned int len = 0;
+                while ((len < DFU_LZ_MAX_MATCH) && (i + len < length) && (image[c + len] == image[i + len]))
+                {
+                    len++;
+                }
+                if (len > best_len)
+                {
+                    best_len = len;
+                    best_dist = i - c;
+                    if (len == DFU_LZ_MAX_MATCH)
+                    {
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (best_len < DFU_LZ_MIN_MATCH)
+        {
+            if (literals == 0)
+            {
+                literal_start = i;
+            }
+            literals++;
+            step = 1;
+        }
+        else
+        {
+            step = best_len;
+        }
+
+        /* Flush literals ahead of a match, or once a run is full */
+        if (literals && ((step > 1) || (literals == DFU_LZ_MAX_LITERALS) || (i + 1 == length)))
+        {
+            out[pos++] = literals - 1;
+            memcpy(out + pos, image + literal_start, literals);
+            pos += literals;
+            literals = 0;
+        }
+
+        if (step > 1)
+        {
+            out[pos++] = DFU_LZ_MATCH | (best_len - DFU_LZ_MIN_MATCH);
+            out[pos++] = (best_dist - 1) & 0xff;
+            out[pos++] = (best_dist - 1) >> 8;
+        }
+
+        for (unsigned int j = 0; j < step; j++, i++)
+        {
+            if (i + DFU_LZ_MIN_MATCH <= length)
+            {
+                unsigned int h = lz_hash(image + i);
+                prev[i] = head[h];
+                head[h] = i;
+            }
+        }
+    }
+
+    free(head);
+    free(prev);
+
+    *size = pos;
+    return out;
+}
+
+/* Downloads file compressed, then verifies the result */
+int write_dfu_compressed(char *file)
+{
+    unsigned int pages = 0, compressed_size = 0;
+    unsigned char *image, *compressed;
+    int result;
+
+    image = read_image_pages(file, &pages);
+    if (image == NULL)
+    {
+        return -1;
+    }
+
+    compressed = make_compressed(image, pages, &compressed_size);
+    free(image);
+    if (compressed == NULL)
+    {
+        fprintf(stderr,"Error: Failed to compress image.\n");
+        return -1;
+    }
+
+    printf("... Downloading %s compressed (%u bytes for an image of %u bytes) to device\n", file, compressed_size,
+           pages * FLASH_PAGE_SIZE);
+
+    result = download_stream(compressed, compressed_size, "compressed");
+    free(compressed);
+
+    if (result == 0)
+    {
+        result = verify_dfu_image(file);
+    }
+    return result;
+}
+
+static void print_device_list(FILE *file, const char *indent)
+{
+    for (long unsigned int i = 0; i < sizeof(pidList)/sizeof(pidList[0]); i++)
+    {
+        fprintf(file, "%s%-30s (0x%0x)\n", indent, pidList[i].device_name, pidList[i].pid);
+    }
+}
+
+static void print_usage(const char *program_name, const char *error_msg)
+{
+    fprintf(stderr, "ERROR: %s\n\n", error_msg);
+    fprintf(stderr, "Usage:\n");
+    fprintf(stderr, "     %s --listdevices\n", program_name);
+    fprintf(stderr, "     %s DEVICE_PID COMMAND\n", program_name);
+
+    fprintf(stderr, "    Where DEVICE_PID can be a hex value or a name from:\n");
+    print_device_list(stderr, "      ");
+
+    fprintf(stderr, "    And COMMAND is one of:\n");
+    fprintf(stderr, "       --download <firmware> : write an upgrade image\n");
+    fprintf(stderr, "       --upload <firmware>   : read the upgrade image\n");
+    fprintf(stderr, "       --verify <firmware>   : check the upgrade image matches, by CRC on the device\n");
+    fprintf(stderr, "       --download-resume <firmware> : continue an interrupted download of an upgrade image,\n");
+    fprintf(stderr, "                                   or start it if there is none to continue\n");
+    fprintf(stderr, "       --download-delta <installed> <firmware> : write an upgrade image as a delta against the\n");
+    fprintf(stderr, "                                   installed upgrade image, then verify it\n");
+    fprintf(stderr, "       --download-compressed <firmware> : write an upgrade image compressed, then verify it\n");
+    fprintf(stderr, "       --download-all <firmware> : write and verify an upgrade image on every matching device,\n");
+    fprintf(stderr, "                                   concurrently\n");
+    fprintf(stderr, "       --revertfactory       : revert to the factory image\n");
+    fprintf(stderr, "       --savecustomstate     : \n");
+    fprintf(stderr, "       --restorecustomstate  : \n");
+
+    exit(1);
+}
+
+static unsigned int select_pid(char *device_pid)
+{
+    // Try interpreting the name as a hex value
+    char * endptr = device_pid;
+    int pid = strtol(device_pid, &endptr, 16);
+    if (endptr != device_pid && *endptr == '\0')
+    {
+        return pid;
+    }
+
+    // Otherwise do a lookup of names
+    for (long unsigned int i = 0; i < sizeof(pidList)/sizeof(pidList[0]); i++)
+    {
+        if (strcmp(device_pid, pidList[i].device_name) == 0)
+        {
+            return pidList[i].pid;
+        }
+    }
+
+    fprintf(stderr, "Failed to find device '%s', should have been one of:\n", device_pid);
+    print_device_list(stderr, "  ");
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int download = 0;
+    unsigned int resume = 0;
+    unsigned int delta = 0;
+    unsigned int compressed = 0;
+    unsigned int upload = 0;
+    unsigned int verify = 0;
+    unsigned int batch = 0;
+    unsigned int revert = 0;
+    unsigned int save = 0;
+    unsigned int restore = 0;
+    unsigned int listdev = 0;
+
+    char *firmware_filename = NULL;
+    char *installed_filename = NULL;
+
+    const char *program_name = argv[0];
+
+    int r = libusb_init(NULL);
+    if (r < 0)
+    {
+        fprintf(stderr, "failed to initialise libusb\n");
+        return -1;
+    }
+
+    if (argc == 2)
+    {
+        if (strcmp(argv[1], "--listdevices") == 0)
+        {
+            find_xmos_device(0, 0, 1);
+            return 0;
+        }
+        print_usage(program_name, "Not enough options passed to dfu application");
+    }
+
+    if (argc < 3)
+    {
+        print_usage(program_name, "Not enough options passed to dfu application");
+    }
+
+    char *device_pid = argv[1];
+    char *command = argv[2];
+
+    if (strcmp(command, "--download") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(program_name, "No filename specified for download option");
+        }
+        firmware_filename = argv[3];
+        download = 1;
+    }
+    else if (strcmp(command, "--download-resume") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(program_name, "No filename specified for download-resume option");
+        }
+        firmware_filename = argv[3];
+        download = 1;
+        resume = 1;
+    }
+    else if (strcmp(command, "--download-delta") == 0)
+    {
+        if (argc < 5)
+        {
+            print_usage(program_name, "Installed and new filenames required for download-delta option");
+        }
+        installed_filename = argv[3];
+        firmware_filename = argv[4];
+        delta = 1;
+    }
+    else if (strcmp(command, "--download-compressed") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(program_name, "Target filename required for download-compressed option");
+        }
+        firmware_filename = argv[3];
+        compressed = 1;
+    }
+    else if (strcmp(command, "--upload") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(program_name, "No filename specified for upload option");
+        }
+        firmware_filename = argv[3];
+        upload = 1;
+    }
+    else if (strcmp(command, "--verify") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(program_name, "No filename specified for verify option");
+        }
+        firmware_filename = argv[3];
+        verify = 1;
+    }
+    else if (strcmp(command, "--download-all") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(program_name, "No filename specified for download-all option");
+        }
+        firmware_filename = argv[3];
+        batch = 1;
+    }
+    else if (strcmp(command, "--revertfactory") == 0)
+    {
+        revert = 1;
+    }
+    else if(strcmp(command, "--savecustomstate") == 0)
+    {
+        save = 1;
+    }
+    else if(strcmp(command, "--restorecustomstate") == 0)
+    {
+        restore = 1;
+    }
+    else
+    {
+        print_usage(program_name,  "Invalid option passed to dfu application");
+    }
+
+    unsigned int pid = select_pid(device_pid);
+    if (pid == 0)
+    {
+        return -1;
+    }
+
+    if (batch)
+    {
+        r = batch_download(pid, firmware_filename);
+        libusb_exit(NULL);
+        return r;
+    }
+//#define START_IN_DFU 1
+#ifndef START_IN_DFU
+    r = find_xmos_device(0, pid, 0);
+    if (r < 0)
+    {
+        fprintf(stderr, "Could not find/open device\n");
+        return -1;
+    }
+
+    r = libusb_claim_interface(devh, XMOS_DFU_IF);
+    if (r < 0)
+    {
+        fprintf(stderr, "Error claiming interface %d %d\n", XMOS_DFU_IF, r);
+        return -1;
+    }
+    printf("XMOS DFU application started - Interface %d claimed\n", XMOS_DFU_IF);
+#endif
+
+    /* Dont go into DFU mode for save/restore */
+    if(save)
+    {
+        xmos_dfu_save_state(XMOS_DFU_IF);
+    }
+    else if(restore)
+    {
+        xmos_dfu_restore_state(XMOS_DFU_IF);
+    }
+    else if(!listdev)
+    {
+#ifndef START_IN_DFU
+        unsigned int in_progress = 0;
+
+        if (resume)
+        {
+            unsigned int blocks, crc, length;
+
+            /* A device with an interrupted download has stayed in DFU mode, detaching would lose the download */
+            if (xmos_dfu_dnload_state(XMOS_DFU_IF, &in_progress, &blocks, &crc, &length) != 0)
+            {
+                in_progress = 0;
+            }
+        }
+
+        if (in_progress)
+        {
+            printf("Device has an interrupted download, already in DFU mode.\n");
+            libusb_release_interface(devh, XMOS_DFU_IF);
+            libusb_close(devh);
+        }
+        else
+        {
+            printf("Detaching device from application mode.\n");
+            xmos_dfu_resetintodfu(XMOS_DFU_IF);
+
+            libusb_release_interface(devh, XMOS_DFU_IF);
+            libusb_close(devh);
+
+            printf("Waiting for device to restart and enter DFU mode...\n");
+
+            // Wait for device to enter dfu mode and restart
+            Sleep(20 * 1000);
+        }
 #endif
 
         // NOW IN DFU APPLICATION MODE
@@ -579,7 +1839,17 @@ int main(int argc, char **argv)
 
         if (download)
         {
-            write_dfu_image(firmware_filename);
+            write_dfu_image(firmware_filename, resume);
+            xmos_dfu_resetfromdfu(XMOS_DFU_IF);
+        }
+        else if (delta)
+        {
+            write_dfu_delta(installed_filename, firmware_filename);
+            xmos_dfu_resetfromdfu(XMOS_DFU_IF);
+        }
+        else if (compressed)
+        {
+            write_dfu_compressed(firmware_filename);
             xmos_dfu_resetfromdfu(XMOS_DFU_IF);
         }
         else if (upload)
@@ -587,6 +1857,11 @@ int main(int argc, char **argv)
             read_dfu_image(firmware_filename);
             xmos_dfu_resetfromdfu(XMOS_DFU_IF);
         }
+        else if (verify)
+        {
+            verify_dfu_image(firmware_filename);
+            xmos_dfu_resetfromdfu(XMOS_DFU_IF);
+        }
         else if (revert)
         {
             printf("... Reverting device to factory image\n");
@@ -43,6 +43,8 @@ endif()
 
 set(LIB_COMPILER_FLAGS_xua_endpoint0.c ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
 set(LIB_COMPILER_FLAGS_xua_ep0_uacreqs.xc ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
+set(LIB_COMPILER_FLAGS_xua_ep0_vendorreqs.c ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
+set(LIB_COMPILER_FLAGS_xua_ep0_scene.c ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
 set(LIB_COMPILER_FLAGS_dbcalc.xc ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
 set(LIB_COMPILER_FLAGS_audioports.c ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
 set(LIB_COMPILER_FLAGS_audioports.xc ${LIB_COMPILER_FLAGS} -Os -mno-dual-issue)
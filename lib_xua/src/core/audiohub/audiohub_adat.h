@@ -1,25 +1,46 @@
-// Copyright 2018-2023 XMOS LIMITED.
+// Copyright 2018-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 unsigned adatCounter = 0;
-unsigned adatSamples[8];
 
-#pragma unsafe arrays
-static inline void TransferAdatTxSamples(chanend c_adat_out, const unsigned samplesFromHost[], int smux, int handshake)
+/* Double buffered, per port, frames for the ADAT Tx cores. The audiohub fills adatSamples[adatBuff] in SMUX order
+ * whilst the ADAT Tx cores output the other buffer. The only channel traffic is one pointer and one handshake per
+ * port per ADAT frame */
+unsigned adatSamples[2][XUA_ADAT_TX_PORTS][8];
+unsigned adatBuff = 0;
+
+/* Hand the ADAT Tx cores their first buffer, must be called before the first TransferAdatTxSamples() */
+static inline void StartAdatTx(chanend c_adat_out[XUA_ADAT_TX_PORTS])
 {
-    /* Do some re-arranging for SMUX.. */
+    memset(adatSamples, 0, sizeof(adatSamples));
+    adatBuff = 0;
+
     unsafe
     {
-        unsigned * unsafe samplesFromHostAdat = (unsigned * unsafe) &samplesFromHost[ADAT_TX_INDEX];
+#pragma loop unroll
+        for(int p = 0; p < XUA_ADAT_TX_PORTS; p++)
+        {
+            volatile unsigned * unsafe samplePtr = (unsigned * unsafe) &adatSamples[1][p];
+            outuint(c_adat_out[p], (unsigned) samplePtr);
+        }
+    }
+}
+
+#pragma unsafe arrays
+static inline void TransferAdatTxSamples(chanend c_adat_out[XUA_ADAT_TX_PORTS], const unsigned samplesFromHost[], int smux, int handshake)
+{
+    /* Each port carries 8/smux channels, interleaved into one ADAT frame over smux sample periods */
+    const int chansPerPort = 8/smux;
+
+#pragma loop unroll
+    for(int p = 0; p < XUA_ADAT_TX_PORTS; p++)
+    {
+        int adatSampleIndex = adatCounter;
 
         /* Note, when smux == 1 this loop just does a straight 1:1 copy */
-        //if(smux != 1)
+        for(int i = 0; i < chansPerPort; i++)
         {
-            int adatSampleIndex = adatCounter;
-            for(int i = 0; i < (8/smux); i++)
-            {
-                adatSamples[adatSampleIndex] = samplesFromHostAdat[i];
-                adatSampleIndex += smux;
-            }
+            adatSamples[adatBuff][p][adatSampleIndex] = samplesFromHost[ADAT_TX_INDEX + (p * chansPerPort) + i];
+            adatSampleIndex += smux;
         }
     }
 
@@ -27,24 +48,21 @@ static inline void TransferAdatTxSamples(chanend c_adat_out, const unsigned samp
 
     if(adatCounter == smux)
     {
-#ifdef ADAT_TX_USE_SHARED_BUFF
         unsafe
         {
-            /* Wait for ADAT core to be done with buffer */
-            /* Note, we are "running ahead" of the ADAT core */
-            inuint(c_adat_out);
-
-            /* Send buffer pointer over to ADAT core */
-            volatile unsigned * unsafe samplePtr = (unsigned * unsafe) &adatSamples;
-            outuint(c_adat_out, (unsigned) samplePtr);
-        }
-#else
 #pragma loop unroll
-        for (int i = 0; i < 8; i++)
-        {
-            outuint(c_adat_out, samplesFromHost[ADAT_TX_INDEX + i]);
+            for(int p = 0; p < XUA_ADAT_TX_PORTS; p++)
+            {
+                /* Wait for ADAT core to be done with the previous buffer */
+                /* Note, we are "running ahead" of the ADAT core */
+                inuint(c_adat_out[p]);
+
+                /* Send buffer pointer over to ADAT core */
+                volatile unsigned * unsafe samplePtr = (unsigned * unsafe) &adatSamples[adatBuff][p];
+                outuint(c_adat_out[p], (unsigned) samplePtr);
+            }
         }
-#endif
+        adatBuff ^= 1;
         adatCounter = 0;
     }
 }
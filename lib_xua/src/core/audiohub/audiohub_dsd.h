@@ -1,4 +1,4 @@
-// Copyright 2018-2023 XMOS LIMITED.
+// Copyright 2018-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #if (DSD_CHANS_DAC != 0)
@@ -15,18 +15,83 @@ extern buffered out port:32 p_i2s_dac[I2S_WIRES_DAC];
 extern buffered in port:32  p_i2s_adc[I2S_WIRES_ADC];
 #endif
 
+/* Outputs a 32b DSD word to each DSD port, 8 bits per chan, 1st 1-bit sample in MSB */
+#pragma unsafe arrays
+static inline void DoDsdNativeFrame(const unsigned samples[])
+{
+#pragma loop unroll
+    for(int i = 0; i < DSD_CHANS_DAC; i++)
+    {
+        unsigned dsdSample = bitrev(byterev(samples[i]));
+        asm volatile("out res[%0], %1"::"r"(p_dsd_dac[i]),"r"(dsdSample));
+    }
+}
+
 /* This function performs the DSD native loop and outputs a 32b DSD stream per loop */
-static inline void DoDsdNative(unsigned samplesOut[], unsigned &dsdSample_l, unsigned &dsdSample_r, unsigned divide)
+static inline void DoDsdNative(unsigned samplesOut[], unsigned divide)
 {
-     /* 8 bits per chan, 1st 1-bit sample in MSB */
-    dsdSample_l =  samplesOut[0];
-    dsdSample_r =  samplesOut[1];
-    dsdSample_r = bitrev(byterev(dsdSample_r));
-    dsdSample_l = bitrev(byterev(dsdSample_l));
-
-    asm volatile("out res[%0], %1"::"r"(p_dsd_dac[0]),"r"(dsdSample_l));
-    asm volatile("out res[%0], %1"::"r"(p_dsd_dac[1]),"r"(dsdSample_r));
+    DoDsdNativeFrame(samplesOut);
+}
+
+#if (XUA_DSD_BLOCK_TRANSFER)
+/* Native DSD loop with block transfer (XUA_DSD_BLOCK_FRAMES). Decouple sends the DSD words of a block of frames in one
+ * exchange, returning an input frame for each. The next block is requested before the last frame of the current
+ * block is output so that decouple's response overlaps it. Returns the command that ended streaming */
+#pragma unsafe arrays
+static unsigned DoDsdNativeBlocks(chanend ?c_out, unsigned underflowWord)
+{
+    unsigned block[XUA_DSD_BLOCK_FRAMES][DSD_CHANS_DAC];
+
+    for(int f = 0; f < XUA_DSD_BLOCK_FRAMES; f++)
+    {
+        for(int i = 0; i < DSD_CHANS_DAC; i++)
+        {
+            block[f][i] = underflowWord;
+        }
+    }
+
+    while(1)
+    {
+        for(int f = 0; f < XUA_DSD_BLOCK_FRAMES - 1; f++)
+        {
+            DoDsdNativeFrame(block[f]);
+        }
+
+        outuint(c_out, underflowWord);
+
+        DoDsdNativeFrame(block[XUA_DSD_BLOCK_FRAMES - 1]);
+
+        if(testct(c_out))
+        {
+            unsigned command = inct(c_out);
+            p_dsd_clk <: 0;
+            return command;
+        }
+
+        for(int f = 0; f < XUA_DSD_BLOCK_FRAMES; f++)
+        {
+#pragma loop unroll
+            for(int i = 0; i < DSD_CHANS_DAC; i++)
+            {
+                block[f][i] = inuint(c_out);
+            }
+        }
+
+        /* No audio input is sampled in native DSD mode, the last input frame is repeated */
+#if (NUM_USB_CHAN_IN > 0)
+        for(int f = 0; f < XUA_DSD_BLOCK_FRAMES; f++)
+        {
+#pragma loop unroll
+            for(int i = 0; i < NUM_USB_CHAN_IN; i++)
+            {
+                outuint(c_out, samplesIn[0][i]);
+            }
+        }
+#endif
+    }
+    return 0;
 }
+#endif
 
 /* This function performs the DOP loop and collects 16b of DSD per loop
    and outputs a 32b word into the port buffer every other cycle. */
@@ -49,47 +114,4 @@ static inline void DoDsdDop(int &everyOther, unsigned samplesOut[], unsigned &ds
     }
 }
 
-/* When DSD is enabled and streaming is standard PCM, this function checks for a series of DoP markers in the upper byte.
-   If found it will exit deliver() with the command to restart in DoP mode.
-   When in DoP mode, this function will check for a single absence of the DoP marker and exit deliver() with the command
-   to restart in I2S/PCM mode. */
-static inline int DoDsdDopCheck(unsigned &dsdMode, int &dsdCount, unsigned curSamFreq, unsigned samplesOut[], unsigned &dsdMarker)
-{
-    /* Check for DSD - note we only move into DoP mode if valid DoP Freq */
-    /* Currently we only check on channel 0 - we get all 0's on channels without data */
-    if((dsdMode == DSD_MODE_OFF) && (curSamFreq > 96000))
-    {
-        if((DSD_MASK(samplesOut[0]) == dsdMarker) && (DSD_MASK(samplesOut[1]) == dsdMarker))
-        {
-            dsdCount++;
-            dsdMarker ^= DSD_MARKER_XOR;
-            if(dsdCount == DSD_EN_THRESH)
-            {
-                dsdMode = DSD_MODE_DOP;
-                dsdCount = 0;
-                dsdMarker = DSD_MARKER_2;
-                return 0;
-            }
-        }
-        else
-        {
-            dsdCount = 0;
-            dsdMarker = DSD_MARKER_2;
-        }
-    }
-    else if(dsdMode == DSD_MODE_DOP)
-    {
-        /* If we are running in DOP mode, check if we need to come out */
-        if((DSD_MASK(samplesOut[0]) != DSD_MARKER_1) && (DSD_MASK(samplesOut[1]) != DSD_MARKER_1))
-        {
-            if((DSD_MASK(samplesOut[0]) != DSD_MARKER_2) && (DSD_MASK(samplesOut[1]) != DSD_MARKER_2))
-            {
-                dsdMode = DSD_MODE_OFF;
-                return 0;
-            }
-        }
-    }
-    return 1;
-}
-
 
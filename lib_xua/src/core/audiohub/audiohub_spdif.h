@@ -0,0 +1,44 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+#if (NUM_USB_CHAN_OUT > 0) && ((SPDIF_TX_INDEX + (2 * XUA_SPDIF_TX_PORTS)) > NUM_USB_CHAN_OUT)
+#error SPDIF_TX_INDEX + 2 * XUA_SPDIF_TX_PORTS exceeds NUM_USB_CHAN_OUT
+#endif
+
+/* Double buffered frames, all ports, for XUA_SpdifTxMulti(). The audiohub fills spdifSamples[spdifBuff] whilst the
+ * S/PDIF Tx core takes the other buffer. The only channel traffic is one pointer and one handshake per frame */
+unsigned spdifSamples[2][2 * XUA_SPDIF_TX_PORTS];
+unsigned spdifBuff = 0;
+
+/* Hand the S/PDIF Tx core its first buffer, must be called before the first TransferSpdifTxSamples() */
+static inline void StartSpdifTx(chanend c_spdif_out)
+{
+    memset(spdifSamples, 0, sizeof(spdifSamples));
+    spdifBuff = 0;
+
+    unsafe
+    {
+        volatile unsigned * unsafe samplePtr = (unsigned * unsafe) &spdifSamples[1];
+        outuint(c_spdif_out, (unsigned) samplePtr);
+    }
+}
+
+#pragma unsafe arrays
+static inline void TransferSpdifTxSamples(chanend c_spdif_out, const unsigned samplesFromHost[])
+{
+#pragma loop unroll
+    for(int i = 0; i < 2 * XUA_SPDIF_TX_PORTS; i++)
+    {
+        spdifSamples[spdifBuff][i] = samplesFromHost[SPDIF_TX_INDEX + i];
+    }
+
+    unsafe
+    {
+        /* Wait for the S/PDIF core to be done with the previous buffer */
+        inuint(c_spdif_out);
+
+        volatile unsigned * unsafe samplePtr = (unsigned * unsafe) &spdifSamples[spdifBuff];
+        outuint(c_spdif_out, (unsigned) samplePtr);
+    }
+    spdifBuff ^= 1;
+}
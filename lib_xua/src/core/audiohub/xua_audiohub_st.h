@@ -1,12 +1,42 @@
-// Copyright 2011-2023 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
+#if ((MIXER) && (XUA_SHARED_SAMPLE_TRANSFER)) || (XUA_SHARED_SAMPLE_TRANSFER_DECOUPLE)
+#define SHARED_SAMPLE_TRANSFER (1)
+#else
+#define SHARED_SAMPLE_TRANSFER (0)
+#endif
+
+/* In block mode the frame is swapped with the block being filled, with a worker thread it is swapped with a delayed
+ * frame from the worker's ring and with DSP fan-out it is swapped with the previous frame from the fan-out workers,
+ * rather than being processed in place */
+#if (XUA_USER_BUFFER_BLOCK_FRAMES > 0)
+#define USER_BUFFER_MANAGEMENT(out, in) XUA_UserBufferBlock_Exchange(out, in)
+#elif (XUA_USER_BUFFER_WORKER)
+#define USER_BUFFER_MANAGEMENT(out, in) XUA_UserBufferWorker_Exchange(out, in)
+#elif (XUA_DSP_FANOUT_WORKERS > 0)
+#define USER_BUFFER_MANAGEMENT(out, in) XUA_DspFanOut_Exchange(out, in)
+#else
+#define USER_BUFFER_MANAGEMENT(out, in) UserBufferManagement(out, in)
+#endif
+
+/* Request the next sample exchange. With SHARED_SAMPLE_TRANSFER the mixer (or decouple) is also passed the
+ * buffers it should write output samples to and read input samples from */
+static inline void SendSampleRequest(chanend ?c_out, const int readBuffNo, const unsigned underflowWord)
+{
+    outuint(c_out, underflowWord);
+#if (SHARED_SAMPLE_TRANSFER)
+    outuint(c_out, array_to_xc_ptr(samplesOut));
+    outuint(c_out, array_to_xc_ptr(samplesIn[readBuffNo]));
+#endif
+}
+
 #pragma unsafe arrays
 static inline unsigned DoSampleTransfer(chanend ?c_out, const int readBuffNo, const unsigned underflowWord)
 {
     if(XUA_USB_EN)
     {
-        outuint(c_out, underflowWord);
+        SendSampleRequest(c_out, readBuffNo, underflowWord);
 
         /* Check for sample freq change (or other command) or new samples from mixer*/
         if(testct(c_out))
@@ -37,6 +67,28 @@ static inline unsigned DoSampleTransfer(chanend ?c_out, const int readBuffNo, co
         }
         else
         {
+#if (SHARED_SAMPLE_TRANSFER)
+            /* Mixer (or decouple) has written directly to samplesOut */
+            inuint(c_out);
+
+            USER_BUFFER_MANAGEMENT(samplesOut, samplesIn[readBuffNo]);
+
+            /* Inform the mixer (or decouple) samplesIn is ready and wait for it to be read */
+            outct(c_out, XS1_CT_END);
+            chkct(c_out, XS1_CT_END);
+#elif (XUA_FRAME_PACK_HUB)
+            /* Samples are exchanged with the mixer (or decouple) packed */
+#if NUM_USB_CHAN_OUT > 0
+            XUA_PackedInFrame(c_out, samplesOut, NUM_USB_CHAN_OUT);
+#else
+            inuint(c_out);
+#endif
+            USER_BUFFER_MANAGEMENT(samplesOut, samplesIn[readBuffNo]);
+
+#if NUM_USB_CHAN_IN > 0
+            XUA_PackedOutFrame(c_out, samplesIn[readBuffNo], NUM_USB_CHAN_IN);
+#endif
+#else
 #if NUM_USB_CHAN_OUT > 0
 #pragma loop unroll
             for(int i = 0; i < NUM_USB_CHAN_OUT; i++)
@@ -47,7 +99,7 @@ static inline unsigned DoSampleTransfer(chanend ?c_out, const int readBuffNo, co
 #else
             inuint(c_out);
 #endif
-            UserBufferManagement(samplesOut, samplesIn[readBuffNo]);
+            USER_BUFFER_MANAGEMENT(samplesOut, samplesIn[readBuffNo]);
 
 #if NUM_USB_CHAN_IN > 0
 #pragma loop unroll
@@ -56,10 +108,11 @@ static inline unsigned DoSampleTransfer(chanend ?c_out, const int readBuffNo, co
                 outuint(c_out, samplesIn[readBuffNo][i]);
             }
 #endif
+#endif /* SHARED_SAMPLE_TRANSFER */
         }
     }
     else
-        UserBufferManagement(samplesOut, samplesIn[readBuffNo]);
+        USER_BUFFER_MANAGEMENT(samplesOut, samplesIn[readBuffNo]);
 
     return 0;
 }
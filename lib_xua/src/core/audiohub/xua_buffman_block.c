@@ -0,0 +1,114 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <string.h>
+#include "xua.h"
+#include "xua_audiohub.h"
+#include "xua_buffman_block.h"
+
+#if (XUA_USER_BUFFER_BLOCK_FRAMES > 0)
+
+/* Avoid zero sized arrays for output or input only devices */
+#define BLOCK_CHANS_OUT     ((NUM_USB_CHAN_OUT > 0) ? NUM_USB_CHAN_OUT : 1)
+#define BLOCK_CHANS_IN      ((NUM_USB_CHAN_IN > 0) ? NUM_USB_CHAN_IN : 1)
+
+/* Channel interleaved blocks, [frame * channels + channel]. Index 0/1 alternates between the audiohub and the block task */
+static unsigned blockOut[2][XUA_USER_BUFFER_BLOCK_FRAMES * BLOCK_CHANS_OUT];
+static unsigned blockIn[2][XUA_USER_BUFFER_BLOCK_FRAMES * BLOCK_CHANS_IN];
+
+/* Audiohub state */
+unsigned g_buff_block_chan;
+static unsigned hubBlock;
+static unsigned hubFrame;
+static unsigned hubPending;
+
+void XUA_UserBufferBlock_Init(void)
+{
+    memset(blockOut, 0, sizeof(blockOut));
+    memset(blockIn, 0, sizeof(blockIn));
+    hubBlock = 0;
+    hubFrame = 0;
+    hubPending = 0;
+}
+
+#pragma unsafe arrays
+void XUA_UserBufferBlock_Exchange(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[])
+{
+    /* Take the processed sample from the current block and replace it with the new one */
+#if (NUM_USB_CHAN_OUT > 0)
+    unsigned *out = &blockOut[hubBlock][hubFrame * NUM_USB_CHAN_OUT];
+#pragma loop unroll
+    for(int i = 0; i < NUM_USB_CHAN_OUT; i++)
+    {
+        unsigned tmp = out[i];
+        out[i] = sampsFromUsbToAudio[i];
+        sampsFromUsbToAudio[i] = tmp;
+    }
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+    unsigned *in = &blockIn[hubBlock][hubFrame * NUM_USB_CHAN_IN];
+#pragma loop unroll
+    for(int i = 0; i < NUM_USB_CHAN_IN; i++)
+    {
+        unsigned tmp = in[i];
+        in[i] = sampsFromAudioToUsb[i];
+        sampsFromAudioToUsb[i] = tmp;
+    }
+#endif
+
+    if(++hubFrame == XUA_USER_BUFFER_BLOCK_FRAMES)
+    {
+        unsigned tmp;
+        hubFrame = 0;
+
+        /* The other block must have been processed before we start on it. If the block task has not finished it
+         * this blocks the audiohub, UserBufferManagementBlock() must complete within a block period */
+        if(hubPending)
+        {
+            asm volatile("in %0, res[%1]" : "=r"(tmp) : "r"(g_buff_block_chan));
+        }
+
+        asm volatile("out res[%0], %1" :: "r"(g_buff_block_chan), "r"(hubBlock));
+        hubPending = 1;
+        hubBlock ^= 1;
+    }
+}
+
+void XUA_UserBufferBlock_Stop(void)
+{
+    unsigned tmp;
+
+    if(hubPending)
+    {
+        asm volatile("in %0, res[%1]" : "=r"(tmp) : "r"(g_buff_block_chan));
+        hubPending = 0;
+    }
+
+    asm volatile("outct res[%0], %1" :: "r"(g_buff_block_chan), "r"(XS1_CT_END));
+    asm volatile("chkct res[%0], %1" :: "r"(g_buff_block_chan), "r"(XS1_CT_END));
+}
+
+void XUA_UserBufferBlockTask(chanend c_buff_block)
+{
+    while(1)
+    {
+        unsigned isCt;
+        unsigned block;
+
+        asm volatile("testct %0, res[%1]" : "=r"(isCt) : "r"(c_buff_block));
+        if(isCt)
+        {
+            asm volatile("chkct res[%0], %1" :: "r"(c_buff_block), "r"(XS1_CT_END));
+            asm volatile("outct res[%0], %1" :: "r"(c_buff_block), "r"(XS1_CT_END));
+            return;
+        }
+
+        asm volatile("in %0, res[%1]" : "=r"(block) : "r"(c_buff_block));
+
+        UserBufferManagementBlock(blockOut[block], blockIn[block], XUA_USER_BUFFER_BLOCK_FRAMES);
+
+        asm volatile("out res[%0], %1" :: "r"(c_buff_block), "r"(block));
+    }
+}
+
+#endif
@@ -0,0 +1,35 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_BUFFMAN_BLOCK_H_
+#define _XUA_BUFFMAN_BLOCK_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Block mode user buffer management (XUA_USER_BUFFER_BLOCK_FRAMES > 0).
+ *
+ * The audiohub exchanges one frame per sample transfer with the block currently being filled. At the end of each
+ * block it is handed to XUA_UserBufferBlockTask(), which runs UserBufferManagementBlock() on it in place, whilst the
+ * audiohub moves on to the other block (processed during the previous block period). Samples are therefore delayed
+ * by two blocks in each direction. */
+
+#if (XUA_USER_BUFFER_BLOCK_FRAMES > 0)
+
+/* Chanend used by the audiohub to hand blocks to XUA_UserBufferBlockTask() */
+extern unsigned g_buff_block_chan;
+
+/** Reset the block state. Must be called before the first exchange after the block task is started */
+void XUA_UserBufferBlock_Init(void);
+
+/** Exchange one frame with the current block, handing the block over for processing when it is full */
+void XUA_UserBufferBlock_Exchange(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[]);
+
+/** Wait for any outstanding block and stop XUA_UserBufferBlockTask() */
+void XUA_UserBufferBlock_Stop(void);
+
+/** Runs UserBufferManagementBlock() on each block handed over by the audiohub, returns when stopped */
+void XUA_UserBufferBlockTask(chanend c_buff_block);
+
+#endif
+
+#endif
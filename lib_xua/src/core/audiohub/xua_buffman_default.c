@@ -1,4 +1,4 @@
-// Copyright 2016-2023 XMOS LIMITED.
+// Copyright 2016-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #include "xccompat.h"
@@ -15,3 +15,16 @@ void __attribute__ ((weak)) UserBufferManagement(unsigned sampsFromUsbToAudio[],
 {
     /* Do nothing */
 }
+
+/* Default implementation for UserBufferManagementBlock() */
+void __attribute__ ((weak)) UserBufferManagementBlock(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[], unsigned frames)
+{
+    /* Do nothing */
+}
+
+/* Default implementation for UserBufferManagementGroup() */
+void __attribute__ ((weak)) UserBufferManagementGroup(unsigned group, unsigned sampsFromUsbToAudio[], unsigned numChansOut,
+    unsigned sampsFromAudioToUsb[], unsigned numChansIn)
+{
+    /* Do nothing */
+}
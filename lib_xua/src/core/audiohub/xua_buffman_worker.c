@@ -0,0 +1,133 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <string.h>
+#include "xua.h"
+#include "xua_audiohub.h"
+#include "xua_buffman_worker.h"
+
+#if (XUA_USER_BUFFER_WORKER)
+
+/* Avoid zero sized arrays for output or input only devices */
+#define WORKER_CHANS_OUT    ((NUM_USB_CHAN_OUT > 0) ? NUM_USB_CHAN_OUT : 1)
+#define WORKER_CHANS_IN     ((NUM_USB_CHAN_IN > 0) ? NUM_USB_CHAN_IN : 1)
+
+/* One slot is being written by the audiohub, one is being read back and the worker has the remainder */
+#define RING_FRAMES         (XUA_USER_BUFFER_WORKER_LATENCY + 2)
+
+typedef struct
+{
+    unsigned out[WORKER_CHANS_OUT];
+    unsigned in[WORKER_CHANS_IN];
+} worker_frame_t;
+
+static worker_frame_t ring[RING_FRAMES];
+
+/* Frames pushed by the audiohub and frames processed by the worker. Free running, only ever written by one thread */
+static volatile unsigned writeCount;
+static volatile unsigned doneCount;
+static volatile unsigned stop;
+static unsigned workerSampFreq;
+
+/* Audiohub state */
+static unsigned hubWriteSlot;
+static unsigned hubReadSlot;
+
+unsigned g_xua_buffman_worker_misses;
+
+void XUA_UserBufferWorker_Init(unsigned sampFreq)
+{
+    memset(ring, 0, sizeof(ring));
+    writeCount = 0;
+    doneCount = 0;
+    stop = 0;
+    workerSampFreq = sampFreq;
+    hubWriteSlot = 0;
+    hubReadSlot = RING_FRAMES - XUA_USER_BUFFER_WORKER_LATENCY;
+    g_xua_buffman_worker_misses = 0;
+}
+
+#pragma unsafe arrays
+void XUA_UserBufferWorker_Exchange(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[])
+{
+    worker_frame_t *f = &ring[hubWriteSlot];
+
+#if (NUM_USB_CHAN_OUT > 0)
+    memcpy(f->out, sampsFromUsbToAudio, NUM_USB_CHAN_OUT * sizeof(unsigned));
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+    memcpy(f->in, sampsFromAudioToUsb, NUM_USB_CHAN_IN * sizeof(unsigned));
+#endif
+
+    /* Publish the frame, stores are not re-ordered so the frame is visible to the worker before the count */
+    unsigned wc = writeCount + 1;
+    writeCount = wc;
+
+    if(++hubWriteSlot == RING_FRAMES)
+        hubWriteSlot = 0;
+
+    /* Take back the frame pushed XUA_USER_BUFFER_WORKER_LATENCY frames ago (before that the ring is still filling) */
+    f = &ring[hubReadSlot];
+    if(++hubReadSlot == RING_FRAMES)
+        hubReadSlot = 0;
+
+    if(((int)(doneCount - (wc - XUA_USER_BUFFER_WORKER_LATENCY)) >= 0) && (wc > XUA_USER_BUFFER_WORKER_LATENCY))
+    {
+#if (NUM_USB_CHAN_OUT > 0)
+        memcpy(sampsFromUsbToAudio, f->out, NUM_USB_CHAN_OUT * sizeof(unsigned));
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+        memcpy(sampsFromAudioToUsb, f->in, NUM_USB_CHAN_IN * sizeof(unsigned));
+#endif
+    }
+    else
+    {
+        if(wc > XUA_USER_BUFFER_WORKER_LATENCY)
+            g_xua_buffman_worker_misses++;
+
+#if (NUM_USB_CHAN_OUT > 0)
+        memset(sampsFromUsbToAudio, 0, NUM_USB_CHAN_OUT * sizeof(unsigned));
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+        memset(sampsFromAudioToUsb, 0, NUM_USB_CHAN_IN * sizeof(unsigned));
+#endif
+    }
+}
+
+void XUA_UserBufferWorker_Stop(void)
+{
+    stop = 1;
+}
+
+void XUA_UserBufferWorkerTask(void)
+{
+    unsigned done = 0;
+    unsigned slot = 0;
+
+    UserBufferManagementInit(workerSampFreq);
+
+    while(!stop)
+    {
+        unsigned wc = writeCount;
+
+        if(wc == done)
+            continue;
+
+        /* Frames older than this have already been taken back by the audiohub, skip ahead rather than
+         * falling further behind */
+        if((wc - done) > XUA_USER_BUFFER_WORKER_LATENCY)
+        {
+            done = wc - XUA_USER_BUFFER_WORKER_LATENCY;
+            slot = done % RING_FRAMES;
+        }
+
+        UserBufferManagement(ring[slot].out, ring[slot].in);
+
+        if(++slot == RING_FRAMES)
+            slot = 0;
+
+        done++;
+        doneCount = done;
+    }
+}
+
+#endif
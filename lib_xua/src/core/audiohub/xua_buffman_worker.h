@@ -0,0 +1,35 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_BUFFMAN_WORKER_H_
+#define _XUA_BUFFMAN_WORKER_H_
+
+#include "xua.h"
+
+/* Worker thread user buffer management (XUA_USER_BUFFER_WORKER).
+ *
+ * The audiohub pushes each frame into a single-producer single-consumer ring and takes back the frame it pushed
+ * XUA_USER_BUFFER_WORKER_LATENCY frames earlier. XUA_UserBufferWorkerTask() runs UserBufferManagement() on each frame
+ * in the ring in place. The two threads share only the write and done counts, neither ever waits for the other.
+ * A frame the worker has not finished by the time the audiohub needs it is replaced with silence and counted in
+ * g_xua_buffman_worker_misses. */
+
+#if (XUA_USER_BUFFER_WORKER)
+
+/* Number of frames not processed in time since the last sample rate change */
+extern unsigned g_xua_buffman_worker_misses;
+
+/** Reset the ring, must be called before both the audiohub and the worker are started */
+void XUA_UserBufferWorker_Init(unsigned sampFreq);
+
+/** Push one frame into the ring and replace it with the delayed, processed frame */
+void XUA_UserBufferWorker_Exchange(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[]);
+
+/** Request XUA_UserBufferWorkerTask() to return */
+void XUA_UserBufferWorker_Stop(void);
+
+/** Runs UserBufferManagement() on frames pushed by the audiohub, returns when stopped */
+void XUA_UserBufferWorkerTask(void);
+
+#endif
+
+#endif
@@ -0,0 +1,121 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_audiohub.h"
+#include "xua_dsp_fanout.h"
+
+#if (XUA_DSP_FANOUT_WORKERS > 0)
+
+/* Avoid zero sized arrays for output or input only devices */
+#define FANOUT_CHANS_OUT    ((XUA_DSP_FANOUT_CHANS_OUT > 0) ? XUA_DSP_FANOUT_CHANS_OUT : 1)
+#define FANOUT_CHANS_IN     ((XUA_DSP_FANOUT_CHANS_IN > 0) ? XUA_DSP_FANOUT_CHANS_IN : 1)
+
+static unsigned fanoutChans[XUA_DSP_FANOUT_WORKERS];
+
+/* Number of channels in group g, the last group takes any remainder */
+static inline unsigned GroupChans(unsigned g, unsigned chansPerGroup, unsigned totalChans)
+{
+    unsigned first = g * chansPerGroup;
+
+    if(first >= totalChans)
+        return 0;
+    if((totalChans - first) < chansPerGroup)
+        return totalChans - first;
+    return chansPerGroup;
+}
+
+static inline void OutWord(unsigned c, unsigned x)
+{
+    asm volatile("out res[%0], %1" :: "r"(c), "r"(x));
+}
+
+static inline unsigned InWord(unsigned c)
+{
+    unsigned x;
+    asm volatile("in %0, res[%1]" : "=r"(x) : "r"(c));
+    return x;
+}
+
+void XUA_DspFanOut_SetChanend(unsigned group, unsigned c)
+{
+    fanoutChans[group] = c;
+}
+
+#pragma unsafe arrays
+void XUA_DspFanOut_Exchange(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[])
+{
+    unsigned resultOut[NUM_USB_CHAN_OUT > 0 ? NUM_USB_CHAN_OUT : 1];
+    unsigned resultIn[NUM_USB_CHAN_IN > 0 ? NUM_USB_CHAN_IN : 1];
+
+    /* Collect the previous frame from every worker before sending any new samples, so no worker can be blocked
+     * sending its results whilst the audiohub is blocked sending it samples */
+    for(unsigned g = 0; g < XUA_DSP_FANOUT_WORKERS; g++)
+    {
+        unsigned c = fanoutChans[g];
+        unsigned n = GroupChans(g, XUA_DSP_FANOUT_CHANS_OUT, NUM_USB_CHAN_OUT);
+        unsigned *p = &resultOut[g * XUA_DSP_FANOUT_CHANS_OUT];
+
+        for(unsigned i = 0; i < n; i++)
+            p[i] = InWord(c);
+
+        n = GroupChans(g, XUA_DSP_FANOUT_CHANS_IN, NUM_USB_CHAN_IN);
+        p = &resultIn[g * XUA_DSP_FANOUT_CHANS_IN];
+
+        for(unsigned i = 0; i < n; i++)
+            p[i] = InWord(c);
+    }
+
+    for(unsigned g = 0; g < XUA_DSP_FANOUT_WORKERS; g++)
+    {
+        unsigned c = fanoutChans[g];
+        unsigned n = GroupChans(g, XUA_DSP_FANOUT_CHANS_OUT, NUM_USB_CHAN_OUT);
+        unsigned *p = &sampsFromUsbToAudio[g * XUA_DSP_FANOUT_CHANS_OUT];
+
+        for(unsigned i = 0; i < n; i++)
+            OutWord(c, p[i]);
+
+        n = GroupChans(g, XUA_DSP_FANOUT_CHANS_IN, NUM_USB_CHAN_IN);
+        p = &sampsFromAudioToUsb[g * XUA_DSP_FANOUT_CHANS_IN];
+
+        for(unsigned i = 0; i < n; i++)
+            OutWord(c, p[i]);
+    }
+
+#if (NUM_USB_CHAN_OUT > 0)
+    for(unsigned i = 0; i < NUM_USB_CHAN_OUT; i++)
+        sampsFromUsbToAudio[i] = resultOut[i];
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+    for(unsigned i = 0; i < NUM_USB_CHAN_IN; i++)
+        sampsFromAudioToUsb[i] = resultIn[i];
+#endif
+}
+
+void XUA_DspFanOutWorker(unsigned c, unsigned group)
+{
+    unsigned out[FANOUT_CHANS_OUT];
+    unsigned in[FANOUT_CHANS_IN];
+    const unsigned numOut = GroupChans(group, XUA_DSP_FANOUT_CHANS_OUT, NUM_USB_CHAN_OUT);
+    const unsigned numIn = GroupChans(group, XUA_DSP_FANOUT_CHANS_IN, NUM_USB_CHAN_IN);
+
+    /* Prime the pipeline with a frame of silence, the audiohub always collects before it sends */
+    for(unsigned i = 0; i < (numOut + numIn); i++)
+        OutWord(c, 0);
+
+    while(1)
+    {
+        for(unsigned i = 0; i < numOut; i++)
+            out[i] = InWord(c);
+        for(unsigned i = 0; i < numIn; i++)
+            in[i] = InWord(c);
+
+        UserBufferManagementGroup(group, out, numOut, in, numIn);
+
+        for(unsigned i = 0; i < numOut; i++)
+            OutWord(c, out[i]);
+        for(unsigned i = 0; i < numIn; i++)
+            OutWord(c, in[i]);
+    }
+}
+
+#endif
@@ -0,0 +1,33 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_DSP_FANOUT_H_
+#define _XUA_DSP_FANOUT_H_
+
+#include "xua.h"
+
+/* DSP fan-out (XUA_DSP_FANOUT_WORKERS > 0).
+ *
+ * Every frame the audiohub collects the processed channel groups of the previous frame from each worker and then
+ * sends each worker its channel group of the current frame, over one streaming channel per worker. Workers may be on
+ * either tile. Processed samples are therefore always delayed by exactly one frame. Each worker must complete
+ * UserBufferManagementGroup() within one frame period, otherwise the audiohub waits for it. */
+
+#if (XUA_DSP_FANOUT_WORKERS > 0)
+
+#ifdef __XC__
+/** Register the audiohub end of the streaming channel to worker ``group`` */
+void XUA_DspFanOut_SetChanend(unsigned group, streaming chanend c);
+
+/** DSP fan-out worker, runs UserBufferManagementGroup() for channel group ``group`` every frame. Never returns */
+void XUA_DspFanOutWorker(streaming chanend c, unsigned group);
+#else
+void XUA_DspFanOut_SetChanend(unsigned group, unsigned c);
+void XUA_DspFanOutWorker(unsigned c, unsigned group);
+#endif
+
+/** Exchange one frame with the workers, replacing it with the processed previous frame */
+void XUA_DspFanOut_Exchange(unsigned sampsFromUsbToAudio[], unsigned sampsFromAudioToUsb[]);
+
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_src.h"
+
+#if (XUA_SRC_RATIO > 1) && (XUA_SRC_RATIO != 3)
+
+/* Decimator output is scaled by the per-phase gain as well as the coefficient format */
+#if (XUA_SRC_RATIO == 2)
+#define DS_SHIFT            (XUA_SRC_COEF_Q + 1)
+#elif (XUA_SRC_RATIO == 4)
+#define DS_SHIFT            (XUA_SRC_COEF_Q + 2)
+#else
+#error Unsupported XUA_SRC_RATIO
+#endif
+#define US_SHIFT            (XUA_SRC_COEF_Q)
+
+#if (XUA_SRC_TAPS_PER_PHASE % 2)
+#error XUA_SRC_TAPS_PER_PHASE must be even
+#endif
+
+static inline int32_t Saturate(int64_t sum, const int shift)
+{
+    sum = (sum + (1LL << (shift - 1))) >> shift;
+
+    if(sum > INT32_MAX)
+        return INT32_MAX;
+    if(sum < INT32_MIN)
+        return INT32_MIN;
+    return (int32_t) sum;
+}
+
+/* Shift a new sample into the delay line and return the dot product of the shifted line with the coefficients.
+ * Works down the line two taps at a time so that the shift and MACs are done in a single pass */
+static inline int64_t ShiftMac(int64_t sum, int32_t * restrict d, const int32_t * restrict c, int32_t sample)
+{
+#pragma loop unroll
+    for(int i = XUA_SRC_TAPS_PER_PHASE - 1; i > 0; i -= 2)
+    {
+        int32_t d1 = d[i - 1];
+        int32_t d0 = (i == 1) ? sample : d[i - 2];
+
+        d[i] = d1;
+        d[i - 1] = d0;
+
+        sum += (int64_t) d1 * c[i];
+        sum += (int64_t) d0 * c[i - 1];
+    }
+    return sum;
+}
+
+static inline int64_t Mac(int64_t sum, const int32_t * restrict d, const int32_t * restrict c)
+{
+#pragma loop unroll
+    for(int i = 0; i < XUA_SRC_TAPS_PER_PHASE; i += 2)
+    {
+        sum += (int64_t) d[i] * c[i];
+        sum += (int64_t) d[i + 1] * c[i + 1];
+    }
+    return sum;
+}
+
+int64_t XUA_Src_DsAddSample(int64_t sum, int32_t delayLine[], const int32_t coefs[], int32_t sample)
+{
+    return ShiftMac(sum, delayLine, coefs, sample);
+}
+
+int32_t XUA_Src_DsAddFinalSample(int64_t sum, int32_t delayLine[], const int32_t coefs[], int32_t sample)
+{
+    return Saturate(ShiftMac(sum, delayLine, coefs, sample), DS_SHIFT);
+}
+
+int32_t XUA_Src_UsInputSample(int32_t delayLine[], const int32_t coefs[], int32_t sample)
+{
+    return Saturate(ShiftMac(0, delayLine, coefs, sample), US_SHIFT);
+}
+
+int32_t XUA_Src_UsGetNextSample(int32_t delayLine[], const int32_t coefs[])
+{
+    return Saturate(Mac(0, delayLine, coefs), US_SHIFT);
+}
+
+#endif
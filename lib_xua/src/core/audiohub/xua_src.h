@@ -0,0 +1,85 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_SRC_H_
+#define _XUA_SRC_H_
+
+#include <stdint.h>
+#include "xua.h"
+
+/* Polyphase sample rate conversion between the I2S rate and the USB rate (AUD_TO_USB_RATIO:1).
+ *
+ * The audiohub calls the resampler once per I2S frame with a phase counter, n, that runs from 0 to
+ * AUD_TO_USB_RATIO - 1. For each channel, the decimator (I2S -> USB) keeps one delay line per phase
+ * and the interpolator (USB -> I2S) a single delay line:
+ *
+ *   Decimator:     n == 0:           sum = 0
+ *                  n < ratio - 1:    sum = XUA_SRC_DS_ADD_SAMPLE(sum, delayLine[n], XUA_SRC_DS_COEFS(n), sample)
+ *                  n == ratio - 1:   out = XUA_SRC_DS_ADD_FINAL_SAMPLE(sum, delayLine[n], XUA_SRC_DS_COEFS(n), sample)
+ *
+ *   Interpolator:  n == 0:           out = XUA_SRC_US_INPUT_SAMPLE(delayLine, XUA_SRC_US_COEFS(0), sample)
+ *                  n > 0:            out = XUA_SRC_US_GET_NEXT_SAMPLE(delayLine, XUA_SRC_US_COEFS(n))
+ *
+ * Delay lines are int32_t [XUA_SRC_TAPS_PER_PHASE] and must be double word aligned. The 3:1 ratio uses
+ * the lib_src voice resampler (the application must depend on lib_src). Other ratios use the resampler
+ * in xua_src.c with the filters in xua_src_coefs.c
+ *
+ * The Decoupler uses the decimator in the same way to convert the IN channels from the USB OUT rate to the
+ * USB IN rate (USB_OUT_TO_IN_RATIO:1), n then counting frames from the mixer/audiohub. At most one of the two
+ * ratios may be above 1, XUA_SRC_RATIO being the one in use */
+
+#if (AUD_TO_USB_RATIO > 1)
+#define XUA_SRC_RATIO                       (AUD_TO_USB_RATIO)
+#else
+#define XUA_SRC_RATIO                       (USB_OUT_TO_IN_RATIO)
+#endif
+
+#if (XUA_SRC_RATIO == 3)
+
+#include "src.h"
+
+#define XUA_SRC_NUM_PHASES                  (SRC_FF3V_FIR_NUM_PHASES)
+#define XUA_SRC_TAPS_PER_PHASE              (SRC_FF3V_FIR_TAPS_PER_PHASE)
+#define XUA_SRC_DS_COEFS(n)                 src_ff3v_fir_coefs[n]
+#define XUA_SRC_US_COEFS(n)                 src_ff3v_fir_coefs[(SRC_FF3V_FIR_NUM_PHASES - 1) - (n)]
+#define XUA_SRC_DS_ADD_SAMPLE               src_ds3_voice_add_sample
+#define XUA_SRC_DS_ADD_FINAL_SAMPLE         src_ds3_voice_add_final_sample
+#define XUA_SRC_US_INPUT_SAMPLE             src_us3_voice_input_sample
+#define XUA_SRC_US_GET_NEXT_SAMPLE          src_us3_voice_get_next_sample
+
+#elif (XUA_SRC_RATIO > 1)
+
+#define XUA_SRC_NUM_PHASES                  (XUA_SRC_RATIO)
+#define XUA_SRC_TAPS_PER_PHASE              (32)     /* Must match xua_src_coefs.py */
+#define XUA_SRC_COEF_Q                      (29)     /* Must match xua_src_coefs.py */
+#define XUA_SRC_DS_COEFS(n)                 xua_src_coefs[n]
+#define XUA_SRC_US_COEFS(n)                 xua_src_coefs[(XUA_SRC_NUM_PHASES - 1) - (n)]
+#define XUA_SRC_DS_ADD_SAMPLE               XUA_Src_DsAddSample
+#define XUA_SRC_DS_ADD_FINAL_SAMPLE         XUA_Src_DsAddFinalSample
+#define XUA_SRC_US_INPUT_SAMPLE             XUA_Src_UsInputSample
+#define XUA_SRC_US_GET_NEXT_SAMPLE          XUA_Src_UsGetNextSample
+
+/* Polyphase filter coefficients, [phase][tap]. Each phase has a gain of XUA_SRC_RATIO */
+extern const int32_t xua_src_coefs[XUA_SRC_NUM_PHASES][XUA_SRC_TAPS_PER_PHASE];
+
+/** Decimator: add a sample (for any phase other than the last) to the partial sum of the next output sample
+ *
+ *  \param sum          Partial sum so far (0 for the first phase)
+ *  \param delayLine    Delay line for this phase
+ *  \param coefs        Coefficients for this phase, XUA_SRC_DS_COEFS(n)
+ *  \param sample       Input sample at the I2S rate
+ *  \returns            Updated partial sum
+ */
+int64_t XUA_Src_DsAddSample(int64_t sum, int32_t delayLine[], const int32_t coefs[], int32_t sample);
+
+/** Decimator: add the sample for the last phase and return the output sample at the USB rate */
+int32_t XUA_Src_DsAddFinalSample(int64_t sum, int32_t delayLine[], const int32_t coefs[], int32_t sample);
+
+/** Interpolator: input a sample at the USB rate and return the first output sample at the I2S rate */
+int32_t XUA_Src_UsInputSample(int32_t delayLine[], const int32_t coefs[], int32_t sample);
+
+/** Interpolator: return the next output sample at the I2S rate */
+int32_t XUA_Src_UsGetNextSample(int32_t delayLine[], const int32_t coefs[]);
+
+#endif
+
+#endif
@@ -0,0 +1,68 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/* AUTOGENERATED using xua_src_coefs.py */
+#include "xua.h"
+#include "xua_src.h"
+
+#if (XUA_SRC_RATIO == 2)
+/* 2:1, 64 taps, Kaiser (beta 7.0) windowed sinc, cut-off 0.96 x USB Nyquist. Q29, phase gain 2 */
+const int32_t xua_src_coefs[XUA_SRC_NUM_PHASES][XUA_SRC_TAPS_PER_PHASE] =
+{
+    {
+             115766,     -288746,      553466,     -906658,     1318216,    -1720974,
+            2000724,    -1985811,     1432961,           0,    -2819004,     7866177,
+          -16838867,    34237058,   -78729001,   467529636,   174271902,   -79205561,
+           50902645,   -35979864,    26151884,   -18991543,    13559073,    -9410842,
+            6288959,    -4006834,     2405561,    -1339768,      676251,     -297398,
+             105198,      -23690,
+    },
+    {
+             -23690,      105198,     -297398,      676251,    -1339768,     2405561,
+           -4006834,     6288959,    -9410842,    13559073,   -18991543,    26151884,
+          -35979864,    50902645,   -79205561,   174271902,   467529636,   -78729001,
+           34237058,   -16838867,     7866177,    -2819004,           0,     1432961,
+           -1985811,     2000724,    -1720974,     1318216,     -906658,      553466,
+            -288746,      115766,
+    },
+};
+#endif
+
+#if (XUA_SRC_RATIO == 4)
+/* 4:1, 128 taps, Kaiser (beta 7.0) windowed sinc, cut-off 0.96 x USB Nyquist. Q29, phase gain 4 */
+const int32_t xua_src_coefs[XUA_SRC_NUM_PHASES][XUA_SRC_TAPS_PER_PHASE] =
+{
+    {
+             166700,     -403417,      786695,    -1343763,     2083454,    -2985724,
+            3991312,    -4991886,     5819438,    -6229879,     5866207,    -4157528,
+                  0,     9508047,   -37164502,   503145455,    93161406,   -51194691,
+           36556800,   -27938686,    21655468,   -16638533,    12512171,    -9127722,
+            6409978,    -4298535,     2726084,    -1613660,      874100,     -418925,
+             165655,      -43706,
+    },
+    {
+              86486,     -197471,      338835,     -476246,      543732,     -435787,
+                  0,      971380,    -2755685,     5731509,   -10456597,    17871487,
+          -29892838,    51542038,  -102407594,   411571411,   258726516,   -99840042,
+           59429107,   -39653111,    27415513,   -19000003,    12954175,    -8572838,
+            5440997,    -3268980,     1828660,     -929763,      412715,     -147564,
+              33968,           0,
+    },
+    {
+                  0,       33968,     -147564,      412715,     -929763,     1828660,
+           -3268980,     5440997,    -8572838,    12954175,   -19000003,    27415513,
+          -39653111,    59429107,   -99840042,   258726516,   411571411,  -102407594,
+           51542038,   -29892838,    17871487,   -10456597,     5731509,    -2755685,
+             971380,           0,     -435787,      543732,     -476246,      338835,
+            -197471,       86486,
+    },
+    {
+             -43706,      165655,     -418925,      874100,    -1613660,     2726084,
+           -4298535,     6409978,    -9127722,    12512171,   -16638533,    21655468,
+          -27938686,    36556800,   -51194691,    93161406,   503145455,   -37164502,
+            9508047,           0,    -4157528,     5866207,    -6229879,     5819438,
+           -4991886,     3991312,    -2985724,     2083454,    -1343763,      786695,
+            -403417,      166700,
+    },
+};
+#endif
+
@@ -0,0 +1,77 @@
+# Copyright 2024 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#
+# Generates xua_src_coefs.c, the polyphase anti-aliasing/anti-imaging filters used by the audiohub and Decoupler
+# for AUD_TO_USB_RATIO and USB_OUT_TO_IN_RATIO values not provided by lib_src.
+#
+# Usage: python3 xua_src_coefs.py > xua_src_coefs.c
+
+import math
+
+TAPS_PER_PHASE = 32     # Must match XUA_SRC_TAPS_PER_PHASE in xua_src.h
+COEF_Q = 29             # Must match XUA_SRC_COEF_Q in xua_src.h
+PASSBAND = 0.96         # Cut-off as a fraction of the lower (USB) Nyquist frequency
+KAISER_BETA = 7.0       # ~70dB stop-band attenuation
+RATIOS = [2, 4]
+
+
+def bessel_i0(x):
+    total = 1.0
+    term = 1.0
+    k = 1
+    while term > 1e-12 * total:
+        term *= (x / (2.0 * k)) ** 2
+        total += term
+        k += 1
+    return total
+
+
+def design(ratio):
+    """Kaiser windowed sinc low-pass at the higher rate, scaled so that each phase has unity gain"""
+    n = ratio * TAPS_PER_PHASE
+    fc = 0.5 * PASSBAND / ratio
+    centre = (n - 1) / 2.0
+    h = []
+    for k in range(n):
+        t = k - centre
+        sinc = 2.0 * fc if t == 0 else math.sin(2.0 * math.pi * fc * t) / (math.pi * t)
+        w = bessel_i0(KAISER_BETA * math.sqrt(1.0 - (2.0 * t / (n - 1)) ** 2)) / bessel_i0(KAISER_BETA)
+        h.append(sinc * w)
+    gain = sum(h)
+    return [ratio * x / gain for x in h]
+
+
+def polyphase(h, ratio):
+    """coefs[q][t] = h[t*ratio + (ratio-1-q)], see xua_src.h for how the phases are used"""
+    return [[h[t * ratio + (ratio - 1 - q)] for t in range(TAPS_PER_PHASE)] for q in range(ratio)]
+
+
+def main():
+    print("// Copyright 2024 XMOS LIMITED.")
+    print("// This Software is subject to the terms of the XMOS Public Licence: Version 1.")
+    print("/* AUTOGENERATED using xua_src_coefs.py */")
+    print("#include \"xua.h\"")
+    print("#include \"xua_src.h\"")
+    print("")
+    for ratio in RATIOS:
+        h = design(ratio)
+        # Decimation sums over all phases, check the worst case fits the 64-bit accumulator
+        assert sum(abs(x) for x in h) * (2 ** 31) * (2 ** COEF_Q) < 2 ** 63
+        print("#if (XUA_SRC_RATIO == %d)" % ratio)
+        print("/* %d:1, %d taps, Kaiser (beta %.1f) windowed sinc, cut-off %.2f x USB Nyquist. Q%d, phase gain %d */"
+              % (ratio, len(h), KAISER_BETA, PASSBAND, COEF_Q, ratio))
+        print("const int32_t xua_src_coefs[XUA_SRC_NUM_PHASES][XUA_SRC_TAPS_PER_PHASE] =")
+        print("{")
+        for phase in polyphase(h, ratio):
+            q = [int(round(x * (2 ** COEF_Q))) for x in phase]
+            print("    {")
+            for i in range(0, len(q), 6):
+                print("        " + " ".join("%11d," % v for v in q[i:i + 6]))
+            print("    },")
+        print("};")
+        print("#endif")
+        print("")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,253 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include "xua.h"
+
+#if (XUA_SYNCMODE == XUA_SYNCMODE_ASYNC)
+#include "xua_feedback.h"
+
+#if (XUA_FEEDBACK_FILTER != XUA_FEEDBACK_FILTER_NONE)
+/* Load the filter such that its output is the given value */
+static void FeedbackFilterPreload(fb_filter_t *f, unsigned value)
+{
+#if (XUA_FEEDBACK_FILTER == XUA_FEEDBACK_FILTER_MOVING_AVERAGE)
+    for(int i = 0; i < XUA_FEEDBACK_MA_LEN; i++)
+    {
+        f->history[i] = value;
+    }
+    f->index = 0;
+    f->sum = value * XUA_FEEDBACK_MA_LEN;
+#else
+    f->acc = (unsigned long long) value << XUA_FEEDBACK_IIR_SHIFT;
+#endif
+    f->residual = 0;
+}
+
+/* Filter a feedback value (16.16), returns the filtered value */
+static unsigned FeedbackFilter(fb_filter_t *f, unsigned value, unsigned highSpeed)
+{
+    unsigned result;
+
+#if (XUA_FEEDBACK_FILTER == XUA_FEEDBACK_FILTER_MOVING_AVERAGE)
+    f->sum = f->sum - f->history[f->index] + value;
+    f->history[f->index] = value;
+    if(++f->index == XUA_FEEDBACK_MA_LEN)
+    {
+        f->index = 0;
+    }
+    result = f->sum / XUA_FEEDBACK_MA_LEN;
+#else
+    /* First order low pass, y += (x - y) / 2^XUA_FEEDBACK_IIR_SHIFT */
+    f->acc = f->acc - (f->acc >> XUA_FEEDBACK_IIR_SHIFT) + value;
+    result = (unsigned) (f->acc >> XUA_FEEDBACK_IIR_SHIFT);
+#endif
+
+    /* Keep the LSBs clear as they are for unfiltered values. The truncated part is carried
+     * forward so that the mean feedback value is not biased */
+    unsigned mask = highSpeed ? FB_LSB_MASK_HS : FB_LSB_MASK_FS;
+    result += f->residual;
+    f->residual = result & mask;
+
+    return result & ~mask;
+}
+#endif
+
+void XUA_Feedback_Reset(xua_feedback_t *fb)
+{
+    fb->clockcounter = 0;
+    fb->modFromLastTime = 0;
+#if FB_USE_REF_CLOCK
+    fb->clockRemainder = 0;
+#endif
+    fb->sofCount = 0;
+    fb->windowCount = 0;
+    fb->windowLog2 = FB_WINDOW_LOG2_START;
+#if (XUA_FEEDBACK_SOF_DEJITTER)
+    fb->dejitter.valid = 0;
+#endif
+#if (XUA_FEEDBACK_FILTER != XUA_FEEDBACK_FILTER_NONE)
+    fb->locking = 1;
+#endif
+}
+
+/* Adds the scaled clock count of count ticks to that of the current window */
+static void FeedbackAccumulate(xua_feedback_t *fb, int count, unsigned sampleFreq, unsigned masterClockFreq,
+    unsigned highSpeed)
+{
+    /* Assuming 48kHz from a 24.576 master clock (0.0407uS period)
+     * MCLK ticks per SOF = 125uS / 0.0407 = 3072 MCLK ticks per SOF.
+     * expected Feedback is 48000/8000 = 6 samples. so 0x60000 in 16:16 format.
+     * Average over 128 SOFs - 128 x 3072 = 0x60000.
+     */
+    unsigned long long feedbackMul = 64ULL;
+
+    /* At full speed (1ms SOFs) 128 SOFs x 24576 = 0x300000. Scaling by 128 rather than 64 gives
+     * the full 14 fractional bits of the 10.14 value sent to the host, see FB_LSB_MASK_FS */
+    if(!highSpeed)
+        feedbackMul = 128ULL;
+
+    unsigned long long full_result = count * feedbackMul * sampleFreq;
+
+#if FB_USE_REF_CLOCK
+    /* This section scales from the 100MHz ref clock to the current MCLK */
+    if (masterClockFreq == MCLK_48)
+    {
+        /* 24.576 / 100 = 768 / 3125 */
+        unsigned long long scaled = full_result * 768;
+        full_result = scaled / 3125;
+        fb->clockRemainder += scaled % 3125;
+        if (fb->clockRemainder >= 3125)
+        {
+            fb->clockRemainder -= 3125;
+            full_result++;
+        }
+    }
+    else //MCLK_441
+    {
+        /* 22.5792 / 100 = 3528 / 15625 */
+        unsigned long long scaled = full_result * 3528;
+        full_result = scaled / 15625;
+        fb->clockRemainder += scaled % 15625;
+        if (fb->clockRemainder >= 15625)
+        {
+            fb->clockRemainder -= 15625;
+            full_result++;
+        }
+    }
+#endif
+    fb->clockcounter += full_result;
+}
+
+/* Calculates the feedback value (16.16) of the window just completed and starts the next */
+static unsigned FeedbackWindowEnd(xua_feedback_t *fb, unsigned masterClockFreq, unsigned highSpeed)
+{
+    fb->sofCount = 0;
+
+    /* Scale the count to that of a 128 SOF window so the precision (and LSBs) of
+     * the result do not depend on the window length */
+    long long clockcounter = (fb->clockcounter << (FB_WINDOW_LOG2_MAX - fb->windowLog2)) + fb->modFromLastTime;
+    unsigned result = clockcounter / masterClockFreq;
+    fb->modFromLastTime = clockcounter % masterClockFreq;
+    fb->clockcounter = 0;
+
+    if(highSpeed)
+    {
+        result <<= 3;
+    }
+    else
+    {
+        result <<= 2;
+    }
+
+#if (XUA_FEEDBACK_FILTER != XUA_FEEDBACK_FILTER_NONE)
+    if(fb->locking)
+    {
+        /* Follow the measurement directly until the first full length window */
+        FeedbackFilterPreload(&fb->filter, result);
+    }
+    else
+    {
+        result = FeedbackFilter(&fb->filter, result, highSpeed);
+    }
+#endif
+    if(fb->windowLog2 < XUA_FEEDBACK_WINDOW_LOG2)
+    {
+        /* Double the window. The remainder is in scaled units so carries over */
+        fb->windowLog2++;
+    }
+#if (XUA_FEEDBACK_FILTER != XUA_FEEDBACK_FILTER_NONE)
+    else
+    {
+        fb->locking = 0;
+    }
+#endif
+
+    return result;
+}
+
+int XUA_Feedback_Sof(xua_feedback_t *fb, int count, unsigned sampleFreq, unsigned masterClockFreq,
+    unsigned highSpeed, unsigned *clocks)
+{
+    FeedbackAccumulate(fb, count, sampleFreq, masterClockFreq, highSpeed);
+
+    fb->sofCount++;
+
+    /* Calculate feedback at the end of each window of SOFs. Once locked the window is
+     * 1 << XUA_FEEDBACK_WINDOW_LOG2 SOFs (by default 128, so 16ms @ HS, 128ms @ FS).
+     * During fast lock the window starts short and doubles until it reaches this length */
+    if(fb->sofCount != (1 << fb->windowLog2))
+    {
+        return 0;
+    }
+
+    *clocks = FeedbackWindowEnd(fb, masterClockFreq, highSpeed);
+    return 1;
+}
+
+int XUA_Feedback_Window(xua_feedback_t *fb, unsigned sampleFreq, unsigned masterClockFreq, unsigned highSpeed,
+    unsigned *clocks)
+{
+    /* The scaling is linear and its remainders are carried forward, so scaling the sum of the counts once gives
+     * exactly the result of scaling each count as it arrives */
+    FeedbackAccumulate(fb, fb->windowCount, sampleFreq, masterClockFreq, highSpeed);
+    fb->windowCount = 0;
+
+    *clocks = FeedbackWindowEnd(fb, masterClockFreq, highSpeed);
+    return 1;
+}
+
+#if (XUA_FEEDBACK_SOF_DEJITTER)
+/* SOFs between corrections of the prediction */
+#define FB_DEJITTER_WINDOW      (1 << FB_WINDOW_LOG2_MAX)
+
+static void DejitterStartWindow(fb_sof_dejitter_t *d)
+{
+    d->windowCount = 0;
+    d->windowMin = 0x7fffffff;
+    d->windowEarly = 0;
+}
+
+unsigned XUA_Feedback_SofLatency(xua_feedback_t *fb, unsigned time, unsigned highSpeed)
+{
+    fb_sof_dejitter_t *d = &fb->dejitter;
+
+    if(!d->valid || (d->highSpeed != highSpeed))
+    {
+        /* Start from the nominal period, 125uS or 1mS of 100MHz ticks */
+        d->valid = 1;
+        d->highSpeed = highSpeed;
+        d->edge = time << 8;
+        d->period = (highSpeed ? (XS1_TIMER_HZ / 8000) : (XS1_TIMER_HZ / 1000)) << 8;
+        DejitterStartWindow(d);
+        return 0;
+    }
+
+    /* The SOFs are evenly spaced so any time beyond the prediction is handling latency. A SOF handled earlier than
+     * predicted has less latency than any before it and becomes the new reference */
+    d->edge += d->period;
+    int latency = (int) ((time << 8) - d->edge);
+    if(latency < 0)
+    {
+        d->edge = time << 8;
+        d->windowEarly -= latency;
+        latency = 0;
+    }
+
+    if(latency < d->windowMin)
+    {
+        d->windowMin = latency;
+    }
+
+    /* At the end of each window move the prediction onto the lowest latency SOF seen and correct the period by the
+     * drift between the two over the window, such that the prediction follows the minimum latency */
+    if(++d->windowCount == FB_DEJITTER_WINDOW)
+    {
+        d->edge += d->windowMin;
+        d->period += (d->windowMin - d->windowEarly) / FB_DEJITTER_WINDOW;
+        DejitterStartWindow(d);
+    }
+
+    return (unsigned) latency >> 8;
+}
+#endif
+#endif
@@ -0,0 +1,95 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_FEEDBACK_H_
+#define _XUA_FEEDBACK_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+#if (XUA_SYNCMODE == XUA_SYNCMODE_ASYNC)
+/* Feedback results are scaled to those of a window of 1 << FB_WINDOW_LOG2_MAX SOFs */
+#define FB_WINDOW_LOG2_MAX      (7)
+
+/* Bits of the 16.16 result that are not sent to the host. The high speed value is sent as 16.16 with
+ * 13 fractional bits, the full speed value as 10.14 (the 16.16 value shifted down by 2) */
+#define FB_LSB_MASK_HS          (7)
+#define FB_LSB_MASK_FS          (3)
+
+/* With fast lock the window starts at 8 SOFs (1ms @ HS, 8ms @ FS) after a sample rate change */
+#if (XUA_FEEDBACK_FAST_LOCK) && (XUA_FEEDBACK_WINDOW_LOG2 > 3)
+#define FB_WINDOW_LOG2_START    (3)
+#else
+#define FB_WINDOW_LOG2_START    (XUA_FEEDBACK_WINDOW_LOG2)
+#endif
+
+#if (XUA_FEEDBACK_FILTER != XUA_FEEDBACK_FILTER_NONE)
+typedef struct
+{
+#if (XUA_FEEDBACK_FILTER == XUA_FEEDBACK_FILTER_MOVING_AVERAGE)
+    unsigned history[XUA_FEEDBACK_MA_LEN];
+    unsigned index;
+    unsigned sum;
+#else
+    unsigned long long acc;
+#endif
+    unsigned residual;
+} fb_filter_t;
+#endif
+
+#if (XUA_FEEDBACK_SOF_DEJITTER)
+/* SOF time prediction (XUA_FEEDBACK_SOF_DEJITTER). Times are reference timer ticks with 8 fractional bits */
+typedef struct
+{
+    unsigned valid;
+    unsigned highSpeed;
+    unsigned edge;                      /* Predicted time of the last SOF at minimum handling latency */
+    unsigned period;                    /* Estimated SOF period */
+    unsigned windowCount;               /* SOFs into the current correction window */
+    int windowMin;                      /* Lowest latency of the window, the prediction being early by this */
+    int windowEarly;                    /* Total by which SOFs of the window were earlier than predicted */
+} fb_sof_dejitter_t;
+#endif
+
+/* Asynchronous feedback state, owned by XUA_Buffer() */
+typedef struct
+{
+    long long clockcounter;             /* Scaled clock count of the current window */
+    unsigned modFromLastTime;           /* Remainder of the last window, carried forward */
+#if FB_USE_REF_CLOCK
+    unsigned long long clockRemainder;  /* The carry term from the 100MHz -> MCLK */
+#endif
+    unsigned sofCount;
+    unsigned windowLog2;
+    int windowCount;                    /* Summed clock count of the window, see XUA_Feedback_Window() */
+#if (XUA_FEEDBACK_SOF_DEJITTER)
+    fb_sof_dejitter_t dejitter;
+#endif
+#if (XUA_FEEDBACK_FILTER != XUA_FEEDBACK_FILTER_NONE)
+    fb_filter_t filter;
+    unsigned locking;
+#endif
+} xua_feedback_t;
+
+/* Resets the feedback state e.g. on a sample rate change. The next window starts at FB_WINDOW_LOG2_START */
+void XUA_Feedback_Reset(REFERENCE_PARAM(xua_feedback_t, fb));
+
+/* Accumulates the clock count of one SOF period, count being MCLK ticks (or 100MHz ticks with FB_USE_REF_CLOCK)
+ * between this SOF and the last. At the end of each window the feedback value (16.16 samples per SOF period) is
+ * stored to clocks and 1 is returned, otherwise returns 0 and clocks is unchanged */
+int XUA_Feedback_Sof(REFERENCE_PARAM(xua_feedback_t, fb), int count, unsigned sampleFreq, unsigned masterClockFreq,
+    unsigned highSpeed, REFERENCE_PARAM(unsigned, clocks));
+
+/* Coalesced form of XUA_Feedback_Sof() (XUA_FEEDBACK_SOF_COALESCE). The caller sums the count of each SOF into
+ * windowCount and bumps sofCount, calling this once sofCount reaches 1 << windowLog2. Stores the feedback value of
+ * the window to clocks, identical to that from XUA_Feedback_Sof() given the same counts, and returns 1 */
+int XUA_Feedback_Window(REFERENCE_PARAM(xua_feedback_t, fb), unsigned sampleFreq, unsigned masterClockFreq,
+    unsigned highSpeed, REFERENCE_PARAM(unsigned, clocks));
+
+#if (XUA_FEEDBACK_SOF_DEJITTER)
+/* Returns the handling latency of the SOF handled at time (reference timer ticks) in excess of the minimum seen,
+ * in reference timer ticks. The clock count taken alongside time, less this latency, is that at the SOF event */
+unsigned XUA_Feedback_SofLatency(REFERENCE_PARAM(xua_feedback_t, fb), unsigned time, unsigned highSpeed);
+#endif
+#endif
+
+#endif
@@ -11,16 +11,23 @@ extern "C"
 {
     #include "sw_pll.h"
 }
+#include "xua_sw_pll_telemetry.h"
 
 /* Special control value to disable SDM. Outside of normal range which is less than 16b.*/
 #define DISABLE_SDM     0x10000000
 
+/* Special control value to slew to a new clock source, see XUA_CLOCK_SWITCH_SEAMLESS */
+#define SLEW_SDM        0x10000001
+
 
 /** Task that receives an error term, passes it through a PI controller and periodically
  *  calclulates a sigma delta output value and sends it to the PLL fractional register.
  *
+ *  The task is combinable, see XUA_SW_PLL_COMBINE_TASKS.
+ *
  *  \param c_sw_pll                 Channel connected to the clocking thread to pass raw error terms.
  */
+[[combinable]]
 void sw_pll_task(chanend c_sw_pll);
 
 /** Helper function that sends a special restart command. It causes the SDM task
@@ -31,6 +38,14 @@ void sw_pll_task(chanend c_sw_pll);
  */
 void restart_sigma_delta(chanend c_sw_pll, unsigned mclk_rate);
 
+/** Helper function that sends a special slew command whilst the SDM is running. Until lock is next acquired the
+ *  error acted on is limited to XUA_CLOCK_SWITCH_SLEW_ERROR, and the fast lock gain is not applied, such that the
+ *  mclk moves to the frequency of a new clock source at a bounded rate.
+ *
+ *  \param c_sw_pll                 Channel connected to the clocking thread to pass raw error terms.
+ */
+void slew_sigma_delta(chanend c_sw_pll);
+
 /** Performs a frequency comparsion between the incoming digital Rx stream and the local mclk.
  *
  *  \param mclk_time_stamp  The captured mclk count (using port timer) at the time of sample Rx.
@@ -0,0 +1,240 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+
+#if (XUA_DIG_RX_ASRC)
+#include <math.h>
+#include <string.h>
+#include "xua_asrc.h"
+
+/* Filter cutoff as a fraction of the input rate (the transition band of the window extends roughly 0.06 either
+ * side) */
+#define ASRC_CUTOFF         (0.44)
+
+#define ASRC_ONE            (1 << 30)
+
+int g_xua_asrc_coeffs[(XUA_ASRC_PHASES + 1) * XUA_ASRC_TAPS];
+
+static int asrcFrame[XUA_ASRC_FRAME_WORDS];
+
+#if defined(__XS3A__)
+/* Dot products of the filter window of all XUA_ASRC_MAX_CHANS channels with one phase of coefficients, see
+ * xua_asrc_vpu.S. stride is the distance in bytes between the histories of adjacent channels */
+void asrcDotVpu(int result[XUA_ASRC_MAX_CHANS], const int *window, const int *coeffs, unsigned stride);
+#endif
+
+static void AsrcDot(xua_asrc_t *asrc, int result[XUA_ASRC_MAX_CHANS], unsigned start, const int *coeffs)
+{
+#if defined(__XS3A__)
+    asrcDotVpu(result, &asrc->history[0][start], coeffs, sizeof(asrc->history[0]));
+#else
+    for(unsigned c = 0; c < asrc->chans; c++)
+    {
+        const int *x = &asrc->history[c][start];
+        long long acc = 0;
+
+        for(unsigned i = 0; i < XUA_ASRC_TAPS; i++)
+        {
+            acc += ((long long)x[i] * coeffs[i] + (1 << 29)) >> 30;
+        }
+
+        if(acc > 0x7fffffffLL)
+            acc = 0x7fffffffLL;
+        else if(acc < -0x80000000LL)
+            acc = -0x80000000LL;
+
+        result[c] = (int)acc;
+    }
+#endif
+}
+
+/* Windowed sinc with the window (4 term Blackman-Harris) spanning XUA_ASRC_TAPS input frames, t in input frames */
+static double AsrcPrototype(double t)
+{
+    const double half = XUA_ASRC_TAPS / 2;
+    double u = t / half;
+    double w, s;
+
+    if((u <= -1.0) || (u >= 1.0))
+        return 0.0;
+
+    w = 0.35875 + 0.48829 * cos(M_PI * u) + 0.14128 * cos(2 * M_PI * u) + 0.01168 * cos(3 * M_PI * u);
+
+    if(t == 0.0)
+        s = 2 * ASRC_CUTOFF;
+    else
+        s = sin(2 * M_PI * ASRC_CUTOFF * t) / (M_PI * t);
+
+    return s * w;
+}
+
+void XUA_Asrc_InitCoeffs(void)
+{
+    for(int p = 0; p <= XUA_ASRC_PHASES; p++)
+    {
+        double h[XUA_ASRC_TAPS];
+        double sum = 0;
+        int *coeffs = &g_xua_asrc_coeffs[p * XUA_ASRC_TAPS];
+
+        /* The output is at (XUA_ASRC_TAPS / 2 - 1) + p / XUA_ASRC_PHASES frames after the oldest frame of the
+         * window, such that the window spans half the filter either side */
+        for(int i = 0; i < XUA_ASRC_TAPS; i++)
+        {
+            h[i] = AsrcPrototype((double) p / XUA_ASRC_PHASES + (XUA_ASRC_TAPS / 2 - 1) - i);
+            sum += h[i];
+        }
+
+        /* Unity gain at DC for every phase */
+        for(int i = 0; i < XUA_ASRC_TAPS; i++)
+        {
+            coeffs[i] = (int) lround(h[i] / sum * ASRC_ONE);
+        }
+    }
+}
+
+void XUA_Asrc_Start(xua_asrc_t *asrc, unsigned chans)
+{
+    memset(asrc->history, 0, sizeof(asrc->history));
+    asrc->chans = chans;
+    asrc->state = chans ? XUA_ASRC_STATE_MEASURE : XUA_ASRC_STATE_IDLE;
+    asrc->inCount = 0;
+    asrc->lastInTime = 0;
+    asrc->inPeriod = 0;
+    asrc->measureIn = 0;
+    asrc->measureInTime = 0;
+    asrc->measureOutTime = 0;
+    asrc->outCount = 0;
+    asrc->rdPos = 0;
+    asrc->ratio = 0;
+    asrc->error = 0;
+    asrc->resets = 0;
+}
+
+void XUA_Asrc_Input(xua_asrc_t *asrc, const int samples[], unsigned time)
+{
+    unsigned wr = asrc->inCount & (XUA_ASRC_HISTORY - 1);
+
+    for(unsigned c = 0; c < asrc->chans; c++)
+    {
+        asrc->history[c][wr] = samples[c];
+        asrc->history[c][wr + XUA_ASRC_HISTORY] = samples[c];
+    }
+
+    asrc->inCount++;
+    asrc->lastInTime = time;
+}
+
+/* Input frames received by time, 32.32. The fraction is the time since the last input frame */
+static inline unsigned long long AsrcInPos(xua_asrc_t *asrc, unsigned time)
+{
+    int since = (int)(time - asrc->lastInTime);
+    unsigned long long frac = 0;
+
+    if(since >= (int)(asrc->inPeriod >> 16))
+        frac = 0xffffffff;
+    else if(since > 0)
+        frac = ((unsigned long long) since << 48) / asrc->inPeriod;
+
+    return ((unsigned long long) asrc->inCount << 32) + frac;
+}
+
+/* Position the next output window such that the fill is on target */
+static inline void AsrcPrime(xua_asrc_t *asrc, unsigned long long inPos)
+{
+    asrc->rdPos = inPos - ((unsigned long long)(XUA_ASRC_TAPS + XUA_ASRC_FILL) << 32);
+}
+
+void XUA_Asrc_Output(xua_asrc_t *asrc, int samples[], unsigned time)
+{
+    /* Measurement starts at the first output with the input flowing */
+    if((asrc->state == XUA_ASRC_STATE_MEASURE) && asrc->inCount)
+    {
+        if(asrc->outCount == 0)
+        {
+            asrc->measureIn = asrc->inCount;
+            asrc->measureInTime = asrc->lastInTime;
+            asrc->measureOutTime = time;
+        }
+
+        if(++asrc->outCount == XUA_ASRC_MEASURE_FRAMES)
+        {
+            unsigned inFrames = asrc->inCount - asrc->measureIn;
+            unsigned long long outPeriod = ((unsigned long long)(time - asrc->measureOutTime) << 16)
+                / (XUA_ASRC_MEASURE_FRAMES - 1);
+            unsigned long long inPeriod = 0;
+
+            if(inFrames)
+            {
+                inPeriod = ((unsigned long long)(asrc->lastInTime - asrc->measureInTime) << 16) / inFrames;
+            }
+
+            if((inPeriod == 0) || ((outPeriod << 32) / inPeriod > XUA_ASRC_MAX_RATIO))
+            {
+                asrc->state = XUA_ASRC_STATE_RANGE;
+            }
+            else
+            {
+                asrc->inPeriod = (unsigned) inPeriod;
+                asrc->ratio = (long long)((outPeriod << 32) / inPeriod);
+                asrc->state = XUA_ASRC_STATE_RUN;
+                AsrcPrime(asrc, AsrcInPos(asrc, time));
+            }
+        }
+    }
+
+    if(asrc->state != XUA_ASRC_STATE_RUN)
+    {
+        for(unsigned c = 0; c < asrc->chans; c++)
+        {
+            samples[c] = 0;
+        }
+        return;
+    }
+
+    /* Input frames buffered from the start of the window, 32.32 */
+    unsigned long long inPos = AsrcInPos(asrc, time);
+    long long fill = (long long)(inPos - asrc->rdPos);
+    long long frames = (long long)(((unsigned long long)asrc->inCount << 32) - asrc->rdPos);
+
+    if((frames < ((long long)XUA_ASRC_TAPS << 32)) || (frames > ((long long)XUA_ASRC_HISTORY << 32)))
+    {
+        /* The input stalled or jumped, restart at the target fill keeping the ratio */
+        asrc->resets++;
+        AsrcPrime(asrc, inPos);
+        fill = (long long)(XUA_ASRC_TAPS + XUA_ASRC_FILL) << 32;
+    }
+
+    unsigned frac = (unsigned) asrc->rdPos;
+    unsigned start = (unsigned)(asrc->rdPos >> 32) & (XUA_ASRC_HISTORY - 1);
+    unsigned phase = frac >> (32 - XUA_ASRC_PHASES_LOG2);
+    long long alpha = (unsigned)(frac << XUA_ASRC_PHASES_LOG2);
+    const int *coeffs = &g_xua_asrc_coeffs[phase * XUA_ASRC_TAPS];
+    int y0[XUA_ASRC_MAX_CHANS];
+    int y1[XUA_ASRC_MAX_CHANS];
+
+    AsrcDot(asrc, y0, start, coeffs);
+    AsrcDot(asrc, y1, start, coeffs + XUA_ASRC_TAPS);
+
+    /* Interpolate between adjacent phases */
+    for(unsigned c = 0; c < asrc->chans; c++)
+    {
+        samples[c] = (int)(y0[c] + ((((long long)y1[c] - y0[c]) * alpha) >> 32));
+    }
+
+    /* PI loop on the fill, the integral term being the ratio */
+    long long error = fill - ((long long)(XUA_ASRC_TAPS + XUA_ASRC_FILL) << 32);
+    asrc->ratio += error >> XUA_ASRC_KI_SHIFT;
+    asrc->rdPos += asrc->ratio + (error >> XUA_ASRC_KP_SHIFT);
+    asrc->error = error;
+}
+
+void XUA_Asrc_PutFrame(const int frame[XUA_ASRC_FRAME_WORDS])
+{
+    memcpy(asrcFrame, frame, sizeof(asrcFrame));
+}
+
+void XUA_Asrc_GetFrame(int frame[XUA_ASRC_FRAME_WORDS])
+{
+    memcpy(frame, asrcFrame, sizeof(asrcFrame));
+}
+#endif
@@ -0,0 +1,109 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_ASRC_H_
+#define _XUA_ASRC_H_
+
+#include "xua.h"
+
+#if (XUA_DIG_RX_ASRC)
+/* Asynchronous sample rate conversion of the digital inputs (XUA_DIG_RX_ASRC) into the local clock domain.
+ *
+ * Each output frame is interpolated from a polyphase FIR (XUA_ASRC_TAPS taps, XUA_ASRC_PHASES phases with linear
+ * interpolation between adjacent phases) over the input history. Input and output frames are time-stamped (with
+ * the 100MHz reference timer) such that the number of input frames buffered at an output is known to a fraction
+ * of a frame. The ratio of input to output rate is first measured from the time-stamps and then trimmed by a PI
+ * loop that holds the buffered input at XUA_ASRC_TAPS + XUA_ASRC_FILL frames. The latency is therefore fixed, at
+ * XUA_ASRC_TAPS / 2 + XUA_ASRC_FILL input frames */
+
+#define XUA_ASRC_MAX_CHANS      (8)
+#define XUA_ASRC_TAPS           (64)        /* Multiple of 8 */
+#define XUA_ASRC_PHASES         (64)        /* Power of 2 */
+#define XUA_ASRC_PHASES_LOG2    (6)
+#define XUA_ASRC_HISTORY        (128)       /* Input frames held per channel, power of 2 */
+#define XUA_ASRC_FILL           (16)        /* Target input frames buffered beyond the filter window */
+
+/* Output frames over which the ratio is measured before conversion starts */
+#define XUA_ASRC_MEASURE_FRAMES (16384)
+
+/* Loop gains as right shifts of the fill error (32.32 input frames). The integral gain is a quarter of the square
+ * of the proportional gain, for a critically damped loop. The loop only has to correct the error of the measured
+ * ratio and so is slow, such that time-stamp jitter does not modulate the output */
+#define XUA_ASRC_KP_SHIFT       (16)
+#define XUA_ASRC_KI_SHIFT       (34)
+
+#if (XUA_ASRC_TAPS + XUA_ASRC_FILL) > ((3 * XUA_ASRC_HISTORY) / 4)
+#error XUA_ASRC_HISTORY too short for XUA_ASRC_TAPS and XUA_ASRC_FILL
+#endif
+
+/* Converter instances and their position in the frame passed to the audiohub (g_digData) */
+#define XUA_ASRC_SPDIF          (0)
+#define XUA_ASRC_ADAT           (1)
+#define XUA_ASRC_INSTANCES      (2)
+#define XUA_ASRC_FRAME_WORDS    (10)
+
+/* Commands from clockGen() to XUA_DigRxAsrc() */
+#define XUA_ASRC_CMD_START      (0)         /* Followed by the instance and channel count */
+#define XUA_ASRC_CMD_STOP       (1)         /* Followed by the instance */
+#define XUA_ASRC_CMD_INPUT      (2)         /* Followed by the instance, time-stamp and a frame of samples */
+#define XUA_ASRC_CMD_OUTPUT     (3)         /* Followed by a time-stamp, produce the next output frame of every
+                                             * running instance */
+
+/* Converter states */
+#define XUA_ASRC_STATE_IDLE     (0)         /* Not started */
+#define XUA_ASRC_STATE_MEASURE  (1)         /* Measuring the rate ratio, outputs are muted */
+#define XUA_ASRC_STATE_RUN      (2)         /* Converting */
+#define XUA_ASRC_STATE_RANGE    (3)         /* Ratio out of range (input faster than XUA_ASRC_MAX_RATIO), muted */
+
+/* Largest ratio of input to output rate converted (32.32). Higher ratios, for example a 96kHz input to a 48kHz
+ * device, would alias with the fixed filter */
+#define XUA_ASRC_MAX_RATIO      ((110ULL << 32) / 100)
+
+#ifndef __ASSEMBLER__
+#include <xccompat.h>
+
+typedef struct
+{
+    int history[XUA_ASRC_MAX_CHANS][2 * XUA_ASRC_HISTORY];  /* Each frame is written twice such that the filter
+                                                             * window is always contiguous */
+    unsigned chans;
+    unsigned state;
+    unsigned inCount;                   /* Input frames received (wrapping), frame i is at history index
+                                         * i & (XUA_ASRC_HISTORY - 1) */
+    unsigned lastInTime;                /* Time-stamp of the last input frame */
+    unsigned inPeriod;                  /* Time between input frames, 16.16 timer ticks */
+    unsigned measureIn;                 /* Input frames at the start of the measurement */
+    unsigned measureInTime;             /* Time-stamp of that input frame */
+    unsigned measureOutTime;            /* Time-stamp of the first output of the measurement */
+    unsigned outCount;                  /* Output frames produced since the start of the measurement */
+    unsigned long long rdPos;           /* Input frame count, 32.32, at the start of the next output's window */
+    long long ratio;                    /* Input frames per output frame (32.32), the integral term of the loop */
+    long long error;                    /* Last fill error (32.32 frames) */
+    unsigned resets;                    /* Times the fill left the history and conversion restarted */
+} xua_asrc_t;
+
+/* Polyphase filter coefficients with 30 fractional bits. Phase p is at [p * XUA_ASRC_TAPS] and is stored in time
+ * order of the input samples it multiplies (oldest first). Phase XUA_ASRC_PHASES ends the table such that phase
+ * p + 1 is always present for interpolation */
+extern int g_xua_asrc_coeffs[(XUA_ASRC_PHASES + 1) * XUA_ASRC_TAPS];
+
+/* Generates g_xua_asrc_coeffs. Called once by XUA_DigRxAsrc() before servicing clockGen() */
+void XUA_Asrc_InitCoeffs(void);
+
+/* Resets a converter for chans channels (0 to stop) and starts measuring the rate ratio */
+void XUA_Asrc_Start(REFERENCE_PARAM(xua_asrc_t, asrc), unsigned chans);
+
+/* Adds a frame of chans input samples received at time */
+void XUA_Asrc_Input(REFERENCE_PARAM(xua_asrc_t, asrc), const int samples[], unsigned time);
+
+/* Produces a frame of chans output samples for time, zeros unless converting */
+void XUA_Asrc_Output(REFERENCE_PARAM(xua_asrc_t, asrc), int samples[], unsigned time);
+
+/* Output frame handed from XUA_DigRxAsrc() to clockGen(), in the layout of g_digData. It is written on each
+ * XUA_ASRC_CMD_OUTPUT and read by clockGen() on the next audiohub request, before it sends the next
+ * XUA_ASRC_CMD_OUTPUT. Both tasks must therefore be on the same tile */
+void XUA_Asrc_PutFrame(const int frame[XUA_ASRC_FRAME_WORDS]);
+void XUA_Asrc_GetFrame(int frame[XUA_ASRC_FRAME_WORDS]);
+#endif /* __ASSEMBLER__ */
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_DIG_RX_STATS_H_
+#define _XUA_DIG_RX_STATS_H_
+
+/* Digital receive FIFO statistics (XUA_DIG_RX_ELASTIC). Written by clockGen() on each sample request from the
+ * audiohub and held on the tile clockGen() runs on (AUDIO_IO_TILE). Fill levels are in samples */
+typedef struct
+{
+    unsigned fill;          /* Fill at the last request */
+    unsigned minFill;       /* Lowest fill whilst streaming since the last reset */
+    unsigned maxFill;       /* Highest fill whilst streaming since the last reset */
+    unsigned slips;         /* Frames dropped above the high watermark */
+    unsigned repeats;       /* Frames repeated below the low watermark */
+    unsigned overflows;     /* Times the FIFO filled and input was discarded until half empty */
+    unsigned underflows;    /* Times the FIFO emptied and zeros were output until half full */
+    unsigned reset;         /* Set non-zero to clear the above, cleared by clockGen() */
+} xua_dig_rx_stats_t;
+
+#if (XUA_SPDIF_RX_EN)
+extern xua_dig_rx_stats_t g_xua_spdif_rx_stats;
+#endif
+#if (XUA_ADAT_RX_EN)
+extern xua_dig_rx_stats_t g_xua_adat_rx_stats;
+#endif
+
+#endif
@@ -0,0 +1,20 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_SW_PLL_TELEMETRY_H_
+#define _XUA_SW_PLL_TELEMETRY_H_
+
+/* Software PLL telemetry (XUA_SW_PLL_TELEMETRY). Written by sw_pll_task() on each control loop update
+ * and held on the tile the task runs on (AUDIO_IO_TILE) */
+typedef struct
+{
+    int error;              /* Last frequency error received, in mclk counts */
+    int ctrlVal;            /* Last control value passed to the sigma delta modulator */
+    unsigned locked;        /* Non-zero when the error has been within XUA_SW_PLL_LOCK_THRESHOLD for XUA_SW_PLL_LOCK_COUNT updates */
+    unsigned lockTime;      /* Reference timer ticks from (re)start to first lock, 0 until locked */
+    unsigned updates;       /* Control loop updates since (re)start */
+    unsigned restarts;      /* Number of times the PLL has been (re)started, e.g. on mclk change */
+} xua_sw_pll_telemetry_t;
+
+extern xua_sw_pll_telemetry_t g_xua_sw_pll_telemetry;
+
+#endif
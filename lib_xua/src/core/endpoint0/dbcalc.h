@@ -1,4 +1,4 @@
-// Copyright 2011-2021 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #ifndef __dbcalc_h__
 #define __dbcalc_h__
@@ -19,4 +19,17 @@
 */
 unsigned db_to_mult(int db, int db_frac_bits, int result_frac_bits);
 
+/* Function: db_to_vol_mult
+
+     This function converts decibels into a volume multiplier using a lookup table with linear interpolation.
+     Equivalent to db_to_mult(db, 8, 29).
+
+   Parameters:
+       db               - The db value to convert, with 8 binary fractional bits.
+
+   Returns:
+       The multiplier value as a fixed point value with 29 fractional bits.
+*/
+unsigned db_to_vol_mult(int db);
+
 #endif // __dbcalc_h__
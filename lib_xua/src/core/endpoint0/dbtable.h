@@ -0,0 +1,39 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+/* AUTOGENERATED using dbtablegen.py */
+#ifndef __dbtable_h__
+#define __dbtable_h__
+
+#define DB_TABLE_MIN            (-128)
+#define DB_TABLE_MAX            (9)
+#define DB_TABLE_FRAC_BITS      (29)
+
+/* 10^(dB/10) for every whole dB from DB_TABLE_MIN to DB_TABLE_MAX, as used by db_to_mult(), Q29 */
+static const unsigned dbTable[DB_TABLE_MAX - DB_TABLE_MIN + 1] =
+{
+             0,          0,          0,          0,          0,          0,
+             0,          0,          0,          0,          0,          0,
+             0,          0,          0,          0,          0,          0,
+             0,          0,          0,          0,          0,          0,
+             0,          0,          0,          0,          0,          0,
+             0,          0,          0,          0,          0,          0,
+             0,          0,          1,          1,          1,          1,
+             1,          2,          2,          3,          3,          4,
+             5,          7,          9,         11,         13,         17,
+            21,         27,         34,         43,         54,         68,
+            85,        107,        135,        170,        214,        269,
+           339,        426,        537,        676,        851,       1071,
+          1349,       1698,       2137,       2691,       3387,       4265,
+          5369,       6759,       8509,      10712,      13486,      16977,
+         21373,      26907,      33874,      42645,      53687,      67588,
+         85088,     107120,     134856,     169773,     213732,     269073,
+        338743,     426452,     536871,     675880,     850883,    1071198,
+       1348559,    1697735,    2137322,    2690728,    3387426,    4264517,
+       5368709,    6758804,    8508831,   10711983,   13485588,   16977349,
+      21373216,   26907285,   33874264,   42645172,   53687091,   67588043,
+      85088305,  107119830,  134855876,  169773489,  213732160,  269072847,
+     338742645,  426451724,  536870912,  675880434,  850883054, 1071198299,
+    1348558759, 1697734891, 2137321597, 2690728472, 3387426450, 4264517238,
+};
+
+#endif // __dbtable_h__
@@ -0,0 +1,38 @@
+# Copyright 2024 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#
+# Generates dbtable.h, the 1dB step lookup table used by db_to_vol_mult() in dbcalc.xc
+#
+# Usage: python3 dbtablegen.py > dbtable.h
+
+DB_TABLE_MIN = -128     # Must cover MIN_VOLUME (default -127dB)
+DB_TABLE_MAX = 9        # Largest value before a Q29 multiplier overflows 32 bits
+RESULT_FRAC_BITS = 29   # Matches the volume multipliers built in xua_ep0_uacreqs.xc
+
+
+def main():
+    print("// Copyright 2024 XMOS LIMITED.")
+    print("// This Software is subject to the terms of the XMOS Public Licence: Version 1.")
+    print("/* AUTOGENERATED using dbtablegen.py */")
+    print("#ifndef __dbtable_h__")
+    print("#define __dbtable_h__")
+    print("")
+    print("#define DB_TABLE_MIN            (%d)" % DB_TABLE_MIN)
+    print("#define DB_TABLE_MAX            (%d)" % DB_TABLE_MAX)
+    print("#define DB_TABLE_FRAC_BITS      (%d)" % RESULT_FRAC_BITS)
+    print("")
+    print("/* 10^(dB/10) for every whole dB from DB_TABLE_MIN to DB_TABLE_MAX, as used by db_to_mult(), "
+          "Q%d */" % RESULT_FRAC_BITS)
+    print("static const unsigned dbTable[DB_TABLE_MAX - DB_TABLE_MIN + 1] =")
+    print("{")
+    q = [int(round(pow(10, db / 10.0) * (1 << RESULT_FRAC_BITS))) for db in range(DB_TABLE_MIN, DB_TABLE_MAX + 1)]
+    assert max(q) < (1 << 32)
+    for i in range(0, len(q), 6):
+        print("    " + " ".join("%10d," % v for v in q[i:i + 6]))
+    print("};")
+    print("")
+    print("#endif // __dbtable_h__")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,4 +1,4 @@
-// Copyright 2015-2023 XMOS LIMITED.
+// Copyright 2015-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #ifndef __DESCRIPTOR_DEFS_H__
@@ -10,23 +10,32 @@
 #include "xua.h"
 
 #if (NUM_USB_CHAN_IN > 0) && (NUM_USB_CHAN_OUT > 0)
-#define AUDIO_INTERFACE_COUNT 3
+#define AUDIO_INTERFACE_COUNT_MAIN 3
 #elif (NUM_USB_CHAN_IN > 0) || (NUM_USB_CHAN_OUT > 0)
-#define AUDIO_INTERFACE_COUNT 2
+#define AUDIO_INTERFACE_COUNT_MAIN 2
 #else
-#define AUDIO_INTERFACE_COUNT 1
+#define AUDIO_INTERFACE_COUNT_MAIN 1
+#endif
+
+/* Including the auxiliary input stream interface */
+#if (XUA_AUX_IN_EN)
+#define AUDIO_INTERFACE_COUNT (AUDIO_INTERFACE_COUNT_MAIN + 1)
+#else
+#define AUDIO_INTERFACE_COUNT AUDIO_INTERFACE_COUNT_MAIN
 #endif
 
 /* Endpoint address defines */
 #define ENDPOINT_ADDRESS_IN_CONTROL               (ENDPOINT_NUMBER_IN_CONTROL | 0x80)
 #define ENDPOINT_ADDRESS_IN_FEEDBACK              (ENDPOINT_NUMBER_IN_FEEDBACK | 0x80)
 #define ENDPOINT_ADDRESS_IN_AUDIO                 (ENDPOINT_NUMBER_IN_AUDIO | 0x80)
+#define ENDPOINT_ADDRESS_IN_AUDIO_AUX             (ENDPOINT_NUMBER_IN_AUDIO_AUX | 0x80)
 #define ENDPOINT_ADDRESS_IN_INTERRUPT             (ENDPOINT_NUMBER_IN_INTERRUPT | 0x80)
 #define ENDPOINT_ADDRESS_IN_MIDI                  (ENDPOINT_NUMBER_IN_MIDI | 0x80)
 #define ENDPOINT_ADDRESS_IN_HID                   (ENDPOINT_NUMBER_IN_HID | 0x80)
 #define ENDPOINT_ADDRESS_IN_IAP_INT               (ENDPOINT_NUMBER_IN_IAP_INT | 0x80)
 #define ENDPOINT_ADDRESS_IN_IAP                   (ENDPOINT_NUMBER_IN_IAP | 0x80)
 #define ENDPOINT_ADDRESS_IN_IAP_EA_NATIVE_TRANS   (ENDPOINT_NUMBER_IN_IAP_EA_NATIVE_TRANS | 0x80)
+#define ENDPOINT_ADDRESS_IN_LEVEL_METER           (ENDPOINT_NUMBER_IN_LEVEL_METER | 0x80)
 
 #define ENDPOINT_ADDRESS_OUT_CONTROL              (ENDPOINT_NUMBER_OUT_CONTROL)
 #define ENDPOINT_ADDRESS_OUT_AUDIO                (ENDPOINT_NUMBER_OUT_AUDIO)
@@ -45,6 +54,9 @@ enum USBInterfaceNumber
 #if (NUM_USB_CHAN_IN > 0)
     INTERFACE_NUMBER_AUDIO_INPUT,
 #endif
+#if (XUA_AUX_IN_EN)
+    INTERFACE_NUMBER_AUDIO_INPUT_AUX,
+#endif
 #if defined(MIDI) && (MIDI != 0)
     INTERFACE_NUMBER_MIDI_CONTROL,
     INTERFACE_NUMBER_MIDI_STREAM,
@@ -63,6 +75,9 @@ enum USBInterfaceNumber
 #endif
 #if XUA_OR_STATIC_HID_ENABLED
     INTERFACE_NUMBER_HID,
+#endif
+#if (XUA_LEVEL_METER_EP_EN)
+    INTERFACE_NUMBER_LEVEL_METER,
 #endif
     INTERFACE_COUNT          /* End marker */
 };
@@ -75,4 +90,13 @@ enum USBInterfaceNumber
 #define ENDPOINT_INT_INTERVAL_OUT_HID 0x08
 #endif
 
+/* Level meter endpoint polling interval. 0x04 is 1ms at high-speed */
+#ifndef ENDPOINT_INT_INTERVAL_IN_LEVEL_METER
+#define ENDPOINT_INT_INTERVAL_IN_LEVEL_METER 0x04
+#endif
+
+#if (XUA_LEVEL_METER_EP_EN) && (XUA_LEVEL_METER_EP_BYTES > 1024)
+#error Too many level meter channels for the level meter endpoint (XUA_LEVEL_METER_EP_BYTES > 1024)
+#endif
+
 #endif
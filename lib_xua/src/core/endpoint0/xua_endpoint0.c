@@ -25,6 +25,14 @@
 #include "vendorrequests.h"
 #include "xc_ptr.h"
 #include "xua_ep0_uacreqs.h"
+#include "xua_ep0_vendorreqs.h"
+#include "xua_mixer_eq.h"
+#include "xua_memory.h"
+#include "xua_startup.h"
+#include "xua_event_log.h"
+#if (XUA_MIXER_SCENES)
+#include "xua_ep0_scene.h"
+#endif
 
 #if XUA_OR_STATIC_HID_ENABLED
 #include "hid.h"
@@ -118,6 +126,20 @@ unsigned char channelMapUsb[NUM_USB_CHAN_IN];
 
 /* Mapping of channels to Mixer(s) */
 unsigned char mixSel[MAX_MIX_COUNT][MIX_INPUTS];
+
+#if (XUA_MIXER_EQ_BIQUADS > 0)
+/* Output EQ coefficients, as loaded into the mixer */
+int mixerEqCoeffs[XUA_MIXER_EQ_CHANS][XUA_MIXER_EQ_BANK_COEFFS];
+#endif
+#endif
+
+#if (XUA_MIXER_CHANGE_COUNTERS)
+unsigned g_mixerChangeCount[XUA_MIXER_CHANGE_COUNT];
+#endif
+
+#if (XUA_STATUS_INT_EN)
+/* Kept for XUA_Endpoint0_notifyChange(), which runs in the Endpoint 0 thread */
+static unsigned g_c_statusInt;
 #endif
 
 int min(int x, int y);
@@ -245,7 +267,15 @@ const unsigned g_dataFormat_In[INPUT_FORMAT_COUNT]      = {STREAM_FORMAT_INPUT_1
 };
 
 /* Channel count */
-/* Note, currently only input changes.. */
+const unsigned g_chanCount_Out_HS[OUTPUT_FORMAT_COUNT]     = {HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT,
+#if(OUTPUT_FORMAT_COUNT > 1)
+                                                            HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT,
+#endif
+#if(OUTPUT_FORMAT_COUNT > 2)
+                                                            HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT
+#endif
+};
+
 const unsigned g_chanCount_In_HS[INPUT_FORMAT_COUNT]       = {HS_STREAM_FORMAT_INPUT_1_CHAN_COUNT,
 #if(INPUT_FORMAT_COUNT > 1)
                                                             HS_STREAM_FORMAT_INPUT_2_CHAN_COUNT,
@@ -255,6 +285,23 @@ const unsigned g_chanCount_In_HS[INPUT_FORMAT_COUNT]       = {HS_STREAM_FORMAT_I
 #endif
 };
 
+#if (XUA_CHAN_PROFILE_EN)
+/* Channel profile the device enumerated with, see XUA_Endpoint0_setChanProfile() */
+static unsigned g_chanProfile = XUA_CHAN_PROFILE_FULL;
+
+/* Channel count of a high-speed stream format of chans channels in the current profile */
+static inline unsigned ProfileChans(unsigned chans, unsigned profileChans)
+{
+    if((g_chanProfile == XUA_CHAN_PROFILE_REDUCED) && (chans > profileChans))
+    {
+        return profileChans;
+    }
+    return chans;
+}
+#else
+#define ProfileChans(chans, profileChans)  (chans)
+#endif
+
 XUD_ep ep0_out;
 XUD_ep ep0_in;
 
@@ -301,6 +348,15 @@ void InitLocalMixerState()
         {
             mixSel[j][i] = i;
         }
+
+#if (XUA_MIXER_EQ_BIQUADS > 0)
+    /* Pass through, as the mixer starts */
+    for(int j = 0; j < XUA_MIXER_EQ_CHANS; j++)
+        for(int i = 0; i < XUA_MIXER_EQ_BANK_COEFFS; i++)
+        {
+            mixerEqCoeffs[j][i] = ((i % XUA_MIXER_EQ_COEFFS) == 0) ? (1 << XUA_MIXER_EQ_FRAC_BITS) : 0;
+        }
+#endif
 }
 #endif
 
@@ -336,6 +392,9 @@ void XUA_Endpoint0_setStrTable() {
 #if (XUA_ADAT_RX_EN)
     concatenateAndCopyStrings(g_vendor_str, " ADAT Clock", g_strTable.adatClockSourceStr);
 #endif
+#if (XUA_WORDCLOCK_RX_EN)
+    concatenateAndCopyStrings(g_vendor_str, " Word Clock", g_strTable.wordClockSourceStr);
+#endif
 #if (XUA_DFU_EN == 1)
     concatenateAndCopyStrings(g_vendor_str, " DFU", g_strTable.dfuStr);
 #endif
@@ -451,36 +510,418 @@ static unsigned char hidReportDescriptorPtr[] = {
 
 
 
-void XUA_Endpoint0_init(chanend c_ep0_out, chanend c_ep0_in, NULLABLE_RESOURCE(chanend, c_audioControl),
-    chanend c_mix_ctl, chanend c_clk_ctl, chanend c_EANativeTransport_ctrl, CLIENT_INTERFACE(i_dfu, dfuInterface) VENDOR_REQUESTS_PARAMS_DEC_)
+#if (XUA_CHAN_STRINGS_ON_DEMAND)
+/* String table indices of the first channel name strings */
+#define STR_INDEX_OUTPUT_CHAN_1 (offsetof(StringDescTable_t, outputChanStr_1)/sizeof(char *))
+#define STR_INDEX_INPUT_CHAN_1  (offsetof(StringDescTable_t, inputChanStr_1)/sizeof(char *))
+
+/* Shared buffer for string descriptors built on request */
+static unsigned char g_strDescBuffer[2 + (2 * XUA_MAX_STR_LEN)];
+
+/* Appends "<name> <number>" to str at len, preceded by a "/" if str is not empty. Returns the new length */
+static unsigned appendChanName(char *str, unsigned len, const char *name, unsigned number)
 {
-    ep0_out = XUD_InitEp(c_ep0_out);
-    ep0_in  = XUD_InitEp(c_ep0_in);
+    if(len)
+    {
+        str[len++] = '/';
+    }
 
-    XUA_Endpoint0_setStrTable();
+    while(*name)
+    {
+        str[len++] = *name++;
+    }
+    str[len++] = ' ';
 
-    VendorRequests_Init(VENDOR_REQUESTS_PARAMS);
+    if(number >= 10)
+    {
+        str[len++] = '0' + (number / 10);
+    }
+    str[len++] = '0' + (number % 10);
 
-#if (MIXER)
-    /* Set up mixer default state */
-    InitLocalMixerState();
+    return len;
+}
+
+/* Channel name table. Each entry names count consecutive USB channels, starting after channel index, as
+ * "<prefix> 1", "<prefix> 2" etc. A channel covered by more than one entry gets the names joined by "/" */
+typedef struct
+{
+    const char *prefix;
+    unsigned index;
+    unsigned count;
+} chan_name_t;
+
+static const chan_name_t outputChanNames[] =
+{
+    {"Analogue", 0, I2S_CHANS_DAC},
+#if (XUA_SPDIF_TX_EN)
+    {"SPDIF", SPDIF_TX_INDEX, 2},
+#endif
+#if (XUA_ADAT_TX_EN)
+    {"ADAT", ADAT_TX_INDEX, 8},
 #endif
+};
 
-#ifdef VENDOR_AUDIO_REQS
-    VendorAudioRequestsInit(c_audioControl, c_mix_ctl, c_clk_ctl);
+static const chan_name_t inputChanNames[] =
+{
+    {"Analogue", 0, I2S_CHANS_ADC},
+#if (XUA_SPDIF_RX_EN)
+    {"SPDIF", SPDIF_RX_INDEX, 2},
+#endif
+#if (XUA_ADAT_RX_EN)
+    {"ADAT", ADAT_RX_INDEX, 8},
 #endif
+};
 
-#if (XUA_DFU_EN == 1)
-    /* Check if device has started in DFU mode */
-    if (DFUReportResetState(null))
+/* Builds the name of a USB channel (1 based), matching the names in chanstrings.h. Returns its length */
+static unsigned BuildChanName(char *str, unsigned chan, const chan_name_t *names, unsigned nameCount)
+{
+    unsigned len = 0;
+
+    for(unsigned i = 0; i < nameCount; i++)
     {
-        assert(((unsigned)c_audioControl != 0) && msg("DFU not supported when c_audioControl is null"));
+        if((chan > names[i].index) && (chan <= names[i].index + names[i].count))
+        {
+            len = appendChanName(str, len, names[i].prefix, chan - names[i].index);
+        }
+    }
 
-        /* Stop audio */
-        outuint(c_audioControl, SET_SAMPLE_FREQ);
-        outuint(c_audioControl, AUDIO_STOP_FOR_DFU);
-        /* No Handshake */
-        DFU_mode_active = 1;
+    return len;
+}
+
+/* Builds the name of the channel name string at a string table index into name. Returns its length, or 0 if the
+ * index is not that of a channel name, or is of one set by the application */
+static unsigned GetChanName(unsigned index, char *name)
+{
+    unsigned isInput;
+    unsigned chan;
+    char *entry;
+
+    if((index >= STR_INDEX_OUTPUT_CHAN_1) && (index < STR_INDEX_OUTPUT_CHAN_1 + NUM_USB_CHAN_OUT))
+    {
+        isInput = 0;
+        chan = index - STR_INDEX_OUTPUT_CHAN_1 + 1;
+    }
+    else if((index >= STR_INDEX_INPUT_CHAN_1) && (index < STR_INDEX_INPUT_CHAN_1 + NUM_USB_CHAN_IN))
+    {
+        isInput = 1;
+        chan = index - STR_INDEX_INPUT_CHAN_1 + 1;
+    }
+    else
+    {
+        return 0;
+    }
+
+    /* Names set in g_strTable by the application are returned as they are */
+    entry = ((char **) &g_strTable)[index];
+    if(entry[0] != '\0')
+    {
+        return 0;
+    }
+
+    if(isInput)
+    {
+        return BuildChanName(name, chan, inputChanNames, sizeof(inputChanNames)/sizeof(inputChanNames[0]));
+    }
+    else
+    {
+        return BuildChanName(name, chan, outputChanNames, sizeof(outputChanNames)/sizeof(outputChanNames[0]));
+    }
+}
+
+/* Handles a GET_DESCRIPTOR request for a channel name string. Returns XUD_RES_ERR if the request is for any
+ * other descriptor, or for a channel name set by the application, leaving it to USB_StandardRequests() */
+static XUD_Result_t ChanStringRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    unsigned index = sp->wValue & 0xff;
+    unsigned len;
+    char name[XUA_MAX_STR_LEN];
+
+    if((sp->wValue >> 8) != USB_DESCTYPE_STRING)
+    {
+        return XUD_RES_ERR;
+    }
+
+    len = GetChanName(index, name);
+    if(len == 0)
+    {
+        return XUD_RES_ERR;
+    }
+
+    /* String descriptors are UTF-16LE */
+    g_strDescBuffer[0] = 2 + (len * 2);
+    g_strDescBuffer[1] = USB_DESCTYPE_STRING;
+    for(unsigned i = 0; i < len; i++)
+    {
+        g_strDescBuffer[2 + (i * 2)] = name[i];
+        g_strDescBuffer[3 + (i * 2)] = 0;
+    }
+
+    return XUD_DoGetRequest(ep0_out, ep0_in, g_strDescBuffer, g_strDescBuffer[0], sp->wLength);
+}
+#endif
+
+#if (XUA_STRINGS_REQ)
+int XUA_Endpoint0_GetString(unsigned index, char *str, unsigned maxLen)
+{
+    const char *entry;
+    unsigned len = 0;
+
+    if(index >= (sizeof(g_strTable) / sizeof(char *)))
+    {
+        return -1;
+    }
+
+#if (XUA_CHAN_STRINGS_ON_DEMAND)
+    if(maxLen >= XUA_MAX_STR_LEN)
+    {
+        len = GetChanName(index, str);
+        if(len)
+        {
+            return len;
+        }
+    }
+#endif
+
+    entry = ((char **) &g_strTable)[index];
+    while(entry[len] && (len < maxLen))
+    {
+        str[len] = entry[len];
+        len++;
+    }
+
+    return len;
+}
+#endif
+
+#if (XUA_CHAN_PROFILE_EN)
+extern void device_reboot(void);
+
+/* The profile is kept over a reboot in a word of the range 0x7FFC8 - 0x7FFFF (0xFFFC8 - 0xFFFFF) left untouched by the
+ * tools, next to the DFU flag. The magic tells it from the RAM contents at power up */
+#if defined(__XS2A__)
+#define CHAN_PROFILE_FLAG_ADDRESS       (0x7ffc8)
+#else
+#define CHAN_PROFILE_FLAG_ADDRESS       (0xfffc8)
+#endif
+#define CHAN_PROFILE_FLAG_MAGIC         (0x43500000)
+#define CHAN_PROFILE_FLAG_MASK          (0xffff0000)
+
+static void SetChanProfileFlag(unsigned profile)
+{
+    asm volatile("stw %0, %1[0]" :: "r"(CHAN_PROFILE_FLAG_MAGIC | profile), "r"(CHAN_PROFILE_FLAG_ADDRESS));
+}
+
+static unsigned GetChanProfileFlag()
+{
+    unsigned x;
+    asm volatile("ldw %0, %1[0]" : "=r"(x) : "r"(CHAN_PROFILE_FLAG_ADDRESS));
+
+    if(((x & CHAN_PROFILE_FLAG_MASK) != CHAN_PROFILE_FLAG_MAGIC)
+        || ((x & ~CHAN_PROFILE_FLAG_MASK) >= XUA_CHAN_PROFILE_COUNT))
+    {
+        return XUA_CHAN_PROFILE_FULL;
+    }
+    return x & ~CHAN_PROFILE_FLAG_MASK;
+}
+
+/* Max packet size of a high-speed stream format of chans channels, or its size in the full profile if smaller */
+static unsigned short ProfileMaxPacketSize(unsigned chans, unsigned subslot, unsigned fullSize)
+{
+    unsigned size = (((MAX_FREQ + 7999) / 8000) + 1) * chans * subslot;
+
+    return (size < fullSize) ? size : fullSize;
+}
+
+/* Limits the channel counts of the high-speed Audio Class 2.0 descriptors to those of the current profile. The streaming
+ * formats are otherwise unchanged, the host sees the same alternate settings with fewer channels */
+static void SetAudio2DescriptorsForProfile()
+{
+    unsigned chans;
+
+    if(g_chanProfile == XUA_CHAN_PROFILE_FULL)
+    {
+        return;
+    }
+
+#if (NUM_USB_CHAN_OUT > 0)
+    cfgDesc_Audio2.Audio_CS_Control_Int.Audio_Out_InputTerminal.bNrChannels =
+        ProfileChans(NUM_USB_CHAN_OUT, XUA_CHAN_PROFILE_CHAN_OUT);
+    chans = ProfileChans(HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT, XUA_CHAN_PROFILE_CHAN_OUT);
+    cfgDesc_Audio2.Audio_Out_ClassStreamInterface.bNrChannels = chans;
+    cfgDesc_Audio2.Audio_Out_Endpoint.wMaxPacketSize =
+        ProfileMaxPacketSize(chans, HS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES, HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE);
+#if (OUTPUT_FORMAT_COUNT > 1)
+    chans = ProfileChans(HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT, XUA_CHAN_PROFILE_CHAN_OUT);
+    cfgDesc_Audio2.Audio_Out_ClassStreamInterface_2.bNrChannels = chans;
+    cfgDesc_Audio2.Audio_Out_Endpoint_2.wMaxPacketSize =
+        ProfileMaxPacketSize(chans, HS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES, HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE);
+#endif
+#if (OUTPUT_FORMAT_COUNT > 2)
+    chans = ProfileChans(HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT, XUA_CHAN_PROFILE_CHAN_OUT);
+    cfgDesc_Audio2.Audio_Out_ClassStreamInterface_3.bNrChannels = chans;
+    cfgDesc_Audio2.Audio_Out_Endpoint_3.wMaxPacketSize =
+        ProfileMaxPacketSize(chans, HS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES, HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE);
+#endif
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+    cfgDesc_Audio2.Audio_CS_Control_Int.Audio_In_InputTerminal.bNrChannels =
+        ProfileChans(NUM_USB_CHAN_IN, XUA_CHAN_PROFILE_CHAN_IN);
+    chans = ProfileChans(HS_STREAM_FORMAT_INPUT_1_CHAN_COUNT, XUA_CHAN_PROFILE_CHAN_IN);
+    cfgDesc_Audio2.Audio_In_ClassStreamInterface.bNrChannels = chans;
+    cfgDesc_Audio2.Audio_In_Endpoint.wMaxPacketSize =
+        ProfileMaxPacketSize(chans, HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES, HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE);
+#if (INPUT_FORMAT_COUNT > 1)
+    chans = ProfileChans(HS_STREAM_FORMAT_INPUT_2_CHAN_COUNT, XUA_CHAN_PROFILE_CHAN_IN);
+    cfgDesc_Audio2.Audio_In_ClassStreamInterface_2.bNrChannels = chans;
+    cfgDesc_Audio2.Audio_In_Endpoint_2.wMaxPacketSize =
+        ProfileMaxPacketSize(chans, HS_STREAM_FORMAT_INPUT_2_SUBSLOT_BYTES, HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE);
+#endif
+#if (INPUT_FORMAT_COUNT > 2)
+    chans = ProfileChans(HS_STREAM_FORMAT_INPUT_3_CHAN_COUNT, XUA_CHAN_PROFILE_CHAN_IN);
+    cfgDesc_Audio2.Audio_In_ClassStreamInterface_3.bNrChannels = chans;
+    cfgDesc_Audio2.Audio_In_Endpoint_3.wMaxPacketSize =
+        ProfileMaxPacketSize(chans, HS_STREAM_FORMAT_INPUT_3_SUBSLOT_BYTES, HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE);
+#endif
+#endif
+}
+
+void XUA_Endpoint0_setChanProfile(unsigned profile)
+{
+    if(profile >= XUA_CHAN_PROFILE_COUNT)
+    {
+        return;
+    }
+
+    SetChanProfileFlag(profile);
+
+    /* Once enumerated the descriptors can only change over a reconnect. The reboot takes the device off the bus, so the
+     * host sees a new device and the audio threads start again with the new channel counts */
+    if(g_xua_descriptors_ready && (profile != g_chanProfile))
+    {
+        unsigned start, now;
+        asm volatile("gettime %0" : "=r"(start));
+        do
+        {
+            asm volatile("gettime %0" : "=r"(now));
+        } while((now - start) < (XUA_CHAN_PROFILE_REBOOT_DELAY_MS * 100000));
+
+        device_reboot();
+    }
+}
+
+unsigned XUA_Endpoint0_getChanProfile(void)
+{
+    return g_chanProfile;
+}
+#endif
+
+#if !((AUDIO_CLASS_FALLBACK) && (AUDIO_CLASS != 1)) && FULL_SPEED_AUDIO_2
+/* Bus speed the Audio Class 2.0 descriptors were last set up for, -1 until first set up */
+static int g_descUsbSpeed = -1;
+
+/* Unfortunately we need to munge the descriptors a bit between full and high-speed */
+static void SetAudio2DescriptorsForSpeed(XUD_BusSpeed_t speed)
+{
+    if(speed == XUD_SPEED_HS)
+    {
+        /* Modify Audio Class 2.0 Config descriptor for High-speed operation */
+#if (NUM_USB_CHAN_OUT > 0)
+        cfgDesc_Audio2.Audio_CS_Control_Int.Audio_Out_InputTerminal.bNrChannels = NUM_USB_CHAN_OUT;
+#if (NUM_USB_CHAN_OUT > 0)
+        cfgDesc_Audio2.Audio_Out_Format.bSubslotSize = HS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_Out_Format.bBitResolution = HS_STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_Out_Endpoint.wMaxPacketSize = HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_Out_ClassStreamInterface.bNrChannels = HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT;
+#endif
+#if (OUTPUT_FORMAT_COUNT > 1)
+        cfgDesc_Audio2.Audio_Out_Format_2.bSubslotSize = HS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_Out_Format_2.bBitResolution = HS_STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_Out_Endpoint_2.wMaxPacketSize = HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_Out_ClassStreamInterface_2.bNrChannels = HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT;
+#endif
+
+#if (OUTPUT_FORMAT_COUNT > 2)
+        cfgDesc_Audio2.Audio_Out_Format_3.bSubslotSize = HS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_Out_Format_3.bBitResolution = HS_STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_Out_Endpoint_3.wMaxPacketSize = HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_Out_ClassStreamInterface_3.bNrChannels = HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT;
+#endif
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+        cfgDesc_Audio2.Audio_CS_Control_Int.Audio_In_InputTerminal.bNrChannels = NUM_USB_CHAN_IN;
+        cfgDesc_Audio2.Audio_In_Format.bSubslotSize = HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_In_Format.bBitResolution = HS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_In_Endpoint.wMaxPacketSize = HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_In_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_IN;
+#endif
+#if (XUA_AUX_IN_EN)
+        cfgDesc_Audio2.Audio_InAux_Endpoint.wMaxPacketSize = AUX_IN_MAXPACKETSIZE_HS;
+#endif
+#if (XUA_CHAN_PROFILE_EN)
+        SetAudio2DescriptorsForProfile();
+#endif
+    }
+    else
+    {
+        /* Modify Audio Class 2.0 Config descriptor for Full-speed operation */
+#if (NUM_USB_CHAN_OUT > 0)
+        cfgDesc_Audio2.Audio_CS_Control_Int.Audio_Out_InputTerminal.bNrChannels = NUM_USB_CHAN_OUT_FS;
+#if (NUM_USB_CHAN_OUT > 0)
+        cfgDesc_Audio2.Audio_Out_Format.bSubslotSize = FS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_Out_Format.bBitResolution = FS_STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_Out_Endpoint.wMaxPacketSize = FS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_Out_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_OUT_FS;
+#endif
+#if (OUTPUT_FORMAT_COUNT > 1)
+        cfgDesc_Audio2.Audio_Out_Format_2.bSubslotSize = FS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_Out_Format_2.bBitResolution = FS_STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_Out_Endpoint_2.wMaxPacketSize = FS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_Out_ClassStreamInterface_2.bNrChannels = NUM_USB_CHAN_OUT_FS;
+#endif
+
+#if (OUTPUT_FORMAT_COUNT > 2)
+        cfgDesc_Audio2.Audio_Out_Format_3.bSubslotSize = FS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_Out_Format_3.bBitResolution = FS_STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_Out_Endpoint_3.wMaxPacketSize = FS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_Out_ClassStreamInterface_3.bNrChannels = NUM_USB_CHAN_OUT_FS;
+#endif
+#endif
+#if (NUM_USB_CHAN_IN > 0)
+        cfgDesc_Audio2.Audio_CS_Control_Int.Audio_In_InputTerminal.bNrChannels = NUM_USB_CHAN_IN_FS;
+        cfgDesc_Audio2.Audio_In_Format.bSubslotSize = FS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES;
+        cfgDesc_Audio2.Audio_In_Format.bBitResolution = FS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS;
+        cfgDesc_Audio2.Audio_In_Endpoint.wMaxPacketSize = FS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE;
+        cfgDesc_Audio2.Audio_In_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_IN_FS;
+#endif
+#if (XUA_AUX_IN_EN)
+        cfgDesc_Audio2.Audio_InAux_Endpoint.wMaxPacketSize = AUX_IN_MAXPACKETSIZE_FS;
+#endif
+    }
+}
+#endif
+
+/* Set while the descriptors are final. The XUD thread of main.xc only starts XUD once set, such that the host never
+ * sees the device before its descriptors are ready */
+unsigned g_xua_descriptors_ready = 0;
+
+void XUA_Endpoint0_InitDescriptors(void)
+{
+    XUA_Endpoint0_setStrTable();
+
+#if (XUA_CHAN_PROFILE_EN)
+    /* Profile selected before the last reboot, or by the application before now */
+    g_chanProfile = GetChanProfileFlag();
+    SetAudio2DescriptorsForProfile();
+#endif
+
+#if (XUA_CHAN_STRINGS_ON_DEMAND)
+    /* Channel names are built by ChanStringRequest() unless the application sets an entry */
+    {
+        char **strs = (char **) &g_strTable;
+        for(int i = 0; i < NUM_USB_CHAN_OUT; i++)
+            strs[STR_INDEX_OUTPUT_CHAN_1 + i] = "";
+        for(int i = 0; i < NUM_USB_CHAN_IN; i++)
+            strs[STR_INDEX_INPUT_CHAN_1 + i] = "";
     }
 #endif
 
@@ -542,8 +983,89 @@ void XUA_Endpoint0_init(chanend c_ep0_out, chanend c_ep0_in, NULLABLE_RESOURCE(c
 
 #endif // 0 < HID_CONTROLS
 
+    XUA_STARTUP_MARK(XUA_STARTUP_DESCRIPTORS);
+    SET_SHARED_GLOBAL(g_xua_descriptors_ready, 1);
+}
+
+void XUA_Endpoint0_init(chanend c_ep0_out, chanend c_ep0_in, NULLABLE_RESOURCE(chanend, c_audioControl),
+    chanend c_mix_ctl, chanend c_clk_ctl, chanend c_EANativeTransport_ctrl, CLIENT_INTERFACE(i_dfu, dfuInterface) VENDOR_REQUESTS_PARAMS_DEC_)
+{
+    /* Normally already done before XUD was started, see XUA_Endpoint0_InitDescriptors() */
+    if(!g_xua_descriptors_ready)
+    {
+        XUA_Endpoint0_InitDescriptors();
+    }
+
+    ep0_out = XUD_InitEp(c_ep0_out);
+    ep0_in  = XUD_InitEp(c_ep0_in);
+
+#if (XUA_STATUS_INT_EN)
+    g_c_statusInt = (unsigned) c_audioControl;
+#endif
+
+#if (XUA_MEMORY_REPORT)
+#if (AUDIO_CLASS == 2)
+    XUA_MemoryReport("EP0 UAC2 config descriptor", sizeof(cfgDesc_Audio2));
+#endif
+#if (AUDIO_CLASS == 1) || (AUDIO_CLASS_FALLBACK)
+    XUA_MemoryReport("EP0 UAC1 config descriptor", sizeof(cfgDesc_Audio1));
+#endif
+    XUA_MemoryReport("EP0 string table", sizeof(g_strTable));
+#endif
+
+    VendorRequests_Init(VENDOR_REQUESTS_PARAMS);
+
+#if (MIXER)
+    /* Set up mixer default state */
+    InitLocalMixerState();
+#endif
+
+#ifdef VENDOR_AUDIO_REQS
+    VendorAudioRequestsInit(c_audioControl, c_mix_ctl, c_clk_ctl);
+#endif
+
+#if (XUA_DFU_EN == 1)
+    /* Check if device has started in DFU mode */
+    if (DFUReportResetState(null))
+    {
+        assert(((unsigned)c_audioControl != 0) && msg("DFU not supported when c_audioControl is null"));
+
+        /* Stop audio */
+        outuint(c_audioControl, SET_SAMPLE_FREQ);
+        outuint(c_audioControl, AUDIO_STOP_FOR_DFU);
+        /* No Handshake */
+        DFU_mode_active = 1;
+    }
+#endif
+
+#if (XUA_MIXER_SCENES) && (XUA_MIXER_SCENE_BOOT >= 0)
+    /* Leaves the default state if no scene has been saved */
+    if (!DFU_mode_active)
+    {
+        XUA_MixerSceneRecall(dfuInterface, c_mix_ctl, XUA_MIXER_SCENE_BOOT);
+    }
+#endif
+
+    XUA_STARTUP_MARK(XUA_STARTUP_EP0);
 }
 
+#if (XUA_STATUS_INT_EN)
+void XUA_Endpoint0_notifyChange(unsigned entityId, unsigned cs, unsigned cn)
+{
+    if(g_c_statusInt)
+    {
+        AudioControlSync(g_c_statusInt);
+
+        /* Queued by buffering, which sends it on the interrupt endpoint */
+        outuint(g_c_statusInt, STATUS_INTERRUPT);
+        outuint(g_c_statusInt, XUA_STATUS_INT_PACK(entityId, cs, cn));
+
+        /* Wait for handshake */
+        chkct(g_c_statusInt, XS1_CT_END);
+    }
+}
+#endif
+
 void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0_out, chanend c_ep0_in, NULLABLE_RESOURCE(chanend, c_audioControl),
     chanend c_mix_ctl, chanend c_clk_ctl, chanend c_EANativeTransport_ctrl, CLIENT_INTERFACE(i_dfu, dfuInterface) VENDOR_REQUESTS_PARAMS_DEC_)
 {
@@ -559,6 +1081,8 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                 /* Over-riding USB_StandardRequests implementation */
                 if(sp.bRequest == USB_SET_INTERFACE)
                 {
+                    XUA_EVENT(XUA_EVENT_SET_INTERFACE, (sp.wIndex << 8) | (sp.wValue & 0xff));
+
                     switch (sp.wIndex)
                     {
                         /* Check for audio stream from host start/stop */
@@ -573,6 +1097,10 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                                 {
                                     assert((c_audioControl != null) && msg("Format change not supported when c_audioControl is null"));
                                     g_curStreamAlt_Out = sp.wValue;
+                                    XUA_STARTUP_MARK(XUA_STARTUP_STREAM);
+
+                                    /* Complete any outstanding rate change before the stream starts */
+                                    AudioControlSync(c_audioControl);
 
                                     /* Send format of data onto buffering */
                                     outuint(c_audioControl, SET_STREAM_FORMAT_OUT);
@@ -580,7 +1108,7 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
 
                                     if(g_curUsbSpeed == XUD_SPEED_HS)
                                     {
-                                        outuint(c_audioControl, NUM_USB_CHAN_OUT);                 /* Channel count */
+                                        outuint(c_audioControl, ProfileChans(g_chanCount_Out_HS[sp.wValue-1], XUA_CHAN_PROFILE_CHAN_OUT)); /* Channel count */
                                         outuint(c_audioControl, g_subSlot_Out_HS[sp.wValue-1]);    /* Subslot */
                                         outuint(c_audioControl, g_sampRes_Out_HS[sp.wValue-1]);    /* Resolution */
                                     }
@@ -609,6 +1137,10 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                                 {
                                     assert((c_audioControl != null) && msg("Format change not supported when c_audioControl is null"));
                                     g_curStreamAlt_In = sp.wValue;
+                                    XUA_STARTUP_MARK(XUA_STARTUP_STREAM);
+
+                                    /* Complete any outstanding rate change before the stream starts */
+                                    AudioControlSync(c_audioControl);
 
                                     /* Send format of data onto buffering */
                                     outuint(c_audioControl, SET_STREAM_FORMAT_IN);
@@ -616,7 +1148,7 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
 
                                     if(g_curUsbSpeed == XUD_SPEED_HS)
                                     {
-                                        outuint(c_audioControl, g_chanCount_In_HS[sp.wValue-1]);  /* Channel count */
+                                        outuint(c_audioControl, ProfileChans(g_chanCount_In_HS[sp.wValue-1], XUA_CHAN_PROFILE_CHAN_IN));  /* Channel count */
                                         outuint(c_audioControl, g_subSlot_In_HS[sp.wValue-1]);    /* Subslot */
                                         outuint(c_audioControl, g_sampRes_In_HS[sp.wValue-1]);    /* Resolution */
                                     }
@@ -652,6 +1184,30 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                             }
                             break;
 #endif
+
+#if defined(MIDI) && (XUA_MIDI_UMP)
+                        case INTERFACE_NUMBER_MIDI_STREAM:
+                            /* Alt 0 is USB MIDI 1.0, alt 1 is UMP */
+                            if(sp.wValue <= 1)
+                            {
+                                assert((c_audioControl != null) && msg("MIDI 2.0 not supported when c_audioControl is null"));
+
+                                /* Reset all state of endpoints associated with this interface
+                                 * when changing an alternative setting. See USB 2.0 Spec 9.1.1.5 */
+                                XUD_ResetEpStateByAddr(ENDPOINT_ADDRESS_IN_MIDI);
+                                XUD_ResetEpStateByAddr(ENDPOINT_ADDRESS_OUT_MIDI);
+
+                                AudioControlSync(c_audioControl);
+
+                                /* Send the alt onto buffering, which passes it on to the MIDI thread */
+                                outuint(c_audioControl, SET_MIDI_ALT);
+                                outuint(c_audioControl, sp.wValue);
+
+                                /* Wait for handshake */
+                                chkct(c_audioControl, XS1_CT_END);
+                            }
+                            break;
+#endif
                         default:
                             /* Unhandled interface */
                             break;
@@ -743,9 +1299,18 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
 
                 switch(sp.bRequest)
                 {
-#if XUA_OR_STATIC_HID_ENABLED
+#if XUA_OR_STATIC_HID_ENABLED || (defined(MIDI) && (XUA_MIDI_UMP))
                     case USB_GET_DESCRIPTOR:
 
+#if defined(MIDI) && (XUA_MIDI_UMP)
+                        /* USB MIDI 2.0 group terminal block descriptors, requested for alternate setting 1 */
+                        if((sp.wIndex == INTERFACE_NUMBER_MIDI_STREAM) && (sp.wValue == ((MIDI_CS_GR_TRM_BLOCK << 8) | 1)))
+                        {
+                            result = XUD_DoGetRequest(ep0_out, ep0_in, midiGroupTerminalBlocks,
+                                sizeof(midiGroupTerminalBlocks), sp.wLength);
+                        }
+#endif
+#if XUA_OR_STATIC_HID_ENABLED
                         /* Check what inteface request is for */
                         if(sp.wIndex == INTERFACE_NUMBER_HID)
                         {
@@ -775,6 +1340,7 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                                     break;
                             }
                         }
+#endif
                         break;
 #endif
                     default:
@@ -782,6 +1348,16 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                }
                break;
 
+#if (XUA_CHAN_STRINGS_ON_DEMAND)
+            case USB_BMREQ_D2H_STANDARD_DEV:
+
+                if(sp.bRequest == USB_GET_DESCRIPTOR)
+                {
+                    result = ChanStringRequest(ep0_out, ep0_in, &sp);
+                }
+                break;
+#endif
+
             /* Recipient: Device */
             case USB_BMREQ_H2D_STANDARD_DEV:
 
@@ -797,6 +1373,7 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                             /* Consider host active with valid driver at this point */
                             UserHostActive(1);
                         }
+                        XUA_STARTUP_MARK(XUA_STARTUP_CONFIGURED);
 
                         /* We want to run USB_StandardsRequests() implementation also. Don't modify result
                          * and don't call XUD_DoSetRequestStatus() */
@@ -862,6 +1439,8 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
                             (sp.bRequest != XMOS_DFU_RESTORESTATE))
                         {
                             assert((c_audioControl != null) && msg("DFU not supported when c_audioControl is null"));
+                            AudioControlSync(c_audioControl);
+
                             // Stop audio
                             outuint(c_audioControl, SET_SAMPLE_FREQ);
                             outuint(c_audioControl, AUDIO_STOP_FOR_DFU);
@@ -930,6 +1509,14 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
 
     } /* if(result == XUD_RES_OKAY) */
 
+#if (XUA_VENDOR_REQS_EN)
+    if(result == XUD_RES_ERR)
+    {
+        /* Vendor requests handled by lib_xua */
+        result = XUA_VendorRequests(ep0_out, ep0_in, &sp, c_mix_ctl, dfuInterface);
+    }
+#endif
+
     {
         if(result == XUD_RES_ERR)
         {
@@ -958,72 +1545,11 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
 #elif FULL_SPEED_AUDIO_2
             /* Return Audio 2.0 Descriptors for high_speed and full-speed */
 
-            /* Unfortunately we need to munge the descriptors a bit between full and high-speed */
-            if(g_curUsbSpeed == XUD_SPEED_HS)
-            {
-                /* Modify Audio Class 2.0 Config descriptor for High-speed operation */
-#if (NUM_USB_CHAN_OUT > 0)
-                cfgDesc_Audio2.Audio_CS_Control_Int.Audio_Out_InputTerminal.bNrChannels = NUM_USB_CHAN_OUT;
-#if (NUM_USB_CHAN_OUT > 0)
-                cfgDesc_Audio2.Audio_Out_Format.bSubslotSize = HS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_Out_Format.bBitResolution = HS_STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_Out_Endpoint.wMaxPacketSize = HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_Out_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_OUT;
-#endif
-#if (OUTPUT_FORMAT_COUNT > 1)
-                cfgDesc_Audio2.Audio_Out_Format_2.bSubslotSize = HS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_Out_Format_2.bBitResolution = HS_STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_Out_Endpoint_2.wMaxPacketSize = HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_Out_ClassStreamInterface_2.bNrChannels = NUM_USB_CHAN_OUT;
-#endif
-
-#if (OUTPUT_FORMAT_COUNT > 2)
-                cfgDesc_Audio2.Audio_Out_Format_3.bSubslotSize = HS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_Out_Format_3.bBitResolution = HS_STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_Out_Endpoint_3.wMaxPacketSize = HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_Out_ClassStreamInterface_3.bNrChannels = NUM_USB_CHAN_OUT;
-#endif
-#endif
-#if (NUM_USB_CHAN_IN > 0)
-                cfgDesc_Audio2.Audio_CS_Control_Int.Audio_In_InputTerminal.bNrChannels = NUM_USB_CHAN_IN;
-                cfgDesc_Audio2.Audio_In_Format.bSubslotSize = HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_In_Format.bBitResolution = HS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_In_Endpoint.wMaxPacketSize = HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_In_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_IN;
-#endif
-            }
-            else
+            /* Descriptors are only re-written when the bus speed has changed since they were last returned */
+            if((int) g_curUsbSpeed != g_descUsbSpeed)
             {
-                /* Modify Audio Class 2.0 Config descriptor for Full-speed operation */
-#if (NUM_USB_CHAN_OUT > 0)
-                cfgDesc_Audio2.Audio_CS_Control_Int.Audio_Out_InputTerminal.bNrChannels = NUM_USB_CHAN_OUT_FS;
-#if (NUM_USB_CHAN_OUT > 0)
-                cfgDesc_Audio2.Audio_Out_Format.bSubslotSize = FS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_Out_Format.bBitResolution = FS_STREAM_FORMAT_OUTPUT_1_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_Out_Endpoint.wMaxPacketSize = FS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_Out_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_OUT_FS;
-#endif
-#if (OUTPUT_FORMAT_COUNT > 1)
-                cfgDesc_Audio2.Audio_Out_Format_2.bSubslotSize = FS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_Out_Format_2.bBitResolution = FS_STREAM_FORMAT_OUTPUT_2_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_Out_Endpoint_2.wMaxPacketSize = FS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_Out_ClassStreamInterface_2.bNrChannels = NUM_USB_CHAN_OUT_FS;
-#endif
-
-#if (OUTPUT_FORMAT_COUNT > 2)
-                cfgDesc_Audio2.Audio_Out_Format_3.bSubslotSize = FS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_Out_Format_3.bBitResolution = FS_STREAM_FORMAT_OUTPUT_3_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_Out_Endpoint_3.wMaxPacketSize = FS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_Out_ClassStreamInterface_3.bNrChannels = NUM_USB_CHAN_OUT_FS;
-#endif
-#endif
-#if (NUM_USB_CHAN_IN > 0)
-                cfgDesc_Audio2.Audio_CS_Control_Int.Audio_In_InputTerminal.bNrChannels = NUM_USB_CHAN_IN_FS;
-                cfgDesc_Audio2.Audio_In_Format.bSubslotSize = FS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES;
-                cfgDesc_Audio2.Audio_In_Format.bBitResolution = FS_STREAM_FORMAT_INPUT_1_RESOLUTION_BITS;
-                cfgDesc_Audio2.Audio_In_Endpoint.wMaxPacketSize = FS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE;
-                cfgDesc_Audio2.Audio_In_ClassStreamInterface.bNrChannels = NUM_USB_CHAN_IN_FS;
-#endif
+                SetAudio2DescriptorsForSpeed(g_curUsbSpeed);
+                g_descUsbSpeed = (int) g_curUsbSpeed;
             }
 
             result = USB_StandardRequests(ep0_out, ep0_in,
@@ -1076,6 +1602,7 @@ void XUA_Endpoint0_loop(XUD_Result_t result, USB_SetupPacket_t sp, chanend c_ep0
 #else
         g_curUsbSpeed = XUD_ResetEndpoint(ep0_out, &ep0_in);
 #endif
+        XUA_EVENT(XUA_EVENT_USB_RESET, g_curUsbSpeed);
         g_currentConfig = 0;
         g_curStreamAlt_Out = 0;
         g_curStreamAlt_In = 0;
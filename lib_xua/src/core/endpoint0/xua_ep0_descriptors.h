@@ -39,6 +39,7 @@
 #define XUA_MIDI_OUT_EMPTY_STRING "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\09"
 #define XUA_MIDI_IN_EMPTY_STRING "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0a"
 #define XUA_SERIAL_EMPTY_STRING "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0b"
+#define XUA_WORDCLOCK_CLOCK_SOURCE_EMPTY_STRING "\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0c"
 
 // The value below must match the length of XUA_DESCR_EMPTY_STRING.
 #define XUA_MAX_STR_LEN (32)
@@ -95,6 +96,9 @@ typedef struct
 #if (XUA_ADAT_RX_EN)
     STR_TABLE_ENTRY(adatClockSourceStr);          /* iClockSource for external S/PDIF clock */
 #endif
+#if (XUA_WORDCLOCK_RX_EN)
+    STR_TABLE_ENTRY(wordClockSourceStr);          /* iClockSource for external word clock */
+#endif
 #endif // AUDIO_CLASS == 2
 #if (XUA_DFU_EN == 1)
     STR_TABLE_ENTRY(dfuStr);                      /* iInterface for DFU interface */
@@ -369,6 +373,9 @@ StringDescTable_t g_strTable =
 #if (XUA_ADAT_RX_EN)
     .adatClockSourceStr          = XUA_ADAT_CLOCK_SOURCE_EMPTY_STRING,
 #endif
+#if (XUA_WORDCLOCK_RX_EN)
+    .wordClockSourceStr          = XUA_WORDCLOCK_CLOCK_SOURCE_EMPTY_STRING,
+#endif
 #endif // AUDIO_CLASS == 2
 #if (XUA_DFU_EN == 1)
     .dfuStr                      = XUA_DFU_EMPTY_STRING,
@@ -381,7 +388,9 @@ StringDescTable_t g_strTable =
     .midiInStr                    = XUA_MIDI_IN_EMPTY_STRING,
 #endif
 
+#if !(XUA_CHAN_STRINGS_ON_DEMAND)
     #include "chanstrings.h"
+#endif
 
 #if (NUM_USB_CHAN_OUT > 32)
 #error NUM_USB_CHAN_OUT > 32
@@ -564,7 +573,52 @@ unsigned char devQualDesc_Null[] =
 #endif
 
 #ifdef MIDI
-#define MIDI_LENGTH                 (92)
+/* 92 bytes for a single cable, each further cable (XUA_MIDI_PORTS) adds 4 jacks and an associated jack per endpoint */
+#define MIDI_LENGTH_1_0             (60 + (32 * XUA_MIDI_PORTS))
+
+#if (XUA_MIDI_UMP)
+/* USB MIDI 2.0 alternate setting, an associated group terminal block per endpoint for each port */
+#define MIDI_LENGTH                 (MIDI_LENGTH_1_0 + 38 + (2 * XUA_MIDI_PORTS))
+
+/* Group terminal block descriptors, returned by a GET_DESCRIPTOR request to the MIDI streaming interface */
+#define MIDI_CS_GR_TRM_BLOCK        (0x26)
+#define MIDI_GTB_LENGTH             (5 + (13 * XUA_MIDI_PORTS))
+
+/* Bidirectional group terminal block for port (group) n, block ID n + 1, MIDI 2.0 protocol at MIDI 1.0 bandwidth */
+#define MIDI_GTB(n) \
+    0x0D, MIDI_CS_GR_TRM_BLOCK, 0x02, (n) + 1, 0x00, (n), 0x01, 0x00, 0x11, 0x01, 0x00, 0x01, 0x00,
+
+/* Group terminal block IDs associated with each UMP endpoint */
+#if (XUA_MIDI_PORTS == 1)
+#define MIDI_GTB_IDS                0x01
+#elif (XUA_MIDI_PORTS == 2)
+#define MIDI_GTB_IDS                0x01, 0x02
+#elif (XUA_MIDI_PORTS == 3)
+#define MIDI_GTB_IDS                0x01, 0x02, 0x03
+#elif (XUA_MIDI_PORTS == 4)
+#define MIDI_GTB_IDS                0x01, 0x02, 0x03, 0x04
+#elif (XUA_MIDI_PORTS == 5)
+#define MIDI_GTB_IDS                0x01, 0x02, 0x03, 0x04, 0x05
+#elif (XUA_MIDI_PORTS == 6)
+#define MIDI_GTB_IDS                0x01, 0x02, 0x03, 0x04, 0x05, 0x06
+#elif (XUA_MIDI_PORTS == 7)
+#define MIDI_GTB_IDS                0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07
+#else
+#define MIDI_GTB_IDS                0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+#endif
+#else
+#define MIDI_LENGTH                 (MIDI_LENGTH_1_0)
+#endif
+
+/* Class-specific MS interface descriptors */
+#define MIDI_MS_TOTAL_LENGTH        (33 + (32 * XUA_MIDI_PORTS))
+
+/* Tables B-7 to B-10 for a further MIDI cable, jack IDs (4 * cable) + 1 to (4 * cable) + 4 */
+#define MIDI_CABLE_JACKS(cable) \
+    0x06, 0x24, 0x02, 0x01, (4 * (cable)) + 1, 0x00, \
+    0x06, 0x24, 0x02, 0x02, (4 * (cable)) + 2, offsetof(StringDescTable_t, midiInStr)/sizeof(char *), \
+    0x09, 0x24, 0x03, 0x01, (4 * (cable)) + 3, 0x01, (4 * (cable)) + 2, 0x01, 0x00, \
+    0x09, 0x24, 0x03, 0x02, (4 * (cable)) + 4, 0x01, (4 * (cable)) + 1, 0x01, offsetof(StringDescTable_t, midiOutStr)/sizeof(char *),
 #else
 #define MIDI_LENGTH                 (0)
 #endif
@@ -592,18 +646,35 @@ unsigned char devQualDesc_Null[] =
  * Samples per channel. e.g (192000+7999/8000) = 24
  * Must allow 1 sample extra per chan (24 + 1) = 25
  * Multiply by number of channels and bytes      25 * 2 * 4 = 200 bytes
- * TODO Output doesn't get modified by channel count
 */
-#define MAX_PACKET_SIZE_MULT_OUT_HS ((((MAX_FREQ+7999)/8000)+1) * NUM_USB_CHAN_OUT)
+#define MAX_PACKET_SIZE_MULT_OUTPUT_1_HS ((((MAX_FREQ+7999)/8000)+1) * HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT)
+#define MAX_PACKET_SIZE_MULT_OUTPUT_2_HS ((((MAX_FREQ+7999)/8000)+1) * HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT)
+#define MAX_PACKET_SIZE_MULT_OUTPUT_3_HS ((((MAX_FREQ+7999)/8000)+1) * HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT)
 #define MAX_PACKET_SIZE_MULT_OUT_FS ((((MAX_FREQ_FS+999)/1000)+1) * NUM_USB_CHAN_OUT_FS)
 
-#define HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUT_HS * HS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES)
-#define HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUT_HS * HS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES)
-#define HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUT_HS * HS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES)
+#define HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUTPUT_1_HS * HS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES)
+#define HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUTPUT_2_HS * HS_STREAM_FORMAT_OUTPUT_2_SUBSLOT_BYTES)
+#define HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUTPUT_3_HS * HS_STREAM_FORMAT_OUTPUT_3_SUBSLOT_BYTES)
 
-#if (HS_STEAM_FORMAT_OUPUT_1_MAXPACKETSIZE > 1024) || (HS_STEAM_FORMAT_OUPUT_2_MAXPACKETSIZE > 1024) \
-    || (HS_STEAM_FORMAT_OUPUT_3_MAXPACKETSIZE > 1024)
-#error
+/* Sizes above XUA_ISO_MAX_PACKET_SIZE_HS would set the additional transaction bits of wMaxPacketSize, so are limited
+ * to a single transaction. The channel count and rate of such a stream is then only supported where the actual
+ * packets fit */
+#if (HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS)
+#warning HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS
+#undef HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE
+#define HS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE XUA_ISO_MAX_PACKET_SIZE_HS
+#endif
+
+#if (HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS)
+#warning HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS
+#undef HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE
+#define HS_STREAM_FORMAT_OUTPUT_2_MAXPACKETSIZE XUA_ISO_MAX_PACKET_SIZE_HS
+#endif
+
+#if (HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS)
+#warning HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS
+#undef HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE
+#define HS_STREAM_FORMAT_OUTPUT_3_MAXPACKETSIZE XUA_ISO_MAX_PACKET_SIZE_HS
 #endif
 
 #define FS_STREAM_FORMAT_OUTPUT_1_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_OUT_FS * FS_STREAM_FORMAT_OUTPUT_1_SUBSLOT_BYTES)
@@ -616,27 +687,34 @@ unsigned char devQualDesc_Null[] =
 #define MAX_PACKET_SIZE_MULT_INPUT_2_HS  ((((MAX_FREQ+7999)/8000)+1) * HS_STREAM_FORMAT_INPUT_2_CHAN_COUNT)
 #define MAX_PACKET_SIZE_MULT_INPUT_3_HS  ((((MAX_FREQ+7999)/8000)+1) * HS_STREAM_FORMAT_INPUT_3_CHAN_COUNT)
 
-/* TODO SUBSLOT_BYTES shared */
 #define HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_INPUT_1_HS * HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES)
-#define HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_INPUT_1_HS * HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES)
-#define HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_INPUT_1_HS * HS_STREAM_FORMAT_INPUT_1_SUBSLOT_BYTES)
+#define HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_INPUT_2_HS * HS_STREAM_FORMAT_INPUT_2_SUBSLOT_BYTES)
+#define HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE (MAX_PACKET_SIZE_MULT_INPUT_3_HS * HS_STREAM_FORMAT_INPUT_3_SUBSLOT_BYTES)
 
-#if (HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE > 1024)
-#warning HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE > 1024
+#if (HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS)
+#warning HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS
 #undef HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE
-#define HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE 1024
+#define HS_STREAM_FORMAT_INPUT_1_MAXPACKETSIZE XUA_ISO_MAX_PACKET_SIZE_HS
 #endif
 
-#if (HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE > 1024)
-#warning HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE > 1024
+#if (HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS)
+#warning HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS
 #undef HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE
-#define HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE 1024
+#define HS_STREAM_FORMAT_INPUT_2_MAXPACKETSIZE XUA_ISO_MAX_PACKET_SIZE_HS
 #endif
 
-#if (HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE > 1024)
-#warning HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE > 1024
+#if (HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS)
+#warning HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE > XUA_ISO_MAX_PACKET_SIZE_HS
 #undef HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE
-#define HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE 1024
+#define HS_STREAM_FORMAT_INPUT_3_MAXPACKETSIZE XUA_ISO_MAX_PACKET_SIZE_HS
+#endif
+
+/* Auxiliary input stream, always 4 byte subslots */
+#define AUX_IN_MAXPACKETSIZE_HS ((((MAX_FREQ+7999)/8000)+1) * XUA_AUX_IN_NUM_CHAN * 4)
+#define AUX_IN_MAXPACKETSIZE_FS ((((MAX_FREQ_FS+999)/1000)+1) * XUA_AUX_IN_NUM_CHAN * 4)
+
+#if (XUA_AUX_IN_EN) && ((AUX_IN_MAXPACKETSIZE_HS > XUA_ISO_MAX_PACKET_SIZE_HS) || (AUX_IN_MAXPACKETSIZE_FS > XUA_ISO_MAX_PACKET_SIZE_FS))
+#error Too many auxiliary input stream channels for the maximum sample rate (XUA_AUX_IN_NUM_CHAN)
 #endif
 
 /* Input Packet Sizes: full-speed */
@@ -649,6 +727,40 @@ unsigned char devQualDesc_Null[] =
 #define USB_Descriptor_Audio_ClockSelector_t USB_Descriptor_Audio_ClockSelector_2_t
 #elif (NUM_CLOCKS == 3)
 #define USB_Descriptor_Audio_ClockSelector_t USB_Descriptor_Audio_ClockSelector_3_t
+#elif (NUM_CLOCKS == 4)
+/* Clock Selector Descriptor (4.7.2.2) with four input pins */
+typedef struct
+{
+    unsigned char bLength;
+    unsigned char bDescriptorType;
+    unsigned char bDescriptorSubType;
+    unsigned char bClockID;
+    unsigned char bNrPins;
+    unsigned char baCSourceId[4];
+    unsigned char bmControl;
+    unsigned char iClockSelector;
+} __attribute__((packed)) USB_Descriptor_Audio_ClockSelector_4_t;
+
+#define USB_Descriptor_Audio_ClockSelector_t USB_Descriptor_Audio_ClockSelector_4_t
+#endif
+
+#if (USB_OUT_TO_IN_RATIO > 1)
+/* Clock Multiplier Descriptor (4.7.2.3) */
+typedef struct
+{
+    unsigned char bLength;
+    unsigned char bDescriptorType;
+    unsigned char bDescriptorSubType;
+    unsigned char bClockID;
+    unsigned char bCSourceID;
+    unsigned char bmControls;
+    unsigned char iClockMultiplier;
+} __attribute__((packed)) USB_Descriptor_Audio_ClockMultiplier_t;
+
+/* The IN terminals are clocked at 1/USB_OUT_TO_IN_RATIO of the selected clock source */
+#define ID_CLK_IN                ID_CLKMUL_IN
+#else
+#define ID_CLK_IN                ID_CLKSEL
 #endif
 
 typedef struct
@@ -661,8 +773,14 @@ typedef struct
 #endif
 #if (XUA_ADAT_RX_EN)
     USB_Descriptor_Audio_ClockSource_t          Audio_ClockSource_ADAT;
+#endif
+#if (XUA_WORDCLOCK_RX_EN)
+    USB_Descriptor_Audio_ClockSource_t          Audio_ClockSource_WORDCLOCK;
 #endif
     USB_Descriptor_Audio_ClockSelector_t        Audio_ClockSelector;
+#if (USB_OUT_TO_IN_RATIO > 1)
+    USB_Descriptor_Audio_ClockMultiplier_t      Audio_ClockMultiplier_In;
+#endif
 #if (NUM_USB_CHAN_OUT > 0)
     /* Output path */
     USB_Descriptor_Audio_InputTerminal_t        Audio_Out_InputTerminal;
@@ -684,6 +802,9 @@ typedef struct
     USB_Descriptor_Audio_FeatureUnit_In_t       Audio_In_FeatureUnit;
 #endif
     USB_Descriptor_Audio_OutputTerminal_t       Audio_In_OutputTerminal;
+#if (XUA_AUX_IN_EN)
+    USB_Descriptor_Audio_OutputTerminal_t       Audio_InAux_OutputTerminal;
+#endif
 #endif
 #if (MIXER) && (MAX_MIX_COUNT > 0)
     USB_Descriptor_Audio_ExtensionUnit2_t       Audio_Mix_ExtensionUnit;
@@ -691,7 +812,7 @@ typedef struct
     // USB_Descriptor_Audio_MixerUnit_t          Audio_MixerUnit;
     unsigned char configDesc_MixerUnit[MIXER_LENGTH];
 #endif
-#if (XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN)
+#if (XUA_STATUS_INT_EN)
     /* Interrupt EP */
     USB_Descriptor_Endpoint_t                   Audio_Int_Endpoint;
 #endif
@@ -762,6 +883,15 @@ typedef struct
     USB_Descriptor_Audio_Class_AS_Endpoint_t    Audio_In_ClassEndpoint_3;
 #endif
 #endif // NUM_USB_CHAN_IN > 0
+#if (XUA_AUX_IN_EN)
+    /* Audio Streaming: Auxiliary input stream */
+    USB_Descriptor_Interface_t                  Audio_InAux_StreamInterface_Alt0;  /* Zero bandwith alternative */
+    USB_Descriptor_Interface_t                  Audio_InAux_StreamInterface_Alt1;
+    USB_Descriptor_Audio_Interface_AS_t         Audio_InAux_ClassStreamInterface;
+    USB_Descriptor_Audio_Format_Type1_t         Audio_InAux_Format;
+    USB_Descriptor_Endpoint_t                   Audio_InAux_Endpoint;
+    USB_Descriptor_Audio_Class_AS_Endpoint_t    Audio_InAux_ClassEndpoint;
+#endif
 #ifdef MIDI
     /* MIDI descriptors currently handled as a single block */
     unsigned char configDesc_Midi[MIDI_LENGTH];
@@ -801,6 +931,11 @@ typedef struct
 #endif
 #endif
 
+#if (XUA_LEVEL_METER_EP_EN)
+    USB_Descriptor_Interface_t                  LevelMeter_Interface;
+    USB_Descriptor_Endpoint_t                   LevelMeter_In_Endpoint;
+#endif
+
 }__attribute__((packed)) USB_Config_Descriptor_Audio2_t;
 
 #if (AUDIO_CLASS == 2)
@@ -841,7 +976,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         .bDescriptorType               = USB_DESCTYPE_INTERFACE,
         .bInterfaceNumber              = INTERFACE_NUMBER_AUDIO_CONTROL,
         .bAlternateSetting             = 0x00,                     /* Must be 0 */
-#if (XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN)
+#if (XUA_STATUS_INT_EN)
         .bNumEndpoints                 = 0x01,                    /* 0 or 1 if optional interrupt endpoint is present */
 #else
         .bNumEndpoints                 = 0x00,
@@ -936,6 +1071,30 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         },
 #endif
 
+#if (XUA_WORDCLOCK_RX_EN)
+         /* Clock Source Descriptor (4.7.2.1) */
+        .Audio_ClockSource_WORDCLOCK =
+        {
+            .bLength                   = sizeof(USB_Descriptor_Audio_ClockSource_t),
+            .bDescriptorType           = UAC_CS_DESCTYPE_INTERFACE,
+            .bDescriptorSubType        = UAC_CS_AC_INTERFACE_SUBTYPE_CLOCK_SOURCE,
+            .bClockID                  = ID_CLKSRC_WORDCLOCK,
+            .bmAttributes              =  0x00,                   /* D[1:0] :
+                                                                        00: External Clock
+                                                                        01: Internal Fixed Clock
+                                                                        10: Internal Variable Clock
+                                                                        11: Internal Progamable Clock
+                                                                     D[2]   : Clock synced to SOF
+                                                                     D[7:3] : Reserved (0) */
+            .bmControls                = 0x07,                    /*
+                                                                    D[1:0] : Clock Freq Control
+                                                                    D[3:2] : Clock Validity Control
+                                                                    D[7:4] : Reserved (0) */
+            .bAssocTerminal            = 0x00,
+            .iClockSource              = offsetof(StringDescTable_t, wordClockSourceStr)/sizeof(char *),
+        },
+#endif
+
 
         /* Clock Selector Descriptor (4.7.2.2) */
         .Audio_ClockSelector =
@@ -952,11 +1111,31 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
 #endif
 #if (XUA_ADAT_RX_EN)
             ID_CLKSRC_ADAT,            /* baCSourceID */
+#endif
+#if (XUA_WORDCLOCK_RX_EN)
+            ID_CLKSRC_WORDCLOCK,       /* baCSourceID */
 #endif
             .bmControl                 = 0x03,
             .iClockSelector            = offsetof(StringDescTable_t, clockSelectorStr)/sizeof(char *),
         },
 
+#if (USB_OUT_TO_IN_RATIO > 1)
+        /* Clock Multiplier Descriptor (4.7.2.3) */
+        .Audio_ClockMultiplier_In =
+        {
+            .bLength                   = sizeof(USB_Descriptor_Audio_ClockMultiplier_t),
+            .bDescriptorType           = UAC_CS_DESCTYPE_INTERFACE,
+            .bDescriptorSubType        = 0x0C,                    /* CLOCK_MULTIPLIER */
+            .bClockID                  = ID_CLKMUL_IN,
+            .bCSourceID                = ID_CLKSEL,
+            .bmControls                = 0x05,                    /*
+                                                                    D[1:0] : Clock Numerator Control (read only)
+                                                                    D[3:2] : Clock Denominator Control (read only)
+                                                                    D[7:4] : Reserved (0) */
+            .iClockMultiplier          = 0,
+        },
+#endif
+
 #if (NUM_USB_CHAN_OUT > 0)
         /* Input Terminal Descriptor (USB Input Terminal) */
         .Audio_Out_InputTerminal =
@@ -1144,7 +1323,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
             .bTerminalID               = ID_IT_AUD,
             .wTerminalType             = UAC_TT_INPUT_TERMTYPE_MICROPHONE,
             .bAssocTerminal            = 0x00,
-            .bCSourceID                = ID_CLKSEL,
+            .bCSourceID                = ID_CLK_IN,
             .bNrChannels               = NUM_USB_CHAN_IN,
             .bmChannelConfig           = 0x00000000,
             .iChannelNames             = offsetof(StringDescTable_t, inputChanStr_1)/sizeof(char *),
@@ -1302,10 +1481,27 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
 
             .bSourceID                 = ID_IT_AUD,/* 7  bSourceID Connect to analog input term */
 #endif
-            .bCSourceID                = ID_CLKSEL,
+            .bCSourceID                = ID_CLK_IN,
             .bmControls                = 0x0000,
             .iTerminal                 = offsetof(StringDescTable_t, usbOutputTermStr_Audio2)/sizeof(char *)
         },
+
+#if (XUA_AUX_IN_EN)
+        .Audio_InAux_OutputTerminal =
+        {
+            /* Output Terminal Descriptor (USB Streaming), auxiliary input stream */
+            .bLength                   = 0x0C,
+            .bDescriptorType           = UAC_CS_DESCTYPE_INTERFACE,
+            .bDescriptorSubtype        = UAC_CS_AC_INTERFACE_SUBTYPE_OUTPUT_TERMINAL,
+            .bTerminalID               = ID_OT_USB_AUX,
+            .wTerminalType             = USB_TERMTYPE_USB_STREAMING,
+            .bAssocTerminal            = 0x00,
+            .bSourceID                 = ID_IT_AUD,         /* 7  bSourceID Connect to analog input term */
+            .bCSourceID                = ID_CLK_IN,
+            .bmControls                = 0x0000,
+            .iTerminal                 = offsetof(StringDescTable_t, usbOutputTermStr_Audio2)/sizeof(char *)
+        },
+#endif
 #endif /* (NUM_USB_CHAN_IN > 0) */
 
 #if (MIXER) && (MAX_MIX_COUNT > 0)
@@ -1402,7 +1598,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         },
 #endif /* (MIXER) && (MAX_MIX_COUNT > 0) */
 
-#if (XUA_SPDIF_RX_EN) || (XUA_ADAT_RX_EN)
+#if (XUA_STATUS_INT_EN)
         /* Standard AS Interrupt Endpoint Descriptor (4.8.2.1): */
         .Audio_Int_Endpoint =
         {
@@ -1461,7 +1657,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         0x00,                             /* 4  bmControls */
         UAC_FORMAT_TYPE_I,                /* 5  bFormatType */
         STREAM_FORMAT_OUTPUT_1_DATAFORMAT,/* 6:10  bmFormats (note this is a bitmap) */
-        NUM_USB_CHAN_OUT,                 /* 11 bNrChannels */
+        HS_STREAM_FORMAT_OUTPUT_1_CHAN_COUNT, /* 11 bNrChannels */
         0x00000000,                       /* 12:14: bmChannelConfig */
         .iChannelNames                 = offsetof(StringDescTable_t, outputChanStr_1)/sizeof(char *),
     },
@@ -1552,7 +1748,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         0x00,                             /* 4  bmControls */
         UAC_FORMAT_TYPE_I,                /* 5  bFormatType */
         STREAM_FORMAT_OUTPUT_2_DATAFORMAT,/* 6:10  bmFormats (note this is a bitmap) */
-        NUM_USB_CHAN_OUT,                 /* 11 bNrChannels */
+        HS_STREAM_FORMAT_OUTPUT_2_CHAN_COUNT, /* 11 bNrChannels */
         0x00000000,                       /* 12:14: bmChannelConfig */
         .iChannelNames                 = (offsetof(StringDescTable_t, outputChanStr_1)/sizeof(char *)),
     },
@@ -1643,7 +1839,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         0x00,                             /* 4  bmControls */
         UAC_FORMAT_TYPE_I,                /* 5  bFormatType */
         STREAM_FORMAT_OUTPUT_3_DATAFORMAT,/* 6:10  bmFormats (note this is a bitmap) */
-        NUM_USB_CHAN_OUT,                 /* 11 bNrChannels */
+        HS_STREAM_FORMAT_OUTPUT_3_CHAN_COUNT, /* 11 bNrChannels */
         0x00000000,                       /* 12:14: bmChannelConfig */
         .iChannelNames                 = offsetof(StringDescTable_t, outputChanStr_1)/sizeof(char *),
     },
@@ -1747,7 +1943,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         .bTerminalLink                 = ID_OT_USB,
         .bmControls                    = 0x00,
         .bFormatType                   = 0x01,
-        .bmFormats                     = UAC_FORMAT_TYPEI_PCM,
+        .bmFormats                     = STREAM_FORMAT_INPUT_1_DATAFORMAT,
         .bNrChannels                   = HS_STREAM_FORMAT_INPUT_1_CHAN_COUNT,
         .bmChannelConfig               = 0x00000000,
         .iChannelNames                 = offsetof(StringDescTable_t, inputChanStr_1)/sizeof(char *),
@@ -1823,7 +2019,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         .bTerminalLink                 = ID_OT_USB,
         .bmControls                    = 0x00,
         .bFormatType                   = 0x01,
-        .bmFormats                     = UAC_FORMAT_TYPEI_PCM,
+        .bmFormats                     = STREAM_FORMAT_INPUT_2_DATAFORMAT,
         .bNrChannels                   = HS_STREAM_FORMAT_INPUT_2_CHAN_COUNT,
         .bmChannelConfig               = 0x00000000,
         .iChannelNames                 = offsetof(StringDescTable_t, inputChanStr_1)/sizeof(char *),
@@ -1900,7 +2096,7 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
         .bTerminalLink                 = ID_OT_USB,
         .bmControls                    = 0x00,
         .bFormatType                   = 0x01,
-        .bmFormats                     = UAC_FORMAT_TYPEI_PCM,
+        .bmFormats                     = STREAM_FORMAT_INPUT_3_DATAFORMAT,
         .bNrChannels                   = HS_STREAM_FORMAT_INPUT_3_CHAN_COUNT,
         .bmChannelConfig               = 0x00000000,
         .iChannelNames                 = offsetof(StringDescTable_t, inputChanStr_1)/sizeof(char *),
@@ -1953,6 +2149,95 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     },
 #endif /* (INPUT_FORMAT_COUNT > 2) */
 #endif /* (NUM_USB_CHAN_IN > 0) */
+#if (XUA_AUX_IN_EN)
+    /* Auxiliary input stream */
+    /* Zero bandwith alternative 0 */
+    /* Standard AS Interface Descriptor (4.9.1) */
+    .Audio_InAux_StreamInterface_Alt0 =
+    {
+        .bLength                       = 0x09,
+        .bDescriptorType               = USB_DESCTYPE_INTERFACE,
+        .bInterfaceNumber              = INTERFACE_NUMBER_AUDIO_INPUT_AUX,
+        .bAlternateSetting             = 0,
+        .bNumEndpoints                 = 0,
+        .bInterfaceClass               = USB_CLASS_AUDIO,
+        .bInterfaceSubClass            = UAC_INT_SUBCLASS_AUDIOSTREAMING,
+        .bInterfaceProtocol            = 0x20,
+        .iInterface                    = 5, /* (String index) */
+    },
+
+    /* Alternative 1 */
+    /* Standard AS Interface Descriptor (4.9.1) (Alt) */
+    .Audio_InAux_StreamInterface_Alt1 =
+    {
+        .bLength                       = 0x09,
+        .bDescriptorType               = USB_DESCTYPE_INTERFACE,
+        .bInterfaceNumber              = INTERFACE_NUMBER_AUDIO_INPUT_AUX,
+        .bAlternateSetting             = 1,
+        .bNumEndpoints                 = 1,
+        .bInterfaceClass               = USB_CLASS_AUDIO,
+        .bInterfaceSubClass            = UAC_INT_SUBCLASS_AUDIOSTREAMING,
+        .bInterfaceProtocol            = UAC_INT_PROTOCOL_IP_VERSION_02_00,
+        .iInterface                    = 5,     /* (String index) */
+    },
+
+    /* Class Specific AS Interface Descriptor */
+    .Audio_InAux_ClassStreamInterface =
+    {
+        .bLength                       = 0x10,
+        .bDescriptorType               = UAC_CS_DESCTYPE_INTERFACE,
+        .bDescriptorSubType            = UAC_CS_AS_INTERFACE_SUBTYPE_AS_GENERAL,
+        .bTerminalLink                 = ID_OT_USB_AUX,
+        .bmControls                    = 0x00,
+        .bFormatType                   = 0x01,
+        .bmFormats                     = UAC_FORMAT_TYPEI_PCM,
+        .bNrChannels                   = XUA_AUX_IN_NUM_CHAN,
+        .bmChannelConfig               = 0x00000000,
+        .iChannelNames                 = 0,
+    },
+
+    /* Type 1 Format Type Descriptor */
+    .Audio_InAux_Format =
+    {
+        .bLength                       = 6,
+        .bDescriptorType               = UAC_CS_DESCTYPE_INTERFACE,
+        .bDescriptorSubtype            = UAC_CS_AS_INTERFACE_SUBTYPE_FORMAT_TYPE,
+        .bFormatType                   = UAC_FORMAT_TYPE_I,
+        .bSubslotSize                  = 4,    /* Number of bytes per subslot */
+        .bBitResolution                = 24,
+    },
+
+    /* Standard AS Isochronous Audio Data Endpoint Descriptor (4.10.1.1) */
+    .Audio_InAux_Endpoint =
+    {
+        .bLength                       = 0x07,
+        .bDescriptorType               = USB_DESCTYPE_ENDPOINT,
+        .bEndpointAddress              = ENDPOINT_ADDRESS_IN_AUDIO_AUX,
+#if (XUA_SYNCMODE == XUA_SYNCMODE_ADAPT)
+        .bmAttributes                   = ISO_EP_ATTRIBUTES_ADAPTIVE,
+#elif (XUA_SYNCMODE == XUA_SYNCMODE_ASYNC)
+        .bmAttributes                   = ISO_EP_ATTRIBUTES_ASYNC,         /* Iso, Async, data endpoint */
+#elif (XUA_SYNCMODE == XUA_SYNCMODE_SYNC)
+        .bmAttributes                   = ISO_EP_ATTRIBUTES_SYNC,          /* Iso, Sync, data endpoint */
+#else
+    #error "Bad XUA_SYNCMODE"
+#endif
+        .wMaxPacketSize                = AUX_IN_MAXPACKETSIZE_HS,
+        .bInterval                     = 0x01,
+    },
+
+    /* Class-Specific AS Isochronous Audio Data Endpoint Descriptor (4.10.1.2) */
+    .Audio_InAux_ClassEndpoint =
+    {
+        .bLength                       = sizeof(USB_Descriptor_Audio_Class_AS_Endpoint_t),
+        .bDescriptorType               = UAC_CS_DESCTYPE_ENDPOINT,
+        .bDescriptorSubtype            = UAC_CS_ENDPOINT_SUBTYPE_EP_GENERAL,
+        .bmAttributes                  = 0x00,
+        .bmControls                    = 0x00,
+        .bLockDelayUnits               = 0x02,
+        .wLockDelay                    = 0x0008,
+    },
+#endif /* (XUA_AUX_IN_EN) */
 
 #ifdef MIDI
 /* MIDI Descriptors */
@@ -1995,8 +2280,8 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     0x01,                                 /* 2 bDescriptorSubtype : MS_HEADER subtype. (field size 1 bytes) */
     0x00,                                 /* 3 BcdADC : Revision of this class specification. (field size 2 bytes) */
     0x01,                                 /* 4 BcdADC */
-    0x41,                                 /* 5 wTotalLength : Total size of class-specific descriptors. (field size 2 bytes) */
-    0x00,                                 /* 6 wTotalLength */
+    (MIDI_MS_TOTAL_LENGTH & 0xFF),        /* 5 wTotalLength : Total size of class-specific descriptors. (field size 2 bytes) */
+    (MIDI_MS_TOTAL_LENGTH >> 8),          /* 6 wTotalLength */
 
 /* Table B-7: MIDI Adapter MIDI IN Jack Descriptor (Embedded) */
     0x06,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
@@ -2036,6 +2321,29 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     0x01,                                 /* 7 BaSourcePin(1) : Output Pin number of the Entity to which this Input Pin is connected. */
     offsetof(StringDescTable_t, midiOutStr)/sizeof(char *),            /* 5 iJack : Unused. (field size 1 bytes) */
 
+/* Jacks for further cables */
+#if (XUA_MIDI_PORTS > 1)
+    MIDI_CABLE_JACKS(1)
+#endif
+#if (XUA_MIDI_PORTS > 2)
+    MIDI_CABLE_JACKS(2)
+#endif
+#if (XUA_MIDI_PORTS > 3)
+    MIDI_CABLE_JACKS(3)
+#endif
+#if (XUA_MIDI_PORTS > 4)
+    MIDI_CABLE_JACKS(4)
+#endif
+#if (XUA_MIDI_PORTS > 5)
+    MIDI_CABLE_JACKS(5)
+#endif
+#if (XUA_MIDI_PORTS > 6)
+    MIDI_CABLE_JACKS(6)
+#endif
+#if (XUA_MIDI_PORTS > 7)
+    MIDI_CABLE_JACKS(7)
+#endif
+
 /* Table B-11: MIDI Adapter Standard Bulk OUT Endpoint Descriptor */
     0x09,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
     0x05,                                 /* 1 bDescriptorType : ENDPOINT descriptor. (field size 1 bytes) */
@@ -2048,11 +2356,32 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     0x00,                                 /* 8 bSynchAddress : Unused. (field size 1 bytes) */
 
 /* Table B-12: MIDI Adapter Class-specific Bulk OUT Endpoint Descriptor */
-    0x05,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    4 + XUA_MIDI_PORTS,                   /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
     0x25,                                 /* 1 bDescriptorType : CS_ENDPOINT descriptor (field size 1 bytes) */
     0x01,                                 /* 2 bDescriptorSubtype : MS_GENERAL subtype. (field size 1 bytes) */
-    0x01,                                 /* 3 bNumEmbMIDIJack : Number of embedded MIDI IN Jacks. (field size 1 bytes) */
+    XUA_MIDI_PORTS,                       /* 3 bNumEmbMIDIJack : Number of embedded MIDI IN Jacks. (field size 1 bytes) */
     0x01,                                 /* 4 BaAssocJackID(1) : ID of the Embedded MIDI IN Jack. (field size 1 bytes) */
+#if (XUA_MIDI_PORTS > 1)
+    0x05,                                 /* 5 BaAssocJackID(2) */
+#endif
+#if (XUA_MIDI_PORTS > 2)
+    0x09,                                 /* 6 BaAssocJackID(3) */
+#endif
+#if (XUA_MIDI_PORTS > 3)
+    0x0D,                                 /* 7 BaAssocJackID(4) */
+#endif
+#if (XUA_MIDI_PORTS > 4)
+    0x11,                                 /* 8 BaAssocJackID(5) */
+#endif
+#if (XUA_MIDI_PORTS > 5)
+    0x15,                                 /* 9 BaAssocJackID(6) */
+#endif
+#if (XUA_MIDI_PORTS > 6)
+    0x19,                                 /* 10 BaAssocJackID(7) */
+#endif
+#if (XUA_MIDI_PORTS > 7)
+    0x1D,                                 /* 11 BaAssocJackID(8) */
+#endif
 
 /* Table B-13: MIDI Adapter Standard Bulk IN Endpoint Descriptor */
     0x09,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
@@ -2066,11 +2395,86 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     0x00,                                 /* 8 bSynchAddress : Unused. (field size 1 bytes) */
 
 /* Table B-14: MIDI Adapter Class-specific Bulk IN Endpoint Descriptor */
-    0x05,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    4 + XUA_MIDI_PORTS,                   /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
     0x25,                                 /* 1 bDescriptorType : CS_ENDPOINT descriptor (field size 1 bytes) */
     0x01,                                 /* 2 bDescriptorSubtype : MS_GENERAL subtype. (field size 1 bytes) */
-    0x01,                                 /* 3 bNumEmbMIDIJack : Number of embedded MIDI OUT Jacks. (field size 1 bytes) */
+    XUA_MIDI_PORTS,                       /* 3 bNumEmbMIDIJack : Number of embedded MIDI OUT Jacks. (field size 1 bytes) */
     0x03,                                 /* 4 BaAssocJackID(1) : ID of the Embedded MIDI OUT Jack. (field size 1 bytes) */
+#if (XUA_MIDI_PORTS > 1)
+    0x07,                                 /* 5 BaAssocJackID(2) */
+#endif
+#if (XUA_MIDI_PORTS > 2)
+    0x0B,                                 /* 6 BaAssocJackID(3) */
+#endif
+#if (XUA_MIDI_PORTS > 3)
+    0x0F,                                 /* 7 BaAssocJackID(4) */
+#endif
+#if (XUA_MIDI_PORTS > 4)
+    0x13,                                 /* 8 BaAssocJackID(5) */
+#endif
+#if (XUA_MIDI_PORTS > 5)
+    0x17,                                 /* 9 BaAssocJackID(6) */
+#endif
+#if (XUA_MIDI_PORTS > 6)
+    0x1B,                                 /* 10 BaAssocJackID(7) */
+#endif
+#if (XUA_MIDI_PORTS > 7)
+    0x1F,                                 /* 11 BaAssocJackID(8) */
+#endif
+
+#if (XUA_MIDI_UMP)
+/* USB MIDI 2.0 Standard MS Interface Descriptor, alternate setting 1 */
+    0x09,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    0x04,                                 /* 1 bDescriptorType : INTERFACE descriptor. (field size 1 bytes) */
+    INTERFACE_NUMBER_MIDI_STREAM,         /* 2 bInterfaceNumber : Index of this interface. (field size 1 bytes) */
+    0x01,                                 /* 3 bAlternateSetting : Index of this alternate setting. (field size 1 bytes) */
+    0x02,                                 /* 4 bNumEndpoints : 2 endpoints. (field size 1 bytes) */
+    0x01,                                 /* 5 bInterfaceClass : AUDIO. (field size 1 bytes) */
+    0x03,                                 /* 6 bInterfaceSubclass : MIDISTREAMING. (field size 1 bytes) */
+    0x00,                                 /* 7 bInterfaceProtocol : Unused. (field size 1 bytes) */
+    0x00,                                 /* 8 iInterface : Unused. (field size 1 bytes) */
+
+/* USB MIDI 2.0 Class-specific MS Interface Header Descriptor */
+    0x07,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    0x24,                                 /* 1 bDescriptorType : CS_INTERFACE. (field size 1 bytes) */
+    0x01,                                 /* 2 bDescriptorSubtype : MS_HEADER subtype. (field size 1 bytes) */
+    0x00,                                 /* 3 bcdMSC : Revision of this class specification - 2.0 (field size 2 bytes) */
+    0x02,                                 /* 4 bcdMSC */
+    0x07,                                 /* 5 wTotalLength : Total size of class-specific descriptors, this header only. */
+    0x00,                                 /* 6 wTotalLength */
+
+/* USB MIDI 2.0 Standard Bulk OUT Endpoint Descriptor */
+    0x07,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    0x05,                                 /* 1 bDescriptorType : ENDPOINT descriptor. (field size 1 bytes) */
+    ENDPOINT_ADDRESS_OUT_MIDI,            /* 2 bEndpointAddress : OUT Endpoint. (field size 1 bytes) */
+    0x02,                                 /* 3 bmAttributes : Bulk, not shared. (field size 1 bytes) */
+    0x00,                                 /* 4 wMaxPacketSize : 512 bytes per packet. (field size 2 bytes) */
+    0x02,                                 /* 5 wMaxPacketSize */
+    0x00,                                 /* 6 bInterval : Ignored for Bulk. Set to zero. (field size 1 bytes) */
+
+/* USB MIDI 2.0 Class-specific Bulk OUT Endpoint Descriptor */
+    4 + XUA_MIDI_PORTS,                   /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    0x25,                                 /* 1 bDescriptorType : CS_ENDPOINT descriptor (field size 1 bytes) */
+    0x02,                                 /* 2 bDescriptorSubtype : MS_GENERAL_2_0 subtype. (field size 1 bytes) */
+    XUA_MIDI_PORTS,                       /* 3 bNumGrpTrmBlock : Number of group terminal blocks. (field size 1 bytes) */
+    MIDI_GTB_IDS,                         /* 4 baAssoGrpTrmBlkID : IDs of the group terminal blocks. */
+
+/* USB MIDI 2.0 Standard Bulk IN Endpoint Descriptor */
+    0x07,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    0x05,                                 /* 1 bDescriptorType : ENDPOINT descriptor. (field size 1 bytes) */
+    ENDPOINT_ADDRESS_IN_MIDI,             /* 2 bEndpointAddress : IN Endpoint. (field size 1 bytes) */
+    0x02,                                 /* 3 bmAttributes : Bulk, not shared. (field size 1 bytes) */
+    0x00,                                 /* 4 wMaxPacketSize : 512 bytes per packet. (field size 2 bytes) */
+    0x02,                                 /* 5 wMaxPacketSize */
+    0x00,                                 /* 6 bInterval : Ignored for Bulk. Set to zero. (field size 1 bytes) */
+
+/* USB MIDI 2.0 Class-specific Bulk IN Endpoint Descriptor */
+    4 + XUA_MIDI_PORTS,                   /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    0x25,                                 /* 1 bDescriptorType : CS_ENDPOINT descriptor (field size 1 bytes) */
+    0x02,                                 /* 2 bDescriptorSubtype : MS_GENERAL_2_0 subtype. (field size 1 bytes) */
+    XUA_MIDI_PORTS,                       /* 3 bNumGrpTrmBlock : Number of group terminal blocks. (field size 1 bytes) */
+    MIDI_GTB_IDS,                         /* 4 baAssoGrpTrmBlkID : IDs of the group terminal blocks. */
+#endif
     },
 #endif // MIDI
 
@@ -2102,8 +2506,8 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     0x07,                                 /* 2    bmAttributes */
     DFU_DETACH_TIME_OUT & 0xFF,           /* 3    wDetachTimeOut */
     (DFU_DETACH_TIME_OUT >> 8) & 0xFF,    /* 4    wDetachTimeOut */
-    0x40,                                 /* 5    wTransferSize */
-    0x00,                                 /* 6    wTransferSize */
+    XUA_DFU_TRANSFER_SIZE & 0xFF,         /* 5    wTransferSize */
+    (XUA_DFU_TRANSFER_SIZE >> 8) & 0xFF,  /* 6    wTransferSize */
     0x10,                                 /* 7    bcdDFUVersion */
     0x01},                                /* 7    bcdDFUVersion */
 #endif
@@ -2235,6 +2639,33 @@ USB_Config_Descriptor_Audio2_t cfgDesc_Audio2=
     #include "xua_hid_descriptors.h"
 #endif
 
+#if (XUA_LEVEL_METER_EP_EN)
+    /* Level meter interface descriptor */
+    .LevelMeter_Interface =
+    {
+        .bLength                       = sizeof(USB_Descriptor_Interface_t),
+        .bDescriptorType               = USB_DESCTYPE_INTERFACE,
+        .bInterfaceNumber              = INTERFACE_NUMBER_LEVEL_METER,
+        .bAlternateSetting             = 0x00,
+        .bNumEndpoints                 = 0x01,
+        .bInterfaceClass               = USB_CLASS_VENDOR_SPECIFIC,
+        .bInterfaceSubClass            = 0xFF,
+        .bInterfaceProtocol            = 0xFF,
+        .iInterface                    = 0x00,
+    },
+
+    /* Level meter interrupt IN endpoint descriptor */
+    .LevelMeter_In_Endpoint =
+    {
+        .bLength                        = sizeof(USB_Descriptor_Endpoint_t),
+        .bDescriptorType                = USB_DESCTYPE_ENDPOINT,
+        .bEndpointAddress               = ENDPOINT_ADDRESS_IN_LEVEL_METER,
+        .bmAttributes                   = 0x03,     /* Interrupt */
+        .wMaxPacketSize                 = XUA_LEVEL_METER_EP_BYTES,
+        .bInterval                      = ENDPOINT_INT_INTERVAL_IN_LEVEL_METER,
+    },
+#endif
+
 };
 #endif /* (AUDIO_CLASS == 2) */
 
@@ -2251,6 +2682,42 @@ unsigned char* hidDescriptor = (unsigned char*) &cfgDesc_Audio2.HID_Descriptor;
 #endif
 #endif // 0 < HID_CONTROLS
 
+#if defined(MIDI) && (XUA_MIDI_UMP)
+unsigned char midiGroupTerminalBlocks[MIDI_GTB_LENGTH] =
+{
+    /* Group Terminal Block Header Descriptor */
+    0x05,                                 /* 0 bLength : Size of this descriptor, in bytes. (field size 1 bytes) */
+    MIDI_CS_GR_TRM_BLOCK,                 /* 1 bDescriptorType : CS_GR_TRM_BLOCK. (field size 1 bytes) */
+    0x01,                                 /* 2 bDescriptorSubtype : GR_TRM_BLOCK_HEADER subtype. (field size 1 bytes) */
+    (MIDI_GTB_LENGTH & 0xFF),             /* 3 wTotalLength : Total size of the group terminal block descriptors. */
+    (MIDI_GTB_LENGTH >> 8),               /* 4 wTotalLength */
+
+    /* Group Terminal Block Descriptors, one per port */
+    MIDI_GTB(0)
+#if (XUA_MIDI_PORTS > 1)
+    MIDI_GTB(1)
+#endif
+#if (XUA_MIDI_PORTS > 2)
+    MIDI_GTB(2)
+#endif
+#if (XUA_MIDI_PORTS > 3)
+    MIDI_GTB(3)
+#endif
+#if (XUA_MIDI_PORTS > 4)
+    MIDI_GTB(4)
+#endif
+#if (XUA_MIDI_PORTS > 5)
+    MIDI_GTB(5)
+#endif
+#if (XUA_MIDI_PORTS > 6)
+    MIDI_GTB(6)
+#endif
+#if (XUA_MIDI_PORTS > 7)
+    MIDI_GTB(7)
+#endif
+};
+#endif
+
 
 /* Configuration Descriptor for Null device */
 unsigned char cfgDesc_Null[] =
@@ -2897,8 +3364,8 @@ unsigned char cfgDesc_Audio1[] =
     0x07,                                 /* 2    bmAttributes */
     DFU_DETACH_TIME_OUT & 0xFF,           /* 3    wDetachTimeOut */
     (DFU_DETACH_TIME_OUT >> 8) & 0xFF,    /* 4    wDetachTimeOut */
-    0x40,                                 /* 5    wTransferSize */
-    0x00,                                 /* 6    wTransferSize */
+    XUA_DFU_TRANSFER_SIZE & 0xFF,         /* 5    wTransferSize */
+    (XUA_DFU_TRANSFER_SIZE >> 8) & 0xFF,  /* 6    wTransferSize */
     0x10,                                 /* 7    bcdDFUVersion */
     0x01,                                                  /* 7    bcdDFUVersion */
 #endif
@@ -0,0 +1,191 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+
+#if XUA_USB_EN && (XUA_MIXER_SCENES)
+#include <string.h>
+#include "xud_device.h"
+#include "xua_dfu.h"
+#include "xua_ep0_uacreqs.h"
+#include "xua_ep0_scene.h"
+
+#define SCENE_MAGIC         (0x31435358)    /* "XSC1" */
+#define SCENE_LAYOUT        ((NUM_USB_CHAN_OUT) | ((NUM_USB_CHAN_IN) << 8) | ((MAX_MIX_COUNT) << 16) | ((MIX_INPUTS) << 24))
+#define SCENE_PAGE_SIZE     (256)
+#define SCENE_CRC32_POLY    (0xEDB88320)
+
+/* State held by Endpoint 0, see xua_endpoint0.c */
+extern int volsOut[NUM_USB_CHAN_OUT + 1];
+extern unsigned int mutesOut[NUM_USB_CHAN_OUT + 1];
+extern int volsIn[NUM_USB_CHAN_IN + 1];
+extern unsigned int mutesIn[NUM_USB_CHAN_IN + 1];
+extern short mixer1Weights[MIX_INPUTS * MAX_MIX_COUNT];
+extern unsigned char channelMapAud[NUM_USB_CHAN_OUT];
+extern unsigned char channelMapUsb[NUM_USB_CHAN_IN];
+extern unsigned char mixSel[MAX_MIX_COUNT][MIX_INPUTS];
+
+typedef struct
+{
+    unsigned magic;
+    unsigned layout;        /* Channel and mixer dimensions of the firmware that saved the scene */
+    unsigned length;        /* Bytes of state */
+    unsigned crc;           /* CRC-32 of the state, zero padded to a whole word */
+} scene_header_t;
+
+typedef struct
+{
+    int volsOut[NUM_USB_CHAN_OUT + 1];
+    unsigned mutesOut[NUM_USB_CHAN_OUT + 1];
+    int volsIn[NUM_USB_CHAN_IN + 1];
+    unsigned mutesIn[NUM_USB_CHAN_IN + 1];
+    short weights[MIX_INPUTS * MAX_MIX_COUNT];
+    unsigned char mixSel[MAX_MIX_COUNT][MIX_INPUTS];
+    unsigned char channelMapAud[NUM_USB_CHAN_OUT];
+    unsigned char channelMapUsb[NUM_USB_CHAN_IN];
+} scene_state_t;
+
+#define SCENE_PAGES         ((sizeof(scene_header_t) + sizeof(scene_state_t) + SCENE_PAGE_SIZE - 1) / SCENE_PAGE_SIZE)
+
+static union
+{
+    struct
+    {
+        scene_header_t header;
+        scene_state_t state;
+    } scene;
+    unsigned words[SCENE_PAGES * SCENE_PAGE_SIZE / 4];
+    unsigned char bytes[SCENE_PAGES * SCENE_PAGE_SIZE];
+} sceneBuffer;
+
+static unsigned SceneCrc(void)
+{
+    unsigned crc = 0xFFFFFFFF;
+    unsigned first = sizeof(scene_header_t) / 4;
+    unsigned words = (sizeof(scene_state_t) + 3) / 4;
+
+    for (unsigned i = 0; i < words; i++)
+    {
+        asm volatile("crc32 %0, %2, %3" : "=r"(crc) : "0"(crc), "r"(sceneBuffer.words[first + i]), "r"(SCENE_CRC32_POLY));
+    }
+    return ~crc;
+}
+
+static int SceneHeaderValid(void)
+{
+    return (sceneBuffer.scene.header.magic == SCENE_MAGIC)
+        && (sceneBuffer.scene.header.layout == SCENE_LAYOUT)
+        && (sceneBuffer.scene.header.length == sizeof(scene_state_t));
+}
+
+int XUA_MixerSceneSave(unsigned dfuInterface, unsigned slot)
+{
+    if (slot >= XUA_MIXER_SCENES)
+    {
+        return 1;
+    }
+
+    memset(&sceneBuffer, 0, sizeof(sceneBuffer));
+
+    memcpy(sceneBuffer.scene.state.volsOut, volsOut, sizeof(sceneBuffer.scene.state.volsOut));
+    memcpy(sceneBuffer.scene.state.mutesOut, mutesOut, sizeof(sceneBuffer.scene.state.mutesOut));
+    memcpy(sceneBuffer.scene.state.volsIn, volsIn, sizeof(sceneBuffer.scene.state.volsIn));
+    memcpy(sceneBuffer.scene.state.mutesIn, mutesIn, sizeof(sceneBuffer.scene.state.mutesIn));
+    memcpy(sceneBuffer.scene.state.weights, mixer1Weights, sizeof(sceneBuffer.scene.state.weights));
+    memcpy(sceneBuffer.scene.state.mixSel, mixSel, sizeof(sceneBuffer.scene.state.mixSel));
+    memcpy(sceneBuffer.scene.state.channelMapAud, channelMapAud, sizeof(sceneBuffer.scene.state.channelMapAud));
+    memcpy(sceneBuffer.scene.state.channelMapUsb, channelMapUsb, sizeof(sceneBuffer.scene.state.channelMapUsb));
+
+    sceneBuffer.scene.header.magic = SCENE_MAGIC;
+    sceneBuffer.scene.header.layout = SCENE_LAYOUT;
+    sceneBuffer.scene.header.length = sizeof(scene_state_t);
+    sceneBuffer.scene.header.crc = SceneCrc();
+
+    /* Page 0 (the header) erases the sector so is written first, an interrupted save leaves an invalid scene */
+    for (unsigned page = 0; page < SCENE_PAGES; page++)
+    {
+        if (DFUDataWritePage(dfuInterface, slot, page, &sceneBuffer.bytes[page * SCENE_PAGE_SIZE]))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int XUA_MixerSceneRecall(unsigned dfuInterface, chanend c_mix_ctl, unsigned slot)
+{
+    if (slot >= XUA_MIXER_SCENES)
+    {
+        return 1;
+    }
+
+    if (DFUDataReadPage(dfuInterface, slot, 0, sceneBuffer.bytes) || !SceneHeaderValid())
+    {
+        return 1;
+    }
+
+    for (unsigned page = 1; page < SCENE_PAGES; page++)
+    {
+        if (DFUDataReadPage(dfuInterface, slot, page, &sceneBuffer.bytes[page * SCENE_PAGE_SIZE]))
+        {
+            return 1;
+        }
+    }
+
+    /* Padding after the state is written as zero */
+    memset(&sceneBuffer.bytes[sizeof(scene_header_t) + sizeof(scene_state_t)], 0,
+        sizeof(sceneBuffer) - sizeof(scene_header_t) - sizeof(scene_state_t));
+
+    if (sceneBuffer.scene.header.crc != SceneCrc())
+    {
+        return 1;
+    }
+
+    memcpy(volsOut, sceneBuffer.scene.state.volsOut, sizeof(sceneBuffer.scene.state.volsOut));
+    memcpy(mutesOut, sceneBuffer.scene.state.mutesOut, sizeof(sceneBuffer.scene.state.mutesOut));
+    memcpy(volsIn, sceneBuffer.scene.state.volsIn, sizeof(sceneBuffer.scene.state.volsIn));
+    memcpy(mutesIn, sceneBuffer.scene.state.mutesIn, sizeof(sceneBuffer.scene.state.mutesIn));
+    memcpy(mixer1Weights, sceneBuffer.scene.state.weights, sizeof(sceneBuffer.scene.state.weights));
+    memcpy(mixSel, sceneBuffer.scene.state.mixSel, sizeof(sceneBuffer.scene.state.mixSel));
+    memcpy(channelMapAud, sceneBuffer.scene.state.channelMapAud, sizeof(sceneBuffer.scene.state.channelMapAud));
+    memcpy(channelMapUsb, sceneBuffer.scene.state.channelMapUsb, sizeof(sceneBuffer.scene.state.channelMapUsb));
+
+    XUA_MIXER_CHANGED(XUA_MIXER_CHANGE_WEIGHTS);
+    XUA_MIXER_CHANGED(XUA_MIXER_CHANGE_MIXSEL);
+    XUA_MIXER_CHANGED(XUA_MIXER_CHANGE_CHAN_MAP);
+
+    if (c_mix_ctl)
+    {
+        LoadMixerState(c_mix_ctl);
+    }
+
+    return 0;
+}
+
+int XUA_MixerSceneErase(unsigned dfuInterface, unsigned slot)
+{
+    if (slot >= XUA_MIXER_SCENES)
+    {
+        return 1;
+    }
+
+    /* Writing the first page erases the sector, leaving a blank header */
+    memset(&sceneBuffer, 0, SCENE_PAGE_SIZE);
+    return DFUDataWritePage(dfuInterface, slot, 0, sceneBuffer.bytes);
+}
+
+unsigned XUA_MixerSceneValid(unsigned dfuInterface)
+{
+    unsigned valid = 0;
+
+    for (unsigned slot = 0; slot < XUA_MIXER_SCENES; slot++)
+    {
+        if (!DFUDataReadPage(dfuInterface, slot, 0, sceneBuffer.bytes) && SceneHeaderValid())
+        {
+            valid |= (1 << slot);
+        }
+    }
+
+    return valid;
+}
+#endif
@@ -0,0 +1,30 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_EP0_SCENE_H_
+#define _XUA_EP0_SCENE_H_
+
+#include <xccompat.h>
+#include "xua.h"
+#if __XC__
+#include "dfu_interface.h"
+#endif
+
+/* Mixer scenes (XUA_MIXER_SCENES). A scene is a snapshot of the mixer, channel map and volume state held by
+ * Endpoint 0. Scene n is stored in data sector n of the flash data partition, written a page at a time through the
+ * DFU handler. A scene saved by firmware with a different channel or mixer layout is not recalled */
+
+/* Saves the current state to a scene slot. Returns non-zero on error */
+int XUA_MixerSceneSave(CLIENT_INTERFACE(i_dfu, dfuInterface), unsigned slot);
+
+/* Restores the state held in a scene slot and loads it into the mixer, routing and weights being applied on a
+ * single frame. c_mix_ctl may be null when only the Endpoint 0 copy of the state is required. Returns non-zero if
+ * the slot does not hold a valid scene, in which case the state is unchanged */
+int XUA_MixerSceneRecall(CLIENT_INTERFACE(i_dfu, dfuInterface), NULLABLE_RESOURCE(chanend, c_mix_ctl), unsigned slot);
+
+/* Invalidates a scene slot. Returns non-zero on error */
+int XUA_MixerSceneErase(CLIENT_INTERFACE(i_dfu, dfuInterface), unsigned slot);
+
+/* Returns a mask of the slots holding a valid scene */
+unsigned XUA_MixerSceneValid(CLIENT_INTERFACE(i_dfu, dfuInterface));
+
+#endif
@@ -1,4 +1,4 @@
-// Copyright 2014-2021 XMOS LIMITED.
+// Copyright 2014-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #ifndef _AUDIOREQUESTS_H_
@@ -15,6 +15,34 @@ XUD_Result_t AudioClassRequests_1(XUD_ep ep0_out, XUD_ep ep0_in, REFERENCE_PARAM
 int AudioEndpointRequests_1(XUD_ep ep0_out, XUD_ep ep0_in, REFERENCE_PARAM(USB_SetupPacket_t, sp), NULLABLE_RESOURCE(chanend, c_audioControl),
     NULLABLE_RESOURCE(chanend, c_mix_ctl), NULLABLE_RESOURCE(chanend, c_clk_ctl));
 
+#if (XUA_MIXER_CHANGE_COUNTERS)
+/* Indices of the mixer state change counters, in the order returned to the host */
+#define XUA_MIXER_CHANGE_WEIGHTS    (0)
+#define XUA_MIXER_CHANGE_MIXSEL     (1)
+#define XUA_MIXER_CHANGE_CHAN_MAP   (2)
+#define XUA_MIXER_CHANGE_COUNT      (3)
+
+extern unsigned g_mixerChangeCount[XUA_MIXER_CHANGE_COUNT];
+
+#define XUA_MIXER_CHANGED(x)        (g_mixerChangeCount[(x)]++)
+#else
+#define XUA_MIXER_CHANGED(x)
+#endif
+
+/* Completes any sample rate change left outstanding by XUA_EP0_ASYNC_RATE_CHANGE */
+void AudioControlSync(NULLABLE_RESOURCE(chanend, c_audioControl));
+
+/* Loads all of the mixer weights held by Endpoint 0 into the mixer and applies them on a single frame */
+void LoadMixerWeights(chanend c_mix_ctl);
+
+/* Loads all of the mixer routing, weights and volumes held by Endpoint 0 into the mixer. The routing and weights
+ * are applied on a single frame, the volumes immediately after */
+void LoadMixerState(chanend c_mix_ctl);
+
+#if (MIXER) && (XUA_MIXER_EQ_BIQUADS > 0)
+/* Loads the EQ coefficients of an output held by Endpoint 0 into the mixer and applies them between two samples */
+void LoadMixerEq(chanend c_mix_ctl, unsigned chan);
+#endif
 
 void VendorAudioRequestsInit(chanend c_audioControl, NULLABLE_RESOURCE(chanend, c_mix_ctl), NULLABLE_RESOURCE(chanend, c_clk_ctl));
 
@@ -0,0 +1,630 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <string.h>
+#include "xua.h"
+#if XUA_USB_EN
+
+#include "xud_device.h"
+#include "xc_ptr.h"
+#include "xua_ep0_vendorreqs.h"
+#if (XUA_LATENCY_STATS)
+#include "xua_latency.h"
+#endif
+#if (XUA_PROFILE)
+#include "xua_profile.h"
+#endif
+#if (XUA_VENDOR_REQ_SW_PLL_EN)
+#include "xua_sw_pll_telemetry.h"
+#endif
+#if (MIXER) && (MAX_MIX_COUNT > 0)
+#include "xua_ep0_uacreqs.h"
+#endif
+#if (XUA_VENDOR_REQ_MIDI_TIMING_EN)
+#include "xua_midi_timing.h"
+#endif
+#if (XUA_MIXER_SCENES)
+#include "xua_ep0_scene.h"
+#endif
+#if (MIXER) && (XUA_MIXER_EQ_BIQUADS > 0)
+#include "xua_ep0_uacreqs.h"
+#include "xua_mixer_eq.h"
+#endif
+#if (XUA_STARTUP_STATS)
+#include "xua_startup.h"
+#endif
+#if (XUA_PIPELINE_STATS)
+#include "xua_pipeline_stats.h"
+#endif
+#if (XUA_TEST_SIGNAL)
+#include "xua_test_signal.h"
+#endif
+#if (XUA_GLITCH_DETECT)
+#include "xua_glitch.h"
+#endif
+#if (XUA_EVENT_LOG)
+#include "xua_event_log.h"
+#endif
+
+#if (XUA_VENDOR_REQS_EN)
+
+#if (XUA_BUFFER_PREFILL_CTRL)
+/* Shared with XUA_Buffer_Decouple(), which always runs on the same tile as Endpoint 0 */
+extern unsigned g_aud_from_host_prefill;
+extern unsigned g_aud_to_host_prefill;
+extern unsigned g_aud_from_host_prefill_trim;
+extern unsigned g_aud_to_host_prefill_trim;
+
+static int BufferPrefillRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        unsigned outPrefill = sp->wValue;
+        unsigned inPrefill = sp->wIndex;
+
+        /* Decouple limits these to what the buffers can hold */
+        SET_SHARED_GLOBAL(g_aud_from_host_prefill, outPrefill);
+        SET_SHARED_GLOBAL(g_aud_to_host_prefill, inPrefill);
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        unsigned buffer[4];
+
+        GET_SHARED_GLOBAL(buffer[0], g_aud_from_host_prefill);
+        GET_SHARED_GLOBAL(buffer[1], g_aud_to_host_prefill);
+        GET_SHARED_GLOBAL(buffer[2], g_aud_from_host_prefill_trim);
+        GET_SHARED_GLOBAL(buffer[3], g_aud_to_host_prefill_trim);
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_LATENCY_STATS)
+static int LatencyStatsRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    unsigned stage = sp->wIndex;
+
+    if(stage >= XUA_LATENCY_STAGE_COUNT)
+    {
+        return XUD_RES_ERR;
+    }
+
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        /* Reset is carried out by decouple, which owns the statistics */
+        unsigned reset;
+        GET_SHARED_GLOBAL(reset, g_xua_latency_reset);
+        reset |= (1 << stage);
+        SET_SHARED_GLOBAL(g_xua_latency_reset, reset);
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        /* Note, the statistics may be updated whilst being read. This is acceptable for reporting */
+        xua_latency_stats_t *stats = &g_xua_latency_stats[stage];
+        unsigned buffer[5 + XUA_LATENCY_HIST_BINS];
+        unsigned count = stats->count;
+
+        buffer[0] = count;
+        buffer[1] = count ? stats->min : 0;
+        buffer[2] = stats->max;
+        buffer[3] = count ? (unsigned)(stats->total / count) : 0;
+        buffer[4] = XUA_LATENCY_HIST_BIN_TICKS;
+        for(int i = 0; i < XUA_LATENCY_HIST_BINS; i++)
+        {
+            buffer[5 + i] = stats->hist[i];
+        }
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_PROFILE)
+static int ProfileRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    unsigned id = sp->wIndex;
+
+    if(id >= XUA_PROFILE_COUNT)
+    {
+        return XUD_RES_ERR;
+    }
+
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        /* Reset is carried out by the task itself on its next iteration */
+        g_xua_profile_reset[id] = 1;
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        /* Note, the statistics may be updated whilst being read. This is acceptable for reporting */
+        xua_profile_t *p = &g_xua_profile[id];
+        unsigned buffer[6];
+        unsigned periodCount = p->periodCount;
+        unsigned busyCount = p->busyCount;
+
+        buffer[0] = periodCount;
+        buffer[1] = p->maxPeriod;
+        buffer[2] = periodCount ? (unsigned)(p->totalPeriod / periodCount) : 0;
+        buffer[3] = busyCount;
+        buffer[4] = p->maxBusy;
+        buffer[5] = busyCount ? (unsigned)(p->totalBusy / busyCount) : 0;
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_VENDOR_REQ_SW_PLL_EN)
+static int SwPllRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        return XUD_RES_ERR;
+    }
+
+    /* Note, the telemetry may be updated whilst being read. This is acceptable for reporting */
+    xua_sw_pll_telemetry_t *t = &g_xua_sw_pll_telemetry;
+    unsigned buffer[6];
+
+    buffer[0] = (unsigned) t->error;
+    buffer[1] = (unsigned) t->ctrlVal;
+    buffer[2] = t->locked;
+    buffer[3] = t->lockTime;
+    buffer[4] = t->updates;
+    buffer[5] = t->restarts;
+
+    return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+}
+#endif
+
+#if (MIXER) && (MAX_MIX_COUNT > 0)
+/* Mixer weights held by Endpoint 0, see xua_endpoint0.c */
+extern short mixer1Weights[MIX_INPUTS * MAX_MIX_COUNT];
+
+static int MixMatrixRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp, chanend c_mix_ctl)
+{
+    unsigned first = sp->wValue;
+    unsigned count = sp->wLength / sizeof(short);
+    const unsigned nodes = MIX_INPUTS * MAX_MIX_COUNT;
+
+    if((first >= nodes) || (count > (nodes - first)))
+    {
+        return XUD_RES_ERR;
+    }
+
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        short buffer[MIX_INPUTS * MAX_MIX_COUNT];
+        unsigned datalength;
+        XUD_Result_t result;
+
+        if((result = XUD_GetBuffer(ep0_out, (unsigned char *) buffer, &datalength)) != XUD_RES_OKAY)
+        {
+            return result;
+        }
+
+        count = datalength / sizeof(short);
+        if(count > (nodes - first))
+        {
+            count = nodes - first;
+        }
+
+        for(unsigned i = 0; i < count; i++)
+        {
+            mixer1Weights[first + i] = buffer[i];
+        }
+        XUA_MIXER_CHANGED(XUA_MIXER_CHANGE_WEIGHTS);
+
+        if(c_mix_ctl)
+        {
+            LoadMixerWeights(c_mix_ctl);
+        }
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) &mixer1Weights[first], count * sizeof(short), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_MIXER_SCENES)
+static int MixerSceneRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp, chanend c_mix_ctl, unsigned dfuInterface)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        int error;
+
+        switch(sp->wValue)
+        {
+            case XUA_MIXER_SCENE_RECALL:
+                error = XUA_MixerSceneRecall(dfuInterface, c_mix_ctl, sp->wIndex);
+                break;
+            case XUA_MIXER_SCENE_SAVE:
+                error = XUA_MixerSceneSave(dfuInterface, sp->wIndex);
+                break;
+            case XUA_MIXER_SCENE_ERASE:
+                error = XUA_MixerSceneErase(dfuInterface, sp->wIndex);
+                break;
+            default:
+                error = 1;
+                break;
+        }
+
+        if(error)
+        {
+            return XUD_RES_ERR;
+        }
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        unsigned valid = XUA_MixerSceneValid(dfuInterface);
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) &valid, sizeof(valid), sp->wLength);
+    }
+}
+#endif
+
+#if (MIXER) && (XUA_MIXER_EQ_BIQUADS > 0)
+/* Output EQ coefficients held by Endpoint 0, see xua_endpoint0.c */
+extern int mixerEqCoeffs[XUA_MIXER_EQ_CHANS][XUA_MIXER_EQ_BANK_COEFFS];
+
+static int MixerEqRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp, chanend c_mix_ctl)
+{
+    unsigned chan = sp->wValue;
+
+    if(chan >= NUM_USB_CHAN_OUT)
+    {
+        return XUD_RES_ERR;
+    }
+
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        int buffer[XUA_MIXER_EQ_BANK_COEFFS];
+        unsigned datalength;
+        XUD_Result_t result;
+
+        if((result = XUD_GetBuffer(ep0_out, (unsigned char *) buffer, &datalength)) != XUD_RES_OKAY)
+        {
+            return result;
+        }
+
+        /* Every section is loaded, such that a partial cascade is never applied */
+        if(datalength != sizeof(buffer))
+        {
+            return XUD_RES_ERR;
+        }
+
+        for(unsigned i = 0; i < XUA_MIXER_EQ_BANK_COEFFS; i++)
+        {
+            mixerEqCoeffs[chan][i] = buffer[i];
+        }
+
+        if(c_mix_ctl)
+        {
+            LoadMixerEq(c_mix_ctl, chan);
+        }
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) &mixerEqCoeffs[chan][0], sizeof(mixerEqCoeffs[chan]), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_STARTUP_STATS)
+static int StartupStatsRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        return XUD_RES_ERR;
+    }
+
+    unsigned buffer[XUA_STARTUP_COUNT];
+
+    /* Milestones on another tile were never marked on this one, so read as 0 */
+    for(int i = 0; i < XUA_STARTUP_COUNT; i++)
+    {
+        GET_SHARED_GLOBAL(buffer[i], g_xua_startup[i]);
+    }
+
+    return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+}
+#endif
+
+#if (XUA_PIPELINE_STATS)
+static int PipelineStatsRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        /* Reset is carried out by the owner of each statistic */
+        for(int i = 0; i < XUA_STATS_COUNT; i++)
+        {
+            SET_SHARED_GLOBAL(g_xua_stats_count_reset[i], 1);
+        }
+        for(int i = 0; i < XUA_STATS_FILL_COUNT; i++)
+        {
+            SET_SHARED_GLOBAL(g_xua_stats_fill_reset[i], 1);
+        }
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        /* Statistics awaiting reset by their owner read as reset */
+        unsigned buffer[XUA_STATS_COUNT + (2 * XUA_STATS_FILL_COUNT)];
+        unsigned *fills = &buffer[XUA_STATS_COUNT];
+
+        for(int i = 0; i < XUA_STATS_COUNT; i++)
+        {
+            buffer[i] = g_xua_stats_count_reset[i] ? 0 : g_xua_stats_count[i];
+        }
+
+        for(int i = 0; i < XUA_STATS_FILL_COUNT; i++)
+        {
+            xua_stats_fill_t *f = &g_xua_stats_fill[i];
+            unsigned valid = f->valid && !g_xua_stats_fill_reset[i];
+
+            fills[2 * i] = valid ? f->min : 0;
+            fills[(2 * i) + 1] = valid ? f->max : 0;
+        }
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_TEST_SIGNAL)
+static int TestSignalRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        unsigned buffer[XUA_TEST_SIGNAL_CONFIG_WORDS];
+        unsigned datalength;
+        XUD_Result_t result;
+
+        /* No data stage stops the test signal */
+        if(sp->wLength == 0)
+        {
+            if(XUA_TestSignal_Configure(0, 0))
+            {
+                return XUD_RES_ERR;
+            }
+            return XUD_DoSetRequestStatus(ep0_in);
+        }
+
+        if(sp->wLength != sizeof(buffer))
+        {
+            return XUD_RES_ERR;
+        }
+
+        if((result = XUD_GetBuffer(ep0_out, (unsigned char *) buffer, &datalength)) != XUD_RES_OKAY)
+        {
+            return result;
+        }
+
+        /* Refused whilst the audiohub has yet to apply the previous configuration */
+        if((datalength != sizeof(buffer)) || XUA_TestSignal_Configure(buffer, XUA_TEST_SIGNAL_CONFIG_WORDS))
+        {
+            return XUD_RES_ERR;
+        }
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        unsigned buffer[XUA_TEST_SIGNAL_RESULT_WORDS];
+
+        XUA_TestSignal_Results(buffer);
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_GLITCH_DETECT)
+static int GlitchLogRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        /* Cleared by the Decoupler on its next event */
+        SET_SHARED_GLOBAL(g_xua_glitch_reset, 1);
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        unsigned buffer[1 + (XUA_GLITCH_LOG_LEN * XUA_GLITCH_ENTRY_WORDS)];
+        unsigned reset;
+
+        /* A log awaiting reset reads as cleared */
+        GET_SHARED_GLOBAL(reset, g_xua_glitch_reset);
+        buffer[0] = reset ? 0 : g_xua_glitch_count;
+        for(int i = 0; i < XUA_GLITCH_LOG_LEN; i++)
+        {
+            for(int j = 0; j < XUA_GLITCH_ENTRY_WORDS; j++)
+            {
+                buffer[1 + (i * XUA_GLITCH_ENTRY_WORDS) + j] = reset ? 0 : g_xua_glitch_log[i][j];
+            }
+        }
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_EVENT_LOG)
+static int EventLogRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        XUA_EventLog_Reset();
+
+        return XUD_DoSetRequestStatus(ep0_in);
+    }
+    else
+    {
+        unsigned buffer[1 + (XUA_EVENT_LOG_LEN * XUA_EVENT_ENTRY_WORDS)];
+
+        buffer[0] = g_xua_event_count;
+        for(int i = 0; i < XUA_EVENT_LOG_LEN; i++)
+        {
+            /* Time in the low word, see XUA_EVENT() */
+            buffer[1 + (i * XUA_EVENT_ENTRY_WORDS)] = (unsigned) g_xua_event_log[i];
+            buffer[2 + (i * XUA_EVENT_ENTRY_WORDS)] = (unsigned) (g_xua_event_log[i] >> 32);
+        }
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, (unsigned char *) buffer, sizeof(buffer), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_CHAN_PROFILE_EN)
+static int ChanProfileRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        int result;
+
+        if(sp->wValue >= XUA_CHAN_PROFILE_COUNT)
+        {
+            return XUD_RES_ERR;
+        }
+
+        /* Complete the request before any reboot */
+        result = XUD_DoSetRequestStatus(ep0_in);
+        if(result == XUD_RES_OKAY)
+        {
+            XUA_Endpoint0_setChanProfile(sp->wValue);
+        }
+        return result;
+    }
+    else
+    {
+        unsigned char profile = XUA_Endpoint0_getChanProfile();
+
+        return XUD_DoGetRequest(ep0_out, ep0_in, &profile, sizeof(profile), sp->wLength);
+    }
+}
+#endif
+
+#if (XUA_STRINGS_REQ)
+static int StringsRequest(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp)
+{
+    static unsigned char buffer[XUA_STRINGS_REQ_LEN];
+    unsigned maxLen = (sp->wLength < sizeof(buffer)) ? sp->wLength : sizeof(buffer);
+    unsigned len = 0;
+
+    if(sp->bmRequestType.Direction == USB_BM_REQTYPE_DIRECTION_H2D)
+    {
+        return XUD_RES_ERR;
+    }
+
+    for(unsigned i = 0; i < sp->wIndex; i++)
+    {
+        char str[64];
+        int strLen = XUA_Endpoint0_GetString(sp->wValue + i, str, sizeof(str));
+
+        /* Only whole strings, so that the host can ask for the rest from the next index */
+        if((strLen < 0) || ((len + strLen + 1) > maxLen))
+        {
+            break;
+        }
+
+        memcpy(&buffer[len], str, strLen);
+        len += strLen;
+        buffer[len++] = '\0';
+    }
+
+    return XUD_DoGetRequest(ep0_out, ep0_in, buffer, len, sp->wLength);
+}
+#endif
+
+int XUA_VendorRequests(XUD_ep ep0_out, XUD_ep ep0_in, USB_SetupPacket_t *sp, chanend c_mix_ctl, unsigned dfuInterface)
+{
+    if((sp->bmRequestType.Type != USB_BM_REQTYPE_TYPE_VENDOR) || (sp->bmRequestType.Recipient != USB_BM_REQTYPE_RECIP_DEV))
+    {
+        return XUD_RES_ERR;
+    }
+
+    switch(sp->bRequest)
+    {
+#if (XUA_BUFFER_PREFILL_CTRL)
+        case XUA_VENDOR_REQ_BUFFER_PREFILL:
+            return BufferPrefillRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_LATENCY_STATS)
+        case XUA_VENDOR_REQ_LATENCY_STATS:
+            return LatencyStatsRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_PROFILE)
+        case XUA_VENDOR_REQ_PROFILE:
+            return ProfileRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_VENDOR_REQ_SW_PLL_EN)
+        case XUA_VENDOR_REQ_SW_PLL:
+            return SwPllRequest(ep0_out, ep0_in, sp);
+#endif
+#if (MIXER) && (MAX_MIX_COUNT > 0)
+        case XUA_VENDOR_REQ_MIX_MATRIX:
+            return MixMatrixRequest(ep0_out, ep0_in, sp, c_mix_ctl);
+#endif
+#if (XUA_VENDOR_REQ_MIDI_TIMING_EN)
+        case XUA_VENDOR_REQ_MIDI_TIMING:
+            return MidiTimingRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_MIXER_SCENES)
+        case XUA_VENDOR_REQ_MIXER_SCENE:
+            return MixerSceneRequest(ep0_out, ep0_in, sp, c_mix_ctl, dfuInterface);
+#endif
+#if (MIXER) && (XUA_MIXER_EQ_BIQUADS > 0)
+        case XUA_VENDOR_REQ_MIXER_EQ:
+            return MixerEqRequest(ep0_out, ep0_in, sp, c_mix_ctl);
+#endif
+#if (XUA_STARTUP_STATS)
+        case XUA_VENDOR_REQ_STARTUP_STATS:
+            return StartupStatsRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_PIPELINE_STATS)
+        case XUA_VENDOR_REQ_PIPELINE_STATS:
+            return PipelineStatsRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_TEST_SIGNAL)
+        case XUA_VENDOR_REQ_TEST_SIGNAL:
+            return TestSignalRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_GLITCH_DETECT)
+        case XUA_VENDOR_REQ_GLITCH_LOG:
+            return GlitchLogRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_STRINGS_REQ)
+        case XUA_VENDOR_REQ_STRINGS:
+            return StringsRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_EVENT_LOG)
+        case XUA_VENDOR_REQ_EVENT_LOG:
+            return EventLogRequest(ep0_out, ep0_in, sp);
+#endif
+#if (XUA_CHAN_PROFILE_EN)
+        case XUA_VENDOR_REQ_CHAN_PROFILE:
+            return ChanProfileRequest(ep0_out, ep0_in, sp);
+#endif
+        default:
+            break;
+    }
+
+    return XUD_RES_ERR;
+}
+#endif /* XUA_VENDOR_REQS_EN */
+
+#endif /* XUA_USB_EN */
@@ -0,0 +1,144 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_EP0_VENDORREQS_H_
+#define _XUA_EP0_VENDORREQS_H_
+
+#include <xccompat.h>
+#include "xua.h"
+#include "xud_device.h"
+
+/* Vendor requests handled by lib_xua itself. These are device recipient vendor requests.
+ * Any vendor request not handled here is passed on to VendorRequests() */
+
+/* First bRequest value used by lib_xua. Override if this clashes with application vendor requests */
+#ifndef XUA_VENDOR_REQ_BASE
+#define XUA_VENDOR_REQ_BASE                 (0xF0)
+#endif
+
+/* Get/set USB buffer prefill levels (in frames). Requires XUA_BUFFER_PREFILL_CTRL
+ *   Set (H2D): wValue = OUT prefill, wIndex = IN prefill, no data stage. 0 selects the default level.
+ *   Get (D2H): 16 bytes, OUT prefill, IN prefill, OUT adaptive trim, IN adaptive trim (32-bit LE words) */
+#define XUA_VENDOR_REQ_BUFFER_PREFILL       (XUA_VENDOR_REQ_BASE + 0)
+
+/* Get/reset latency statistics. Requires XUA_LATENCY_STATS
+ *   Set (H2D): wIndex = stage, no data stage. Resets the statistics for the stage
+ *   Get (D2H): wIndex = stage. 32-bit LE words: count, min, max, mean, histogram bin width, followed by
+ *              XUA_LATENCY_HIST_BINS histogram counts. Times are in reference timer ticks */
+#define XUA_VENDOR_REQ_LATENCY_STATS        (XUA_VENDOR_REQ_BASE + 1)
+
+/* Get/reset thread load statistics. Requires XUA_PROFILE
+ *   Set (H2D): wIndex = task (XUA_PROFILE_xxx), no data stage. Resets the statistics for the task
+ *   Get (D2H): wIndex = task. 32-bit LE words: period count, max period, mean period, busy count, max busy,
+ *              mean busy. Times are in reference timer ticks. Only tasks running on XUD_TILE report statistics */
+#define XUA_VENDOR_REQ_PROFILE              (XUA_VENDOR_REQ_BASE + 2)
+
+/* Get software PLL telemetry. Requires XUA_USE_SW_PLL, XUA_SW_PLL_TELEMETRY and AUDIO_IO_TILE == XUD_TILE
+ *   Get (D2H): 32-bit LE words: last error (signed, mclk counts), last control value, locked flag, time to lock
+ *              (reference timer ticks, 0 until locked), control loop updates and restarts since boot */
+#define XUA_VENDOR_REQ_SW_PLL               (XUA_VENDOR_REQ_BASE + 3)
+
+/* Load mixer weights. Requires MIXER
+ *   Set (H2D): wValue = first mixer node (as the UAC mixer control channel number i.e. input * MAX_MIX_COUNT + mix),
+ *              data = wLength / 2 weights (16-bit LE, dB in 8.8 format, 0x8000 for -inf). All of the weights are
+ *              applied by the mixer on the same frame
+ *   Get (D2H): wValue = first mixer node. wLength / 2 weights in the same format */
+#define XUA_VENDOR_REQ_MIX_MATRIX           (XUA_VENDOR_REQ_BASE + 4)
+
+/* Get/reset MIDI timing clock jitter. Requires MIDI, XUA_MIDI_TIMING and MIDI_TILE == XUD_TILE
+ *   Set (H2D): wIndex = direction (XUA_MIDI_TIMING_RX or XUA_MIDI_TIMING_TX), no data stage. Resets the statistics
+ *   Get (D2H): wIndex = direction. 32-bit LE words: count, mean clock interval, max jitter, histogram bin width,
+ *              followed by XUA_MIDI_JITTER_HIST_BINS histogram counts. Times are in reference timer ticks */
+#define XUA_VENDOR_REQ_MIDI_TIMING          (XUA_VENDOR_REQ_BASE + 5)
+
+/* Save/recall mixer scenes in flash. Requires XUA_MIXER_SCENES
+ *   Set (H2D): wValue = operation (XUA_MIXER_SCENE_xxx), wIndex = scene slot, no data stage
+ *   Get (D2H): 32-bit LE mask of the slots holding a saved scene */
+#define XUA_VENDOR_REQ_MIXER_SCENE          (XUA_VENDOR_REQ_BASE + 6)
+
+#define XUA_MIXER_SCENE_RECALL              (0)
+#define XUA_MIXER_SCENE_SAVE                (1)
+#define XUA_MIXER_SCENE_ERASE               (2)
+
+/* Get/set the output EQ of an output channel. Requires MIXER and XUA_MIXER_EQ_BIQUADS
+ *   Set (H2D): wValue = output channel, data = XUA_MIXER_EQ_BIQUADS sections of b0, b1, b2, -a1, -a2 (32-bit LE,
+ *              30 fractional bits). All of the sections are applied by the mixer on the same sample
+ *   Get (D2H): wValue = output channel. The coefficients in the same format */
+#define XUA_VENDOR_REQ_MIXER_EQ             (XUA_VENDOR_REQ_BASE + 7)
+
+/* Get startup timing. Requires XUA_STARTUP_STATS
+ *   Get (D2H): XUA_STARTUP_COUNT 32-bit LE words, the reference timer value at which each milestone (XUA_STARTUP_xxx)
+ *              was reached, 0 if not (yet) reached. Milestones on AUDIO_IO_TILE read as 0 unless it is XUD_TILE */
+#define XUA_VENDOR_REQ_STARTUP_STATS        (XUA_VENDOR_REQ_BASE + 8)
+
+/* Get/reset pipeline statistics. Requires XUA_PIPELINE_STATS
+ *   Set (H2D): no data stage. Resets all of the statistics
+ *   Get (D2H): XUA_STATS_COUNT event counts (XUA_STATS_xxx), then the minimum and maximum of each of the
+ *              XUA_STATS_FILL_COUNT fill ranges in bytes (0 if none recorded), as 32-bit LE words. Only statistics of
+ *              tasks on XUD_TILE are updated */
+#define XUA_VENDOR_REQ_PIPELINE_STATS       (XUA_VENDOR_REQ_BASE + 9)
+
+/* Start/stop the production test signal and read its analysis. Requires XUA_TEST_SIGNAL
+ *   Set (H2D): no data stage stops the test signal. Otherwise XUA_TEST_SIGNAL_CONFIG_WORDS 32-bit LE words: output
+ *              channel mask, settle frames, tone amplitude (Q31 peak), XUA_TEST_SIGNAL_TONES tone bins (0 unused, less
+ *              than half of XUA_TEST_SIGNAL_BLOCK) and XUA_TEST_SIGNAL_CAPTURE_CHANS input channels to capture
+ *   Get (D2H): XUA_TEST_SIGNAL_RESULT_WORDS 32-bit LE words: state (XUA_TEST_SIGNAL_OFF/RUNNING/DONE) and block
+ *              length, then for each captured channel the sum and sum of squares of the 24-bit samples and the
+ *              real, imaginary DFT terms at each tone as 64-bit LE values, all zero until the state is DONE */
+#define XUA_VENDOR_REQ_TEST_SIGNAL          (XUA_VENDOR_REQ_BASE + 10)
+
+/* Get/reset the stream glitch log. Requires XUA_GLITCH_DETECT
+ *   Set (H2D): no data stage. Clears the log
+ *   Get (D2H): 32-bit LE words: events recorded since reset, then XUA_GLITCH_LOG_LEN entries in ring order of
+ *              sequence number (1 for the first event since reset, 0 for an unused entry), reference timer value and
+ *              event (XUA_GLITCH_xxx) in the top 8 bits with its argument in the lower 24 */
+#define XUA_VENDOR_REQ_GLITCH_LOG           (XUA_VENDOR_REQ_BASE + 11)
+
+/* Get string descriptors as ASCII. Requires XUA_STRINGS_REQ
+ *   Get (D2H): wValue = first string index, wIndex = string count. The strings that fit whole in wLength (and in
+ *              XUA_STRINGS_REQ_LEN bytes) in string index order, each NUL terminated. Fewer strings are returned past
+ *              the end of the string table. Saves a GET_DESCRIPTOR request per string, e.g. for channel names */
+#define XUA_VENDOR_REQ_STRINGS              (XUA_VENDOR_REQ_BASE + 12)
+
+#define XUA_STRINGS_REQ_LEN                 (512)
+
+/* Get/reset the diagnostic event log. Requires XUA_EVENT_LOG
+ *   Set (H2D): no data stage. Clears the log
+ *   Get (D2H): 32-bit LE words: events logged since reset, then XUA_EVENT_LOG_LEN entries in ring order of reference
+ *              timer value and event (XUA_EVENT_xxx) in the top 8 bits with its argument in the lower 24. The oldest
+ *              entry is at the event count modulo XUA_EVENT_LOG_LEN once the ring has wrapped */
+#define XUA_VENDOR_REQ_EVENT_LOG            (XUA_VENDOR_REQ_BASE + 13)
+
+/* Get/set the channel profile. Requires XUA_CHAN_PROFILE_EN
+ *   Set (H2D): wValue = profile (XUA_CHAN_PROFILE_FULL or XUA_CHAN_PROFILE_REDUCED), no data stage. The device
+ *              reboots and re-enumerates with the profile after the status stage, unless it is already in use
+ *   Get (D2H): 1 byte, the profile the device enumerated with */
+#define XUA_VENDOR_REQ_CHAN_PROFILE         (XUA_VENDOR_REQ_BASE + 14)
+
+/* The PLL task runs on AUDIO_IO_TILE, its telemetry is only visible to Endpoint 0 on the same tile */
+#define XUA_VENDOR_REQ_SW_PLL_EN            ((XUA_USE_SW_PLL) && (XUA_SW_PLL_TELEMETRY) && (AUDIO_IO_TILE == XUD_TILE))
+
+/* Likewise the MIDI timing statistics are kept on MIDI_TILE */
+#if defined(MIDI) && (XUA_MIDI_TIMING) && (MIDI_TILE == XUD_TILE)
+#define XUA_VENDOR_REQ_MIDI_TIMING_EN       (1)
+#else
+#define XUA_VENDOR_REQ_MIDI_TIMING_EN       (0)
+#endif
+
+/* Only build in the handler when at least one lib_xua vendor request is enabled */
+#define XUA_VENDOR_REQS_EN                  ((XUA_BUFFER_PREFILL_CTRL) || (XUA_LATENCY_STATS) || (XUA_PROFILE) \
+                                             || (XUA_VENDOR_REQ_SW_PLL_EN) || ((MIXER) && (MAX_MIX_COUNT > 0)) \
+                                             || (XUA_VENDOR_REQ_MIDI_TIMING_EN) || ((MIXER) && (XUA_MIXER_EQ_BIQUADS > 0)) \
+                                             || (XUA_STARTUP_STATS) || (XUA_PIPELINE_STATS) || (XUA_TEST_SIGNAL) \
+                                             || (XUA_GLITCH_DETECT) || (XUA_STRINGS_REQ) || (XUA_EVENT_LOG) \
+                                             || (XUA_CHAN_PROFILE_EN))
+
+#if (XUA_STRINGS_REQ)
+/** Copies string table entry index as ASCII, building channel names as GET_DESCRIPTOR does, into str of
+ *  maxLen bytes (not NUL terminated). Returns its length, or -1 past the end of the table. In xua_endpoint0.c */
+int XUA_Endpoint0_GetString(unsigned index, char *str, unsigned maxLen);
+#endif
+
+int XUA_VendorRequests(XUD_ep ep0_out, XUD_ep ep0_in, REFERENCE_PARAM(USB_SetupPacket_t, sp),
+    NULLABLE_RESOURCE(chanend, c_mix_ctl), CLIENT_INTERFACE(i_dfu, dfuInterface));
+
+#endif
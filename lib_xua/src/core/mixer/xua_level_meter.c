@@ -0,0 +1,64 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_level_meter.h"
+
+#if (MIXER) && defined(LEVEL_METER_HOST)
+
+/* Levels metered in mixer1() */
+extern int g_xua_level_peak[XUA_LEVEL_METER_CHANS];
+extern unsigned g_xua_level_ms[XUA_LEVEL_METER_CHANS];
+
+unsigned XUA_LevelMeterRms(unsigned ms)
+{
+    unsigned root = 0;
+    unsigned bit = 1 << 30;
+
+    /* Integer square root */
+    while(bit > ms)
+        bit >>= 2;
+
+    while(bit)
+    {
+        if(ms >= root + bit)
+        {
+            ms -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    /* The mean square is of the 16 MSBs of the samples, the peak levels are reported as the 32-bit peak >> 15 */
+    root <<= 1;
+    if(root > 0xffff)
+        root = 0xffff;
+
+    return root;
+}
+
+static inline void storeShort(unsigned char buffer[], unsigned index, unsigned val)
+{
+    buffer[index] = val;
+    buffer[index + 1] = val >> 8;
+}
+
+unsigned XUA_LevelMeterFrame(unsigned char buffer[], unsigned frameCount)
+{
+    storeShort(buffer, 0, frameCount);
+    storeShort(buffer, 2, XUA_LEVEL_METER_CHANS);
+
+    /* Note, the levels may be updated whilst being read. This is acceptable for metering */
+    for(int i = 0; i < XUA_LEVEL_METER_CHANS; i++)
+    {
+        storeShort(buffer, 4 + (i * 4), ((unsigned) g_xua_level_peak[i]) >> 15);
+        storeShort(buffer, 6 + (i * 4), XUA_LevelMeterRms(g_xua_level_ms[i]));
+    }
+
+    return XUA_LEVEL_METER_EP_BYTES;
+}
+
+#endif
@@ -0,0 +1,18 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_LEVEL_METER_H_
+#define _XUA_LEVEL_METER_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Level meter helpers (LEVEL_METER_HOST). The levels themselves are metered by the mixer */
+
+/* Returns the 16-bit RMS level for a metered mean square, on the same scale as the 16-bit peak level */
+unsigned XUA_LevelMeterRms(unsigned ms);
+
+/* Writes a level meter endpoint frame (see XUA_LEVEL_METER_EP_BYTES) to buffer and returns its length in
+ * bytes. Reads the mixer's levels directly, so must be called on the tile the mixer runs on */
+unsigned XUA_LevelMeterFrame(unsigned char buffer[], unsigned frameCount);
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_mixer_eq.h"
+
+#if (XUA_MIXER_EQ_BIQUADS > 0)
+
+typedef struct
+{
+    int coeffs[2][XUA_MIXER_EQ_BANK_COEFFS];        /* Live and shadow banks */
+    unsigned sel;                                   /* Live bank */
+    volatile unsigned pending;                      /* Swap requested by XUA_MixerEqApply(), not yet taken */
+    int state[(XUA_MIXER_EQ_BIQUADS + 1) * 2];      /* Last two inputs of each section, then of the output. The
+                                                     * outputs of a section are the inputs of the next */
+} xua_mixer_eq_t;
+
+static xua_mixer_eq_t eq[XUA_MIXER_EQ_CHANS];
+
+void XUA_MixerEqInit(void)
+{
+    for(unsigned chan = 0; chan < XUA_MIXER_EQ_CHANS; chan++)
+    {
+        for(unsigned i = 0; i < XUA_MIXER_EQ_BANK_COEFFS; i++)
+        {
+            int coeff = ((i % XUA_MIXER_EQ_COEFFS) == 0) ? (1 << XUA_MIXER_EQ_FRAC_BITS) : 0;
+
+            eq[chan].coeffs[0][i] = coeff;
+            eq[chan].coeffs[1][i] = coeff;
+        }
+        eq[chan].sel = 0;
+        eq[chan].pending = 0;
+    }
+    XUA_MixerEqReset();
+}
+
+void XUA_MixerEqReset(void)
+{
+    for(unsigned chan = 0; chan < XUA_MIXER_EQ_CHANS; chan++)
+    {
+        for(unsigned i = 0; i < (XUA_MIXER_EQ_BIQUADS + 1) * 2; i++)
+        {
+            eq[chan].state[i] = 0;
+        }
+    }
+}
+
+void XUA_MixerEqSetCoeff(unsigned chan, unsigned index, int coeff)
+{
+    if((chan < XUA_MIXER_EQ_CHANS) && (index < XUA_MIXER_EQ_BANK_COEFFS))
+    {
+        /* The shadow bank is still about to go live */
+        while(eq[chan].pending);
+
+        eq[chan].coeffs[!eq[chan].sel][index] = coeff;
+    }
+}
+
+void XUA_MixerEqApply(unsigned chan)
+{
+    if(chan < XUA_MIXER_EQ_CHANS)
+    {
+        /* Every request is a swap, so not merged with one still pending */
+        while(eq[chan].pending);
+
+        eq[chan].pending = 1;
+    }
+}
+
+void XUA_MixerEqUpdate(void)
+{
+    for(unsigned chan = 0; chan < XUA_MIXER_EQ_CHANS; chan++)
+    {
+        if(eq[chan].pending)
+        {
+            eq[chan].sel = !eq[chan].sel;
+            eq[chan].pending = 0;
+        }
+    }
+}
+
+int XUA_MixerEq(unsigned chan, int sample)
+{
+    const int *c = eq[chan].coeffs[eq[chan].sel];
+    int *s = eq[chan].state;
+
+    for(unsigned k = 0; k < XUA_MIXER_EQ_BIQUADS; k++)
+    {
+        /* Rounded, the products accumulate as a single maccs chain */
+        long long acc = 1 << (XUA_MIXER_EQ_FRAC_BITS - 1);
+
+        acc += (long long) c[0] * sample;
+        acc += (long long) c[1] * s[0];
+        acc += (long long) c[2] * s[1];
+        acc += (long long) c[3] * s[2];
+        acc += (long long) c[4] * s[3];
+
+        s[1] = s[0];
+        s[0] = sample;
+
+        acc >>= XUA_MIXER_EQ_FRAC_BITS;
+        if(acc > 0x7fffffff)
+            acc = 0x7fffffff;
+        else if(acc < -0x7fffffff - 1)
+            acc = -0x7fffffff - 1;
+        sample = (int) acc;
+
+        c += XUA_MIXER_EQ_COEFFS;
+        s += 2;
+    }
+
+    s[1] = s[0];
+    s[0] = sample;
+
+    return sample;
+}
+#endif
@@ -0,0 +1,51 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_MIXER_EQ_H_
+#define _XUA_MIXER_EQ_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+#if (XUA_MIXER_EQ_BIQUADS > 0)
+/* Output EQ (XUA_MIXER_EQ_BIQUADS). Each output channel is filtered by a cascade of XUA_MIXER_EQ_BIQUADS direct
+ * form I biquads, each section having the coefficients b0, b1, b2, -a1, -a2 (XUA_MIXER_EQ_FRAC_BITS fractional
+ * bits, i.e. a gain of 1.0 is 1 << 30).
+ *
+ * Every channel holds a live and a shadow coefficient bank. Coefficients are written to the shadow bank, then
+ * XUA_MixerEqApply() requests a swap of the banks. The thread running the cascades, which with two mixer threads
+ * is not the thread receiving the control commands, takes the swap between two samples in XUA_MixerEqUpdate() such
+ * that a whole cascade changes at once. Until the swap is taken the shadow bank is the one about to go live, so
+ * XUA_MixerEqSetCoeff() and XUA_MixerEqApply() wait for it */
+
+#define XUA_MIXER_EQ_COEFFS         (5)     /* Coefficients per section */
+#define XUA_MIXER_EQ_FRAC_BITS      (30)
+#define XUA_MIXER_EQ_BANK_COEFFS    (XUA_MIXER_EQ_BIQUADS * XUA_MIXER_EQ_COEFFS)
+
+#if (NUM_USB_CHAN_OUT > 0)
+#define XUA_MIXER_EQ_CHANS          (NUM_USB_CHAN_OUT)
+#else
+#define XUA_MIXER_EQ_CHANS          (1)
+#endif
+
+/* Sets every section of both banks of every channel to pass through and clears the filter state */
+void XUA_MixerEqInit(void);
+
+/* Clears the filter state of every channel, for example on a sample rate change */
+void XUA_MixerEqReset(void);
+
+/* Writes coefficient index (section * XUA_MIXER_EQ_COEFFS + coefficient) of the shadow bank of an output. Waits
+ * for any swap of the output still pending */
+void XUA_MixerEqSetCoeff(unsigned chan, unsigned index, int coeff);
+
+/* Requests a swap of the shadow and live banks of an output, taken by the next XUA_MixerEqUpdate(). The shadow bank
+ * then holds the previous coefficients */
+void XUA_MixerEqApply(unsigned chan);
+
+/* Takes the pending swaps of every output. Called by the thread running the cascades between two samples */
+void XUA_MixerEqUpdate(void);
+
+/* Filters the next sample of an output */
+int XUA_MixerEq(unsigned chan, int sample);
+#endif
+
+#endif
@@ -0,0 +1,49 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+
+#if (MIXER) && (MAX_MIX_COUNT > 0) && (XUA_MIXER_FLOAT)
+/* Floating point mix kernel (XUA_MIXER_FLOAT) for the scalar FPU of xcore.ai. Weights are single precision and
+ * the mix is accumulated as a float, so intermediate sums have no fixed point headroom limit. Only the mix output
+ * is saturated, to 32 bits */
+
+typedef union
+{
+    float f;
+    int i;
+} float_bits_t;
+
+/* Converts a weight, with XUA_MIXER_MULT_FRAC_BITS fractional bits, to the bits of the equivalent float. The list
+ * holds the weights as ints such that it is shared with the sparse mixer */
+int XUA_MixerFloatWeight(int mult)
+{
+    float_bits_t w;
+
+    w.f = (float) mult * (1.0f / (float)(1 << XUA_MIXER_MULT_FRAC_BITS));
+    return w.i;
+}
+
+/* int doMixFloat(volatile int * samples, volatile int * list, unsigned count)
+ *
+ * Mixes count (source, weight) pairs from list, as doMixSparse() but with float weights. Each pair is a single
+ * multiply-accumulate (fmacc) into the float sum */
+int doMixFloat(volatile int * samples, volatile int * list, unsigned count)
+{
+    float acc = 0.0f;
+
+    for(unsigned i = 0; i < count; i++)
+    {
+        float_bits_t w;
+
+        w.i = list[(2 * i) + 1];
+        acc += (float) samples[list[2 * i]] * w.f;
+    }
+
+    if(acc >= 2147483648.0f)
+        return 0x7fffffff;
+    if(acc <= -2147483648.0f)
+        return (int) 0x80000000;
+
+    return (int) acc;
+}
+#endif
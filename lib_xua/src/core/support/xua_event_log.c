@@ -0,0 +1,19 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_event_log.h"
+
+#if (XUA_EVENT_LOG)
+
+unsigned long long g_xua_event_log[XUA_EVENT_LOG_LEN];
+unsigned g_xua_event_count;
+
+void XUA_EventLog_Reset(void)
+{
+    for(int i = 0; i < XUA_EVENT_LOG_LEN; i++)
+    {
+        g_xua_event_log[i] = 0;
+    }
+    g_xua_event_count = 0;
+}
+#endif
@@ -0,0 +1,56 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_EVENT_LOG_H_
+#define _XUA_EVENT_LOG_H_
+
+#include "xua.h"
+
+/* Diagnostic event log (XUA_EVENT_LOG). A ring of the last XUA_EVENT_LOG_LEN events, each the reference timer value
+ * at which it was logged and the event in the top 8 bits of a word with its argument in the lower 24. The entry is
+ * written with a single double word store then the event count bumped, cheap enough to be left enabled in the
+ * streaming paths. The count is not locked: two threads logging at the same instant may write the same entry, one
+ * event then being lost, which is tolerable for a diagnostic.
+ *
+ * The ring is held per tile, only events logged on XUD_TILE are visible to Endpoint 0 */
+
+/* Events, the argument logged with each in brackets */
+#define XUA_EVENT_USB_RESET             (0)     /* USB bus reset (speed, XUD_SPEED_xx) */
+#define XUA_EVENT_SET_INTERFACE         (1)     /* Alternate setting selected by the host (interface << 8 | alt) */
+#define XUA_EVENT_SAMPLE_FREQ           (2)     /* Sample rate change received by the endpoint buffer (rate in Hz) */
+#define XUA_EVENT_FORMAT_OUT            (3)     /* OUT stream format applied by the Decoupler (chans << 8 | subslot) */
+#define XUA_EVENT_FORMAT_IN             (4)     /* IN stream format applied by the Decoupler (chans << 8 | subslot) */
+#define XUA_EVENT_OUT_UNDERFLOW         (5)     /* Decouple OUT FIFO emptied (0) */
+#define XUA_EVENT_IN_OVERFLOW           (6)     /* Decouple IN FIFO full (fill in bytes) */
+#define XUA_EVENT_CLOCK_VALID           (7)     /* Digital clock source validity change (clock index << 8 | valid) */
+#define XUA_EVENT_CLOCK_SELECT          (8)     /* Clock source selected by the host (clock mode) */
+#define XUA_EVENT_COUNT                 (9)
+
+/* Words in each log entry: reference timer value, event << 24 | argument */
+#define XUA_EVENT_ENTRY_WORDS           (2)
+
+/* Log of the last XUA_EVENT_LOG_LEN events and the number logged since reset, shared with Endpoint 0. Entries are
+ * double word aligned for the store made by XUA_EVENT() */
+extern unsigned long long g_xua_event_log[XUA_EVENT_LOG_LEN];
+extern unsigned g_xua_event_count;
+
+#if (XUA_EVENT_LOG)
+/* std stores its first operand at the higher address, so the time is the first word of the entry */
+#define XUA_EVENT(id, arg) \
+    do \
+    { \
+        unsigned _evTime, _evCount, _evLog; \
+        asm volatile("gettime %0" : "=r"(_evTime)); \
+        asm volatile("ldw %0, dp[g_xua_event_count]" : "=r"(_evCount)); \
+        asm volatile("ldaw %0, dp[g_xua_event_log]" : "=r"(_evLog)); \
+        asm volatile("std %0, %1, %2[%3]" :: "r"(((id) << 24) | ((arg) & 0xffffff)), "r"(_evTime), "r"(_evLog), \
+                     "r"(_evCount & (XUA_EVENT_LOG_LEN - 1)) : "memory"); \
+        asm volatile("stw %0, dp[g_xua_event_count]" :: "r"(_evCount + 1) : "memory"); \
+    } while(0)
+#else
+#define XUA_EVENT(id, arg)
+#endif
+
+/** Clears the log. Called by Endpoint 0, an event logged meanwhile may survive the clear */
+void XUA_EventLog_Reset(void);
+
+#endif
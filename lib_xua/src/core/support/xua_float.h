@@ -0,0 +1,59 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_FLOAT_H_
+#define _XUA_FLOAT_H_
+
+#include <xclib.h>
+
+/* Conversion between IEEE-754 single precision stream samples (XUA_FLOAT_OUT_FORMAT_NUM, XUA_FLOAT_IN_FORMAT_NUM) and
+ * the left justified 32 bit fixed point samples of the pipeline, full scale being +/-1.0. Both work on the bit
+ * pattern of the float with integer instructions only, a handful per sample, such that they can be used within the
+ * Decoupler sample loops on any xcore. Magnitudes of 1.0 and above (including infinities and NaNs) saturate */
+
+/* Returns the fixed point sample of the float with bit pattern f, rounding towards zero */
+static inline int XUA_FloatToFixed(unsigned f)
+{
+    /* Left shift of the 24 bit mantissa (with its hidden bit) that gives the Q31 value */
+    int shift = (int) ((f >> 23) & 0xff) - 119;
+    unsigned mant = (f & 0x7fffff) | 0x800000;
+    int sample;
+
+    if(shift >= 8)
+    {
+        sample = 0x7fffffff;
+    }
+    else if(shift >= 0)
+    {
+        sample = mant << shift;
+    }
+    else if(shift > -24)
+    {
+        sample = mant >> -shift;
+    }
+    else
+    {
+        sample = 0;
+    }
+
+    return (f & 0x80000000) ? -sample : sample;
+}
+
+/* Returns the bit pattern of the float of the fixed point sample, truncating to the 24 bit mantissa */
+static inline unsigned XUA_FixedToFloat(int sample)
+{
+    unsigned mag = (sample < 0) ? -sample : sample;
+    unsigned n;
+
+    if(mag == 0)
+    {
+        return 0;
+    }
+
+    /* Normalise such that the leading one is the hidden bit, the value being 2^-n times the mantissa */
+    n = clz(mag);
+    mag <<= n;
+
+    return (sample & 0x80000000) | ((127 - n) << 23) | ((mag >> 8) & 0x7fffff);
+}
+
+#endif
@@ -0,0 +1,42 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_glitch.h"
+
+#if (XUA_GLITCH_DETECT)
+
+unsigned g_xua_glitch_log[XUA_GLITCH_LOG_LEN][XUA_GLITCH_ENTRY_WORDS];
+unsigned g_xua_glitch_count;
+unsigned g_xua_glitch_reset;
+
+int g_xua_glitch_dc[XUA_GLITCH_CHANS];
+unsigned g_xua_glitch_clip[XUA_GLITCH_CHANS];
+unsigned g_xua_glitch_dc_flagged;
+
+void XUA_Glitch_Event(unsigned id, unsigned arg)
+{
+    unsigned time;
+    unsigned *entry;
+
+    asm volatile("gettime %0" : "=r"(time));
+
+    if(g_xua_glitch_reset)
+    {
+        for(int i = 0; i < XUA_GLITCH_LOG_LEN; i++)
+        {
+            g_xua_glitch_log[i][0] = 0;
+        }
+        g_xua_glitch_count = 0;
+        g_xua_glitch_reset = 0;
+    }
+
+    entry = g_xua_glitch_log[g_xua_glitch_count & (XUA_GLITCH_LOG_LEN - 1)];
+
+    /* Sequence number written last, such that a partly written entry reads as unused */
+    entry[0] = 0;
+    entry[1] = time;
+    entry[2] = (id << 24) | (arg & 0xffffff);
+    g_xua_glitch_count++;
+    entry[0] = g_xua_glitch_count;
+}
+#endif
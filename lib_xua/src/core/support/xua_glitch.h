@@ -0,0 +1,93 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_GLITCH_H_
+#define _XUA_GLITCH_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Stream glitch detection (XUA_GLITCH_DETECT). Discontinuities are recorded with the reference timer value at which
+ * they are detected in a ring of the last XUA_GLITCH_LOG_LEN events. Every event is recorded by handle_audio_request()
+ * so the ring has a single writer. Reset requests from Endpoint 0 are serviced on the next event */
+
+/* Events, the argument recorded with each in brackets */
+#define XUA_GLITCH_OUT_UNDERFLOW        (0)     /* Decouple OUT FIFO emptied whilst streaming (0) */
+#define XUA_GLITCH_OUT_PACKET_SIZE      (1)     /* OUT packet two or more frames off the feedback rate, frames dropped
+                                                 * or duplicated by the host (frames << 12 | expected frames) */
+#define XUA_GLITCH_OUT_PARTIAL_FRAME    (2)     /* OUT packet ending part way through a frame (bytes skipped) */
+#define XUA_GLITCH_IN_OVERFLOW          (3)     /* Decouple IN FIFO full, IN packets discarded (fill in bytes) */
+#define XUA_GLITCH_OUT_DC               (4)     /* Sustained DC on an output channel (channel) */
+#define XUA_GLITCH_OUT_CLIP             (5)     /* Run of full scale samples on an output channel (channel) */
+#define XUA_GLITCH_EVENT_COUNT          (6)
+
+/* Words in each log entry: sequence number, reference timer value, event << 24 | argument */
+#define XUA_GLITCH_ENTRY_WORDS          (3)
+
+/* The DC level of each channel is a leaky average settling over 2^XUA_GLITCH_DC_SHIFT samples */
+#define XUA_GLITCH_DC_SHIFT             (12)
+
+/* Samples at or beyond the largest 24 bit magnitude are counted as clipped */
+#define XUA_GLITCH_CLIP_LEVEL           (0x7fffff00)
+
+#if (XUA_GLITCH_DETECT)
+#define XUA_GLITCH_EVENT(id, arg)       XUA_Glitch_Event(id, arg)
+#else
+#define XUA_GLITCH_EVENT(id, arg)
+#endif
+
+/* Log of the last XUA_GLITCH_LOG_LEN events and the number recorded since reset, shared with Endpoint 0. An entry
+ * reads with a sequence number of 0 until it is first written, and whilst it is being written */
+extern unsigned g_xua_glitch_log[XUA_GLITCH_LOG_LEN][XUA_GLITCH_ENTRY_WORDS];
+extern unsigned g_xua_glitch_count;
+
+/* Reset request, set by Endpoint 0 */
+extern unsigned g_xua_glitch_reset;
+
+/* Output signal state of the first XUA_GLITCH_CHANS channels */
+extern int g_xua_glitch_dc[XUA_GLITCH_CHANS];
+extern unsigned g_xua_glitch_clip[XUA_GLITCH_CHANS];
+extern unsigned g_xua_glitch_dc_flagged;
+
+/** Record an event */
+void XUA_Glitch_Event(unsigned id, unsigned arg);
+
+#if (XUA_GLITCH_DETECT)
+/** Check an output sample of channel chan (less than XUA_GLITCH_CHANS) for sustained DC and clipped runs. DC is
+ *  recorded once on rising above XUA_GLITCH_DC_LEVEL, and again only after it has fallen below half of that */
+static inline void XUA_Glitch_Sample(unsigned chan, int sample)
+{
+    int dc = g_xua_glitch_dc[chan];
+    int mag;
+
+    dc += (sample >> XUA_GLITCH_DC_SHIFT) - (dc >> XUA_GLITCH_DC_SHIFT);
+    g_xua_glitch_dc[chan] = dc;
+
+    mag = (dc < 0) ? -dc : dc;
+    if(mag > XUA_GLITCH_DC_LEVEL)
+    {
+        if(!(g_xua_glitch_dc_flagged & (1 << chan)))
+        {
+            g_xua_glitch_dc_flagged |= (1 << chan);
+            XUA_Glitch_Event(XUA_GLITCH_OUT_DC, chan);
+        }
+    }
+    else if(mag < (XUA_GLITCH_DC_LEVEL >> 1))
+    {
+        g_xua_glitch_dc_flagged &= ~(1 << chan);
+    }
+
+    if((sample >= XUA_GLITCH_CLIP_LEVEL) || (sample <= -XUA_GLITCH_CLIP_LEVEL))
+    {
+        if(++g_xua_glitch_clip[chan] == XUA_GLITCH_CLIP_RUN)
+        {
+            XUA_Glitch_Event(XUA_GLITCH_OUT_CLIP, chan);
+        }
+    }
+    else
+    {
+        g_xua_glitch_clip[chan] = 0;
+    }
+}
+#endif
+
+#endif
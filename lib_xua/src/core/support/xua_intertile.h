@@ -0,0 +1,139 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_INTERTILE_H_
+#define _XUA_INTERTILE_H_
+
+#include <xs1.h>
+#include "xua.h"
+
+#if (XUA_INTERTILE_PACKED_24) && (XUA_PIPELINE_PACKED_16)
+#error XUA_INTERTILE_PACKED_24 and XUA_PIPELINE_PACKED_16 cannot both be enabled
+#endif
+
+#if (XUA_PIPELINE_PACKED_16)
+#if (STREAM_FORMAT_OUTPUT_SUBSLOT_3_USED) || (STREAM_FORMAT_OUTPUT_SUBSLOT_4_USED) || \
+    (STREAM_FORMAT_INPUT_SUBSLOT_3_USED) || (STREAM_FORMAT_INPUT_SUBSLOT_4_USED)
+#error XUA_PIPELINE_PACKED_16 requires every stream format to use 2 byte subslots
+#endif
+#endif
+
+/* Frames exchanged between the mixer and the audiohub (or decouple and the audiohub when MIXER is disabled) are
+ * packed. The mixer and audiohub share a tile, so this is only the case in 16 bit mode whilst they exchange samples
+ * over the channel */
+#if (XUA_FRAME_PACK) && (!(MIXER) || ((XUA_PIPELINE_PACKED_16) && !(XUA_SHARED_SAMPLE_TRANSFER)))
+#define XUA_FRAME_PACK_HUB              (1)
+#else
+#define XUA_FRAME_PACK_HUB              (0)
+#endif
+
+#if (XUA_FRAME_PACK)
+/* Packed sample transfer. With XUA_INTERTILE_PACKED_24 the frames passed between decouple on XUD_TILE and the
+ * mixer/audiohub on AUDIO_IO_TILE are sent as the upper 24 bits of each sample, four samples to every three words.
+ * With XUA_PIPELINE_PACKED_16 every frame passed between decouple, the mixer and the audiohub is sent as the upper
+ * 16 bits of each sample, two samples to every word. Any remaining samples of the frame are sent as whole words. The
+ * frame is still preceded by the audio request word, so the exchange protocol (including commands) is unchanged */
+
+#if (STREAM_FORMAT_OUTPUT_RESOLUTION_32BIT_USED) || (STREAM_FORMAT_INPUT_RESOLUTION_32BIT_USED)
+#error Packed sample transfer does not support 32 bit stream formats
+#endif
+
+#if (DSD_CHANS_DAC > 0)
+#error Packed sample transfer does not support DSD, which requires all 32 bits of each sample
+#endif
+
+#if (MIXER) && (IN_VOLUME_IN_MIXER) && (IN_VOLUME_AFTER_MIX)
+#error Packed sample transfer does not support IN_VOLUME_AFTER_MIX in the mixer, whose samples are sent pre-shift
+#endif
+
+#if (XUA_PIPELINE_PACKED_16)
+/* Number of words in a packed frame of n samples */
+#define XUA_PACKED_FRAME_WORDS(n)       (((n) / 2) + ((n) % 2))
+
+/* Sends samples[0..n-1] packed. Called with a constant n such that the loops are unrolled */
+#pragma unsafe arrays
+static inline void XUA_PackedOutFrame(chanend ?c, const unsigned samples[], const unsigned n)
+{
+#pragma loop unroll
+    for(int i = 0; i < (n & ~1); i += 2)
+    {
+        outuint(c, (samples[i] >> 16) | (samples[i + 1] & 0xffff0000));
+    }
+
+    if(n & 1)
+    {
+        outuint(c, samples[n - 1]);
+    }
+}
+
+/* Receives n samples sent by XUA_PackedOutFrame() into samples[0..n-1], the lower 16 bits of each being zero */
+#pragma unsafe arrays
+static inline void XUA_PackedInFrame(chanend ?c, unsigned samples[], const unsigned n)
+{
+#pragma loop unroll
+    for(int i = 0; i < (n & ~1); i += 2)
+    {
+        unsigned w = inuint(c);
+
+        samples[i] = w << 16;
+        samples[i + 1] = w & 0xffff0000;
+    }
+
+    if(n & 1)
+    {
+        samples[n - 1] = inuint(c);
+    }
+}
+#else
+#define XUA_PACKED_FRAME_WORDS(n)       ((((n) / 4) * 3) + ((n) % 4))
+
+/* Sends samples[0..n-1] packed. Called with a constant n such that the loops are unrolled */
+#pragma unsafe arrays
+static inline void XUA_PackedOutFrame(chanend ?c, const unsigned samples[], const unsigned n)
+{
+#pragma loop unroll
+    for(int i = 0; i < (n & ~3); i += 4)
+    {
+        unsigned s0 = samples[i];
+        unsigned s1 = samples[i + 1];
+        unsigned s2 = samples[i + 2];
+        unsigned s3 = samples[i + 3];
+
+        outuint(c, (s0 >> 8) | ((s1 & 0xff00) << 16));
+        outuint(c, (s1 >> 16) | ((s2 & 0xffff00) << 8));
+        outuint(c, (s2 >> 24) | (s3 & 0xffffff00));
+    }
+
+#pragma loop unroll
+    for(int i = (n & ~3); i < n; i++)
+    {
+        outuint(c, samples[i]);
+    }
+}
+
+/* Receives n samples sent by XUA_PackedOutFrame() into samples[0..n-1], the lower 8 bits of each being zero */
+#pragma unsafe arrays
+static inline void XUA_PackedInFrame(chanend ?c, unsigned samples[], const unsigned n)
+{
+#pragma loop unroll
+    for(int i = 0; i < (n & ~3); i += 4)
+    {
+        unsigned w0 = inuint(c);
+        unsigned w1 = inuint(c);
+        unsigned w2 = inuint(c);
+
+        samples[i] = w0 << 8;
+        samples[i + 1] = ((w0 >> 16) & 0xff00) | (w1 << 16);
+        samples[i + 2] = ((w1 >> 8) & 0xffff00) | (w2 << 24);
+        samples[i + 3] = w2 & 0xffffff00;
+    }
+
+#pragma loop unroll
+    for(int i = (n & ~3); i < n; i++)
+    {
+        samples[i] = inuint(c);
+    }
+}
+#endif
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_latency.h"
+
+#if (XUA_LATENCY_STATS)
+
+#include <string.h>
+
+typedef struct
+{
+    unsigned tag[XUA_LATENCY_TAG_COUNT];
+    unsigned time[XUA_LATENCY_TAG_COUNT];
+    volatile unsigned wr;
+    volatile unsigned rd;
+} xua_latency_tags_t;
+
+xua_latency_stats_t g_xua_latency_stats[XUA_LATENCY_STAGE_COUNT];
+unsigned g_xua_latency_reset = (1 << XUA_LATENCY_STAGE_COUNT) - 1;
+
+static xua_latency_tags_t latencyTags[XUA_LATENCY_STAGE_COUNT];
+
+void XUA_Latency_Reset(unsigned stage)
+{
+    xua_latency_stats_t *stats = &g_xua_latency_stats[stage];
+
+    memset(stats, 0, sizeof(xua_latency_stats_t));
+    stats->min = ~0U;
+
+    XUA_Latency_Flush(stage);
+}
+
+void XUA_Latency_Flush(unsigned stage)
+{
+    latencyTags[stage].rd = latencyTags[stage].wr;
+}
+
+void XUA_Latency_Mark(unsigned stage, unsigned tag, unsigned time)
+{
+    xua_latency_tags_t *tags = &latencyTags[stage];
+    unsigned wr = tags->wr;
+
+    /* Drop the mark if full, the packet will simply not be measured */
+    if((wr - tags->rd) >= XUA_LATENCY_TAG_COUNT)
+        return;
+
+    tags->tag[wr & (XUA_LATENCY_TAG_COUNT - 1)] = tag;
+    tags->time[wr & (XUA_LATENCY_TAG_COUNT - 1)] = time;
+    tags->wr = wr + 1;
+}
+
+void XUA_Latency_Match(unsigned stage, unsigned tag, unsigned time)
+{
+    xua_latency_tags_t *tags = &latencyTags[stage];
+    xua_latency_stats_t *stats = &g_xua_latency_stats[stage];
+
+    for(unsigned rd = tags->rd; rd != tags->wr; rd++)
+    {
+        unsigned i = rd & (XUA_LATENCY_TAG_COUNT - 1);
+
+        if(tags->tag[i] == tag)
+        {
+            unsigned elapsed = time - tags->time[i];
+            unsigned bin = elapsed / XUA_LATENCY_HIST_BIN_TICKS;
+
+            if(bin >= XUA_LATENCY_HIST_BINS)
+                bin = XUA_LATENCY_HIST_BINS - 1;
+
+            stats->count++;
+            stats->total += elapsed;
+            stats->hist[bin]++;
+            if(elapsed < stats->min)
+                stats->min = elapsed;
+            if(elapsed > stats->max)
+                stats->max = elapsed;
+
+            /* Consume this tag and any older unmatched ones */
+            tags->rd = rd + 1;
+            return;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_LATENCY_H_
+#define _XUA_LATENCY_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Latency measurement (XUA_LATENCY_STATS). Packets are tagged with a reference timer value at one stage
+ * boundary and matched up when they reach the next. The elapsed times are aggregated per stage.
+ * All stages are measured on XUD_TILE so time stamps are always taken from the same reference timer */
+
+/* Measured stages */
+#define XUA_LATENCY_STAGE_OUT       (0)     /* OUT packet received from host -> first sample passed to audio subsystem */
+#define XUA_LATENCY_STAGE_IN        (1)     /* IN packet complete in decouple FIFO -> packet sent to host */
+#define XUA_LATENCY_STAGE_COUNT     (2)
+
+/* Number of packets in flight that can be tracked per stage. Must be a power of 2 */
+#define XUA_LATENCY_TAG_COUNT       (32)
+
+/* Histogram bin width in reference timer ticks. REF_CLK_FREQ is passed in by the build (MHz) */
+#ifndef REF_CLK_FREQ
+#define REF_CLK_FREQ                (100)
+#endif
+#define XUA_LATENCY_HIST_BIN_TICKS  (XUA_LATENCY_HIST_BIN_US * REF_CLK_FREQ)
+
+#ifndef __XC__
+typedef struct
+{
+    unsigned count;
+    unsigned min;
+    unsigned max;
+    unsigned long long total;
+    unsigned hist[XUA_LATENCY_HIST_BINS];
+} xua_latency_stats_t;
+
+/* Stats for each stage, shared with Endpoint 0 */
+extern xua_latency_stats_t g_xua_latency_stats[XUA_LATENCY_STAGE_COUNT];
+#endif
+
+/* Bit mask of stages to reset, set by Endpoint 0 and serviced by decouple */
+extern unsigned g_xua_latency_reset;
+
+/** Clear the statistics and any outstanding tags for a stage */
+void XUA_Latency_Reset(unsigned stage);
+
+/** Discard any outstanding tags for a stage, e.g. when its FIFO is reset */
+void XUA_Latency_Flush(unsigned stage);
+
+/** Record that the packet identified by tag entered a stage at the given time */
+void XUA_Latency_Mark(unsigned stage, unsigned tag, unsigned time);
+
+/** Record that the packet identified by tag left a stage at the given time. Tags marked before
+ *  this one that were never matched (e.g. packets dropped on overflow) are discarded. If the tag
+ *  is not found (e.g. its mark was dropped) nothing is recorded */
+void XUA_Latency_Match(unsigned stage, unsigned tag, unsigned time);
+
+#endif
@@ -0,0 +1,19 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_memory.h"
+
+#if (XUA_MEMORY_REPORT)
+#include <xs1.h>
+#include <print.h>
+
+void XUA_MemoryReport(const char name[], unsigned bytes)
+{
+    printstr("XUA mem: tile ");
+    printhex(get_local_tile_id());
+    printstr(" ");
+    printuint(bytes);
+    printstr(" ");
+    printstrln(name);
+}
+#endif
@@ -0,0 +1,16 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_MEMORY_H_
+#define _XUA_MEMORY_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+#if (XUA_MEMORY_REPORT)
+/* Memory report (XUA_MEMORY_REPORT). Prints one line per buffer, "XUA mem: tile <tile id> <bytes> <name>", for
+ * the tile the caller runs on. Sizes are the static sizes of the buffers, so only change with the build
+ * configuration */
+void XUA_MemoryReport(const char name[], unsigned bytes);
+#endif
+
+#endif
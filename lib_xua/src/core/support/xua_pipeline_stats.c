@@ -0,0 +1,44 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_pipeline_stats.h"
+
+#if (XUA_PIPELINE_STATS)
+
+unsigned g_xua_stats_count[XUA_STATS_COUNT];
+xua_stats_fill_t g_xua_stats_fill[XUA_STATS_FILL_COUNT];
+unsigned g_xua_stats_count_reset[XUA_STATS_COUNT];
+unsigned g_xua_stats_fill_reset[XUA_STATS_FILL_COUNT];
+
+void XUA_Stats_Event(unsigned id)
+{
+    if(g_xua_stats_count_reset[id])
+    {
+        g_xua_stats_count[id] = 0;
+        g_xua_stats_count_reset[id] = 0;
+    }
+
+    g_xua_stats_count[id]++;
+}
+
+void XUA_Stats_Fill(unsigned id, int fill)
+{
+    xua_stats_fill_t *f = &g_xua_stats_fill[id];
+
+    if(g_xua_stats_fill_reset[id] || !f->valid)
+    {
+        f->min = fill;
+        f->max = fill;
+        f->valid = 1;
+        g_xua_stats_fill_reset[id] = 0;
+    }
+    else if(fill < f->min)
+    {
+        f->min = fill;
+    }
+    else if(fill > f->max)
+    {
+        f->max = fill;
+    }
+}
+#endif
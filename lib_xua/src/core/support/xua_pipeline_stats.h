@@ -0,0 +1,63 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_PIPELINE_STATS_H_
+#define _XUA_PIPELINE_STATS_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Pipeline statistics (XUA_PIPELINE_STATS). Each counter and fill range is updated by the one task that owns the
+ * buffer concerned, as the event happens. Reset requests from Endpoint 0 are serviced by the owner on its next update.
+ *
+ * Statistics are held per tile. Statistics are therefore only visible to Endpoint 0 when their task runs on XUD_TILE */
+
+/* Event counters */
+#define XUA_STATS_OUT_UNDERFLOW         (0)     /* Decouple OUT FIFO emptied whilst streaming */
+#define XUA_STATS_OUT_OVERFLOW          (1)     /* Decouple OUT FIFO full, OUT packets no longer taken */
+#define XUA_STATS_IN_UNDERFLOW          (2)     /* Decouple IN FIFO emptied whilst streaming, zeros sent */
+#define XUA_STATS_IN_OVERFLOW           (3)     /* Decouple IN FIFO full, oldest packets discarded */
+#define XUA_STATS_SPDIF_RX_UNDERFLOW    (4)     /* clockGen() S/PDIF receive FIFO emptied */
+#define XUA_STATS_SPDIF_RX_OVERFLOW     (5)     /* clockGen() S/PDIF receive FIFO full */
+#define XUA_STATS_ADAT_RX_UNDERFLOW     (6)     /* clockGen() ADAT receive FIFO emptied */
+#define XUA_STATS_ADAT_RX_OVERFLOW      (7)     /* clockGen() ADAT receive FIFO full */
+#define XUA_STATS_MIDI_OVERFLOW         (8)     /* MIDI from host FIFO too full to acknowledge a packet */
+#define XUA_STATS_AUDIOHUB_LATE         (9)     /* AudioHub_MainLoop() sample transfer more than a sample period late */
+#define XUA_STATS_COUNT                 (10)
+
+/* Fill ranges, in bytes */
+#define XUA_STATS_FILL_OUT              (0)     /* Decouple OUT FIFO, as each OUT packet is consumed */
+#define XUA_STATS_FILL_IN               (1)     /* Decouple IN FIFO, as each IN packet is sent */
+#define XUA_STATS_FILL_COUNT            (2)
+
+#if (XUA_PIPELINE_STATS)
+#define XUA_STATS_EVENT(id)             XUA_Stats_Event(id)
+#define XUA_STATS_FILL(id, fill)        XUA_Stats_Fill(id, fill)
+#else
+#define XUA_STATS_EVENT(id)
+#define XUA_STATS_FILL(id, fill)
+#endif
+
+#ifndef __XC__
+typedef struct
+{
+    int min;
+    int max;
+    unsigned valid;
+} xua_stats_fill_t;
+
+/* Statistics for tasks on this tile, shared with Endpoint 0 */
+extern unsigned g_xua_stats_count[XUA_STATS_COUNT];
+extern xua_stats_fill_t g_xua_stats_fill[XUA_STATS_FILL_COUNT];
+#endif
+
+/* Reset requests, set by Endpoint 0 and serviced by the owner of each statistic */
+extern unsigned g_xua_stats_count_reset[XUA_STATS_COUNT];
+extern unsigned g_xua_stats_fill_reset[XUA_STATS_FILL_COUNT];
+
+/** Count an event */
+void XUA_Stats_Event(unsigned id);
+
+/** Record a fill level against a fill range */
+void XUA_Stats_Fill(unsigned id, int fill);
+
+#endif
@@ -0,0 +1,88 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_profile.h"
+
+#if (XUA_PROFILE)
+
+#include <string.h>
+#if (XUA_PROFILE_XSCOPE)
+#include <xscope.h>
+#endif
+
+xua_profile_t g_xua_profile[XUA_PROFILE_COUNT];
+unsigned g_xua_profile_reset[XUA_PROFILE_COUNT];
+
+static inline unsigned GetTime(void)
+{
+    unsigned time;
+    asm volatile("gettime %0" : "=r"(time));
+    return time;
+}
+
+void XUA_Profile_Loop(unsigned id)
+{
+    xua_profile_t *p = &g_xua_profile[id];
+    unsigned time = GetTime();
+
+    if(g_xua_profile_reset[id])
+    {
+        memset(p, 0, sizeof(xua_profile_t));
+        g_xua_profile_reset[id] = 0;
+    }
+    else if(p->running)
+    {
+        unsigned period = time - p->lastLoop;
+
+        p->periodCount++;
+        p->totalPeriod += period;
+        if(period > p->maxPeriod)
+            p->maxPeriod = period;
+
+#if (XUA_PROFILE_XSCOPE)
+        /* Report the worst busy time (or period for polling tasks) seen over each interval */
+        if(!p->busyCount && (period > p->intervalMax))
+            p->intervalMax = period;
+
+        if(++p->intervalCount >= XUA_PROFILE_XSCOPE_INTERVAL)
+        {
+            xscope_int(XUA_PROFILE_XSCOPE_PROBE_BASE + id, p->intervalMax);
+            p->intervalCount = 0;
+            p->intervalMax = 0;
+        }
+#endif
+    }
+
+    p->lastLoop = time;
+    p->running = 1;
+}
+
+void XUA_Profile_Wait(unsigned id)
+{
+    xua_profile_t *p = &g_xua_profile[id];
+
+    if(p->running)
+    {
+        unsigned busy = GetTime() - p->lastLoop;
+
+        p->busyCount++;
+        p->totalBusy += busy;
+        if(busy > p->maxBusy)
+            p->maxBusy = busy;
+
+#if (XUA_PROFILE_XSCOPE)
+        if(busy > p->intervalMax)
+            p->intervalMax = busy;
+#endif
+    }
+}
+
+void XUA_Profile_RequestReset(void)
+{
+    for(int i = 0; i < XUA_PROFILE_COUNT; i++)
+    {
+        g_xua_profile_reset[i] = 1;
+    }
+}
+
+#endif
@@ -0,0 +1,68 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_PROFILE_H_
+#define _XUA_PROFILE_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Thread load profiling (XUA_PROFILE). Each profiled task marks where an iteration of work starts
+ * (XUA_PROFILE_LOOP) and, for tasks that block, where it starts waiting again (XUA_PROFILE_WAIT).
+ * The time between LOOP marks is the iteration period and the time from LOOP to WAIT is the busy time.
+ * Tasks that poll (never block) only record the period, which is then their worst-case service latency.
+ *
+ * Statistics are held per tile. A task's statistics are therefore only visible to Endpoint 0 when the
+ * task runs on XUD_TILE. All tasks can be observed through xscope when XUA_PROFILE_XSCOPE is enabled */
+
+/* Profiled tasks */
+#define XUA_PROFILE_AUDIOHUB        (0)     /* AudioHub_MainLoop(), one iteration per port transfer word */
+#define XUA_PROFILE_MIXER1          (1)     /* mixer1(), one iteration per sample */
+#define XUA_PROFILE_MIXER2          (2)     /* mixer2(), one iteration per sample */
+#define XUA_PROFILE_DECOUPLE        (3)     /* handle_audio_request(), one iteration per sample */
+#define XUA_PROFILE_EP_BUFFER       (4)     /* XUA_Buffer_Ep() select loop (polling) */
+#define XUA_PROFILE_CLOCKGEN        (5)     /* clockGen(), one iteration per event */
+#define XUA_PROFILE_MIDI            (6)     /* usb_midi(), one iteration per event */
+#define XUA_PROFILE_COUNT           (7)
+
+#if (XUA_PROFILE)
+#define XUA_PROFILE_LOOP(id)        XUA_Profile_Loop(id)
+#define XUA_PROFILE_WAIT(id)        XUA_Profile_Wait(id)
+#else
+#define XUA_PROFILE_LOOP(id)
+#define XUA_PROFILE_WAIT(id)
+#endif
+
+#ifndef __XC__
+typedef struct
+{
+    unsigned periodCount;
+    unsigned maxPeriod;
+    unsigned long long totalPeriod;
+    unsigned busyCount;
+    unsigned maxBusy;
+    unsigned long long totalBusy;
+    unsigned lastLoop;
+    unsigned running;
+#if (XUA_PROFILE_XSCOPE)
+    unsigned intervalCount;
+    unsigned intervalMax;
+#endif
+} xua_profile_t;
+
+/* Statistics for tasks on this tile, shared with Endpoint 0 */
+extern xua_profile_t g_xua_profile[XUA_PROFILE_COUNT];
+#endif
+
+/* Per task reset requests, set by Endpoint 0 or on sample rate change and serviced by the task itself */
+extern unsigned g_xua_profile_reset[XUA_PROFILE_COUNT];
+
+/** Mark the start of an iteration of work for a task */
+void XUA_Profile_Loop(unsigned id);
+
+/** Mark the point a task starts waiting for more work */
+void XUA_Profile_Wait(unsigned id);
+
+/** Request a reset of the statistics for all tasks on this tile (e.g. on a sample rate change) */
+void XUA_Profile_RequestReset(void);
+
+#endif
@@ -0,0 +1,21 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_startup.h"
+
+#if (XUA_STARTUP_STATS)
+
+unsigned g_xua_startup[XUA_STARTUP_COUNT];
+
+void XUA_Startup_Mark(unsigned milestone)
+{
+    if(!g_xua_startup[milestone])
+    {
+        unsigned time;
+        asm volatile("gettime %0" : "=r"(time));
+
+        /* 0 is reserved for milestones that have not been reached */
+        g_xua_startup[milestone] = time ? time : 1;
+    }
+}
+#endif
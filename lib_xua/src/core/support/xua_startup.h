@@ -0,0 +1,47 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_STARTUP_H_
+#define _XUA_STARTUP_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Startup timing (XUA_STARTUP_STATS). The reference timer value at which each milestone is first reached is recorded
+ * on the tile it is reached on. The reference timers start from reset, so each time is the time since reset in
+ * reference timer ticks. A milestone that has not (yet) been reached reads as 0 */
+
+/* Milestones on XUD_TILE */
+#define XUA_STARTUP_DESCRIPTORS     (0)     /* Descriptors prepared, before XUD is started when using main.xc */
+#define XUA_STARTUP_XUD             (1)     /* XUD_Main() started i.e. the device connects to the bus */
+#define XUA_STARTUP_EP0             (2)     /* Endpoint 0 ready to take requests */
+#define XUA_STARTUP_CONFIGURED      (3)     /* Enumerated, first SetConfiguration() received */
+#define XUA_STARTUP_STREAM          (4)     /* First audio stream interface started by the host */
+#define XUA_STARTUP_FIRST_OUT       (5)     /* First OUT samples passed to the audio subsystem (end of prefill) */
+#define XUA_STARTUP_FIRST_IN        (6)     /* First IN packet sent to the host */
+
+/* Milestones on AUDIO_IO_TILE */
+#define XUA_STARTUP_HW_INIT         (7)     /* AudioHwInit() complete */
+#define XUA_STARTUP_HW_CONFIG       (8)     /* First AudioHwConfig() complete */
+#define XUA_STARTUP_AUDIO           (9)     /* First sample exchange between the audiohub and the USB side */
+
+#define XUA_STARTUP_COUNT           (10)
+
+#if (XUA_STARTUP_STATS)
+#define XUA_STARTUP_MARK(m)         XUA_Startup_Mark(m)
+#else
+#define XUA_STARTUP_MARK(m)
+#endif
+
+/* Set by Endpoint 0 once the descriptors are prepared, see XUA_Endpoint0_InitDescriptors() */
+extern unsigned g_xua_descriptors_ready;
+
+/** Prepare the descriptors and string table. Called by XUA_Endpoint0_init() if not already done */
+void XUA_Endpoint0_InitDescriptors(void);
+
+/* Milestone times for this tile, shared with Endpoint 0 */
+extern unsigned g_xua_startup[XUA_STARTUP_COUNT];
+
+/** Record the current time against a milestone, if it has not already been reached */
+void XUA_Startup_Mark(unsigned milestone);
+
+#endif
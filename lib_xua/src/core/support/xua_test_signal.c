@@ -0,0 +1,233 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+
+#if (XUA_TEST_SIGNAL)
+#include <math.h>
+#include "xua_test_signal.h"
+
+#define BLOCK_MASK                      (XUA_TEST_SIGNAL_BLOCK - 1)
+
+/* Offset of the cosine into the sine table */
+#define COS_OFFSET                      (XUA_TEST_SIGNAL_BLOCK / 4)
+
+typedef struct
+{
+    unsigned outMask;
+    unsigned settleFrames;
+    int amplitude;                                  /* Peak of each tone, Q31 */
+    unsigned bins[XUA_TEST_SIGNAL_TONES];
+    unsigned inChans[XUA_TEST_SIGNAL_CAPTURE_CHANS];
+} xua_test_signal_config_t;
+
+/* One cycle of a full scale sine over the block, Q31 */
+static int g_sine[XUA_TEST_SIGNAL_BLOCK];
+static unsigned g_sineBuilt = 0;
+
+/* Configuration written by Endpoint 0 and applied by the audiohub, which then clears the pending flag */
+static xua_test_signal_config_t g_next;
+static volatile unsigned g_nextPending = 0;
+static volatile unsigned g_nextStop = 0;
+
+/* Owned by the audiohub. The capture is only read by Endpoint 0 once the state is XUA_TEST_SIGNAL_DONE */
+static xua_test_signal_config_t g_config;
+static volatile unsigned g_state = XUA_TEST_SIGNAL_OFF;
+static unsigned g_phase[XUA_TEST_SIGNAL_TONES];
+static unsigned g_settle;
+static unsigned g_captured;
+static int g_capture[XUA_TEST_SIGNAL_CAPTURE_CHANS][XUA_TEST_SIGNAL_BLOCK];
+
+void XUA_TestSignalFrame(unsigned samplesOut[], unsigned samplesIn[])
+{
+    if(g_nextPending)
+    {
+        g_config = g_next;
+        for(int i = 0; i < XUA_TEST_SIGNAL_TONES; i++)
+        {
+            g_phase[i] = 0;
+        }
+        g_settle = g_config.settleFrames;
+        g_captured = 0;
+        g_state = g_nextStop ? XUA_TEST_SIGNAL_OFF : XUA_TEST_SIGNAL_RUNNING;
+        g_nextPending = 0;
+    }
+
+    if(g_state == XUA_TEST_SIGNAL_OFF)
+    {
+        return;
+    }
+
+    long long sum = 0;
+
+    for(int i = 0; i < XUA_TEST_SIGNAL_TONES; i++)
+    {
+        if(g_config.bins[i])
+        {
+            sum += ((long long) g_config.amplitude * g_sine[g_phase[i]]) >> 31;
+            g_phase[i] = (g_phase[i] + g_config.bins[i]) & BLOCK_MASK;
+        }
+    }
+
+    /* Tones summing beyond full scale clip rather than wrap */
+    if(sum > 0x7FFFFFFF)
+    {
+        sum = 0x7FFFFFFF;
+    }
+    else if(sum < -0x7FFFFFFF - 1)
+    {
+        sum = -0x7FFFFFFF - 1;
+    }
+
+    for(int i = 0; i < XUA_TEST_SIGNAL_CHANS_OUT; i++)
+    {
+        if(g_config.outMask & (1 << i))
+        {
+            samplesOut[i] = (unsigned) sum;
+        }
+    }
+
+    if(g_state != XUA_TEST_SIGNAL_RUNNING)
+    {
+        return;
+    }
+
+    if(g_settle)
+    {
+        g_settle--;
+        return;
+    }
+
+    /* Stored as 24-bit such that the sums of the analysis cannot overflow */
+    for(int c = 0; c < XUA_TEST_SIGNAL_CAPTURE_CHANS; c++)
+    {
+        g_capture[c][g_captured] = ((int) samplesIn[g_config.inChans[c]]) >> 8;
+    }
+
+    if(++g_captured == XUA_TEST_SIGNAL_BLOCK)
+    {
+        g_state = XUA_TEST_SIGNAL_DONE;
+    }
+}
+
+int XUA_TestSignal_Configure(const unsigned words[], unsigned words_len)
+{
+    if(g_nextPending)
+    {
+        return 1;
+    }
+
+    if(words == 0)
+    {
+        g_nextStop = 1;
+        g_nextPending = 1;
+        return 0;
+    }
+
+    if(words_len != XUA_TEST_SIGNAL_CONFIG_WORDS)
+    {
+        return 1;
+    }
+
+    g_next.outMask = words[0];
+    g_next.settleFrames = words[1];
+    g_next.amplitude = (int) words[2];
+
+    for(int i = 0; i < XUA_TEST_SIGNAL_TONES; i++)
+    {
+        g_next.bins[i] = words[3 + i];
+
+        /* Bins at or above half the block would alias */
+        if(g_next.bins[i] >= (XUA_TEST_SIGNAL_BLOCK / 2))
+        {
+            return 1;
+        }
+    }
+
+    for(int i = 0; i < XUA_TEST_SIGNAL_CAPTURE_CHANS; i++)
+    {
+        g_next.inChans[i] = words[3 + XUA_TEST_SIGNAL_TONES + i];
+
+        if(g_next.inChans[i] >= XUA_TEST_SIGNAL_CHANS_IN)
+        {
+            return 1;
+        }
+    }
+
+    /* Built on first use, before the audiohub can read it */
+    if(!g_sineBuilt)
+    {
+        for(int i = 0; i < XUA_TEST_SIGNAL_BLOCK; i++)
+        {
+            g_sine[i] = (int) (sin((2.0 * M_PI * i) / XUA_TEST_SIGNAL_BLOCK) * 2147483647.0);
+        }
+        g_sineBuilt = 1;
+    }
+
+    g_nextStop = 0;
+    g_nextPending = 1;
+    return 0;
+}
+
+static unsigned *PutLong(unsigned *w, long long x)
+{
+    w[0] = (unsigned) x;
+    w[1] = (unsigned) (x >> 32);
+    return w + 2;
+}
+
+void XUA_TestSignal_Results(unsigned result[])
+{
+    unsigned state = g_state;
+    unsigned *w = &result[2];
+
+    result[0] = state;
+    result[1] = XUA_TEST_SIGNAL_BLOCK;
+
+    for(int i = 2; i < XUA_TEST_SIGNAL_RESULT_WORDS; i++)
+    {
+        result[i] = 0;
+    }
+
+    if(state != XUA_TEST_SIGNAL_DONE)
+    {
+        return;
+    }
+
+    /* The DFT at each tone bin directly, the tones being coherent with the block such that no window is required */
+    for(int c = 0; c < XUA_TEST_SIGNAL_CAPTURE_CHANS; c++)
+    {
+        const int *x = g_capture[c];
+        long long sum = 0;
+        long long sumSq = 0;
+
+        for(int n = 0; n < XUA_TEST_SIGNAL_BLOCK; n++)
+        {
+            sum += x[n];
+            sumSq += (long long) x[n] * x[n];
+        }
+        w = PutLong(w, sum);
+        w = PutLong(w, sumSq);
+
+        for(int t = 0; t < XUA_TEST_SIGNAL_TONES; t++)
+        {
+            unsigned k = g_config.bins[t];
+            long long re = 0;
+            long long im = 0;
+
+            if(k)
+            {
+                unsigned phase = 0;
+
+                for(int n = 0; n < XUA_TEST_SIGNAL_BLOCK; n++)
+                {
+                    re += ((long long) x[n] * g_sine[(phase + COS_OFFSET) & BLOCK_MASK]) >> 31;
+                    im -= ((long long) x[n] * g_sine[phase]) >> 31;
+                    phase = (phase + k) & BLOCK_MASK;
+                }
+            }
+            w = PutLong(w, re);
+            w = PutLong(w, im);
+        }
+    }
+}
+#endif
@@ -0,0 +1,47 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_TEST_SIGNAL_H_
+#define _XUA_TEST_SIGNAL_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* Production test signal generator and analyser (XUA_TEST_SIGNAL). Endpoint 0 hands a configuration to the audiohub,
+ * which applies it at its next sample transfer. The audiohub then writes the sum of the tones to the selected output
+ * channels, waits for the loopback to settle and captures one block from each selected input channel. Tones are
+ * given as DFT bins of the block, so every tone completes a whole number of cycles per block and is generated from a
+ * single sine table without phase error. The analysis of the captured block is carried out by Endpoint 0 on request,
+ * keeping the per-sample cost in the audiohub to a table lookup per tone */
+
+/* Channel counts of samplesOut[] and samplesIn[] as sized by the audiohub */
+#define XUA_TEST_SIGNAL_CHANS_OUT       ((NUM_USB_CHAN_OUT) > (I2S_CHANS_DAC) ? (NUM_USB_CHAN_OUT) : (I2S_CHANS_DAC))
+#define XUA_TEST_SIGNAL_ADC_CHANS       (I2S_CHANS_ADC + XUA_NUM_PDM_MICS + (8 * XUA_ADAT_RX_EN) + (2 * XUA_SPDIF_RX_EN))
+#define XUA_TEST_SIGNAL_CHANS_IN        ((NUM_USB_CHAN_IN) > XUA_TEST_SIGNAL_ADC_CHANS ? (NUM_USB_CHAN_IN) : XUA_TEST_SIGNAL_ADC_CHANS)
+
+/* States, as reported to the host */
+#define XUA_TEST_SIGNAL_OFF             (0)     /* No test signal, audio passes as normal */
+#define XUA_TEST_SIGNAL_RUNNING         (1)     /* Generating, waiting for the loopback to settle or capturing */
+#define XUA_TEST_SIGNAL_DONE            (2)     /* Generating, capture complete and ready for analysis */
+
+/* Configuration words of XUA_VENDOR_REQ_TEST_SIGNAL: output channel mask, settle frames, tone amplitude, tone bins,
+ * input channels */
+#define XUA_TEST_SIGNAL_CONFIG_WORDS    (3 + XUA_TEST_SIGNAL_TONES + XUA_TEST_SIGNAL_CAPTURE_CHANS)
+
+/* Result words of XUA_VENDOR_REQ_TEST_SIGNAL: state and block length, then for each input channel the sum and the
+ * sum of squares followed by the real and imaginary DFT terms at each tone, each a 64-bit value as two words */
+#define XUA_TEST_SIGNAL_CHAN_WORDS      (4 + (4 * XUA_TEST_SIGNAL_TONES))
+#define XUA_TEST_SIGNAL_RESULT_WORDS    (2 + (XUA_TEST_SIGNAL_CAPTURE_CHANS * XUA_TEST_SIGNAL_CHAN_WORDS))
+
+/** Called by the audiohub after each sample transfer. Replaces the selected channels of samplesOut with the test
+ *  signal and captures the selected channels of samplesIn. Returns immediately whilst no test signal is running */
+void XUA_TestSignalFrame(unsigned samplesOut[], unsigned samplesIn[]);
+
+/** Hands a configuration to the audiohub, or stops the test signal if words is 0. Returns non-zero if the
+ *  configuration is invalid or the audiohub has not yet applied the previous one */
+int XUA_TestSignal_Configure(const unsigned words[], unsigned words_len);
+
+/** Writes the state and, once the capture is complete, the analysis of the captured block to
+ *  result[XUA_TEST_SIGNAL_RESULT_WORDS] */
+void XUA_TestSignal_Results(unsigned result[]);
+
+#endif
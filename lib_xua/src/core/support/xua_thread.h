@@ -0,0 +1,33 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_THREAD_H_
+#define _XUA_THREAD_H_
+
+#include <xs1.h>
+#include "xua.h"
+
+/* Per task thread modes (XUA_THREAD_MODE_*). Each task calls XUA_ThreadConfig() with its mode as it starts on its
+ * thread, including the threads a task pars off itself, since a new thread starts in normal priority without fast
+ * mode. The mode is constant, so only the instructions for the selected mode remain */
+static inline void XUA_ThreadConfig(const unsigned mode)
+{
+    if(mode & XUA_THREAD_FAST)
+    {
+        set_thread_fast_mode_on();
+    }
+    else
+    {
+        set_thread_fast_mode_off();
+    }
+
+    if(mode & XUA_THREAD_HIGH_PRIORITY)
+    {
+        set_core_high_priority_on();
+    }
+    else
+    {
+        set_core_high_priority_off();
+    }
+}
+
+#endif
@@ -0,0 +1,26 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_xscope_tap.h"
+
+#if (XUA_XSCOPE_TAPS)
+
+#include <xscope.h>
+
+/* Frames until the next report of each tap, on this tile */
+static unsigned tapCount[XUA_XSCOPE_TAP_COUNT];
+
+void XUA_XscopeTap(unsigned tap, int value)
+{
+    unsigned id = 31 - __builtin_clz(tap);
+
+    if(tapCount[id])
+    {
+        tapCount[id]--;
+        return;
+    }
+
+    tapCount[id] = XUA_XSCOPE_TAP_DECIMATION - 1;
+    xscope_int(XUA_XSCOPE_TAP_PROBE_BASE + id, value);
+}
+#endif
@@ -0,0 +1,22 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_XSCOPE_TAP_H_
+#define _XUA_XSCOPE_TAP_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* xscope tap points (XUA_XSCOPE_TAPS). Each tap is placed where a sample or fill level is already at hand, once per
+ * frame, and is owned by a single task such that its decimation count needs no locking. A tap that is not enabled
+ * compiles out, including the evaluation of its value */
+
+#if (XUA_XSCOPE_TAPS)
+#define XUA_XSCOPE_TAP(tap, value)  do { if((XUA_XSCOPE_TAPS) & (tap)) XUA_XscopeTap(tap, value); } while(0)
+#else
+#define XUA_XSCOPE_TAP(tap, value)
+#endif
+
+/** Report value to the probe of a tap (one of XUA_XSCOPE_TAP_xxx) once every XUA_XSCOPE_TAP_DECIMATION calls */
+void XUA_XscopeTap(unsigned tap, int value);
+
+#endif
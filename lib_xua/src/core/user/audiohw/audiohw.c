@@ -1,7 +1,8 @@
 // Copyright 2023-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
-/* Default implementations of AudioHwInit(), AudioHwConfig(), AudioHwConfig_Mute() and AudioHwConfig_UnMute() */
+/* Default implementations of AudioHwInit(), AudioHwConfig(), AudioHwConfig_Mute(), AudioHwConfig_UnMute() and
+ * AudioHwConfig_FastRateChange() */
 
 void AudioHwInit() __attribute__ ((weak));
 void AudioHwInit()
@@ -27,3 +28,10 @@ void AudioHwConfig_UnMute()
     return;
 }
 
+
+unsigned AudioHwConfig_FastRateChange(unsigned samFreq, unsigned mClk) __attribute__ ((weak));
+unsigned AudioHwConfig_FastRateChange(unsigned samFreq, unsigned mClk)
+{
+    /* Not handled, use AudioHwConfig() */
+    return 0;
+}
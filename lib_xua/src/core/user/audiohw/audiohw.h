@@ -51,4 +51,22 @@ void AudioHwConfig_Mute(void);
  */
 void AudioHwConfig_UnMute(void);
 
+/**
+ * @brief   User code to change sample rate without reconfiguring audio hardware
+ *
+ * This function is called on a sample rate change that keeps the current master clock frequency (for example
+ * 48kHz to 96kHz). The bit clock divide has already been updated. If the audio hardware can follow the change in
+ * place (e.g. it auto-detects the rate, or only needs a rate register written) this function should do so, without
+ * muting, and return 1. AudioHwConfig_Mute(), AudioHwConfig() and AudioHwConfig_UnMute() are then not called.
+ *
+ * The default implementation returns 0, so every rate change goes through AudioHwConfig()
+ *
+ * \param samFreq       The new sample frequency (in Hz)
+ *
+ * \param mClk          The master clock frequency (in Hz), unchanged from the previous rate
+ *
+ * \return              1 if the rate change has been handled, 0 to perform a full AudioHwConfig()
+ */
+unsigned AudioHwConfig_FastRateChange(unsigned samFreq, unsigned mClk);
+
 #endif
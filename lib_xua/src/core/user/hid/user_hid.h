@@ -50,6 +50,21 @@ typedef struct hidEvent_t {
  */
 size_t UserHIDGetData( const unsigned id, unsigned char hidData[ HID_MAX_DATA_BYTES ]);
 
+/**
+ *  \brief  Handle a HID Report received from the host on the HID OUT endpoint
+ *
+ *  Required when HID_CONTROLS and HID_OUT_REQUIRED are both enabled. Called from the buffer
+ *    core for each HID OUT report. The report is passed in place in the endpoint buffer, it is
+ *    not copied, and the buffer remains valid until the following report has been received.
+ *  As with UserHIDGetData(), care should be taken not to add too much execution time to this
+ *    function.
+ *
+ *  \param[in]  id       The HID Report ID, zero if the application does not use Report IDs
+ *  \param[in]  report   The HID Report. If using Report IDs, the first element holds the Report ID
+ *  \param[in]  length   The length of the HID Report in bytes
+ */
+void UserHIDOutReport( const unsigned id, unsigned char report[], const unsigned length );
+
 /**
  *  \brief  Initialize HID processing
  */
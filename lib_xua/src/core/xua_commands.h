@@ -20,6 +20,9 @@ enum
 #endif
 #if XUA_ADAT_RX_EN
     CLOCK_ADAT,
+#endif
+#if XUA_WORDCLOCK_RX_EN
+    CLOCK_WORDCLOCK,
 #endif
     CLOCK_COUNT
 };
@@ -28,6 +31,11 @@ enum
 #define SET_SAMPLE_FREQ         4
 #define SET_STREAM_FORMAT_OUT   8
 #define SET_STREAM_FORMAT_IN    9
+#define SET_MIDI_ALT            10      /* MIDI streaming alternate setting (XUA_MIDI_UMP), handled by XUA_Buffer */
+#define STATUS_INTERRUPT        11      /* Status interrupt to send (XUA_STATUS_INT_EN), handled by XUA_Buffer */
+
+/* Status interrupt as passed with STATUS_INTERRUPT: entity ID, control selector and channel number */
+#define XUA_STATUS_INT_PACK(entity, cs, cn) ((((entity) & 0xff) << 16) | (((cs) & 0xff) << 8) | ((cn) & 0xff))
 
 #include "dsd_support.h"
 
@@ -1,4 +1,4 @@
-// Copyright 2015-2021 XMOS LIMITED.
+// Copyright 2015-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #ifndef __DFU_INTERFACE_H__
@@ -11,6 +11,12 @@
 interface i_dfu
 {
     {unsigned, int, int, int, unsigned} HandleDfuRequest(USB_SetupPacket_t &sp, unsigned data_buffer[], unsigned data_buffer_length, unsigned dfuState);
+    /* Perform flash writes deferred from earlier requests */
+    void HandleDfuDeferred();
+    /* Read/write a 256 byte page of the flash data partition, see flash_cmd_data_read_page() and
+     * flash_cmd_data_write_page(). Return non-zero on error */
+    int DataReadPage(unsigned sector, unsigned page, unsigned char data[]);
+    int DataWritePage(unsigned sector, unsigned page, unsigned char data[]);
     void finish();
 };
 
@@ -1,4 +1,4 @@
-// Copyright 2011-2021 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 // Default Command requests (from Spec)
 #define DFU_DETACH 0
@@ -17,6 +17,30 @@
 #define XMOS_DFU_SELECTIMAGE   0xf4
 #define XMOS_DFU_SAVESTATE     0xf5
 #define XMOS_DFU_RESTORESTATE  0xf6
+#define XMOS_DFU_IMAGECRC      0xf7
+#define XMOS_DFU_DNLOADSTATE   0xf8 // Download in progress (XUA_DFU_RESUME): active, blocks, bytes, CRC-32 of the bytes
+
+// Delta DFU image (XUA_DFU_DELTA). All fields are little endian words. A header of 16 words:
+// magic, format version, pages and CRC-32 (as XMOS_DFU_IMAGECRC) of the installed image the delta applies to,
+// pages of the new image. Followed by commands, each producing the next pages of the new image
+#define DFU_DELTA_MAGIC         0x41544c44 // "DLTA"
+#define DFU_DELTA_VERSION       1
+#define DFU_DELTA_HEADER_WORDS  16
+#define DFU_DELTA_CMD(x)        ((x) >> 28)
+#define DFU_DELTA_COUNT(x)      ((x) & 0x0fffffff)
+#define DFU_DELTA_CMD_PAD       0 // Padding, ignored
+#define DFU_DELTA_CMD_COPY      1 // Copy count pages from the byte offset in the installed image given by the next word
+#define DFU_DELTA_CMD_DATA      2 // count pages of data follow
+
+// Compressed DFU image (XUA_DFU_COMPRESS). A header of 16 little endian words: magic, format version, window size
+// in bytes, pages of the image. Followed by a byte stream of tokens, ending once the image is complete. A token byte
+// below 0x80 is followed by that plus 1 literal bytes. Otherwise it copies (token & 0x7f) + DFU_LZ_MIN_MATCH bytes
+// from earlier output, at the distance given by the two bytes (little endian) that follow, plus 1
+#define DFU_LZ_MAGIC            0x315a4c44 // "DLZ1"
+#define DFU_LZ_VERSION          1
+#define DFU_LZ_HEADER_WORDS     16
+#define DFU_LZ_MATCH            0x80
+#define DFU_LZ_MIN_MATCH        3
 
 // DFU States
 #define STATE_APP_IDLE                  0x00
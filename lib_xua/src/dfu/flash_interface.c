@@ -1,4 +1,4 @@
-// Copyright 2011-2023 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #include <xs1.h>
 #include <flash.h>
@@ -9,6 +9,8 @@
 #include "xua.h"
 
 #if (XUA_DFU_EN == 1)
+#include "dfu_types.h"
+#include "flash_interface.h"
 
 /* Defines flash area to erase on first DFU download request received
  *
@@ -24,15 +26,99 @@
 #define FLASH_MAX_UPGRADE_SIZE (128 * 1024)
 #endif
 
+/* Estimates of flash erase and program times (milliseconds), used to form the DFU poll timeout whilst
+ * deferred writes are outstanding. Defaults are for the XS2 internal flash (4KB sectors, 70ms sector erase) */
+#ifndef FLASH_SECTOR_ERASE_MS
+#define FLASH_SECTOR_ERASE_MS  (70)
+#endif
+
+#ifndef FLASH_PAGE_WRITE_MS
+#define FLASH_PAGE_WRITE_MS    (1)
+#endif
+
 #define FLASH_ERROR() do {} while(0)
 
+#define FLASH_PAGE_SIZE        (256)
+#define FLASH_SUBPAGE_SIZE     (64)
+#define FLASH_SUBPAGES         (FLASH_PAGE_SIZE / FLASH_SUBPAGE_SIZE)
+
+/* Download page buffers. Completed pages wait here to be written whilst the next page is filled, enough for a
+ * whole DFU transfer plus one partially filled page. Upload and download are never in progress together so page
+ * reads use the first buffer */
+#define FLASH_WRITE_PAGES      (((XUA_DFU_TRANSFER_SIZE + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE) + 1)
+
 static int flash_device_open = 0;
+
+/* Image directory, found by the first flash_cmd_init() and kept current as images are written and deleted, such
+ * that later DFU sessions and image queries need not scan the flash */
+static int image_dir_valid = 0;
 static fl_BootImageInfo factory_image;
 static fl_BootImageInfo upgrade_image;
 
 static int upgrade_image_valid = 0;
 static int current_flash_subpage_index = 0;
-static unsigned char current_flash_page_data[256];
+static unsigned char flash_page_data[FLASH_WRITE_PAGES][FLASH_PAGE_SIZE];
+static unsigned flash_page_fill = 0;        /* Page currently being filled */
+static unsigned flash_page_next_write = 0;  /* Oldest page waiting to be written */
+static unsigned flash_pages_pending = 0;    /* Number of complete pages waiting to be written */
+static int flash_erase_pending = 0;
+
+#if (XUA_DFU_DELTA)
+/* Delta download. Each queued operation produces the next pages of the new image, either literal pages waiting
+ * in the page buffers or pages copied from the installed image. Queued in order, as the writes must be */
+#define FLASH_DELTA_OPS        (8)
+
+typedef struct
+{
+    unsigned copy;          /* Non-zero to copy from the installed image, otherwise literal pages */
+    unsigned src;           /* Byte offset in the installed image of the next page copied */
+    unsigned count;         /* Pages left */
+} delta_op_t;
+
+enum
+{
+    DELTA_HEADER,
+    DELTA_CMD,
+    DELTA_COPY_SRC,
+    DELTA_DATA,
+};
+
+static int delta_active = 0;
+static unsigned delta_state;
+static unsigned delta_words;                /* Words of the header, or bytes of page data, still to come */
+static unsigned delta_copy_count;
+static delta_op_t delta_ops[FLASH_DELTA_OPS];
+static unsigned delta_op_first = 0;
+static unsigned delta_op_count = 0;
+static unsigned delta_copy_pages = 0;       /* Total pages of the queued copies */
+static unsigned char delta_copy_page[FLASH_PAGE_SIZE];
+#endif
+
+#if (XUA_DFU_COMPRESS)
+/* Compressed download. Tokens are decoded a byte at a time as sub-pages arrive, the output going both to the page
+ * buffers and to the window that back references are copied from */
+enum
+{
+    LZ_HEADER,
+    LZ_TOKEN,
+    LZ_LITERAL,
+    LZ_DIST_LO,
+    LZ_DIST_HI,
+    LZ_DONE,
+};
+
+static int lz_active = 0;
+static unsigned lz_state;
+static unsigned lz_count;                   /* Header bytes to skip, literal bytes to come or match length */
+static unsigned lz_dist;
+static unsigned lz_pages_left;              /* Pages of the image still to be produced */
+static unsigned lz_window_pos = 0;
+static unsigned char lz_window[XUA_DFU_COMPRESS_WINDOW];
+#endif
+
+#if (XUA_DFU_DELTA) || (XUA_DFU_COMPRESS)
+static unsigned flash_page_bytes;           /* Bytes filled in the page being filled */
+#endif
 
 int flash_cmd_enable_ports() __attribute__ ((weak));
 int flash_cmd_enable_ports() {
@@ -72,6 +158,11 @@ int flash_cmd_init(void)
         return 1;
     }
 
+    if (image_dir_valid)
+    {
+        return 0;
+    }
+
 #if (!XUA_QUAD_SPI_FLASH)
     // Disable flash protection
     fl_setProtection(0);
@@ -90,7 +181,9 @@ int flash_cmd_init(void)
         upgrade_image = image;
     }
 
-     return 0;
+    image_dir_valid = 1;
+
+    return 0;
 }
 
 int flash_cmd_deinit(void)
@@ -118,7 +211,7 @@ int flash_cmd_read_page(unsigned char *data)
 
     current_flash_subpage_index = 0;
 
-    if (fl_readImagePage(current_flash_page_data) == 0)
+    if (fl_readImagePage(flash_page_data[0]) == 0)
     {
         *(unsigned int *)data = 0;
      }
@@ -131,35 +224,425 @@ int flash_cmd_read_page(unsigned char *data)
 
 int flash_cmd_read_page_data(unsigned char *data)
 {
-    unsigned char *page_data_ptr = &current_flash_page_data[current_flash_subpage_index * 64];
-    memcpy(data, page_data_ptr, 64);
+    unsigned char *page_data_ptr = &flash_page_data[0][current_flash_subpage_index * FLASH_SUBPAGE_SIZE];
+    memcpy(data, page_data_ptr, FLASH_SUBPAGE_SIZE);
 
     current_flash_subpage_index++;
 
-    return 64;
+    return FLASH_SUBPAGE_SIZE;
 }
 
-static void begin_write()
+/* Standard (reflected) CRC-32 polynomial, as used by zlib and most host tools */
+#define FLASH_CRC32_POLY       (0xEDB88320)
+
+int flash_cmd_image_crc(unsigned pages, unsigned *crc, unsigned *length)
 {
-    int result;
-    // TODO this will take a long time. To minimise the amount of time spent
-    // paused on this operation it would be preferable to move to this to a
-    // seperate command, e.g. start_write.
-    do
+    unsigned checksum = 0xFFFFFFFF;
+    unsigned count = 0;
+
+    *crc = 0;
+    *length = 0;
+
+    if (!upgrade_image_valid)
+    {
+        return 1;
+    }
+
+    fl_startImageRead(&upgrade_image);
+
+    while ((pages == 0) || (count < pages))
     {
-        result = fl_startImageAdd(&factory_image, FLASH_MAX_UPGRADE_SIZE, 0);
-    } while (result > 0);
+        if (fl_readImagePage(flash_page_data[0]) != 0)
+        {
+            break;
+        }
+
+        for (int i = 0; i < FLASH_PAGE_SIZE; i += 4)
+        {
+            unsigned word;
+            memcpy(&word, &flash_page_data[0][i], 4);
+            asm volatile("crc32 %0, %2, %3" : "=r"(checksum) : "0"(checksum), "r"(word), "r"(FLASH_CRC32_POLY));
+        }
+        count++;
+    }
 
-    if (result < 0)
-        FLASH_ERROR();
+    *crc = ~checksum;
+    *length = count * FLASH_PAGE_SIZE;
+
+    return 0;
 }
 
 static int pages_written = 0;
 
+/* The erase and page writes are not done here but deferred to flash_cmd_write_deferred(), such that the
+ * control transfer carrying the data can complete first */
+static void begin_write()
+{
+    flash_erase_pending = 1;
+    flash_page_fill = 0;
+    flash_page_next_write = 0;
+    flash_pages_pending = 0;
+    current_flash_subpage_index = 0;
+    pages_written = 0;
+#if (XUA_DFU_DELTA)
+    delta_active = 0;
+#endif
+#if (XUA_DFU_COMPRESS)
+    lz_active = 0;
+#endif
+}
+
+int flash_cmd_write_deferred(void)
+{
+    if (flash_erase_pending)
+    {
+        int result;
+
+        do
+        {
+#if (XUA_DFU_DELTA)
+            /* A delta is written after the installed image, which it is read from */
+            result = fl_startImageAdd(delta_active ? &upgrade_image : &factory_image, FLASH_MAX_UPGRADE_SIZE, 0);
+#else
+            result = fl_startImageAdd(&factory_image, FLASH_MAX_UPGRADE_SIZE, 0);
+#endif
+        } while (result > 0);
+
+        if (result < 0)
+            FLASH_ERROR();
+
+        flash_erase_pending = 0;
+    }
+
+#if (XUA_DFU_DELTA)
+    while (delta_op_count)
+    {
+        delta_op_t *op = &delta_ops[delta_op_first];
+
+        while (op->count)
+        {
+            if (op->copy)
+            {
+                if (fl_readPage(upgrade_image.startAddress + op->src, delta_copy_page) != 0)
+                    FLASH_ERROR();
+
+                if (fl_writeImagePage(delta_copy_page) != 0)
+                    FLASH_ERROR();
+
+                op->src += FLASH_PAGE_SIZE;
+                delta_copy_pages--;
+            }
+            else
+            {
+                if (fl_writeImagePage(flash_page_data[flash_page_next_write]) != 0)
+                    FLASH_ERROR();
+
+                flash_page_next_write = (flash_page_next_write + 1) % FLASH_WRITE_PAGES;
+                flash_pages_pending--;
+            }
+            op->count--;
+            pages_written++;
+        }
+
+        delta_op_first = (delta_op_first + 1) % FLASH_DELTA_OPS;
+        delta_op_count--;
+    }
+
+    // Pages of a delta are only written by its operations
+    if (delta_active)
+    {
+        return 0;
+    }
+#endif
+
+    while (flash_pages_pending)
+    {
+        if (fl_writeImagePage(flash_page_data[flash_page_next_write]) != 0)
+            FLASH_ERROR();
+
+        flash_page_next_write = (flash_page_next_write + 1) % FLASH_WRITE_PAGES;
+        flash_pages_pending--;
+        pages_written++;
+    }
+
+    return 0;
+}
+
+unsigned flash_cmd_write_deferred_time(void)
+{
+    unsigned ms = flash_pages_pending * FLASH_PAGE_WRITE_MS;
+
+#if (XUA_DFU_DELTA)
+    ms += delta_copy_pages * FLASH_PAGE_WRITE_MS;
+#endif
+
+    if (flash_erase_pending)
+    {
+        ms += ((FLASH_MAX_UPGRADE_SIZE + 4095) / 4096) * FLASH_SECTOR_ERASE_MS;
+    }
+
+    return ms;
+}
+
+#if (XUA_DFU_DELTA)
+/* Queues pages for writing, merging with the last operation where possible */
+static void delta_queue(unsigned copy, unsigned src, unsigned count)
+{
+    if (delta_op_count)
+    {
+        delta_op_t *last = &delta_ops[(delta_op_first + delta_op_count - 1) % FLASH_DELTA_OPS];
+
+        if (!copy && !last->copy)
+        {
+            last->count += count;
+            return;
+        }
+    }
+
+    // No free operation, host has not waited out the poll timeout
+    if (delta_op_count == FLASH_DELTA_OPS)
+    {
+        flash_cmd_write_deferred();
+    }
+
+    delta_op_t *op = &delta_ops[(delta_op_first + delta_op_count) % FLASH_DELTA_OPS];
+    op->copy = copy;
+    op->src = src;
+    op->count = count;
+    delta_op_count++;
+
+    if (copy)
+    {
+        delta_copy_pages += count;
+    }
+}
+
+int flash_cmd_delta_begin(unsigned char *data)
+{
+    unsigned header[DFU_DELTA_HEADER_WORDS];
+    unsigned crc, length;
+
+    memcpy(header, data, sizeof(header));
+
+    if ((header[0] != DFU_DELTA_MAGIC) || (header[1] != DFU_DELTA_VERSION) || !upgrade_image_valid)
+    {
+        return 1;
+    }
+
+    // The delta only applies to the image it was made against
+    if ((flash_cmd_image_crc(header[2], &crc, &length) != 0) || (length != (header[2] * FLASH_PAGE_SIZE))
+        || (crc != header[3]) || ((header[4] * FLASH_PAGE_SIZE) > FLASH_MAX_UPGRADE_SIZE))
+    {
+        return 1;
+    }
+
+    begin_write();
+    delta_active = 1;
+    delta_state = DELTA_HEADER;
+    delta_words = DFU_DELTA_HEADER_WORDS;
+    flash_page_bytes = 0;
+    delta_op_first = 0;
+    delta_op_count = 0;
+    delta_copy_pages = 0;
+
+    return 0;
+}
+
+/* Interprets a sub-page of a delta image a word at a time */
+static void delta_write_page_data(unsigned char *data)
+{
+    for (int i = 0; i < FLASH_SUBPAGE_SIZE; i += 4)
+    {
+        unsigned word;
+        memcpy(&word, &data[i], 4);
+
+        switch (delta_state)
+        {
+            case DELTA_HEADER:
+                if (--delta_words == 0)
+                {
+                    delta_state = DELTA_CMD;
+                }
+                break;
+
+            case DELTA_CMD:
+                if ((DFU_DELTA_CMD(word) == DFU_DELTA_CMD_COPY) && DFU_DELTA_COUNT(word))
+                {
+                    delta_copy_count = DFU_DELTA_COUNT(word);
+                    delta_state = DELTA_COPY_SRC;
+                }
+                else if ((DFU_DELTA_CMD(word) == DFU_DELTA_CMD_DATA) && DFU_DELTA_COUNT(word))
+                {
+                    delta_words = DFU_DELTA_COUNT(word) * FLASH_PAGE_SIZE;
+                    delta_state = DELTA_DATA;
+                }
+                break;
+
+            case DELTA_COPY_SRC:
+                delta_queue(1, word, delta_copy_count);
+                delta_state = DELTA_CMD;
+                break;
+
+            case DELTA_DATA:
+                memcpy(&flash_page_data[flash_page_fill][flash_page_bytes], &word, 4);
+                flash_page_bytes += 4;
+
+                if (flash_page_bytes == FLASH_PAGE_SIZE)
+                {
+                    flash_page_bytes = 0;
+                    flash_page_fill = (flash_page_fill + 1) % FLASH_WRITE_PAGES;
+                    delta_queue(0, 0, 1);
+                    flash_pages_pending++;
+
+                    // No free buffer for the next page, host has not waited out the poll timeout
+                    if (flash_pages_pending == FLASH_WRITE_PAGES)
+                    {
+                        flash_cmd_write_deferred();
+                    }
+                }
+
+                delta_words -= 4;
+                if (delta_words == 0)
+                {
+                    delta_state = DELTA_CMD;
+                }
+                break;
+        }
+    }
+}
+#endif
+
+#if (XUA_DFU_COMPRESS)
+int flash_cmd_compressed_begin(unsigned char *data)
+{
+    unsigned header[DFU_LZ_HEADER_WORDS];
+
+    memcpy(header, data, sizeof(header));
+
+    if ((header[0] != DFU_LZ_MAGIC) || (header[1] != DFU_LZ_VERSION) || (header[2] > XUA_DFU_COMPRESS_WINDOW)
+        || (header[3] == 0) || ((header[3] * FLASH_PAGE_SIZE) > FLASH_MAX_UPGRADE_SIZE))
+    {
+        return 1;
+    }
+
+    flash_cmd_erase_all();
+    begin_write();
+    lz_active = 1;
+    lz_state = LZ_HEADER;
+    lz_count = DFU_LZ_HEADER_WORDS * 4;
+    lz_pages_left = header[3];
+    flash_page_bytes = 0;
+
+    return 0;
+}
+
+static void lz_output(unsigned char byte)
+{
+    lz_window[lz_window_pos] = byte;
+    lz_window_pos = (lz_window_pos + 1) & (XUA_DFU_COMPRESS_WINDOW - 1);
+
+    flash_page_data[flash_page_fill][flash_page_bytes++] = byte;
+
+    if (flash_page_bytes == FLASH_PAGE_SIZE)
+    {
+        flash_page_bytes = 0;
+        flash_page_fill = (flash_page_fill + 1) % FLASH_WRITE_PAGES;
+        flash_pages_pending++;
+
+        // No free buffer for the next page, the host has not waited out the poll timeout or a single sub-page
+        // decompressed to more pages than are buffered
+        if (flash_pages_pending == FLASH_WRITE_PAGES)
+        {
+            flash_cmd_write_deferred();
+        }
+
+        if (--lz_pages_left == 0)
+        {
+            lz_state = LZ_DONE;
+        }
+    }
+}
+
+/* Decodes a sub-page of a compressed image. Data after the last page, padding of the final block, is ignored */
+static void lz_write_page_data(unsigned char *data)
+{
+    for (int i = 0; (i < FLASH_SUBPAGE_SIZE) && (lz_state != LZ_DONE); i++)
+    {
+        unsigned byte = data[i];
+
+        switch (lz_state)
+        {
+            case LZ_HEADER:
+                if (--lz_count == 0)
+                {
+                    lz_state = LZ_TOKEN;
+                }
+                break;
+
+            case LZ_TOKEN:
+                if (byte & DFU_LZ_MATCH)
+                {
+                    lz_count = (byte & ~DFU_LZ_MATCH) + DFU_LZ_MIN_MATCH;
+                    lz_state = LZ_DIST_LO;
+                }
+                else
+                {
+                    lz_count = byte + 1;
+                    lz_state = LZ_LITERAL;
+                }
+                break;
+
+            case LZ_LITERAL:
+                lz_output(byte);
+                if ((lz_state != LZ_DONE) && (--lz_count == 0))
+                {
+                    lz_state = LZ_TOKEN;
+                }
+                break;
+
+            case LZ_DIST_LO:
+                lz_dist = byte;
+                lz_state = LZ_DIST_HI;
+                break;
+
+            case LZ_DIST_HI:
+                lz_dist = (lz_dist | (byte << 8)) + 1;
+                lz_state = LZ_TOKEN;
+
+                // Matches may overlap their own output, so are copied a byte at a time
+                while (lz_count-- && (lz_state != LZ_DONE))
+                {
+                    lz_output(lz_window[(lz_window_pos - lz_dist) & (XUA_DFU_COMPRESS_WINDOW - 1)]);
+                }
+                break;
+        }
+    }
+}
+#endif
+
 int flash_cmd_write_page(unsigned char *data)
 {
     unsigned int flag = *(unsigned int *)data;
 
+#if (XUA_DFU_DELTA)
+    if (delta_active && (flag == 2))
+    {
+        flash_cmd_write_deferred();
+
+        if (fl_endWriteImage() != 0)
+            FLASH_ERROR();
+
+        // The new image is complete, so the one it was made from may go
+        if (fl_deleteImage(&upgrade_image) != 0)
+            FLASH_ERROR();
+
+        upgrade_image = factory_image;
+        upgrade_image_valid = (fl_getNextBootImage(&upgrade_image) == 0);
+        delta_active = 0;
+        return 0;
+    }
+#endif
+
     if (upgrade_image_valid)
     {
         return 0;
@@ -170,50 +653,74 @@ int flash_cmd_write_page(unsigned char *data)
         case 0:
             // First page.
             begin_write();
-            pages_written = 0;
-            // fallthrough
+            break;
         case 1:
             // Do nothing.
             break;
         case 2:
-            // Termination.
+            // Termination, complete any outstanding writes first.
+            flash_cmd_write_deferred();
+
             if (fl_endWriteImage() != 0)
                 FLASH_ERROR();
 
-            // Sanity check
+            // Sanity check, and the new image is now the upgrade image
             fl_BootImageInfo image = factory_image;
             if (fl_getNextBootImage(&image) != 0)
+            {
                 FLASH_ERROR();
+            }
+            else
+            {
+                upgrade_image = image;
+                upgrade_image_valid = 1;
+            }
             break;
     }
-    current_flash_subpage_index = 0;
 
     return 0;
 }
 
 int flash_cmd_write_page_data(unsigned char *data)
 {
-    unsigned char *page_data_ptr = &current_flash_page_data[current_flash_subpage_index * 64];
+    unsigned char *page_data_ptr = &flash_page_data[flash_page_fill][current_flash_subpage_index * FLASH_SUBPAGE_SIZE];
 
-    if (upgrade_image_valid)
+#if (XUA_DFU_DELTA)
+    if (delta_active)
     {
+        delta_write_page_data(data);
         return 0;
     }
+#endif
+
+#if (XUA_DFU_COMPRESS)
+    if (lz_active)
+    {
+        lz_write_page_data(data);
+        return 0;
+    }
+#endif
 
-    if (current_flash_subpage_index >= 4)
+    if (upgrade_image_valid)
     {
         return 0;
     }
 
-    memcpy(page_data_ptr, data, 64);
+    memcpy(page_data_ptr, data, FLASH_SUBPAGE_SIZE);
 
     current_flash_subpage_index++;
 
-    if (current_flash_subpage_index == 4)
+    if (current_flash_subpage_index == FLASH_SUBPAGES)
     {
-        if (fl_writeImagePage(current_flash_page_data) != 0)
-            FLASH_ERROR();
-        pages_written++;
+        current_flash_subpage_index = 0;
+        flash_page_fill = (flash_page_fill + 1) % FLASH_WRITE_PAGES;
+        flash_pages_pending++;
+
+        // No free buffer for the next page, host has not waited out the poll timeout
+        if (flash_pages_pending == FLASH_WRITE_PAGES)
+        {
+            flash_cmd_write_deferred();
+        }
     }
 
     return 0;
@@ -251,5 +758,52 @@ int flash_cmd_erase_all(void)
     }
     return 0;
 }
+
+/* First page, within the data partition, of a data sector. -1 if there is no such sector */
+static int data_sector_first_page(unsigned sector)
+{
+    unsigned page = 0;
+
+    if (sector >= fl_getNumDataSectors())
+    {
+        return -1;
+    }
+
+    for (unsigned i = 0; i < sector; i++)
+    {
+        page += fl_getDataSectorSize(i) / FLASH_PAGE_SIZE;
+    }
+
+    return page;
+}
+
+int flash_cmd_data_read_page(unsigned sector, unsigned page, unsigned char *data)
+{
+    int first = data_sector_first_page(sector);
+
+    if ((first < 0) || (page >= (fl_getDataSectorSize(sector) / FLASH_PAGE_SIZE)))
+    {
+        return 1;
+    }
+
+    return fl_readDataPage(first + page, data) != 0;
+}
+
+int flash_cmd_data_write_page(unsigned sector, unsigned page, unsigned char *data)
+{
+    int first = data_sector_first_page(sector);
+
+    if ((first < 0) || (page >= (fl_getDataSectorSize(sector) / FLASH_PAGE_SIZE)))
+    {
+        return 1;
+    }
+
+    if ((page == 0) && (fl_eraseDataSector(sector) != 0))
+    {
+        return 1;
+    }
+
+    return fl_writeDataPage(first + page, data) != 0;
+}
 #endif
 
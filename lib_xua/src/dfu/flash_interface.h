@@ -1,20 +1,45 @@
-// Copyright 2011-2021 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #ifndef _flash_interface_h_
 #define _flash_interface_h_
 
+#include <xccompat.h>
+
 int flash_cmd_init(void);
 /**
  * Prepare to write a page of a new upgrade image.
  * The first word of data should be set to 0 if it is the first page,
  * 1 for all other pages and 2 to terminate the write (no further data is sent).
+ * Termination completes any deferred erase and page writes.
  */
 int flash_cmd_write_page(unsigned char []);
 /**
- * Provide upgrade image data. flash_cmd_write_page() must be called previously.
- * Once a page of data has been provided it is written to the device.
+ * Provide 64 bytes of upgrade image data. flash_cmd_write_page() must be called previously.
+ * Data is collected into pages, complete pages are queued and written by flash_cmd_write_deferred().
  */
 int flash_cmd_write_page_data(unsigned char []);
+/**
+ * Start writing a delta image (XUA_DFU_DELTA), in place of flash_cmd_write_page() with 0. data is the first 64
+ * bytes of the delta, its header. The installed upgrade image is kept and the rest of the delta, including the
+ * header, is passed to flash_cmd_write_page_data(). Termination deletes the installed image.
+ * Returns non-zero if the delta was not made against the installed upgrade image.
+ */
+int flash_cmd_delta_begin(unsigned char []);
+/**
+ * Start writing a compressed image (XUA_DFU_COMPRESS), in place of flash_cmd_write_page() with 0. data is the first
+ * 64 bytes of the image, its header. The upgrade images are erased as for an uncompressed image and the rest of the
+ * image, including the header, is passed to flash_cmd_write_page_data().
+ * Returns non-zero if the header is not valid or the image needs a larger window than XUA_DFU_COMPRESS_WINDOW.
+ */
+int flash_cmd_compressed_begin(unsigned char []);
+/**
+ * Perform the erase and page writes queued by flash_cmd_write_page() and flash_cmd_write_page_data().
+ */
+int flash_cmd_write_deferred(void);
+/**
+ * Estimate of the time in milliseconds flash_cmd_write_deferred() will take, 0 if nothing is queued.
+ */
+unsigned flash_cmd_write_deferred_time(void);
 /**
  * Read a page of data from the upgrade image.
  * If the first word of data is 0 the page is read from the start of the
@@ -27,6 +52,23 @@ int flash_cmd_read_page(unsigned char []);
  * Get data previously read by flash_cmd_read_page().
  */
 int flash_cmd_read_page_data(unsigned char []);
+/**
+ * Compute the CRC-32 (as zlib crc32()) of the upgrade image on the device, without transferring it.
+ * pages is the number of 256 byte pages to include from the start of the image, 0 for the whole image.
+ * On return length holds the number of bytes included, 0 if there is no upgrade image.
+ * Returns non-zero if there is no upgrade image. Restarts any upload in progress.
+ */
+int flash_cmd_image_crc(unsigned pages, REFERENCE_PARAM(unsigned, crc), REFERENCE_PARAM(unsigned, length));
+/**
+ * Read a 256 byte page of the flash data partition. Pages are numbered from the start of data sector sector.
+ * Returns non-zero if the page is not within the sector.
+ */
+int flash_cmd_data_read_page(unsigned sector, unsigned page, unsigned char []);
+/**
+ * Write a 256 byte page of the flash data partition, as flash_cmd_data_read_page(). Writing page 0 first erases
+ * the whole sector, so the pages of a sector must be written in order.
+ */
+int flash_cmd_data_write_page(unsigned sector, unsigned page, unsigned char []);
 int flash_cmd_erase_all(void);
 int flash_cmd_reboot(void);
 int flash_cmd_init(void);
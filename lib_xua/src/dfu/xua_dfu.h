@@ -1,4 +1,4 @@
-// Copyright 2011-2021 XMOS LIMITED.
+// Copyright 2011-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 #ifndef _XUA_DFU_H_
@@ -78,8 +78,8 @@ unsigned char DFUcfgDesc[] = {
     0x07,                           /* 2    bmAttributes */
     0xFA,                           /* 3    wDetachTimeOut */
     0x00,                           /* 4    wDetachTimeOut */
-    0x40,                           /* 5    wTransferSize */
-    0x00,                           /* 6    wTransferSize */
+    XUA_DFU_TRANSFER_SIZE & 0xFF,   /* 5    wTransferSize */
+    (XUA_DFU_TRANSFER_SIZE >> 8) & 0xFF, /* 6    wTransferSize */
     0x10,                           /* 7    bcdDFUVersion */
     0x01,                           /* 8    bcdDFUVersion */
 };
@@ -88,6 +88,11 @@ int DFUReportResetState(NULLABLE_RESOURCE(chanend , c_user_cmd));
 int DFUDeviceRequests(XUD_ep c_ep0_out, NULLABLE_REFERENCE_PARAM(XUD_ep, ep0_in), REFERENCE_PARAM(USB_SetupPacket_t, sp),
         NULLABLE_RESOURCE(chanend, c_user_cmd), unsigned int altInterface, CLIENT_INTERFACE(i_dfu, dfuInterface), REFERENCE_PARAM(int, reset));
 
+/* Access a 256 byte page of the flash data partition through the DFU handler, which may be on another tile.
+ * Return non-zero on error */
+int DFUDataReadPage(CLIENT_INTERFACE(i_dfu, dfuInterface), unsigned sector, unsigned page, unsigned char data[]);
+int DFUDataWritePage(CLIENT_INTERFACE(i_dfu, dfuInterface), unsigned sector, unsigned page, unsigned char data[]);
+
 /* Helper function for C */
 void DFUDelay(unsigned d);
 
@@ -1,4 +1,4 @@
-// Copyright 2021-2023 XMOS LIMITED.
+// Copyright 2021-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #include "xua_conf_full.h"
 #if XUA_HID_ENABLED
@@ -23,10 +23,17 @@
 swlock_t hidStaticVarLock = SWLOCK_INITIAL_VALUE;
 
 /*
- * Each element in s_hidChangePending corresponds to an element in hidReports.
+ * Each flag in s_hidChangePending corresponds to an element in hidReports.
+ * A flag is one byte so that hidSetChangePending() records a change with a single store and no lock,
+ * making it cheap to call from any thread on the tile. The flags are packed into words so that
+ * hidGetNextDueReportId() tests four Report IDs per load and skips words with no change.
  */
+#define HID_CHANGE_WORD_COUNT ( ( HID_REPORT_COUNT + 3U ) / 4U )
 
-static unsigned s_hidChangePending[ HID_REPORT_COUNT ];
+static union {
+    unsigned words[ HID_CHANGE_WORD_COUNT ];
+    unsigned char flags[ HID_CHANGE_WORD_COUNT * 4U ];
+} volatile s_hidChangePending;
 static unsigned char s_hidReportDescriptor[ HID_REPORT_DESCRIPTOR_MAX_LENGTH ];
 static size_t s_hidReportDescriptorLength;
 static unsigned s_hidReportDescriptorPrepared;
@@ -35,6 +42,25 @@ static unsigned s_hidCurrentPeriod[ HID_REPORT_COUNT ];
 static unsigned s_hidIdleActive[ HID_REPORT_COUNT ];
 static unsigned s_hidNextReportTime[ HID_REPORT_COUNT ];
 static unsigned s_hidReportTime[ HID_REPORT_COUNT ];
+static volatile unsigned s_hidChangeTime[ HID_REPORT_COUNT ];
+
+/*
+ * The earliest periodic report time of the reports that are not idle, kept up to date by the functions
+ * that alter the report times so that hidGetNextDueReportId() need only scan when a report is due.
+ */
+static unsigned s_hidEarliestReportTime;
+static unsigned s_hidPeriodicActive;
+
+/*
+ * Index into hidReports for each Report ID, built on first use since the Report IDs come from the
+ * application's hidReports elements. Report IDs are limited to 4 bits by the element location field.
+ */
+#define HID_REPORT_ID_INDEX_COUNT ( ( HID_REPORT_ELEMENT_LOC_ID_MASK >> HID_REPORT_ELEMENT_LOC_ID_SHIFT ) + 1U )
+#define HID_REPORT_INDEX_NONE     ( 0xFFU )
+
+static unsigned char s_hidReportIndex[ HID_REPORT_ID_INDEX_COUNT ];
+static unsigned s_hidReportIdLimit;
+static volatile unsigned s_hidReportIndexBuilt;
 
 /**
  * @brief Get the bit position from the location of a report element
@@ -123,6 +149,7 @@ static unsigned hidGetItemType( const unsigned char header );
  *
  * @return The USB HID Usage Page code or zero if the \a id parameter is out-of-range
  */
+static unsigned hidGetReportIndex( const unsigned id );
 static unsigned hidGetUsagePage( const unsigned id );
 
 /**
@@ -139,6 +166,13 @@ static unsigned hidGetUsagePage( const unsigned id );
  */
 static size_t hidTranslateItem( const USB_HID_Short_Item_t* inPtr, unsigned char** outPtrPtr );
 
+/**
+ * @brief Recalculate the earliest periodic report time
+ *
+ * Call with hidStaticVarLock held after altering a periodic report time, period or Idle state.
+ */
+static void hidUpdateEarliestReportTime( void );
+
 unsigned hidIsReportIdInUse ( void ) {
     return !hidIsReportIdValid(0U);
 }
@@ -146,10 +180,10 @@ unsigned hidIsReportIdInUse ( void ) {
 void hidCalcNextReportTime( const unsigned id )
 {
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            s_hidNextReportTime[ idx ] = s_hidReportTime[ idx ] + s_hidCurrentPeriod[ idx ];
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        s_hidNextReportTime[ idx ] = s_hidReportTime[ idx ] + s_hidCurrentPeriod[ idx ];
+        hidUpdateEarliestReportTime();
     }
     swlock_release(&hidStaticVarLock);
 }
@@ -157,10 +191,9 @@ void hidCalcNextReportTime( const unsigned id )
 void hidCaptureReportTime( const unsigned id, const unsigned time )
 {
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            s_hidReportTime[ idx ] = time;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        s_hidReportTime[ idx ] = time;
     }
     swlock_release(&hidStaticVarLock);
 }
@@ -168,11 +201,9 @@ void hidCaptureReportTime( const unsigned id, const unsigned time )
 void hidClearChangePending( const unsigned id )
 {
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if(( id == 0U ) || ( id == hidGetElementReportId( hidReports[ idx ]->location ))) {
-            s_hidChangePending[ idx ] = 0U;
-            break;
-        }
+    unsigned idx = ( id == 0U ) ? 0U : hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        s_hidChangePending.flags[ idx ] = 0U;
     }
     swlock_release(&hidStaticVarLock);
 }
@@ -219,15 +250,85 @@ static unsigned hidGetItemType( const unsigned char header )
     return bType;
 }
 
+/**
+ * @brief Get the index into hidReports for a Report ID
+ *
+ * Must be called with hidStaticVarLock held.
+ *
+ * Parameters:
+ *
+ *  @param[in] id           The Report ID, zero if Report IDs are not in use
+ *
+ * @return The index of the report, or HID_REPORT_INDEX_NONE if the Report ID is not in use
+ */
+static unsigned hidGetReportIndex( const unsigned id )
+{
+    if( !s_hidReportIndexBuilt ) {
+        memset( s_hidReportIndex, HID_REPORT_INDEX_NONE, sizeof( s_hidReportIndex ));
+        s_hidReportIdLimit = 0U;
+
+        /* Walk backwards so the first element with a given Report ID wins, as the linear searches did */
+        for( size_t idx = HID_REPORT_COUNT; idx-- > 0U; ) {
+            unsigned reportId = hidGetElementReportId( hidReports[ idx ]->location );
+            s_hidReportIndex[ reportId ] = (unsigned char) idx;
+            if( reportId >= s_hidReportIdLimit ) {
+                s_hidReportIdLimit = reportId + 1;
+            }
+        }
+        s_hidReportIndexBuilt = 1U;
+    }
+
+    return ( id < HID_REPORT_ID_INDEX_COUNT ) ? s_hidReportIndex[ id ] : HID_REPORT_INDEX_NONE;
+}
+
+unsigned hidGetNextDueReportId( const unsigned time )
+{
+    unsigned retVal = HID_REPORT_ID_NONE;
+    int earliest = 0;
+    unsigned changed = 0U;
+
+    /* Nothing is due in the common case, so test that without the lock. A stale read only delays a
+     * report to the next call */
+    for( size_t word = 0U; word < HID_CHANGE_WORD_COUNT; ++word ) {
+        changed |= s_hidChangePending.words[ word ];
+    }
+    if( !changed && ( !s_hidPeriodicActive || ( (int)( s_hidEarliestReportTime - time ) > 0 ))) {
+        return retVal;
+    }
+
+    swlock_acquire(&hidStaticVarLock);
+    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
+        unsigned deadline;
+
+        if( s_hidChangePending.flags[ idx ] ) {
+            deadline = s_hidChangeTime[ idx ];
+        } else if( !s_hidIdleActive[ idx ] && ( 0U != s_hidCurrentPeriod[ idx ] ) &&
+                   ( (int)( s_hidNextReportTime[ idx ] - time ) <= 0 )) {
+            deadline = s_hidNextReportTime[ idx ];
+        } else {
+            continue;
+        }
+
+        /* Earliest deadline first, ties go to the lowest index */
+        int age = (int)( time - deadline );
+        if(( HID_REPORT_ID_NONE == retVal ) || ( age > earliest )) {
+            retVal = hidGetElementReportId( hidReports[ idx ]->location );
+            earliest = age;
+        }
+    }
+    swlock_release(&hidStaticVarLock);
+
+    return retVal;
+}
+
 unsigned hidGetNextReportTime( const unsigned id ) {
     swlock_acquire(&hidStaticVarLock);
     unsigned retVal = 0U;
 
-    for ( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            retVal = s_hidNextReportTime[ idx ];
-        }
-     }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retVal = s_hidNextReportTime[ idx ];
+    }
     swlock_release(&hidStaticVarLock);
     return retVal;
 }
@@ -254,15 +355,9 @@ size_t hidGetReportDescriptorLength( void )
 }
 
 unsigned hidGetReportIdLimit ( void ) {
-    unsigned retVal = 0U;
-
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        unsigned reportId = hidGetElementReportId( hidReports[ idx ]->location );
-        if( reportId >= retVal ) {
-            retVal = reportId + 1;
-        }
-    }
+    hidGetReportIndex( 0U );
+    unsigned retVal = s_hidReportIdLimit;
     swlock_release(&hidStaticVarLock);
     return retVal;
 }
@@ -270,12 +365,9 @@ unsigned hidGetReportIdLimit ( void ) {
 unsigned hidGetNextValidReportId ( unsigned idPrev ) {
     size_t retIndex = 0;
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        unsigned reportId = hidGetElementReportId( hidReports[ idx ]->location );
-        if( reportId == idPrev ) {
-            retIndex = (idx + 1) % HID_REPORT_COUNT;
-            break;
-        }
+    unsigned idx = hidGetReportIndex( idPrev );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retIndex = (idx + 1) % HID_REPORT_COUNT;
     }
 
     unsigned retVal = hidGetElementReportId( hidReports[ retIndex ]->location );
@@ -327,10 +419,9 @@ size_t hidGetReportLength( const unsigned id )
     swlock_acquire(&hidStaticVarLock);
     size_t retVal = 0U;
     if( s_hidReportDescriptorPrepared ) {
-        for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-            if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-                retVal = hidGetElementReportLength( hidReports[ idx ]->location );
-            }
+        unsigned idx = hidGetReportIndex( id );
+        if( HID_REPORT_INDEX_NONE != idx ) {
+            retVal = hidGetElementReportLength( hidReports[ idx ]->location );
         }
     }
     swlock_release(&hidStaticVarLock);
@@ -341,11 +432,9 @@ unsigned hidGetReportPeriod( const unsigned id )
 {
     swlock_acquire(&hidStaticVarLock);
     unsigned retVal = 0U;
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            retVal = s_hidCurrentPeriod[ idx ];
-            break;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retVal = s_hidCurrentPeriod[ idx ];
     }
     swlock_release(&hidStaticVarLock);
     return retVal;
@@ -356,10 +445,9 @@ unsigned hidGetReportTime( const unsigned id )
     swlock_acquire(&hidStaticVarLock);
     unsigned retVal = 0U;
 
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            retVal = s_hidReportTime[ idx ];
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retVal = s_hidReportTime[ idx ];
     }
 
     swlock_release(&hidStaticVarLock);
@@ -371,11 +459,9 @@ static unsigned hidGetUsagePage( const unsigned id )
     unsigned retVal = 0U;
     swlock_acquire(&hidStaticVarLock);
 
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            retVal = hidReports[ idx ]->item.data[ 0 ];
-            break;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retVal = hidReports[ idx ]->item.data[ 0 ];
     }
 
     swlock_release(&hidStaticVarLock);
@@ -387,11 +473,9 @@ unsigned hidIsChangePending( const unsigned id )
     unsigned retVal = 0U;
     swlock_acquire(&hidStaticVarLock);
 
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            retVal  = ( s_hidChangePending[ idx ] != 0U );
-            break;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retVal  = ( s_hidChangePending.flags[ idx ] != 0U );
     }
 
   swlock_release(&hidStaticVarLock);
@@ -403,11 +487,9 @@ unsigned hidIsIdleActive( const unsigned id )
     unsigned retVal = 0U;
 
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            retVal  = ( s_hidIdleActive[ idx ] != 0U );
-            break;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        retVal  = ( s_hidIdleActive[ idx ] != 0U );
     }
     swlock_release(&hidStaticVarLock);
     return retVal;
@@ -425,13 +507,7 @@ unsigned hidIsReportIdValid ( unsigned id ) {
     size_t retVal = 0;
 
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        unsigned reportId = hidGetElementReportId( hidReports[ idx ]->location );
-        if( reportId == id ) {
-            retVal = 1;
-            break;
-        }
-    }
+    retVal = ( HID_REPORT_INDEX_NONE != hidGetReportIndex( id ));
 
     swlock_release(&hidStaticVarLock);
     return retVal;
@@ -460,7 +536,13 @@ void hidReportInit( void )
         s_hidCurrentPeriod[ idx ] = ENDPOINT_INT_INTERVAL_IN_HID * MS_IN_TICKS * HID_REPORT_COUNT;
     }
     memset( s_hidIdleActive, 0, sizeof( s_hidIdleActive ) );
-    memset( s_hidChangePending, 0, sizeof( s_hidChangePending ) );
+    for( unsigned word = 0U; word < HID_CHANGE_WORD_COUNT; ++word ) {
+        s_hidChangePending.words[ word ] = 0U;
+    }
+    hidUpdateEarliestReportTime();
+
+    /* Build the Report ID index now so that hidSetChangePending() can use it without the lock */
+    (void) hidGetReportIndex( 0U );
     swlock_release(&hidStaticVarLock);
 }
 
@@ -473,24 +555,35 @@ void hidResetReportDescriptor( void )
 
 void hidSetChangePending( const unsigned id )
 {
-    swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            s_hidChangePending[ idx ] = 1U;
-            break;
+    unsigned time;
+    asm volatile( "gettime %0" : "=r" ( time ));
+
+    if( !s_hidReportIndexBuilt ) {
+        swlock_acquire(&hidStaticVarLock);
+        (void) hidGetReportIndex( 0U );
+        swlock_release(&hidStaticVarLock);
+    }
+
+    /* Lock-free: the index is not altered once built and each flag is written with a single byte store.
+     * The time is written before the flag so the flag is never seen without its deadline. A change that
+     * races with hidClearChangePending() may keep an older deadline, so is only reported sooner */
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        /* The deadline is set by the first unreported change */
+        if( !s_hidChangePending.flags[ idx ] ) {
+            s_hidChangeTime[ idx ] = time;
         }
+        s_hidChangePending.flags[ idx ] = 1U;
     }
-    swlock_release(&hidStaticVarLock);
 }
 
 void hidSetIdle( const unsigned id, const unsigned state )
 {
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            s_hidIdleActive[ idx ] = ( state != 0U );
-            break;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        s_hidIdleActive[ idx ] = ( state != 0U );
+        hidUpdateEarliestReportTime();
     }
     swlock_release(&hidStaticVarLock);
 }
@@ -498,10 +591,10 @@ void hidSetIdle( const unsigned id, const unsigned state )
 void hidSetNextReportTime( const unsigned id, const unsigned time )
 {
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            s_hidNextReportTime[ idx ] = time;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        s_hidNextReportTime[ idx ] = time;
+        hidUpdateEarliestReportTime();
     }
     swlock_release(&hidStaticVarLock);
 }
@@ -572,15 +665,35 @@ unsigned hidSetReportItem(
 void hidSetReportPeriod( const unsigned id, const unsigned period )
 {
     swlock_acquire(&hidStaticVarLock);
-    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx) {
-        if( id == hidGetElementReportId( hidReports[ idx ]->location )) {
-            s_hidCurrentPeriod[ idx ] = period;
-            break;
-        }
+    unsigned idx = hidGetReportIndex( id );
+    if( HID_REPORT_INDEX_NONE != idx ) {
+        s_hidCurrentPeriod[ idx ] = period;
+        hidUpdateEarliestReportTime();
     }
     swlock_release(&hidStaticVarLock);
 }
 
+static void hidUpdateEarliestReportTime( void )
+{
+    unsigned now;
+    int earliest = 0;
+    unsigned active = 0U;
+
+    asm volatile( "gettime %0" : "=r" ( now ));
+
+    for( size_t idx = 0U; idx < HID_REPORT_COUNT; ++idx ) {
+        if( !s_hidIdleActive[ idx ] && ( 0U != s_hidCurrentPeriod[ idx ] )) {
+            int due = (int)( s_hidNextReportTime[ idx ] - now );
+            if( !active || ( due < earliest )) {
+                s_hidEarliestReportTime = s_hidNextReportTime[ idx ];
+                earliest = due;
+                active = 1U;
+            }
+        }
+    }
+    s_hidPeriodicActive = active;
+}
+
 static size_t hidTranslateItem( const USB_HID_Short_Item_t* inPtr, unsigned char** outPtrPtr )
 {
     size_t count = 0U;
@@ -1,4 +1,4 @@
-// Copyright 2021-2022 XMOS LIMITED.
+// Copyright 2021-2024 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 /**
@@ -83,6 +83,9 @@
 
 #define MS_IN_TICKS 100000U
 
+/* Returned by hidGetNextDueReportId() when no HID Report is due. Report IDs are 8-bit */
+#define HID_REPORT_ID_NONE ( 0x100U )
+
 /**
  * @brief USB HID Report Descriptor Short Item
  *
@@ -268,6 +271,28 @@ unsigned hidGetReportItem(
     unsigned char data[]);
 #endif
 
+/**
+ * @brief Get the Report ID of the HID Report to send next
+ *
+ * A HID Report is due if it has changed data not yet sent to the USB Host, or
+ *   if it is not idle and its periodic report time has been reached.
+ * Of the due HID Reports, the one that has waited longest since its first
+ *   unreported change or its periodic report time is returned. Calling this
+ *   each time the previous HID Report has been sent therefore services many
+ *   Report IDs in successive interrupt IN transactions, oldest first.
+ * When no HID Report is due this returns without taking the HID lock or
+ *   scanning the Report IDs, so it may be polled often.
+ *
+ * Parameters:
+ *
+ *  @param[in]  time  The current time
+ *
+ *  @returns  The Report ID of the HID Report to send, zero if the application
+ *              does not use Report IDs, or \c HID_REPORT_ID_NONE if no HID
+ *              Report is due
+ */
+unsigned hidGetNextDueReportId( const unsigned time );
+
 /**
  * @brief Get the time to send the next HID Report for the given \a id
  *
@@ -447,6 +472,11 @@ void hidResetReportDescriptor( void );
  *    for that Report ID has changed and has not yet been reported to the USB
  *    Host.
  *
+ *  This function does not take the HID lock, so may be called from any
+ *    thread on the tile each time a report element is updated. Only the
+ *    Report IDs with a change pending are rebuilt by \c UserHIDGetData()
+ *    ahead of their periodic report time.
+ *
  *  \warning This function will fail silently if given an id that is not
  *    either the value zero (in the case that Report IDs are not in use),
  *    or a Report ID that is in use.
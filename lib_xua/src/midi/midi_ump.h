@@ -0,0 +1,42 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef MIDI_UMP_H
+#define MIDI_UMP_H
+
+/* Translation between USB MIDI 2.0 Universal MIDI Packets (UMP) and the MIDI 1.0 byte stream of the UARTs
+ * (XUA_MIDI_UMP). UMPs from the host are converted to MIDI 1.0 bytes, MIDI 2.0 channel voice messages being scaled
+ * down to MIDI 1.0 resolution. USB MIDI 1.0 events from midi_in_parse() are converted to UMPs, channel voice messages
+ * being scaled up to MIDI 2.0 channel voice messages. The UMP group is the USB MIDI cable number (port) */
+
+/* Largest UMP in words, and the most MIDI 1.0 bytes one UMP is converted to (an RPN gives four control changes) */
+#define MIDI_UMP_MAX_WORDS      (4)
+#define MIDI_UMP_MAX_BYTES      (12)
+
+/* Message types */
+#define MIDI_UMP_MT_SYSTEM      (0x1)
+#define MIDI_UMP_MT_MIDI1_CV    (0x2)
+#define MIDI_UMP_MT_SYSEX7      (0x3)
+#define MIDI_UMP_MT_MIDI2_CV    (0x4)
+
+#define MIDI_UMP_GROUP(w0)      (((w0) >> 24) & 0xF)
+
+/* State for the conversion of USB MIDI 1.0 events to UMPs, holding the SysEx data bytes not yet sent */
+struct midi_ump_in_state {
+    unsigned sysex[6];
+    unsigned count;
+    unsigned started;       // A SysEx start packet has been sent for this message
+};
+
+#ifdef __XC__
+void midi_ump_reset(struct midi_ump_in_state &state);
+
+/* Converts the UMP in ump[] (MIDI_UMP_WORDS(ump[0]) words) into MIDI 1.0 bytes. Returns the number of bytes written
+ * to bytes[], 0 for messages with no MIDI 1.0 equivalent (which are dropped) */
+unsigned midi_ump_to_bytes(const unsigned ump[MIDI_UMP_MAX_WORDS], unsigned bytes[MIDI_UMP_MAX_BYTES]);
+
+/* Converts a USB MIDI 1.0 event, as returned by midi_in_parse(), into UMPs. Returns the number of words written to
+ * ump[], which may be 0 (SysEx bytes held for the next packet) or hold two SysEx packets */
+unsigned midi_ump_from_event(struct midi_ump_in_state &state, unsigned event, unsigned ump[MIDI_UMP_MAX_WORDS]);
+#endif
+
+#endif
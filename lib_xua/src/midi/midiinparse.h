@@ -24,6 +24,12 @@ struct midi_in_parse_state {
 void reset_midi_state(struct midi_in_parse_state &mips);
 void dump_midi_in_parse_state(struct midi_in_parse_state &s);
 {unsigned int , unsigned int} midi_in_parse(struct midi_in_parse_state &mips, unsigned cable_number, unsigned char b);
+
+/* Parses up to count bytes into USB MIDI events, stopping early once max_events have been produced.
+ * Returns the number of bytes consumed and the number of events written to events[]. Each byte produces at most
+ * one event so max_events >= count always consumes every byte */
+{unsigned, unsigned} midi_in_parse_bytes(struct midi_in_parse_state &mips, unsigned cable_number,
+    const unsigned char bytes[], unsigned count, unsigned events[], unsigned max_events);
 #endif
 
 #endif
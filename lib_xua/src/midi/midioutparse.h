@@ -9,6 +9,9 @@
 #ifdef __XC__
 // Takes a MIDI packet and decomoses it into up to 3 data bytes followed by a byte count.
 {unsigned, unsigned, unsigned, unsigned} midi_out_parse(unsigned event);
+
+// Returns the cable number of a MIDI packet
+unsigned midi_out_parse_cable(unsigned event);
 #endif
 
 #endif
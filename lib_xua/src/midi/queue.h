@@ -16,6 +16,22 @@ typedef struct queue_t {
     unsigned mask;
 } queue_t;
 
+/* Single producer, single consumer variant of queue_t that may be shared between two threads on the same tile
+ * through unsafe pointers. The producer only writes wrptr and the consumer only writes rdptr. All accesses by both
+ * sides are volatile so the compiler keeps the data access ordered with respect to the index update that publishes
+ * it, which is sufficient since threads on a tile see memory accesses in program order.
+ *
+ * Unlike queue_t, pushing to a full queue or popping from an empty queue is not an error since the other thread
+ * may not have caught up yet - the functions return how many words were transferred */
+typedef struct queue_spsc_t {
+    /// Read index, written by the consumer only.
+    unsigned rdptr;
+    /// Write index, written by the producer only.
+    unsigned wrptr;
+    unsigned size;
+    unsigned mask;
+} queue_spsc_t;
+
 #ifdef __XC__
 
 inline int is_power_of_2(unsigned x) {
@@ -69,6 +85,112 @@ inline unsigned queue_space(const queue_t &q) {
     return q.size - queue_items(q);
 }
 
+/* Must be called before the queue is shared */
+inline void queue_spsc_init(queue_spsc_t volatile * unsafe q, unsigned size) {
+    xassert(is_power_of_2(size) && "SPSC FIFO size must be a power of 2");
+    unsafe {
+        q->rdptr = 0;
+        q->wrptr = 0;
+        q->size = size;
+        q->mask = size - 1;
+    }
+}
+
+inline unsigned queue_spsc_items(queue_spsc_t volatile * unsafe q) {
+    unsafe {
+        return q->wrptr - q->rdptr;
+    }
+}
+
+inline unsigned queue_spsc_space(queue_spsc_t volatile * unsafe q) {
+    unsafe {
+        return q->size - (q->wrptr - q->rdptr);
+    }
+}
+
+/* Producer: returns 1 if data was pushed, 0 if the queue was full */
+inline int queue_spsc_push_word(queue_spsc_t volatile * unsafe q, unsigned volatile * unsafe array, unsigned data) {
+    unsafe {
+        unsigned wrptr = q->wrptr;
+
+        if(wrptr - q->rdptr == q->size)
+            return 0;
+
+        array[wrptr & q->mask] = data;
+        q->wrptr = wrptr + 1;
+        return 1;
+    }
+}
+
+/* Consumer: returns 1 and sets data if a word was popped, 0 if the queue was empty */
+inline int queue_spsc_pop_word(queue_spsc_t volatile * unsafe q, unsigned volatile * unsafe array, unsigned &data) {
+    unsafe {
+        unsigned rdptr = q->rdptr;
+
+        if(q->wrptr == rdptr)
+            return 0;
+
+        data = array[rdptr & q->mask];
+        q->rdptr = rdptr + 1;
+        return 1;
+    }
+}
+
+/* Producer: pushes up to count words from src, in at most two contiguous copies, and publishes them together.
+ * Returns the number of words pushed */
+inline unsigned queue_spsc_push_words(queue_spsc_t volatile * unsafe q, unsigned volatile * unsafe array,
+    const unsigned * unsafe src, unsigned count) {
+    unsafe {
+        unsigned wrptr = q->wrptr;
+        unsigned space = q->size - (wrptr - q->rdptr);
+        unsigned start = wrptr & q->mask;
+        unsigned first;
+
+        if(count > space)
+            count = space;
+
+        /* Span up to the end of the array, then the remainder from the start */
+        first = q->size - start;
+        if(first > count)
+            first = count;
+
+        for(unsigned i = 0; i < first; i++)
+            array[start + i] = src[i];
+        for(unsigned i = first; i < count; i++)
+            array[i - first] = src[i];
+
+        q->wrptr = wrptr + count;
+        return count;
+    }
+}
+
+/* Consumer: pops up to count words into dst, in at most two contiguous copies, and releases them together.
+ * Returns the number of words popped */
+inline unsigned queue_spsc_pop_words(queue_spsc_t volatile * unsafe q, unsigned volatile * unsafe array,
+    unsigned * unsafe dst, unsigned count) {
+    unsafe {
+        unsigned rdptr = q->rdptr;
+        unsigned items = q->wrptr - rdptr;
+        unsigned start = rdptr & q->mask;
+        unsigned first;
+
+        if(count > items)
+            count = items;
+
+        first = q->size - start;
+        if(first > count)
+            first = count;
+
+        for(unsigned i = 0; i < first; i++)
+            dst[i] = array[start + i];
+        for(unsigned i = first; i < count; i++)
+            dst[i] = array[i - first];
+
+        q->rdptr = rdptr + count;
+        return count;
+    }
+}
+
 #endif // __XC__
 
 #endif /* QUEUE_H_ */
@@ -0,0 +1,53 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include "xua.h"
+#include "xua_midi_timing.h"
+
+#if defined(MIDI) && (XUA_MIDI_TIMING)
+
+#include <string.h>
+
+xua_midi_timing_t g_xua_midi_timing[XUA_MIDI_TIMING_DIR_COUNT];
+unsigned g_xua_midi_timing_reset = (1 << XUA_MIDI_TIMING_DIR_COUNT) - 1;
+
+void XUA_MidiTiming_Clock(unsigned dir, unsigned time)
+{
+    xua_midi_timing_t *stats = &g_xua_midi_timing[dir];
+    unsigned interval;
+
+    if(g_xua_midi_timing_reset & (1 << dir))
+    {
+        g_xua_midi_timing_reset &= ~(1 << dir);
+        memset(stats, 0, sizeof(xua_midi_timing_t));
+        stats->lastTime = time;
+        return;
+    }
+
+    interval = time - stats->lastTime;
+    stats->lastTime = time;
+
+    if(stats->lastInterval)
+    {
+        int diff = (int)(interval - stats->lastInterval);
+        unsigned jitter = diff < 0 ? -diff : diff;
+        unsigned bin = jitter / XUA_MIDI_JITTER_BIN_TICKS;
+
+        if(bin >= XUA_MIDI_JITTER_HIST_BINS)
+            bin = XUA_MIDI_JITTER_HIST_BINS - 1;
+
+        stats->count++;
+        stats->hist[bin]++;
+        if(jitter > stats->maxJitter)
+            stats->maxJitter = jitter;
+
+        stats->interval += ((int)(interval - stats->interval)) >> 4;
+    }
+    else
+    {
+        stats->interval = interval;
+    }
+
+    stats->lastInterval = interval;
+}
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef _XUA_MIDI_TIMING_H_
+#define _XUA_MIDI_TIMING_H_
+
+#include <xccompat.h>
+#include "xua.h"
+
+/* MIDI timing measurement (XUA_MIDI_TIMING). Each MIDI timing clock (0xF8) is time stamped with the reference
+ * timer at its start bit, as it is received on the MIDI input or as it starts on the MIDI output. The jitter of
+ * each direction is the difference between successive clock intervals */
+
+#define XUA_MIDI_TIMING_RX          (0)     /* MIDI input -> host */
+#define XUA_MIDI_TIMING_TX          (1)     /* Host -> MIDI output */
+#define XUA_MIDI_TIMING_DIR_COUNT   (2)
+
+/* MIDI timing clock status byte */
+#define XUA_MIDI_TIMING_CLOCK       (0xF8)
+
+#ifndef REF_CLK_FREQ
+#define REF_CLK_FREQ                (100)
+#endif
+#define XUA_MIDI_JITTER_BIN_TICKS   (XUA_MIDI_JITTER_BIN_US * REF_CLK_FREQ)
+
+#ifndef __XC__
+typedef struct
+{
+    unsigned count;                 /* Intervals measured */
+    unsigned lastTime;              /* Time stamp of the last clock */
+    unsigned lastInterval;          /* Last clock interval, 0 until two clocks have been seen */
+    unsigned interval;              /* Mean clock interval (IIR, 1/16 weighting) */
+    unsigned maxJitter;
+    unsigned hist[XUA_MIDI_JITTER_HIST_BINS];
+} xua_midi_timing_t;
+
+/* Stats for each direction, shared with Endpoint 0 */
+extern xua_midi_timing_t g_xua_midi_timing[XUA_MIDI_TIMING_DIR_COUNT];
+#endif
+
+/* Bit mask of directions to reset, set by Endpoint 0 and serviced by the MIDI thread */
+extern unsigned g_xua_midi_timing_reset;
+
+/** Record a MIDI timing clock in direction dir, time stamped at its start bit */
+void XUA_MidiTiming_Clock(unsigned dir, unsigned time);
+
+#endif
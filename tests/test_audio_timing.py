@@ -0,0 +1,152 @@
+# Copyright 2024 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
+import os
+import pytest
+import Pyxsim
+from Pyxsim import testers
+
+TIMING_PREFIX = "AUDIO_TIMING: "
+
+# Report table and raw results, written at the end of the run
+TIMING_REPORT_FILE = os.environ.get("AUDIO_TIMING_REPORT", "audio_timing_report.txt")
+TIMING_RESULTS_FILE = os.environ.get("AUDIO_TIMING_RESULTS", "audio_timing.json")
+
+timing_results = {}
+
+
+class TimingTester(testers.ComparisonTester):
+    """Checks for PASS and captures the timing result line"""
+
+    def __init__(self):
+        super().__init__(open("pass.expect"), ignore=[TIMING_PREFIX])
+        self.result = None
+
+    def run(self, output):
+        for line in output:
+            if line.startswith(TIMING_PREFIX):
+                self.result = json.loads(line[len(TIMING_PREFIX) :])
+        return super().run(output)
+
+
+def write_report():
+    header = f"{'config':<44} {'period':>8} {'busy max':>8} {'slack':>8} {'margin':>7} {'xchg max':>8}  result"
+    lines = [header, "-" * len(header)]
+    max_chans = {}
+
+    for desc, r in sorted(timing_results.items()):
+        lines.append(
+            f"{desc:<44} {r['audiohub_period_avg']:>8} {r['audiohub_busy_max']:>8} {r['slack']:>8} "
+            f"{r['margin_pct']:>6}% {r['exchange_max']:>8}  {'PASS' if r['slack'] > 0 else 'FAIL'}"
+        )
+        if r["slack"] > 0:
+            key = (r["pcm_format"], r["i2s_role"], r["sample_rate"], r["word_length"])
+            max_chans[key] = max(max_chans.get(key, 0), r["channel_count"])
+
+    lines += ["", "Maximum channel count with positive slack:"]
+    for (pcm_format, i2s_role, sample_rate, word_length), chans in sorted(max_chans.items()):
+        lines.append(f"  {pcm_format} {i2s_role} {sample_rate}Hz {word_length}bit: {chans}")
+
+    with open(TIMING_REPORT_FILE, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+    with open(TIMING_RESULTS_FILE, "w") as f:
+        json.dump(timing_results, f, indent=2, sort_keys=True)
+
+
+@pytest.fixture(scope="module", autouse=True)
+def timing_report():
+    yield
+    if timing_results:
+        write_report()
+
+
+def do_test(pcm_format, i2s_role, channel_count, sample_rate, word_length, test_file, options, capfd):
+
+    build_options = []
+    testname, _ = os.path.splitext(os.path.basename(test_file))
+
+    build_options += [f"pcm_format={pcm_format}"]
+    build_options += [f"i2s_role={i2s_role}"]
+    build_options += [f"channel_count={channel_count}"]
+    build_options += [f"sample_rate={sample_rate}"]
+    build_options += [f"word_length={word_length}"]
+
+    desc = f"timing_{pcm_format}_{i2s_role}_{channel_count}in_{channel_count}out_{sample_rate}_{word_length}bit"
+    binary = f"{testname}/bin/{desc}/{testname}_{desc}.xe"
+
+    tester = TimingTester()
+
+    # As test_i2s_loopback
+    loopback_args = (
+        "-port tile[0] XS1_PORT_1M 1 0 -port tile[0] XS1_PORT_1I 1 0 "
+        + "-port tile[0] XS1_PORT_1N 1 0 -port tile[0] XS1_PORT_1J 1 0 "
+        + "-port tile[0] XS1_PORT_1O 1 0 -port tile[0] XS1_PORT_1K 1 0 "
+        + "-port tile[0] XS1_PORT_1P 1 0 -port tile[0] XS1_PORT_1L 1 0 "
+        + "-port tile[0] XS1_PORT_1A 1 0 -port tile[0] XS1_PORT_1F 1 0 "
+    )
+    if i2s_role == "slave":
+        loopback_args += "-port tile[0] XS1_PORT_1B 1 0 -port tile[0] XS1_PORT_1H 1 0 "  # bclk
+        loopback_args += "-port tile[0] XS1_PORT_1C 1 0 -port tile[0] XS1_PORT_1G 1 0 "  # lrclk
+
+    max_cycles = 1500000
+
+    simargs = [
+        "--max-cycles",
+        str(max_cycles),
+        "--plugin",
+        "LoopbackPort.dll",
+        loopback_args,
+    ]
+
+    result = Pyxsim.run_on_simulator(
+        binary,
+        build_options=build_options,
+        tester=tester,
+        simargs=simargs,
+        capfd=capfd,
+        instTracing=options.enabletracing,
+        vcdTracing=options.enablevcdtracing,
+    )
+
+    assert result
+    assert tester.result is not None, "No timing result reported"
+
+    r = tester.result
+    r.update(
+        pcm_format=pcm_format,
+        i2s_role=i2s_role,
+        channel_count=channel_count,
+        sample_rate=sample_rate,
+        word_length=word_length,
+    )
+    r["slack"] = r["audiohub_period_avg"] - r["audiohub_busy_max"]
+    r["margin_pct"] = (100 * r["slack"] // r["audiohub_period_avg"]) if r["audiohub_period_avg"] else 0
+    timing_results[desc] = r
+
+    return r
+
+
+@pytest.mark.parametrize("i2s_role", ["master", "slave"])
+@pytest.mark.parametrize("pcm_format", ["i2s", "tdm"])
+@pytest.mark.parametrize("channel_count", [2, 8, 16])
+@pytest.mark.parametrize("word_length", [16, 32])  # I2S world length in bits
+@pytest.mark.parametrize("sample_rate", [48000, 96000, 192000])
+def test_audio_timing(i2s_role, pcm_format, channel_count, sample_rate, word_length, test_file, options, capfd):
+
+    # Same valid combinations as test_i2s_loopback
+    if pcm_format == "i2s" and channel_count == 16:
+        pytest.skip("Invalid parameter combination")
+
+    if pcm_format == "i2s" and sample_rate not in [48000, 192000]:
+        pytest.skip("Invalid parameter combination")
+
+    if pcm_format == "tdm" and channel_count == 2:
+        pytest.skip("Invalid parameter combination")
+
+    if pcm_format == "tdm" and sample_rate == 192000:
+        pytest.skip("Invalid parameter combination")
+
+    r = do_test(pcm_format, i2s_role, channel_count, sample_rate, word_length, test_file, options, capfd)
+
+    assert r["slack"] > 0, f"AudioHub has no slack: period {r['audiohub_period_avg']} busy {r['audiohub_busy_max']}"
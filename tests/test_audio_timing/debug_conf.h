@@ -0,0 +1,9 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#ifndef __debug_conf_h__
+#define __debug_conf_h__
+
+#define DEBUG_PRINT_ENABLE_MAIN 1
+#define DEBUG_PRINT_ENABLE_AUDIO_IO 0
+
+#endif // __debug_conf_h__
@@ -0,0 +1,27 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdio.h>
+#include "xua.h"
+#include "../../lib_xua/src/core/support/xua_profile.h"
+
+void TimingReset(void)
+{
+    XUA_Profile_RequestReset();
+}
+
+/* Print the AudioHub statistics gathered by XUA_PROFILE along with the decouple exchange timing */
+void TimingReport(unsigned exchangeMax, unsigned exchangeAvg, unsigned frames)
+{
+    xua_profile_t *p = &g_xua_profile[XUA_PROFILE_AUDIOHUB];
+    unsigned periodAvg = p->periodCount ? (unsigned)(p->totalPeriod / p->periodCount) : 0;
+    unsigned busyAvg = p->busyCount ? (unsigned)(p->totalBusy / p->busyCount) : 0;
+
+    printf("AUDIO_TIMING: {\"frames\": %u, \"timer_hz\": %u, "
+           "\"audiohub_period_avg\": %u, \"audiohub_period_max\": %u, "
+           "\"audiohub_busy_avg\": %u, \"audiohub_busy_max\": %u, "
+           "\"exchange_avg\": %u, \"exchange_max\": %u}\n",
+           frames, XS1_TIMER_HZ,
+           periodAvg, p->maxPeriod,
+           busyAvg, p->maxBusy,
+           exchangeAvg, exchangeMax);
+}
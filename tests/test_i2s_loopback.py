@@ -69,7 +69,7 @@ def do_test(
 
 
 @pytest.mark.parametrize("i2s_role", ["master", "slave"])
-@pytest.mark.parametrize("pcm_format", ["i2s", "tdm"])
+@pytest.mark.parametrize("pcm_format", ["i2s", "tdm", "tdm16"])
 @pytest.mark.parametrize("channel_count", [2, 8, 16])
 @pytest.mark.parametrize("word_length", [16, 32]) # I2S world length in bits
 @pytest.mark.parametrize("sample_rate", [48000, 96000, 192000])
@@ -89,6 +89,10 @@ def test_i2s_loopback(
     if pcm_format == "tdm" and sample_rate == 192000:
         pytest.skip("Invalid parameter combination")
 
+    # 16 slots of 32 bits at 48kHz is a bit clock equal to the 24.576MHz master clock
+    if pcm_format == "tdm16" and (channel_count != 16 or sample_rate != 48000):
+        pytest.skip("Invalid parameter combination")
+
     result = do_test(
         pcm_format, i2s_role, channel_count, sample_rate, word_length, test_file, options, capfd
     )
@@ -0,0 +1,85 @@
+# Copyright 2024 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import json
+import os
+import pytest
+import Pyxsim
+from Pyxsim import testers
+
+# Build configurations from test_mixer_benchmark/Makefile
+BENCH_CONFIGS = [
+    "mix8_in18",
+    "mix8_in18_vol",
+    "mix8_in18_meter",
+    "mix8_in18_vol_meter",
+    "mix4_in10",
+    "mix2_in18",
+    "mix8_in18_sparse",
+    "mix8_in18_vpu",
+    "mix8_in18_single",
+    "mix8_in18_float",
+    "mix8_in18_ldd",
+    "mix0",
+]
+
+BENCH_PREFIX = "MIXER_BENCH: "
+
+# Results from all configurations are collected here so regressions can be tracked across runs
+BENCH_RESULTS_FILE = os.environ.get("MIXER_BENCH_RESULTS", "mixer_benchmark.json")
+
+
+class BenchTester(testers.ComparisonTester):
+    """Checks for PASS and captures the benchmark result line"""
+
+    def __init__(self):
+        super().__init__(open("pass.expect"), ignore=[BENCH_PREFIX])
+        self.result = None
+
+    def run(self, output):
+        for line in output:
+            if line.startswith(BENCH_PREFIX):
+                self.result = json.loads(line[len(BENCH_PREFIX) :])
+        return super().run(output)
+
+
+def save_result(config, result):
+    results = {}
+    if os.path.exists(BENCH_RESULTS_FILE):
+        with open(BENCH_RESULTS_FILE) as f:
+            results = json.load(f)
+    results[config] = result
+    with open(BENCH_RESULTS_FILE, "w") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+
+@pytest.mark.parametrize("config", BENCH_CONFIGS)
+def test_mixer_benchmark(options, capfd, test_file, config):
+
+    testname, _ = os.path.splitext(os.path.basename(test_file))
+
+    binary = f"{testname}/bin/{config}/{testname}_{config}.xe"
+
+    tester = BenchTester()
+
+    max_cycles = 15000000
+
+    simargs = [
+        "--max-cycles",
+        str(max_cycles),
+    ]
+
+    result = Pyxsim.run_on_simulator(
+        binary,
+        tester=tester,
+        build_options=["CONFIG=" + config],
+        simargs=simargs,
+        capfd=capfd,
+        instTracing=options.enabletracing,
+        vcdTracing=options.enablevcdtracing,
+    )
+
+    assert result
+    assert tester.result is not None, "No benchmark result reported"
+
+    tester.result["ns_avg"] = tester.result["ticks_avg"] * 1000000000 // tester.result["timer_hz"]
+    save_result(config, tester.result)
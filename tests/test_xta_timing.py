@@ -0,0 +1,74 @@
+# Copyright 2024 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+import os
+import subprocess
+import pytest
+from pathlib import Path
+
+# Static timing checks. XTA is run over the xta endpoints in lib_xua for a representative build of each
+# thread and the worst case path is required to fit within a sample period at the build's MAX_FREQ
+
+XTA_DIR = Path(__file__).parent / "test_xta_timing"
+
+# Threads assumed per tile, the minimum thread rate guaranteed by the xcore
+XTA_THREADS = 5
+
+XTA_TARGETS = {
+    # script: (build directory, build options, binary, MAX_FREQ, NUM_USB_CHAN_OUT)
+    "audiohub": (
+        "test_i2s_loopback",
+        ["pcm_format=i2s", "i2s_role=master", "channel_count=8", "sample_rate=192000", "word_length=32"],
+        "test_i2s_loopback/bin/simulation_i2s_master_8in_8out_192000_32bit/"
+        "test_i2s_loopback_simulation_i2s_master_8in_8out_192000_32bit.xe",
+        192000,
+        8,
+    ),
+    "mixer": (
+        "test_mixer_routing_output",
+        ["TEST_SEED=0"],
+        "test_mixer_routing_output/bin/test_mixer_routing_output.xe",
+        192000,
+        10,
+    ),
+    "buffer": (
+        "../examples/AN00246_xua_example",
+        [],
+        "../examples/AN00246_xua_example/bin/app_xua_simple.xe",
+        48000,
+        2,
+    ),
+}
+
+
+def run(cmd, cwd):
+    result = subprocess.run(cmd, capture_output=True, text=True, cwd=cwd)
+    assert result.returncode == 0, f"{' '.join(cmd)}\n{result.stderr}\n{result.stdout}"
+    return result.stdout
+
+
+@pytest.mark.parametrize("script", XTA_TARGETS.keys())
+def test_xta_timing(script, tmp_path):
+
+    tests_dir = Path(__file__).parent
+    build_dir, build_options, binary, max_freq, chan_out = XTA_TARGETS[script]
+
+    run(["xmake", "-C", build_dir] + build_options, tests_dir)
+
+    period_ns = 1000000000 // max_freq
+    template = (XTA_DIR / f"{script}.xta").read_text()
+    xta_script = tmp_path / f"{script}.xta"
+    xta_script.write_text(
+        template.format(
+            binary=(tests_dir / binary).resolve(),
+            threads=XTA_THREADS,
+            period_ns=period_ns,
+            half_period_ns=period_ns // 2,
+            chan_out=chan_out,
+        )
+    )
+
+    output = run(["xta", "source", str(xta_script)], tests_dir)
+    print(output)
+
+    failures = [line for line in output.splitlines() if "fail" in line.lower() or "error" in line.lower()]
+    assert not failures, "\n".join(failures)
@@ -66,6 +66,10 @@ class UnityTestExecutable(pytest.Item):
         unity_pass = False
         test_output = test_output.split("\n")
         for line in test_output:
+            if line.startswith("bench "):
+                # Benchmark result, printed when built with XUA_UNIT_TEST_BENCH
+                print("\n {}".format(line), end=" ")
+                continue
             if "test" in line:
                 test_report = line.split(":")
                 # Unity output is as follows:
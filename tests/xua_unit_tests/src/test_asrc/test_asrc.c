@@ -0,0 +1,291 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "xua_unit_tests.h"
+#include "../../../lib_xua/src/core/clocking/xua_asrc.h"
+
+/* Simulates the digital input sample rate converter (XUA_DIG_RX_ASRC, enabled for this test by CMakeLists.txt)
+ * with input and output frames interleaved in time order at the given rates. A sine is converted and compared
+ * with the ideal output to measure the SNR and the latency */
+
+#define DEBUG       0
+
+#if     DEBUG
+#define dprintf(...) printf(__VA_ARGS__)
+#else
+#define dprintf(...)
+#endif
+
+/* Output frames run before measuring, covering the ratio measurement and the PI loop settling */
+#define SETTLE_FRAMES           (XUA_ASRC_MEASURE_FRAMES + 16384)
+#define MEASURE_FRAMES          (8192)
+#define FIT_FRAMES              (1024)
+
+#define AMPLITUDE               (1 << 30)
+
+#define RANDOM_SEED             20240618
+
+/* Reference timer used for the time-stamps */
+#define TICKS_PER_SEC           (100000000.0)
+
+/* Maximum time-stamp error, in ticks, modelling the event latency of clockGen() */
+#define JITTER_TICKS            (100)
+
+/* Fill error bound, in input frames, once settled */
+#define FILL_ERROR_MAX          (2.0)
+
+/* Latency in input frames. The window starts XUA_ASRC_TAPS + XUA_ASRC_FILL frames before the input position (one
+ * on from the last input frame received) and the output is (XUA_ASRC_TAPS / 2 - 1) frames after its start */
+#define LATENCY_FRAMES          (XUA_ASRC_TAPS / 2 + XUA_ASRC_FILL)
+
+typedef struct
+{
+    double snrDb;               /* Worst of the fitted blocks, first channel */
+    double latency;             /* Of the last block, input frames */
+    double maxFillError;        /* Input frames */
+    unsigned resets;
+} asrc_sim_result_t;
+
+static xua_asrc_t asrc;
+
+static unsigned Timestamp(double t, unsigned *seed)
+{
+    return (unsigned)(long long)(t * TICKS_PER_SEC) + (random(seed) % (2 * JITTER_TICKS + 1));
+}
+
+/* Least squares fit of a sine at freq to a block of output, y = a.sin + b.cos + (c.sin + d.cos).t, the residual
+ * being noise and distortion. The terms in t allow for the slow correction of the latency by the loop, which would
+ * otherwise be seen as noise */
+#define FIT_TERMS               (4)
+
+typedef struct
+{
+    double m[FIT_TERMS][FIT_TERMS];
+    double v[FIT_TERMS];
+    double yy;
+} sine_fit_t;
+
+static void fit_add(sine_fit_t *f, double freq, double t, double tBlock, double y)
+{
+    double basis[FIT_TERMS];
+
+    basis[0] = sin(2 * M_PI * freq * t);
+    basis[1] = cos(2 * M_PI * freq * t);
+    basis[2] = basis[0] * tBlock;
+    basis[3] = basis[1] * tBlock;
+
+    for(unsigned i = 0; i < FIT_TERMS; i++)
+    {
+        for(unsigned j = 0; j < FIT_TERMS; j++)
+        {
+            f->m[i][j] += basis[i] * basis[j];
+        }
+        f->v[i] += basis[i] * y;
+    }
+    f->yy += y * y;
+}
+
+static void fit_block(sine_fit_t *f, double freq, double inRate, asrc_sim_result_t *res)
+{
+    double m[FIT_TERMS][FIT_TERMS];
+    double x[FIT_TERMS];
+    double signal = 0;
+
+    /* Solve the normal equations by Gaussian elimination */
+    memcpy(m, f->m, sizeof(m));
+    memcpy(x, f->v, sizeof(x));
+
+    for(unsigned i = 0; i < FIT_TERMS; i++)
+    {
+        for(unsigned k = i + 1; k < FIT_TERMS; k++)
+        {
+            double r = m[k][i] / m[i][i];
+            for(unsigned j = i; j < FIT_TERMS; j++)
+            {
+                m[k][j] -= r * m[i][j];
+            }
+            x[k] -= r * x[i];
+        }
+    }
+    for(int i = FIT_TERMS - 1; i >= 0; i--)
+    {
+        for(unsigned j = i + 1; j < FIT_TERMS; j++)
+        {
+            x[i] -= m[i][j] * x[j];
+        }
+        x[i] /= m[i][i];
+    }
+
+    for(unsigned i = 0; i < FIT_TERMS; i++)
+    {
+        signal += x[i] * f->v[i];
+    }
+
+    double snrDb = 10 * log10(signal / (f->yy - signal));
+    if(snrDb < res->snrDb)
+        res->snrDb = snrDb;
+
+    /* a.sin(wt) + b.cos(wt) = A.sin(w(t - d)) at the centre of the block */
+    double delay = -atan2(x[1], x[0]) / (2 * M_PI * freq);
+    if(delay < 0)
+        delay += 1 / freq;
+    res->latency = delay * inRate;
+
+    memset(f, 0, sizeof(*f));
+}
+
+static void run_asrc(unsigned chans, double inRate, double outRate, double freq, asrc_sim_result_t *res)
+{
+    int in[XUA_ASRC_MAX_CHANS];
+    int out[XUA_ASRC_MAX_CHANS];
+    unsigned long long inFrames = 0;
+    unsigned seed = RANDOM_SEED;
+    sine_fit_t fit;
+
+    memset(&fit, 0, sizeof(fit));
+    XUA_Asrc_Start(&asrc, chans);
+    res->maxFillError = 0;
+    res->snrDb = 1000;
+
+    for(unsigned j = 0; j < SETTLE_FRAMES + MEASURE_FRAMES; j++)
+    {
+        double t = j / outRate;
+
+        /* Inputs received up to (and at) this output */
+        while((inFrames / inRate) <= t)
+        {
+            double x = AMPLITUDE * sin(2 * M_PI * freq * (inFrames / inRate));
+
+            for(unsigned c = 0; c < chans; c++)
+            {
+                /* Further channels are inverted copies */
+                in[c] = (int) lround((c & 1) ? -x : x);
+            }
+            XUA_Asrc_Input(&asrc, in, Timestamp(inFrames / inRate, &seed));
+            inFrames++;
+        }
+
+        XUA_Asrc_Output(&asrc, out, Timestamp(t, &seed));
+
+        /* Channels are independent, allowing for rounding of each product */
+        for(unsigned c = 1; c < chans; c++)
+        {
+            TEST_ASSERT_INT32_WITHIN(2 * XUA_ASRC_TAPS, (c & 1) ? -out[0] : out[0], out[c]);
+        }
+
+        if(j >= SETTLE_FRAMES)
+        {
+            double fillError = fabs(asrc.error / 4294967296.0);
+            double tBlock = ((double)((j - SETTLE_FRAMES) % FIT_FRAMES) - FIT_FRAMES / 2) / outRate;
+
+            if(fillError > res->maxFillError)
+                res->maxFillError = fillError;
+
+            fit_add(&fit, freq, t, tBlock, out[0]);
+
+            if(((j - SETTLE_FRAMES) % FIT_FRAMES) == (FIT_FRAMES - 1))
+            {
+                fit_block(&fit, freq, inRate, res);
+            }
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(XUA_ASRC_STATE_RUN, asrc.state);
+    res->resets = asrc.resets;
+
+    dprintf("%6.0f -> %6.0f Hz, %5.0f Hz sine, %u chans: SNR %.1f dB, latency %.2f frames, fill error %.3f frames\n",
+        inRate, outRate, freq, chans, res->snrDb, res->latency, res->maxFillError);
+}
+
+static void check_asrc(unsigned chans, double inRate, double outRate, double freq, double minSnrDb)
+{
+    asrc_sim_result_t res;
+
+    run_asrc(chans, inRate, outRate, freq, &res);
+
+    TEST_ASSERT_EQUAL_UINT32(0, res.resets);
+    TEST_ASSERT_TRUE(res.maxFillError < FILL_ERROR_MAX);
+    TEST_ASSERT_TRUE(res.snrDb > minSnrDb);
+
+    /* The latency is measured from the phase of the sine so is only known if shorter than its period */
+    if((inRate / freq) > (2 * LATENCY_FRAMES))
+    {
+        TEST_ASSERT_TRUE(fabs(res.latency - LATENCY_FRAMES) < 1.0);
+    }
+}
+
+void test_asrc_coeffs(void)
+{
+    XUA_Asrc_InitCoeffs();
+
+    /* Every phase has unity gain at DC */
+    for(unsigned p = 0; p <= XUA_ASRC_PHASES; p++)
+    {
+        long long sum = 0;
+
+        for(unsigned i = 0; i < XUA_ASRC_TAPS; i++)
+        {
+            sum += g_xua_asrc_coeffs[p * XUA_ASRC_TAPS + i];
+        }
+        TEST_ASSERT_TRUE((sum > (1 << 30) - XUA_ASRC_TAPS) && (sum < (1 << 30) + XUA_ASRC_TAPS));
+    }
+
+    /* The last phase is the first delayed by one frame */
+    for(unsigned i = 1; i < XUA_ASRC_TAPS; i++)
+    {
+        int diff = g_xua_asrc_coeffs[XUA_ASRC_PHASES * XUA_ASRC_TAPS + i] - g_xua_asrc_coeffs[i - 1];
+        TEST_ASSERT_TRUE((diff < 64) && (diff > -64));
+    }
+}
+
+void test_asrc_same_rate(void)
+{
+    XUA_Asrc_InitCoeffs();
+
+    /* Offset as for an unlocked digital input */
+    check_asrc(2, 48000 * (1 + 100e-6), 48000, 400, 110);
+    check_asrc(2, 48000 * (1 - 100e-6), 48000, 400, 110);
+}
+
+void test_asrc_44100_48000(void)
+{
+    XUA_Asrc_InitCoeffs();
+    check_asrc(8, 44100 * (1 + 50e-6), 48000, 400, 110);
+}
+
+void test_asrc_48000_44100(void)
+{
+    XUA_Asrc_InitCoeffs();
+    check_asrc(2, 48000 * (1 - 1000e-6), 44100, 400, 110);
+}
+
+void test_asrc_high_freq(void)
+{
+    XUA_Asrc_InitCoeffs();
+    check_asrc(2, 48000 * (1 + 100e-6), 96000, 15000, 80);
+}
+
+void test_asrc_range(void)
+{
+    int in[XUA_ASRC_MAX_CHANS] = {0x1000000, 0x1000000};
+    int out[XUA_ASRC_MAX_CHANS];
+
+    XUA_Asrc_InitCoeffs();
+    XUA_Asrc_Start(&asrc, 2);
+
+    /* 96kHz in to 48kHz out is not converted and is muted */
+    for(unsigned j = 0; j < XUA_ASRC_MEASURE_FRAMES + 256; j++)
+    {
+        XUA_Asrc_Input(&asrc, in, j * 2083);
+        XUA_Asrc_Input(&asrc, in, j * 2083 + 1042);
+        XUA_Asrc_Output(&asrc, out, j * 2083 + 1042);
+        TEST_ASSERT_EQUAL_INT32(0, out[0]);
+        TEST_ASSERT_EQUAL_INT32(0, out[1]);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(XUA_ASRC_STATE_RANGE, asrc.state);
+}
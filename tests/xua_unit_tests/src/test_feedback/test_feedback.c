@@ -0,0 +1,270 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stddef.h>
+#include <stdio.h>
+
+#include "xua_unit_tests.h"
+#include "../../../lib_xua/src/core/buffer/ep/xua_feedback.h"
+
+/* Simulates the asynchronous feedback calculation against a host whose SOFs are offset in frequency from the
+ * device clock. Reports the number of SOFs taken to lock and the steady state error of the feedback value. The
+ * feedback configuration (XUA_FEEDBACK_FILTER, XUA_FEEDBACK_WINDOW_LOG2 etc.) may be changed through
+ * EXTRA_BUILD_FLAGS to compare alternatives */
+
+#define DEBUG       0
+
+#if     DEBUG
+#define dprintf(...) printf(__VA_ARGS__)
+#else
+#define dprintf(...)
+#endif
+
+#define RANDOM_SEED             20240611
+
+#if FB_USE_REF_CLOCK
+#define TICK_FREQ(mclk)         (100000000.0)
+#else
+#define TICK_FREQ(mclk)         ((double)(mclk))
+#endif
+
+/* Feedback within this error is considered locked */
+#define LOCK_PPM                (100.0)
+
+/* Bound on the steady state error of the mean feedback value */
+#define MEAN_PPM                (2.0)
+
+/* With fast lock the windows up to the full length sum to less than twice its length */
+#define LOCK_SOFS_MAX           (2 << XUA_FEEDBACK_WINDOW_LOG2)
+
+#define SIM_SOFS                (64 << XUA_FEEDBACK_WINDOW_LOG2)
+
+/* SOF time-stamp error, scaled with the window such that a locked value stays within LOCK_PPM (8 ticks over
+ * 128 SOFs) */
+#define JITTER_TICKS            ((1 << XUA_FEEDBACK_WINDOW_LOG2) / 16)
+
+typedef struct
+{
+    unsigned lockSofs;          /* SOFs until the feedback values remain within LOCK_PPM */
+    unsigned values;            /* Feedback values calculated */
+    double meanPpm;             /* Error of the mean feedback value once locked */
+    double maxPpm;              /* Largest error of a single feedback value once locked */
+} fb_sim_result_t;
+
+/* Runs the feedback calculation over sofs SOFs. The device clock runs ppm faster than the host. jitter is the
+ * maximum error, in ticks, of the time-stamp taken on each SOF */
+static void run_feedback(xua_feedback_t *fb, unsigned sampleFreq, unsigned mclk, unsigned highSpeed, double ppm,
+    unsigned jitter, unsigned sofs, fb_sim_result_t *res)
+{
+    const double sofRate = highSpeed ? 8000.0 : 1000.0;
+    const double ticksPerSof = TICK_FREQ(mclk) * (1.0 + ppm / 1e6) / sofRate;
+    const double expected = sampleFreq * (1.0 + ppm / 1e6) / sofRate * 65536.0;
+    unsigned seed = RANDOM_SEED;
+    long long lastTime = 0;
+    double sum = 0;
+    unsigned summed = 0;
+
+    res->lockSofs = 0;
+    res->values = 0;
+    res->maxPpm = 0;
+
+    for(unsigned sof = 1; sof <= sofs; sof++)
+    {
+        long long time = (long long)(sof * ticksPerSof);
+
+        if(jitter)
+        {
+            time += (int)(random(&seed) % (2 * jitter + 1)) - (int)jitter;
+        }
+
+        unsigned clocks;
+        int count = (int)(time - lastTime);
+        lastTime = time;
+
+        if(XUA_Feedback_Sof(fb, count, sampleFreq, mclk, highSpeed, &clocks))
+        {
+            double errPpm = (clocks - expected) / expected * 1e6;
+            double absPpm = errPpm < 0 ? -errPpm : errPpm;
+            res->values++;
+
+            dprintf("SOF %5u feedback 0x%08x error %8.2f ppm\n", sof, clocks, errPpm);
+
+            if(absPpm > LOCK_PPM)
+            {
+                res->lockSofs = sof;
+                sum = 0;
+                summed = 0;
+                res->maxPpm = 0;
+            }
+            else
+            {
+                sum += clocks;
+                summed++;
+                if(absPpm > res->maxPpm)
+                    res->maxPpm = absPpm;
+            }
+        }
+    }
+
+    TEST_ASSERT_TRUE_MESSAGE(summed > 0, "Feedback did not lock");
+    res->meanPpm = ((sum / summed) - expected) / expected * 1e6;
+}
+
+static void check_feedback(unsigned sampleFreq, unsigned mclk, unsigned highSpeed, double ppm, unsigned jitter)
+{
+    xua_feedback_t fb;
+    fb_sim_result_t res;
+
+    XUA_Feedback_Reset(&fb);
+    run_feedback(&fb, sampleFreq, mclk, highSpeed, ppm, jitter, SIM_SOFS, &res);
+
+    dprintf("%6u Hz %s %+7.1f ppm jitter %u: lock %u SOFs, mean error %.3f ppm, max error %.1f ppm\n",
+        sampleFreq, highSpeed ? "HS" : "FS", ppm, jitter, res.lockSofs, res.meanPpm, res.maxPpm);
+
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(LOCK_SOFS_MAX, res.lockSofs);
+    TEST_ASSERT_TRUE(res.meanPpm < MEAN_PPM);
+    TEST_ASSERT_TRUE(res.meanPpm > -MEAN_PPM);
+}
+
+static const double ppmOffsets[] = {-500.0, -100.0, -10.0, 0.0, 10.0, 100.0, 500.0};
+
+#define NUM_OFFSETS (sizeof(ppmOffsets) / sizeof(ppmOffsets[0]))
+
+void test_feedback_nominal_hs(void)
+{
+    xua_feedback_t fb;
+    unsigned clocks = 0;
+    unsigned count = (unsigned) (TICK_FREQ(MCLK_48) / 8000);
+
+    XUA_Feedback_Reset(&fb);
+
+    /* With the host and device clocks in step every value is exact, 6 samples per microframe at 48kHz */
+    for(unsigned sof = 0; sof < SIM_SOFS; sof++)
+    {
+        if(XUA_Feedback_Sof(&fb, count, 48000, MCLK_48, 1, &clocks))
+        {
+            TEST_ASSERT_EQUAL_HEX32(0x60000, clocks);
+        }
+    }
+}
+
+void test_feedback_ppm_hs_48000(void)
+{
+    for(unsigned i = 0; i < NUM_OFFSETS; i++)
+    {
+        check_feedback(48000, MCLK_48, 1, ppmOffsets[i], 0);
+    }
+}
+
+void test_feedback_ppm_hs_44100(void)
+{
+    for(unsigned i = 0; i < NUM_OFFSETS; i++)
+    {
+        check_feedback(44100, MCLK_441, 1, ppmOffsets[i], 0);
+    }
+}
+
+void test_feedback_ppm_hs_192000(void)
+{
+    for(unsigned i = 0; i < NUM_OFFSETS; i++)
+    {
+        check_feedback(192000, MCLK_48, 1, ppmOffsets[i], 0);
+    }
+}
+
+void test_feedback_ppm_fs_48000(void)
+{
+    for(unsigned i = 0; i < NUM_OFFSETS; i++)
+    {
+        check_feedback(48000, MCLK_48, 0, ppmOffsets[i], 0);
+    }
+}
+
+void test_feedback_ppm_fs_44100(void)
+{
+    for(unsigned i = 0; i < NUM_OFFSETS; i++)
+    {
+        check_feedback(44100, MCLK_441, 0, ppmOffsets[i], 0);
+    }
+}
+
+void test_feedback_resolution_fs(void)
+{
+    xua_feedback_t fb;
+    unsigned clocks = 0;
+    long long lastTime = 0;
+
+    XUA_Feedback_Reset(&fb);
+
+    /* 44.1 samples per frame is not exact in 10.14, once locked every value is one of the two either side of it */
+    for(unsigned sof = 1; sof <= SIM_SOFS; sof++)
+    {
+        long long time = (long long)(sof * TICK_FREQ(MCLK_441) / 1000);
+        int count = (int)(time - lastTime);
+        lastTime = time;
+
+        if(XUA_Feedback_Sof(&fb, count, 44100, MCLK_441, 0, &clocks) && (sof > LOCK_SOFS_MAX))
+        {
+            TEST_ASSERT_EQUAL_HEX32(0, clocks & FB_LSB_MASK_FS);
+            TEST_ASSERT_UINT32_WITHIN(FB_LSB_MASK_FS + 1, (44100 * 65536ULL) / 1000, clocks);
+        }
+    }
+}
+
+void test_feedback_jitter_hs(void)
+{
+    check_feedback(48000, MCLK_48, 1, 100.0, JITTER_TICKS);
+    check_feedback(48000, MCLK_48, 1, -100.0, JITTER_TICKS);
+}
+
+void test_feedback_rate_change(void)
+{
+    xua_feedback_t fb;
+    fb_sim_result_t res;
+
+    /* Lock at one rate then reset, as on a sample rate change, and lock at another */
+    XUA_Feedback_Reset(&fb);
+    run_feedback(&fb, 48000, MCLK_48, 1, 100.0, 0, SIM_SOFS, &res);
+
+    XUA_Feedback_Reset(&fb);
+    run_feedback(&fb, 44100, MCLK_441, 1, 100.0, 0, SIM_SOFS, &res);
+
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(LOCK_SOFS_MAX, res.lockSofs);
+    TEST_ASSERT_TRUE(res.meanPpm < MEAN_PPM);
+    TEST_ASSERT_TRUE(res.meanPpm > -MEAN_PPM);
+}
+
+void test_feedback_coalesce(void)
+{
+    xua_feedback_t fb, fbCoalesced;
+    const double ticksPerSof = TICK_FREQ(MCLK_441) * (1.0 + 100.0 / 1e6) / 8000.0;
+    unsigned seed = RANDOM_SEED;
+    long long lastTime = 0;
+    unsigned values = 0;
+
+    XUA_Feedback_Reset(&fb);
+    XUA_Feedback_Reset(&fbCoalesced);
+
+    /* Summing the counts of a window and calculating once must give the same values as counting every SOF,
+     * across fast lock and the window length changes */
+    for(unsigned sof = 1; sof <= SIM_SOFS; sof++)
+    {
+        long long time = (long long)(sof * ticksPerSof) + (int)(random(&seed) % (2 * JITTER_TICKS + 1)) - JITTER_TICKS;
+        int count = (int)(time - lastTime);
+        unsigned clocks = 0, clocksCoalesced = 0;
+        int done;
+        lastTime = time;
+
+        done = XUA_Feedback_Sof(&fb, count, 44100, MCLK_441, 1, &clocks);
+
+        fbCoalesced.windowCount += count;
+        TEST_ASSERT_EQUAL_INT(done, ++fbCoalesced.sofCount == (1u << fbCoalesced.windowLog2));
+        if(done)
+        {
+            XUA_Feedback_Window(&fbCoalesced, 44100, MCLK_441, 1, &clocksCoalesced);
+            TEST_ASSERT_EQUAL_HEX32(clocks, clocksCoalesced);
+            values++;
+        }
+    }
+
+    TEST_ASSERT_TRUE(values > 0);
+}
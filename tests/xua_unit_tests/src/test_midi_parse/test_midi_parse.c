@@ -220,3 +220,119 @@ void test_midi_sys_ex(void) {
         printf("Sysex PASS length: %u\n", msg_len);
     }
 }
+
+#define STREAM_LEN      4096
+
+// Builds a stream of channel messages with running status, interleaved real time bytes and SysEx
+static unsigned build_stream(unsigned char stream[STREAM_LEN]){
+    unsigned len = 0;
+
+    while(len < STREAM_LEN - 8){
+        unsigned r = random(&rndm);
+        switch(r & 0x7){
+            case 0:
+            case 1:
+            case 2:
+                stream[len++] = NOTE_ON | ((r >> 4) & 0xF);
+                stream[len++] = (r >> 8) & DATA_MASK;
+                stream[len++] = (r >> 16) & DATA_MASK;
+                break;
+            case 3:
+                // Running status
+                stream[len++] = (r >> 8) & DATA_MASK;
+                stream[len++] = (r >> 16) & DATA_MASK;
+                break;
+            case 4:
+                stream[len++] = PROGRAM | ((r >> 4) & 0xF);
+                stream[len++] = (r >> 8) & DATA_MASK;
+                break;
+            case 5:
+                // Timing clock
+                stream[len++] = 0xF8;
+                break;
+            default:
+                stream[len++] = SYSEX_SOM;
+                for(unsigned i = 0; i < ((r >> 4) & 0x3); i++){
+                    stream[len++] = (r >> (8 + i)) & DATA_MASK;
+                }
+                stream[len++] = SYSEX_EOM;
+                break;
+        }
+    }
+
+    return len;
+}
+
+static unsigned char stream[STREAM_LEN];
+static unsigned events_ref[STREAM_LEN];
+static unsigned events_dut[STREAM_LEN];
+
+static unsigned parse_stream_byte_wise(unsigned len, unsigned events[]){
+    struct midi_in_parse_state mips;
+    unsigned num_events = 0;
+
+    reset_midi_state_c_wrapper(&mips);
+    for(unsigned i = 0; i < len; i++){
+        unsigned valid = 0;
+        unsigned packed = 0;
+        midi_in_parse_c_wrapper((void * )&mips, CABLE_NUM, stream[i], &valid, &packed);
+        if(valid){
+            events[num_events++] = packed;
+        }
+    }
+
+    return num_events;
+}
+
+void test_midi_parse_bytes(void) {
+    unsigned len = build_stream(stream);
+    unsigned num_ref = parse_stream_byte_wise(len, events_ref);
+
+    // Parse in bursts with a small event buffer so the parser has to stop early and resume
+    struct midi_in_parse_state mips;
+    reset_midi_state_c_wrapper(&mips);
+
+    unsigned pos = 0;
+    unsigned num_dut = 0;
+    while(pos < len){
+        unsigned burst = (random(&rndm) & 0x1F) + 1;
+        unsigned consumed = 0;
+        unsigned num_events = 0;
+
+        if(burst > len - pos){
+            burst = len - pos;
+        }
+
+        midi_in_parse_bytes_c_wrapper((void * )&mips, CABLE_NUM, &stream[pos], burst, &events_dut[num_dut], 4, &consumed, &num_events);
+        TEST_ASSERT_TRUE(consumed <= burst);
+        TEST_ASSERT_TRUE(num_events <= 4);
+        pos += consumed;
+        num_dut += num_events;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(num_ref, num_dut);
+    for(unsigned i = 0; i < num_ref; i++){
+        TEST_ASSERT_EQUAL_UINT32(events_ref[i], events_dut[i]);
+    }
+}
+
+void test_midi_parse_throughput(void) {
+    unsigned len = build_stream(stream);
+    unsigned t0, t1, t2;
+    unsigned num_ref, num_dut, consumed;
+    struct midi_in_parse_state mips;
+
+    t0 = get_time();
+    num_ref = parse_stream_byte_wise(len, events_ref);
+    t1 = get_time();
+    reset_midi_state_c_wrapper(&mips);
+    midi_in_parse_bytes_c_wrapper((void * )&mips, CABLE_NUM, stream, len, events_dut, STREAM_LEN, &consumed, &num_dut);
+    t2 = get_time();
+
+    TEST_ASSERT_EQUAL_UINT32(len, consumed);
+    TEST_ASSERT_EQUAL_UINT32(num_ref, num_dut);
+
+    // Per byte of the stream. A MIDI byte takes 32000 ticks on the wire
+    xua_bench_report("midi_in_parse", t1 - t0, len);
+    xua_bench_report("midi_in_parse_bytes", t2 - t1, len);
+}
@@ -20,6 +20,10 @@
 #define USB_MIDI_DEVICE_OUT_FIFO_SIZE   1024
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof(x[0]))
 
+#if (XUA_UNIT_TEST_BENCH_CALLS > USB_MIDI_DEVICE_OUT_FIFO_SIZE)
+#error XUA_UNIT_TEST_BENCH_CALLS must not exceed the queue size
+#endif
+
 unsigned rndm = RANDOM_SEED;
 
 
@@ -112,4 +116,145 @@ void test_midi_queue_push_pop(void) {
 
         counter++;
     }
-}
\ No newline at end of file
+}
+
+void test_bench_midi_queue_push_pop(void) {
+    queue_t symbol_fifo;
+    unsigned symbol_fifo_storage[USB_MIDI_DEVICE_OUT_FIFO_SIZE];
+    unsigned t0, t1, t2;
+    unsigned sum = 0;
+    queue_init_c_wrapper(&symbol_fifo, ARRAY_SIZE(symbol_fifo_storage));
+
+    // The queue never fills or empties, such that every call moves a word
+    t0 = get_time();
+    for(unsigned i = 0; i < XUA_UNIT_TEST_BENCH_CALLS; i++){
+        queue_push_word_c_wrapper(&symbol_fifo, symbol_fifo_storage, i);
+    }
+    t1 = get_time();
+    for(unsigned i = 0; i < XUA_UNIT_TEST_BENCH_CALLS; i++){
+        sum += queue_pop_word_c_wrapper(&symbol_fifo, symbol_fifo_storage);
+    }
+    t2 = get_time();
+
+    TEST_ASSERT_EQUAL_UINT32((XUA_UNIT_TEST_BENCH_CALLS * (XUA_UNIT_TEST_BENCH_CALLS - 1)) / 2, sum);
+    TEST_ASSERT_EQUAL_INT32(1, queue_is_empty_c_wrapper(&symbol_fifo));
+
+    xua_bench_report("queue_push_word", t1 - t0, XUA_UNIT_TEST_BENCH_CALLS);
+    xua_bench_report("queue_pop_word", t2 - t1, XUA_UNIT_TEST_BENCH_CALLS);
+}
+
+#define SPSC_FIFO_SIZE                  8
+
+void test_midi_queue_spsc_full_empty(void) {
+    queue_spsc_t fifo;
+    unsigned fifo_storage[SPSC_FIFO_SIZE];
+    unsigned entry = 0;
+    queue_spsc_init_c_wrapper(&fifo, ARRAY_SIZE(fifo_storage));
+
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_items_c_wrapper(&fifo));
+    TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE, queue_spsc_space_c_wrapper(&fifo));
+
+    // Pop of an empty queue is refused and leaves data alone
+    TEST_ASSERT_EQUAL_INT32(0, queue_spsc_pop_word_c_wrapper(&fifo, fifo_storage, &entry));
+    TEST_ASSERT_EQUAL_UINT32(0, entry);
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_pop_words_c_wrapper(&fifo, fifo_storage, &entry, 1));
+
+    for(unsigned i = 0; i < SPSC_FIFO_SIZE; i++){
+        TEST_ASSERT_EQUAL_INT32(1, queue_spsc_push_word_c_wrapper(&fifo, fifo_storage, 100 + i));
+    }
+    TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE, queue_spsc_items_c_wrapper(&fifo));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_space_c_wrapper(&fifo));
+
+    // Push to a full queue is refused and overwrites nothing
+    TEST_ASSERT_EQUAL_INT32(0, queue_spsc_push_word_c_wrapper(&fifo, fifo_storage, 999));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_push_words_c_wrapper(&fifo, fifo_storage, &entry, 1));
+    TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE, queue_spsc_items_c_wrapper(&fifo));
+
+    for(unsigned i = 0; i < SPSC_FIFO_SIZE; i++){
+        TEST_ASSERT_EQUAL_INT32(1, queue_spsc_pop_word_c_wrapper(&fifo, fifo_storage, &entry));
+        TEST_ASSERT_EQUAL_UINT32(100 + i, entry);
+    }
+    TEST_ASSERT_EQUAL_INT32(0, queue_spsc_pop_word_c_wrapper(&fifo, fifo_storage, &entry));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_items_c_wrapper(&fifo));
+    TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE, queue_spsc_space_c_wrapper(&fifo));
+}
+
+void test_midi_queue_spsc_wrap(void) {
+    queue_spsc_t fifo;
+    unsigned fifo_storage[SPSC_FIFO_SIZE];
+    unsigned entry = 0;
+    unsigned next_push = 0;
+    unsigned next_pop = 0;
+    queue_spsc_init_c_wrapper(&fifo, ARRAY_SIZE(fifo_storage));
+
+    // Start just short of the index wrap, the indices passing both the array end and 2^32
+    fifo.rdptr = 0xfffffffc;
+    fifo.wrptr = 0xfffffffc;
+
+    for(unsigned round = 0; round < 4 * SPSC_FIFO_SIZE; round++){
+        for(unsigned i = 0; i < 5; i++){
+            TEST_ASSERT_EQUAL_INT32(1, queue_spsc_push_word_c_wrapper(&fifo, fifo_storage, next_push++));
+        }
+        TEST_ASSERT_EQUAL_UINT32(5, queue_spsc_items_c_wrapper(&fifo));
+        TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE - 5, queue_spsc_space_c_wrapper(&fifo));
+
+        for(unsigned i = 0; i < 5; i++){
+            TEST_ASSERT_EQUAL_INT32(1, queue_spsc_pop_word_c_wrapper(&fifo, fifo_storage, &entry));
+            TEST_ASSERT_EQUAL_UINT32(next_pop++, entry);
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_items_c_wrapper(&fifo));
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(0xfffffffc, fifo.wrptr);
+}
+
+void test_midi_queue_spsc_bulk_split(void) {
+    queue_spsc_t fifo;
+    unsigned fifo_storage[SPSC_FIFO_SIZE];
+    unsigned src[SPSC_FIFO_SIZE + 2];
+    unsigned dst[SPSC_FIFO_SIZE + 2];
+    queue_spsc_init_c_wrapper(&fifo, ARRAY_SIZE(fifo_storage));
+
+    for(unsigned i = 0; i < ARRAY_SIZE(src); i++){
+        src[i] = 200 + i;
+    }
+
+    // Move the indices to 5, so that 6 words span 5..7 then 0..2
+    TEST_ASSERT_EQUAL_UINT32(5, queue_spsc_push_words_c_wrapper(&fifo, fifo_storage, src, 5));
+    TEST_ASSERT_EQUAL_UINT32(5, queue_spsc_pop_words_c_wrapper(&fifo, fifo_storage, dst, 5));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(src, dst, 5);
+
+    TEST_ASSERT_EQUAL_UINT32(6, queue_spsc_push_words_c_wrapper(&fifo, fifo_storage, src, 6));
+    TEST_ASSERT_EQUAL_UINT32(src[0], fifo_storage[5]);
+    TEST_ASSERT_EQUAL_UINT32(src[2], fifo_storage[7]);
+    TEST_ASSERT_EQUAL_UINT32(src[3], fifo_storage[0]);
+    TEST_ASSERT_EQUAL_UINT32(src[5], fifo_storage[2]);
+    TEST_ASSERT_EQUAL_UINT32(6, queue_spsc_items_c_wrapper(&fifo));
+
+    memset(dst, 0, sizeof(dst));
+    TEST_ASSERT_EQUAL_UINT32(6, queue_spsc_pop_words_c_wrapper(&fifo, fifo_storage, dst, 6));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(src, dst, 6);
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_items_c_wrapper(&fifo));
+
+    // Bulk copies are limited to the space and items available, again split across the wrap (indices now at 3)
+    TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE, queue_spsc_push_words_c_wrapper(&fifo, fifo_storage, src, ARRAY_SIZE(src)));
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_space_c_wrapper(&fifo));
+
+    memset(dst, 0, sizeof(dst));
+    TEST_ASSERT_EQUAL_UINT32(SPSC_FIFO_SIZE, queue_spsc_pop_words_c_wrapper(&fifo, fifo_storage, dst, ARRAY_SIZE(dst)));
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(src, dst, SPSC_FIFO_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(0, dst[SPSC_FIFO_SIZE]);
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_items_c_wrapper(&fifo));
+}
+
+void test_midi_queue_spsc_two_thread(void) {
+    queue_spsc_t fifo;
+    unsigned fifo_storage[SPSC_FIFO_SIZE];
+    queue_spsc_init_c_wrapper(&fifo, ARRAY_SIZE(fifo_storage));
+
+    // A small queue, such that the producer often finds it full and the consumer empty
+    unsigned errors = queue_spsc_two_thread_c_wrapper(&fifo, fifo_storage, 4096);
+
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL_UINT32(0, queue_spsc_items_c_wrapper(&fifo));
+    TEST_ASSERT_EQUAL_UINT32(4096, fifo.wrptr);
+}
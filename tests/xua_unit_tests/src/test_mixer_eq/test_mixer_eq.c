@@ -0,0 +1,209 @@
+// Copyright 2024 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stddef.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "xua_unit_tests.h"
+#include "../../../lib_xua/src/core/mixer/xua_mixer_eq.h"
+
+/* Tests the output EQ kernel of the mixer (XUA_MIXER_EQ_BIQUADS, set to 2 for this test by CMakeLists.txt) against
+ * a double precision model of the cascade */
+
+#define DEBUG       0
+
+#if     DEBUG
+#define dprintf(...) printf(__VA_ARGS__)
+#else
+#define dprintf(...)
+#endif
+
+#define RANDOM_SEED             20241014
+#define TEST_SAMPLES            (4096)
+
+#define Q30(x)                  ((int) lround((x) * (1 << XUA_MIXER_EQ_FRAC_BITS)))
+
+/* Peaking section, +6dB at fs / 8 with a Q of 1, and a low pass section at fs / 4 (RBJ cookbook) */
+static void design(double coeffs[XUA_MIXER_EQ_BANK_COEFFS])
+{
+    double w0 = 2 * M_PI / 8;
+    double A = pow(10, 6.0 / 40);
+    double alpha = sin(w0) / 2;
+    double a0 = 1 + alpha / A;
+
+    coeffs[0] = (1 + alpha * A) / a0;
+    coeffs[1] = (-2 * cos(w0)) / a0;
+    coeffs[2] = (1 - alpha * A) / a0;
+    coeffs[3] = (2 * cos(w0)) / a0;
+    coeffs[4] = -(1 - alpha / A) / a0;
+
+    w0 = 2 * M_PI / 4;
+    alpha = sin(w0) / (2 * M_SQRT1_2);
+    a0 = 1 + alpha;
+
+    coeffs[5] = ((1 - cos(w0)) / 2) / a0;
+    coeffs[6] = (1 - cos(w0)) / a0;
+    coeffs[7] = ((1 - cos(w0)) / 2) / a0;
+    coeffs[8] = (2 * cos(w0)) / a0;
+    coeffs[9] = -(1 - alpha) / a0;
+}
+
+static void load(unsigned chan, const double coeffs[XUA_MIXER_EQ_BANK_COEFFS])
+{
+    for(unsigned i = 0; i < XUA_MIXER_EQ_BANK_COEFFS; i++)
+    {
+        XUA_MixerEqSetCoeff(chan, i, Q30(coeffs[i]));
+    }
+}
+
+void test_mixer_eq_pass_through(void)
+{
+    unsigned seed = RANDOM_SEED;
+
+    XUA_MixerEqInit();
+
+    for(unsigned j = 0; j < TEST_SAMPLES; j++)
+    {
+        int x = (int) random(&seed);
+
+        for(unsigned chan = 0; chan < XUA_MIXER_EQ_CHANS; chan++)
+        {
+            TEST_ASSERT_EQUAL_INT32(x, XUA_MixerEq(chan, x));
+        }
+    }
+}
+
+void test_mixer_eq_response(void)
+{
+    double coeffs[XUA_MIXER_EQ_BANK_COEFFS];
+    double state[XUA_MIXER_EQ_BIQUADS + 1][2] = {{0}};
+    unsigned seed = RANDOM_SEED;
+
+    XUA_MixerEqInit();
+    design(coeffs);
+    load(0, coeffs);
+    XUA_MixerEqApply(0);
+    XUA_MixerEqUpdate();
+
+    for(unsigned j = 0; j < TEST_SAMPLES; j++)
+    {
+        /* Leave headroom for the boost */
+        int x = ((int) random(&seed)) >> 2;
+        double y = x;
+
+        for(unsigned k = 0; k < XUA_MIXER_EQ_BIQUADS; k++)
+        {
+            const double *c = &coeffs[k * XUA_MIXER_EQ_COEFFS];
+            double out = c[0] * y + c[1] * state[k][0] + c[2] * state[k][1] + c[3] * state[k + 1][0]
+                + c[4] * state[k + 1][1];
+
+            state[k][1] = state[k][0];
+            state[k][0] = y;
+            y = out;
+        }
+        state[XUA_MIXER_EQ_BIQUADS][1] = state[XUA_MIXER_EQ_BIQUADS][0];
+        state[XUA_MIXER_EQ_BIQUADS][0] = y;
+
+        /* Coefficient quantisation and rounding of each section, relative to full scale */
+        int out = XUA_MixerEq(0, x);
+        dprintf("%d %d %f\n", j, out, y);
+        TEST_ASSERT_TRUE(fabs(out - y) < 1024);
+
+        /* Other outputs are unaffected */
+        TEST_ASSERT_EQUAL_INT32(x, XUA_MixerEq(1, x));
+    }
+}
+
+void test_mixer_eq_double_buffer(void)
+{
+    double coeffs[XUA_MIXER_EQ_BANK_COEFFS] = {0};
+
+    XUA_MixerEqInit();
+
+    /* Half gain, written to the shadow bank only */
+    coeffs[0] = 0.5;
+    coeffs[XUA_MIXER_EQ_COEFFS] = 1.0;
+    load(0, coeffs);
+    TEST_ASSERT_EQUAL_INT32(0x10000, XUA_MixerEq(0, 0x10000));
+
+    XUA_MixerEqApply(0);
+    XUA_MixerEqUpdate();
+    TEST_ASSERT_EQUAL_INT32(0x8000, XUA_MixerEq(0, 0x10000));
+
+    /* The shadow bank now holds the pass through coefficients */
+    XUA_MixerEqApply(0);
+    XUA_MixerEqUpdate();
+    TEST_ASSERT_EQUAL_INT32(0x10000, XUA_MixerEq(0, 0x10000));
+
+    /* Out of range writes are ignored */
+    XUA_MixerEqSetCoeff(XUA_MIXER_EQ_CHANS, 0, 0);
+    XUA_MixerEqSetCoeff(0, XUA_MIXER_EQ_BANK_COEFFS, 0);
+    XUA_MixerEqApply(XUA_MIXER_EQ_CHANS);
+    XUA_MixerEqUpdate();
+    TEST_ASSERT_EQUAL_INT32(0x10000, XUA_MixerEq(0, 0x10000));
+}
+
+void test_mixer_eq_swap_timing(void)
+{
+    double coeffs[XUA_MIXER_EQ_BANK_COEFFS] = {0};
+
+    XUA_MixerEqInit();
+
+    coeffs[0] = 0.5;
+    coeffs[XUA_MIXER_EQ_COEFFS] = 1.0;
+    load(0, coeffs);
+
+    /* The live bank filters every sample until the swap is taken */
+    XUA_MixerEqApply(0);
+    TEST_ASSERT_EQUAL_INT32(0x10000, XUA_MixerEq(0, 0x10000));
+    TEST_ASSERT_EQUAL_INT32(0x10000, XUA_MixerEq(0, 0x10000));
+
+    XUA_MixerEqUpdate();
+    TEST_ASSERT_EQUAL_INT32(0x8000, XUA_MixerEq(0, 0x10000));
+
+    /* Only outputs with a swap pending are swapped */
+    XUA_MixerEqUpdate();
+    TEST_ASSERT_EQUAL_INT32(0x8000, XUA_MixerEq(0, 0x10000));
+    TEST_ASSERT_EQUAL_INT32(0x10000, XUA_MixerEq(1, 0x10000));
+}
+
+void test_mixer_eq_swap_two_thread(void)
+{
+    int before, after;
+
+    XUA_MixerEqInit();
+
+    /* Half gain in the shadow bank */
+    XUA_MixerEqSetCoeff(0, 0, Q30(0.5));
+
+    /* One thread requests the swap then writes a quarter gain, whilst the other filters a sample some time later
+     * before taking the swap. The write must wait for the swap, rather than landing in the bank going live */
+    mixer_eq_two_thread_c_wrapper(Q30(0.25), 0x10000, 10000, &before, &after);
+    TEST_ASSERT_EQUAL_INT32(0x10000, before);
+    TEST_ASSERT_EQUAL_INT32(0x8000, after);
+
+    /* The write went to the bank swapped out */
+    XUA_MixerEqApply(0);
+    XUA_MixerEqUpdate();
+    TEST_ASSERT_EQUAL_INT32(0x4000, XUA_MixerEq(0, 0x10000));
+}
+
+void test_mixer_eq_saturation(void)
+{
+    double coeffs[XUA_MIXER_EQ_BANK_COEFFS] = {0};
+
+    XUA_MixerEqInit();
+
+    coeffs[0] = 1.5;
+    coeffs[XUA_MIXER_EQ_COEFFS] = 1.0;
+    load(1, coeffs);
+    XUA_MixerEqApply(1);
+    XUA_MixerEqUpdate();
+
+    TEST_ASSERT_EQUAL_INT32(0x7fffffff, XUA_MixerEq(1, 0x7fffffff));
+    TEST_ASSERT_EQUAL_INT32(-0x7fffffff - 1, XUA_MixerEq(1, -0x7fffffff - 1));
+
+    /* State is cleared */
+    XUA_MixerEqReset();
+    TEST_ASSERT_EQUAL_INT32(0x300, XUA_MixerEq(1, 0x200));
+}
@@ -924,3 +924,93 @@ void test_report_time_calc( void )
     TEST_ASSERT_EQUAL_UINT( reportTime1 + reportPeriod1, nextReportTime1 );
     TEST_ASSERT_EQUAL_UINT( reportTime2 + reportPeriod2, nextReportTime2 );
 }
+
+void test_next_due_report_id( void )
+{
+    test_init();
+    unsigned reportId;
+
+    // Silence periodic reports so only changes are due
+    for ( reportId = 1; reportId <= HID_REPORT_COUNT; ++reportId ) {
+        hidSetIdle( reportId, 1 );
+    }
+
+    unsigned now;
+    asm volatile( "gettime %0" : "=r" ( now ));
+    TEST_ASSERT_EQUAL_UINT( HID_REPORT_ID_NONE, hidGetNextDueReportId( now ));
+
+    // Oldest change first, regardless of Report ID order
+    hidSetChangePending( 3 );
+    hidSetChangePending( 1 );
+    hidSetChangePending( 2 );
+
+    asm volatile( "gettime %0" : "=r" ( now ));
+    TEST_ASSERT_EQUAL_UINT( 3, hidGetNextDueReportId( now ));
+    hidClearChangePending( 3 );
+    TEST_ASSERT_EQUAL_UINT( 1, hidGetNextDueReportId( now ));
+    hidClearChangePending( 1 );
+    TEST_ASSERT_EQUAL_UINT( 2, hidGetNextDueReportId( now ));
+    hidClearChangePending( 2 );
+    TEST_ASSERT_EQUAL_UINT( HID_REPORT_ID_NONE, hidGetNextDueReportId( now ));
+}
+
+void test_next_due_report_id_periodic( void )
+{
+    test_init();
+    unsigned reportId;
+
+    for ( reportId = 1; reportId <= HID_REPORT_COUNT; ++reportId ) {
+        hidSetIdle( reportId, 1 );
+    }
+
+    // Report 2 becomes due periodically
+    hidSetIdle( 2, 0 );
+    hidSetReportPeriod( 2, 10 );
+    hidCaptureReportTime( 2, 1000 );
+    hidCalcNextReportTime( 2 );
+
+    TEST_ASSERT_EQUAL_UINT( HID_REPORT_ID_NONE, hidGetNextDueReportId( 1005 ));
+    TEST_ASSERT_EQUAL_UINT( 2, hidGetNextDueReportId( 1010 ));
+}
+
+// Benchmarks, cycling through the last valid location of each report such that the Report ID is looked up each call
+void test_bench_hidGetReportItem( void )
+{
+    test_init();
+    const unsigned bytes[ HID_REPORT_COUNT ] = { REPORT1_MAX_VALID_BYTE, REPORT2_MAX_VALID_BYTE, REPORT3_MAX_VALID_BYTE };
+    const unsigned bits[ HID_REPORT_COUNT ] = { REPORT1_MAX_VALID_BIT, REPORT2_MAX_VALID_BIT, REPORT3_MAX_VALID_BIT };
+    unsigned char data[ HID_REPORT_ITEM_MAX_SIZE ];
+    unsigned char header;
+    unsigned char page;
+    unsigned good = 0;
+    unsigned idx = 0;
+
+    unsigned t0 = get_time();
+    for( unsigned i = 0; i < XUA_UNIT_TEST_BENCH_CALLS; ++i ) {
+        good += ( HID_STATUS_GOOD == hidGetReportItem( idx + 1, bytes[ idx ], bits[ idx ], &page, &header, data ));
+        idx = ( idx == HID_REPORT_COUNT - 1 ) ? 0 : idx + 1;
+    }
+    unsigned t1 = get_time();
+
+    TEST_ASSERT_EQUAL_UINT( XUA_UNIT_TEST_BENCH_CALLS, good );
+
+    xua_bench_report( "hidGetReportItem", t1 - t0, XUA_UNIT_TEST_BENCH_CALLS );
+}
+
+// Times preparation from the item list, each call following a reset
+void test_bench_hidPrepareReportDescriptor( void )
+{
+    test_init();
+
+    unsigned t0 = get_time();
+    for( unsigned i = 0; i < XUA_UNIT_TEST_BENCH_CALLS; ++i ) {
+        hidResetReportDescriptor();
+        hidPrepareReportDescriptor();
+    }
+    unsigned t1 = get_time();
+
+    TEST_ASSERT_NOT_NULL( hidGetReportDescriptor() );
+    TEST_ASSERT_EQUAL_UINT( 2, hidGetReportLength( 2 ));
+
+    xua_bench_report( "hidPrepareReportDescriptor", t1 - t0, XUA_UNIT_TEST_BENCH_CALLS );
+}
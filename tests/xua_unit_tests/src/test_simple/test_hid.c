@@ -690,3 +690,44 @@ void test_report_time( void )
     unsigned nextReportTime = hidGetNextReportTime(0);
     TEST_ASSERT_EQUAL_UINT(133, nextReportTime);
 }
+
+// Benchmarks, alternating between the first and last valid locations
+void test_bench_hidGetReportItem( void )
+{
+    test_init();
+    const unsigned reportId = 0;
+    unsigned char data[ HID_REPORT_ITEM_MAX_SIZE ];
+    unsigned char header;
+    unsigned char page;
+    unsigned good = 0;
+
+    unsigned t0 = get_time();
+    for( unsigned i = 0; i < XUA_UNIT_TEST_BENCH_CALLS; ++i ) {
+        const unsigned byte = ( i & 1 ) ? MAX_VALID_BYTE : MIN_VALID_BYTE;
+        const unsigned bit = ( i & 1 ) ? MAX_VALID_BIT : MIN_VALID_BIT;
+        good += ( HID_STATUS_GOOD == hidGetReportItem( reportId, byte, bit, &page, &header, data ));
+    }
+    unsigned t1 = get_time();
+
+    TEST_ASSERT_EQUAL_UINT( XUA_UNIT_TEST_BENCH_CALLS, good );
+
+    xua_bench_report( "hidGetReportItem", t1 - t0, XUA_UNIT_TEST_BENCH_CALLS );
+}
+
+// Times preparation from the item list, each call following a reset
+void test_bench_hidPrepareReportDescriptor( void )
+{
+    test_init();
+
+    unsigned t0 = get_time();
+    for( unsigned i = 0; i < XUA_UNIT_TEST_BENCH_CALLS; ++i ) {
+        hidResetReportDescriptor();
+        hidPrepareReportDescriptor();
+    }
+    unsigned t1 = get_time();
+
+    TEST_ASSERT_NOT_NULL( hidGetReportDescriptor() );
+    TEST_ASSERT_EQUAL_UINT( HID_REPORT_LENGTH, hidGetReportLength( 0 ));
+
+    xua_bench_report( "hidPrepareReportDescriptor", t1 - t0, XUA_UNIT_TEST_BENCH_CALLS );
+}
@@ -7,11 +7,46 @@
 #include "xua_conf.h"
 #include "../../../lib_xua/src/midi/queue.h"
 
+/* Benchmark mode, build with -DXUA_UNIT_TEST_BENCH=1 (for example through EXTRA_BUILD_FLAGS). The test_bench_ cases
+ * then print the reference timer ticks and core clock cycles per call of the function they time. Otherwise they run
+ * as ordinary tests, without output */
+#ifndef XUA_UNIT_TEST_BENCH
+#define XUA_UNIT_TEST_BENCH         (0)
+#endif
+
+/* Calls timed by each benchmark */
+#ifndef XUA_UNIT_TEST_BENCH_CALLS
+#define XUA_UNIT_TEST_BENCH_CALLS   (512)
+#endif
+
+#define XUA_UNIT_TEST_TIMER_MHZ     (100)
+
 #ifndef __XC__
+#include <stdio.h>
+
+/* Reports, in benchmark mode, ticks of the reference timer over calls. The time includes the loop and C wrapper
+ * around the call */
+static inline void xua_bench_report(const char *name, unsigned ticks, unsigned calls)
+{
+    /* Hundredths of a tick per call */
+    unsigned long long perCall = ((unsigned long long) ticks * 100) / calls;
+
+#if (XUA_UNIT_TEST_BENCH)
+    printf("bench %s: %u.%02u ticks, %u core cycles per call\n", name, (unsigned) (perCall / 100),
+        (unsigned) (perCall % 100), (unsigned) ((perCall * XUD_CORE_CLOCK) / (XUA_UNIT_TEST_TIMER_MHZ * 100)));
+#else
+    (void) name;
+    (void) perCall;
+#endif
+}
+
 void midi_in_parse_c_wrapper(void * mips, unsigned cable_number, unsigned char b, unsigned * valid, unsigned * packed);
 void midi_out_parse_c_wrapper(unsigned tx_data, unsigned midi[3], unsigned * size);
 void reset_midi_state_c_wrapper(void *mips);
+void midi_in_parse_bytes_c_wrapper(void * mips, unsigned cable_number, const unsigned char bytes[], unsigned count,
+    unsigned events[], unsigned max_events, unsigned * consumed, unsigned * num_events);
 unsigned random(unsigned *x);
+unsigned get_time(void);
 
 void queue_init_c_wrapper(queue_t *q, unsigned size);
 int queue_is_empty_c_wrapper(const queue_t *q);
@@ -23,6 +58,17 @@ unsigned queue_pop_byte_c_wrapper(queue_t *q, unsigned char array[]);
 unsigned queue_items_c_wrapper(const queue_t *q);
 unsigned queue_space_c_wrapper(const queue_t *q);
 
+void queue_spsc_init_c_wrapper(queue_spsc_t *q, unsigned size);
+unsigned queue_spsc_items_c_wrapper(queue_spsc_t *q);
+unsigned queue_spsc_space_c_wrapper(queue_spsc_t *q);
+int queue_spsc_push_word_c_wrapper(queue_spsc_t *q, unsigned *array, unsigned data);
+int queue_spsc_pop_word_c_wrapper(queue_spsc_t *q, unsigned *array, unsigned *data);
+unsigned queue_spsc_push_words_c_wrapper(queue_spsc_t *q, unsigned *array, const unsigned *src, unsigned count);
+unsigned queue_spsc_pop_words_c_wrapper(queue_spsc_t *q, unsigned *array, unsigned *dst, unsigned count);
+unsigned queue_spsc_two_thread_c_wrapper(queue_spsc_t *q, unsigned *array, unsigned count);
+
+void mixer_eq_two_thread_c_wrapper(int coeff, int sample, unsigned delay, int *before, int *after);
+
 #endif
 
 #endif /* XUA_UNIT_TESTS_H_ */